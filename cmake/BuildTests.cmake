@@ -120,6 +120,7 @@ SET(TEST_RESOURCES ${TEST_DIR}/resources)
 GETSOURCEFILES(UNIT_TESTS "${TEST_DIR}/unit/")
 GETSOURCEFILES(NANOFI_UNIT_TESTS "${NANOFI_TEST_DIR}")
 GETSOURCEFILES(INTEGRATION_TESTS "${TEST_DIR}/integration/")
+GETSOURCEFILES(BENCHMARKS "${TEST_DIR}/benchmarks/")
 
 SET(UNIT_TEST_COUNT 0)
 FOREACH(testfile ${UNIT_TESTS})
@@ -172,6 +173,16 @@ FOREACH(testfile ${INTEGRATION_TESTS})
 ENDFOREACH()
 message("-- Finished building ${INT_TEST_COUNT} integration test file(s)...")
 
+# benchmarks are built alongside the tests but are not registered with ctest
+SET(BENCHMARK_COUNT 0)
+FOREACH(benchmarkfile ${BENCHMARKS})
+  get_filename_component(benchmarkfilename "${benchmarkfile}" NAME_WE)
+  add_executable("${benchmarkfilename}" "${TEST_DIR}/benchmarks/${benchmarkfile}")
+  createTests("${benchmarkfilename}")
+  MATH(EXPR BENCHMARK_COUNT "${BENCHMARK_COUNT}+1")
+ENDFOREACH()
+message("-- Finished building ${BENCHMARK_COUNT} benchmark file(s)...")
+
 get_property(extensions GLOBAL PROPERTY EXTENSION-TESTS)
 foreach(EXTENSION ${extensions})
 	add_subdirectory(${EXTENSION})
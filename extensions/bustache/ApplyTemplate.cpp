@@ -76,8 +76,8 @@ int64_t ApplyTemplate::WriteCallback::process(const std::shared_ptr<io::BaseStre
   bustache::format format(file);
   bustache::object data;
 
-  for (const auto &attr : flow_file_->getAttributes()) {
-    data[attr.first] = attr.second;
+  for (const auto &attr : flow_file_->getAttributeStore()) {
+    data[attr.key->name] = attr.value;
   }
 
   // TODO(calebj) write ostream reciever for format() to prevent excessive copying
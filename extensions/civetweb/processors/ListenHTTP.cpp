@@ -276,7 +276,7 @@ void ListenHTTP::Handler::set_header_attributes(const mg_request_info *req_info,
       if (!flow_file->updateAttribute("filename", header->value)) {
         flow_file->addAttribute("filename", header->value);
       }
-    } else if (std::regex_match(header->name, headers_as_attrs_regex_)) {
+    } else if (headers_as_attrs_regex_.matchesFully(header->name)) {
       if (!flow_file->updateAttribute(header->name, header->value)) {
         flow_file->addAttribute(header->name, header->value);
       }
@@ -340,7 +340,7 @@ bool ListenHTTP::Handler::auth_request(mg_connection *conn, const mg_request_inf
   // If this is a two-way TLS connection, authorize the peer against the configured pattern
   bool authorized = true;
   if (req_info->is_ssl && req_info->client_cert != nullptr) {
-    if (!std::regex_match(req_info->client_cert->subject, auth_dn_regex_)) {
+    if (!auth_dn_regex_.matchesFully(req_info->client_cert->subject)) {
       mg_printf(conn, "HTTP/1.1 403 Forbidden\r\n"
                 "Content-Type: text/html\r\n"
                 "Content-Length: 0\r\n\r\n");
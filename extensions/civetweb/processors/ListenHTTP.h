@@ -21,7 +21,6 @@
 #define __LISTEN_HTTP_H__
 
 #include <memory>
-#include <regex>
 
 #include <CivetServer.h>
 #include <concurrentqueue.h>
@@ -32,6 +31,7 @@
 #include "core/Core.h"
 #include "core/Resource.h"
 #include "core/logging/LoggerConfiguration.h"
+#include "utils/RegexUtils.h"
 
 namespace org {
 namespace apache {
@@ -120,8 +120,8 @@ class ListenHTTP : public core::Processor {
     void write_body(mg_connection *conn, const mg_request_info *req_info, bool include_payload = true);
 
     std::string base_uri_;
-    std::regex auth_dn_regex_;
-    std::regex headers_as_attrs_regex_;
+    utils::Regex auth_dn_regex_;
+    utils::Regex headers_as_attrs_regex_;
     core::ProcessContext *process_context_;
     core::ProcessSessionFactory *session_factory_;
 
@@ -27,8 +27,9 @@
 
 #include <utils/StringUtils.h>
 #include <utils/OsUtils.h>
+#include <utils/RegexUtils.h>
+#include <Exception.h>
 #include <expression/Expression.h>
-#include <regex>
 #ifndef DISABLE_CURL
 #include <curl/curl.h>
 #endif
@@ -753,18 +754,20 @@ Value expr_replace(const std::vector<Value> &args) {
   return Value(result);
 }
 
+Value expr_replaceFirst(const std::vector<Value> &args, const utils::Regex &find) {
+  return Value(find.replace(args[0].asString(), args[2].asString(), true));
+}
+
 Value expr_replaceFirst(const std::vector<Value> &args) {
-  std::string result = args[0].asString();
-  const std::regex find(args[1].asString());
-  const std::string &replace = args[2].asString();
-  return Value(std::regex_replace(result, find, replace, std::regex_constants::format_first_only));
+  return expr_replaceFirst(args, utils::Regex(args[1].asString()));
+}
+
+Value expr_replaceAll(const std::vector<Value> &args, const utils::Regex &find) {
+  return Value(find.replace(args[0].asString(), args[2].asString()));
 }
 
 Value expr_replaceAll(const std::vector<Value> &args) {
-  std::string result = args[0].asString();
-  const std::regex find(args[1].asString());
-  const std::string &replace = args[2].asString();
-  return Value(std::regex_replace(result, find, replace));
+  return expr_replaceAll(args, utils::Regex(args[1].asString()));
 }
 
 Value expr_replaceNull(const std::vector<Value> &args) {
@@ -776,24 +779,41 @@ Value expr_replaceNull(const std::vector<Value> &args) {
 }
 
 Value expr_replaceEmpty(const std::vector<Value> &args) {
-  std::string result = args[0].asString();
-  const std::regex find("^[ \n\r\t]*$");
-  const std::string &replace = args[1].asString();
-  return Value(std::regex_replace(result, find, replace));
+  static const utils::Regex find("^[ \n\r\t]*$");
+  return Value(find.replace(args[0].asString(), args[1].asString()));
+}
+
+Value expr_matches(const std::vector<Value> &args, const utils::Regex &expr) {
+  return Value(expr.matchesFully(args[0].asString()));
 }
 
 Value expr_matches(const std::vector<Value> &args) {
-  const auto &subject = args[0].asString();
-  const std::regex expr = std::regex(args[1].asString());
+  return expr_matches(args, utils::Regex(args[1].asString()));
+}
 
-  return Value(std::regex_match(subject.begin(), subject.end(), expr));
+Value expr_find(const std::vector<Value> &args, const utils::Regex &expr) {
+  return Value(expr.find(args[0].asString()));
 }
 
 Value expr_find(const std::vector<Value> &args) {
-  const auto &subject = args[0].asString();
-  const std::regex expr = std::regex(args[1].asString());
+  return expr_find(args, utils::Regex(args[1].asString()));
+}
 
-  return Value(std::regex_search(subject.begin(), subject.end(), expr));
+/**
+ * Compiles the regex of a pattern argument once when the pattern is static.
+ *
+ * @return compiled regex, or nullptr when the pattern has to be compiled on every evaluation
+ */
+std::shared_ptr<const utils::Regex> make_static_regex(const Expression &pattern) {
+  if (pattern.is_dynamic()) {
+    return nullptr;
+  }
+  try {
+    return std::make_shared<const utils::Regex>(pattern( { }).asString());
+  } catch (const Exception &) {
+    // invalid patterns keep failing on evaluation
+    return nullptr;
+  }
 }
 
 #endif  // EXPRESSION_LANGUAGE_USE_REGEX
@@ -908,6 +928,24 @@ Value expr_random(const std::vector<Value> &args) {
   return Value(distribution(generator));
 }
 
+/**
+ * Whether the function only depends on its arguments, so that calls with static
+ * arguments can be evaluated once when the expression is compiled.
+ */
+bool is_foldable(const std::string &function_name) {
+  return function_name != "hostname" && function_name != "ip" && function_name != "UUID" && function_name != "random" && function_name != "now"
+      && function_name != "resolve_user_id";
+}
+
+bool all_static(const std::vector<Expression> &args) {
+  for (const auto &arg : args) {
+    if (arg.is_dynamic()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template<Value T(const std::vector<Value> &)>
 Expression make_dynamic_function_incomplete(const std::string &function_name, const std::vector<Expression> &args, std::size_t num_args) {
 
@@ -917,6 +955,18 @@ Expression make_dynamic_function_incomplete(const std::string &function_name, co
     throw std::runtime_error(message_ss.str());
   }
 
+  if (is_foldable(function_name) && all_static(args)) {
+    std::vector<Value> evaluated_args;
+    for (const auto &arg : args) {
+      evaluated_args.emplace_back(arg( { }));
+    }
+    try {
+      return Expression(T(evaluated_args));
+    } catch (const std::exception &) {
+      // leave the error to evaluation, where it has always been raised
+    }
+  }
+
   if (!args.empty() && args[0].is_multi()) {
     std::vector<Expression> multi_args;
 
@@ -941,6 +991,35 @@ Expression make_dynamic_function_incomplete(const std::string &function_name, co
   }
 }
 
+#ifdef EXPRESSION_LANGUAGE_USE_REGEX
+
+/**
+ * Creates a regex function whose pattern, the second argument, is compiled once
+ * at compile time when it is static.
+ */
+template<Value T(const std::vector<Value> &), Value T_compiled(const std::vector<Value> &, const utils::Regex &)>
+Expression make_regex_function(const std::string &function_name, const std::vector<Expression> &args, std::size_t num_args) {
+  if (args.size() <= num_args || args[0].is_multi() || all_static(args)) {
+    return make_dynamic_function_incomplete<T>(function_name, args, num_args);
+  }
+  auto regex = make_static_regex(args[1]);
+  if (!regex) {
+    return make_dynamic_function_incomplete<T>(function_name, args, num_args);
+  }
+  return make_dynamic([=](const Parameters &params, const std::vector<Expression> &sub_exprs) -> Value {
+    std::vector<Value> evaluated_args;
+    evaluated_args.reserve(args.size());
+
+    for (const auto &arg : args) {
+      evaluated_args.emplace_back(arg(params));
+    }
+
+    return T_compiled(evaluated_args, *regex);
+  });
+}
+
+#endif  // EXPRESSION_LANGUAGE_USE_REGEX
+
 Value expr_literal(const std::vector<Value> &args) {
   return args[0];
 }
@@ -1146,20 +1225,29 @@ Expression make_allMatchingAttributes(const std::string &function_name, const st
     return Value(all_true);
   });
 
+  std::vector<std::shared_ptr<const utils::Regex>> static_regexes;
+  for (const auto &arg : args) {
+    static_regexes.push_back(make_static_regex(arg));
+  }
+
   result.make_multi([=](const Parameters &params) -> std::vector<Expression> {
     std::vector<Expression> out_exprs;
+    const auto cur_flow_file = params.flow_file.lock();
+    std::map<std::string, std::string> attrs;
 
-    for (const auto &arg : args) {
-      const std::regex attr_regex = std::regex(arg(params).asString());
-      const auto cur_flow_file = params.flow_file.lock();
-      std::map<std::string, std::string> attrs;
+    if (cur_flow_file) {
+      attrs = cur_flow_file->getAttributes();
+    }
 
-      if (cur_flow_file) {
-        attrs = cur_flow_file->getAttributes();
+    for (std::size_t i = 0; i < args.size(); i++) {
+      auto attr_regex_ptr = static_regexes[i];
+      if (!attr_regex_ptr) {
+        attr_regex_ptr = std::make_shared<const utils::Regex>(args[i](params).asString());
       }
+      const utils::Regex &attr_regex = *attr_regex_ptr;
 
       for (const auto &attr : attrs) {
-        if (std::regex_match(attr.first.begin(), attr.first.end(), attr_regex)) {
+        if (attr_regex.matchesFully(attr.first)) {
           out_exprs.emplace_back(make_dynamic([=](const Parameters &params,
                       const std::vector<Expression> &sub_exprs) -> Value {
                     std::string attr_val;
@@ -1199,20 +1287,29 @@ Expression make_anyMatchingAttribute(const std::string &function_name, const std
     return Value(any_true);
   });
 
+  std::vector<std::shared_ptr<const utils::Regex>> static_regexes;
+  for (const auto &arg : args) {
+    static_regexes.push_back(make_static_regex(arg));
+  }
+
   result.make_multi([=](const Parameters &params) -> std::vector<Expression> {
     std::vector<Expression> out_exprs;
+    const auto cur_flow_file = params.flow_file.lock();
+    std::map<std::string, std::string> attrs;
 
-    for (const auto &arg : args) {
-      const std::regex attr_regex = std::regex(arg(params).asString());
-      const auto cur_flow_file = params.flow_file.lock();
-      std::map<std::string, std::string> attrs;
+    if (cur_flow_file) {
+      attrs = cur_flow_file->getAttributes();
+    }
 
-      if (cur_flow_file) {
-        attrs = cur_flow_file->getAttributes();
+    for (std::size_t i = 0; i < args.size(); i++) {
+      auto attr_regex_ptr = static_regexes[i];
+      if (!attr_regex_ptr) {
+        attr_regex_ptr = std::make_shared<const utils::Regex>(args[i](params).asString());
       }
+      const utils::Regex &attr_regex = *attr_regex_ptr;
 
       for (const auto &attr : attrs) {
-        if (std::regex_match(attr.first.begin(), attr.first.end(), attr_regex)) {
+        if (attr_regex.matchesFully(attr.first)) {
           out_exprs.emplace_back(make_dynamic([=](const Parameters &params,
                       const std::vector<Expression> &sub_exprs) -> Value {
                     std::string attr_val;
@@ -1426,17 +1523,17 @@ Expression make_dynamic_function(const std::string &function_name, const std::ve
   } else if (function_name == "replace") {
     return make_dynamic_function_incomplete<expr_replace>(function_name, args, 2);
   } else if (function_name == "replaceFirst") {
-    return make_dynamic_function_incomplete<expr_replaceFirst>(function_name, args, 2);
+    return make_regex_function<expr_replaceFirst, expr_replaceFirst>(function_name, args, 2);
   } else if (function_name == "replaceAll") {
-    return make_dynamic_function_incomplete<expr_replaceAll>(function_name, args, 2);
+    return make_regex_function<expr_replaceAll, expr_replaceAll>(function_name, args, 2);
   } else if (function_name == "replaceNull") {
     return make_dynamic_function_incomplete<expr_replaceNull>(function_name, args, 1);
   } else if (function_name == "replaceEmpty") {
     return make_dynamic_function_incomplete<expr_replaceEmpty>(function_name, args, 1);
   } else if (function_name == "matches") {
-    return make_dynamic_function_incomplete<expr_matches>(function_name, args, 1);
+    return make_regex_function<expr_matches, expr_matches>(function_name, args, 1);
   } else if (function_name == "find") {
-    return make_dynamic_function_incomplete<expr_find>(function_name, args, 1);
+    return make_regex_function<expr_find, expr_find>(function_name, args, 1);
   } else if (function_name == "allMatchingAttributes") {
     return make_allMatchingAttributes(function_name, args);
   } else if (function_name == "anyMatchingAttribute") {
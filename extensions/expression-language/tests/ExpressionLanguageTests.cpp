@@ -1570,3 +1570,40 @@ TEST_CASE("resolve_user_id_test", "[resolve_user_id tests]") {  // NOLINT
 }
 }
 
+
+TEST_CASE("Static function calls are folded", "[expressionLanguageConstantFolding]") {  // NOLINT
+  auto expr = expression::compile("${literal('abc'):toUpper():append(${literal(2):plus(3)})}");
+  REQUIRE_FALSE(expr.is_dynamic());
+  REQUIRE("ABC5" == expr( { }).asString());
+}
+
+TEST_CASE("Non-deterministic function calls are not folded", "[expressionLanguageConstantFolding2]") {  // NOLINT
+  auto expr = expression::compile("${literal('abc'):append(${UUID()})}");
+  REQUIRE(expr.is_dynamic());
+  REQUIRE(expr( { }).asString() != expr( { }).asString());
+}
+
+TEST_CASE("Static patterns are reused across flow files", "[expressionLanguageStaticPattern]") {  // NOLINT
+  auto expr = expression::compile("${attr:replaceAll('\\\\..*', ''):matches('[a-z]+')}");
+
+  auto flow_file_a = std::make_shared<MockFlowFile>();
+  flow_file_a->addAttribute("attr", "filename.txt");
+  auto flow_file_b = std::make_shared<MockFlowFile>();
+  flow_file_b->addAttribute("attr", "file name.txt");
+  REQUIRE("true" == expr( { flow_file_a }).asString());
+  REQUIRE("false" == expr( { flow_file_b }).asString());
+  REQUIRE("true" == expr( { flow_file_a }).asString());
+}
+
+TEST_CASE("Dynamic patterns are compiled on evaluation", "[expressionLanguageDynamicPattern]") {  // NOLINT
+  auto expr = expression::compile("${attr:find(${pattern})}");
+
+  auto flow_file_a = std::make_shared<MockFlowFile>();
+  flow_file_a->addAttribute("attr", "a brand new filename.txt");
+  flow_file_a->addAttribute("pattern", "[Bb]rand");
+  auto flow_file_b = std::make_shared<MockFlowFile>();
+  flow_file_b->addAttribute("attr", "a brand new filename.txt");
+  flow_file_b->addAttribute("pattern", "^brand");
+  REQUIRE("true" == expr( { flow_file_a }).asString());
+  REQUIRE("false" == expr( { flow_file_b }).asString());
+}
@@ -52,6 +52,29 @@ HTTPClient::HTTPClient(const std::string &url, const std::shared_ptr<minifi::con
   http_session_ = curl_easy_init();
 }
 
+HTTPClient::HTTPClient(const std::string &url, const std::shared_ptr<HTTPConnectionPool> &connection_pool,
+                       const std::shared_ptr<minifi::controllers::SSLContextService> ssl_context_service)
+    : core::Connectable("HTTPClient"),
+      ssl_context_service_(ssl_context_service),
+      url_(url),
+      connect_timeout_(0),
+      read_timeout_(0),
+      content_type_str_(nullptr),
+      headers_(nullptr),
+      callback(nullptr),
+      write_callback_(nullptr),
+      http_code(0),
+      read_callback_(INT_MAX),
+      header_response_(-1),
+      res(CURLE_OK),
+      connection_pool_(connection_pool),
+      keep_alive_probe_(HTTPConnectionPool::KEEP_ALIVE_INTERVAL_SECONDS),
+      keep_alive_idle_(HTTPConnectionPool::KEEP_ALIVE_IDLE_SECONDS),
+      logger_(logging::LoggerFactory<HTTPClient>::getLogger()) {
+  // pooled connections stay open between requests, so they are kept alive
+  http_session_ = connection_pool_ != nullptr ? connection_pool_->acquire() : curl_easy_init();
+}
+
 HTTPClient::HTTPClient(std::string name, utils::Identifier uuid)
     : core::Connectable(name, uuid),
       ssl_context_service_(nullptr),
@@ -98,7 +121,11 @@ HTTPClient::~HTTPClient() {
     headers_ = nullptr;
   }
   if (http_session_ != nullptr) {
-    curl_easy_cleanup(http_session_);
+    if (connection_pool_ != nullptr) {
+      connection_pool_->release(http_session_);
+    } else {
+      curl_easy_cleanup(http_session_);
+    }
     http_session_ = nullptr;
   }
   // forceClose ended up not being the issue in MINIFICPP-667, but leaving here
@@ -275,6 +302,12 @@ void HTTPClient::setUseChunkedEncoding() {
 }
 
 bool HTTPClient::submit() {
+  if (!prepare())
+    return false;
+  return finish(curl_easy_perform(http_session_));
+}
+
+bool HTTPClient::prepare() {
   if (IsNullOrEmpty(url_))
     return false;
   if (connect_timeout_ > 0) {
@@ -306,7 +339,11 @@ bool HTTPClient::submit() {
     logger_->log_debug("Not using keep alive");
     curl_easy_setopt(http_session_, CURLOPT_TCP_KEEPALIVE, 0L);
   }
-  res = curl_easy_perform(http_session_);
+  return true;
+}
+
+bool HTTPClient::finish(CURLcode result) {
+  res = result;
   if (callback == nullptr) {
     read_callback_.close();
   }
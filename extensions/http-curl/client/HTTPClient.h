@@ -42,6 +42,7 @@
 #include <vector>
 
 #include "utils/ByteArrayCallback.h"
+#include "HTTPConnectionPool.h"
 #include "controllers/SSLContextService.h"
 #include "core/logging/Logger.h"
 #include "core/logging/LoggerConfiguration.h"
@@ -71,6 +72,12 @@ class HTTPClient : public BaseHTTPClient, public core::Connectable {
 
   HTTPClient(const std::string &url, const std::shared_ptr<minifi::controllers::SSLContextService> ssl_context_service = nullptr);
 
+  /**
+   * Creates a client whose connections are reused by the other clients of the pool.
+   */
+  HTTPClient(const std::string &url, const std::shared_ptr<HTTPConnectionPool> &connection_pool,
+             const std::shared_ptr<minifi::controllers::SSLContextService> ssl_context_service = nullptr);
+
   ~HTTPClient();
 
   static int debug_callback(CURL *handle, curl_infotype type, char *data, size_t size, void *userptr);
@@ -105,6 +112,24 @@ class HTTPClient : public BaseHTTPClient, public core::Connectable {
 
   bool submit() override;
 
+  /**
+   * Applies the options of the request to the session, without performing it, so that
+   * the session can be driven by a curl multi handle.
+   * @return false if the request cannot be sent
+   */
+  bool prepare();
+
+  /**
+   * Collects the response of a prepared session once it was performed.
+   * @param result result of performing the session
+   * @return true if the request succeeded
+   */
+  bool finish(CURLcode result);
+
+  CURL *getSession() {
+    return http_session_;
+  }
+
   CURLcode getResponseResult();
 
   int64_t &getResponseCode() override;
@@ -246,6 +271,9 @@ class HTTPClient : public BaseHTTPClient, public core::Connectable {
 
   CURL *http_session_;
 
+  // pool that owns the session, if any
+  std::shared_ptr<HTTPConnectionPool> connection_pool_;
+
   std::string method_;
 
   long keep_alive_probe_;
@@ -0,0 +1,149 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "HTTPConnectionPool.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "utils/HTTPClient.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+constexpr size_t HTTPConnectionPool::DEFAULT_MAX_IDLE_HANDLES;
+constexpr long HTTPConnectionPool::KEEP_ALIVE_IDLE_SECONDS;
+constexpr long HTTPConnectionPool::KEEP_ALIVE_INTERVAL_SECONDS;
+
+std::mutex HTTPConnectionPool::registry_mutex_;
+std::map<std::string, std::weak_ptr<HTTPConnectionPool>> HTTPConnectionPool::registry_;
+
+HTTPConnectionPool::HTTPConnectionPool(size_t max_idle_handles)
+    : max_idle_handles_(max_idle_handles) {
+  share_ = curl_share_init();
+  curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &HTTPConnectionPool::lock);
+  curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &HTTPConnectionPool::unlock);
+  curl_share_setopt(share_, CURLSHOPT_USERDATA, static_cast<void*>(this));
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if CURL_AT_LEAST_VERSION(7, 57, 0)
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+}
+
+HTTPConnectionPool::~HTTPConnectionPool() {
+  for (auto handle : idle_handles_) {
+    curl_easy_cleanup(handle);
+  }
+  idle_handles_.clear();
+  // every client holds on to the pool, so none of the handles still uses the share
+  curl_share_cleanup(share_);
+}
+
+std::shared_ptr<HTTPConnectionPool> HTTPConnectionPool::getPool(const std::string &url) {
+  std::string parsed_url = url, host, protocol, key = url;
+  int port = -1;
+  parse_url(&parsed_url, &host, &port, &protocol);
+  if (!protocol.empty()) {
+    key = protocol + host + ":" + std::to_string(port);
+  }
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  auto pool = registry_[key].lock();
+  if (pool == nullptr) {
+    // drops the pools of hosts no longer in use, so the registry does not grow with every host ever used
+    for (auto it = registry_.begin(); it != registry_.end();) {
+      if (it->second.expired()) {
+        it = registry_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    pool = std::make_shared<HTTPConnectionPool>();
+    registry_[key] = pool;
+  }
+  return pool;
+}
+
+CURL *HTTPConnectionPool::acquire() {
+  CURL *handle = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!idle_handles_.empty()) {
+      handle = idle_handles_.back();
+      idle_handles_.pop_back();
+    }
+  }
+  if (handle == nullptr) {
+    handle = curl_easy_init();
+  }
+  if (handle != nullptr) {
+    configure(handle);
+  }
+  return handle;
+}
+
+void HTTPConnectionPool::release(CURL *handle) {
+  if (handle == nullptr) {
+    return;
+  }
+  // a reset clears the options of the finished request, but keeps the connections of the handle open
+  curl_easy_reset(handle);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_handles_.size() < max_idle_handles_) {
+      idle_handles_.push_back(handle);
+      return;
+    }
+  }
+  curl_easy_cleanup(handle);
+}
+
+size_t HTTPConnectionPool::getIdleCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_handles_.size();
+}
+
+bool HTTPConnectionPool::supportsHTTP2() {
+  curl_version_info_data *info = curl_version_info(CURLVERSION_NOW);
+  return info != nullptr && (info->features & CURL_VERSION_HTTP2) != 0;
+}
+
+void HTTPConnectionPool::configure(CURL *handle) {
+  curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+  if (supportsHTTP2()) {
+    // plain connections keep HTTP/1.1, secure ones negotiate HTTP/2 and multiplex onto an open connection
+    curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+  }
+}
+
+void HTTPConnectionPool::lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *pool) {
+  static_cast<HTTPConnectionPool*>(pool)->share_mutexes_[data].lock();
+}
+
+void HTTPConnectionPool::unlock(CURL *handle, curl_lock_data data, void *pool) {
+  static_cast<HTTPConnectionPool*>(pool)->share_mutexes_[data].unlock();
+}
+
+} /* namespace utils */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
@@ -0,0 +1,109 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef EXTENSIONS_HTTP_CURL_CLIENT_HTTPCONNECTIONPOOL_H_
+#define EXTENSIONS_HTTP_CURL_CLIENT_HTTPCONNECTIONPOOL_H_
+
+#ifdef WIN32
+#define CURL_STATICLIB
+#endif
+#include <curl/curl.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Purpose: Lets the HTTP clients of a remote host reuse its open connections, TLS sessions and
+ * resolved addresses, rather than every request paying for its own connection and handshake.
+ *
+ * Design: The clients of a pool share a curl share handle, which holds the connection cache
+ * when libcurl supports sharing it, along with the TLS session and DNS caches. Finished easy
+ * handles are reset and kept idle, so that a later client also reuses the connections each
+ * handle still caches. HTTP/2 is negotiated over TLS when libcurl supports it. Pools are
+ * registered per host, and a pool lives as long as any of its clients.
+ */
+class HTTPConnectionPool {
+ public:
+  static constexpr size_t DEFAULT_MAX_IDLE_HANDLES = 8;
+  // seconds a pooled connection may stay idle before TCP keep-alive probes are sent, and between probes
+  static constexpr long KEEP_ALIVE_IDLE_SECONDS = 60;
+  static constexpr long KEEP_ALIVE_INTERVAL_SECONDS = 30;
+
+  explicit HTTPConnectionPool(size_t max_idle_handles = DEFAULT_MAX_IDLE_HANDLES);
+
+  ~HTTPConnectionPool();
+
+  /**
+   * Returns the pool of the scheme, host and port of the url, creating it if none of its
+   * clients is alive.
+   */
+  static std::shared_ptr<HTTPConnectionPool> getPool(const std::string &url);
+
+  /**
+   * Takes an idle easy handle, or creates one, attached to the shared caches.
+   */
+  CURL *acquire();
+
+  /**
+   * Returns an easy handle once its request finished. The handle is cleaned up if the pool already
+   * holds as many idle handles as allowed.
+   */
+  void release(CURL *handle);
+
+  size_t getIdleCount() const;
+
+  /**
+   * Determines whether libcurl was built with HTTP/2 support.
+   */
+  static bool supportsHTTP2();
+
+  HTTPConnectionPool(const HTTPConnectionPool &other) = delete;
+  HTTPConnectionPool &operator=(const HTTPConnectionPool &other) = delete;
+
+ private:
+  static void lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *pool);
+  static void unlock(CURL *handle, curl_lock_data data, void *pool);
+
+  // applies the options that curl_easy_reset clears
+  void configure(CURL *handle);
+
+  CURLSH *share_;
+  std::mutex share_mutexes_[CURL_LOCK_DATA_LAST];
+
+  mutable std::mutex mutex_;
+  size_t max_idle_handles_;
+  std::vector<CURL*> idle_handles_;
+
+  static std::mutex registry_mutex_;
+  static std::map<std::string, std::weak_ptr<HTTPConnectionPool>> registry_;
+};
+
+} /* namespace utils */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* EXTENSIONS_HTTP_CURL_CLIENT_HTTPCONNECTIONPOOL_H_ */
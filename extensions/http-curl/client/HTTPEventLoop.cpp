@@ -0,0 +1,185 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "HTTPEventLoop.h"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+constexpr int HTTPEventLoop::WAIT_MILLIS;
+constexpr int HTTPEventLoop::IDLE_WAIT_MILLIS;
+
+HTTPEventLoop::HTTPEventLoop()
+    : running_(false),
+      active_count_(0),
+      logger_(logging::LoggerFactory<HTTPEventLoop>::getLogger()) {
+  multi_ = curl_multi_init();
+#if CURL_AT_LEAST_VERSION(7, 43, 0)
+  curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+}
+
+HTTPEventLoop::~HTTPEventLoop() {
+  stop();
+  curl_multi_cleanup(multi_);
+}
+
+void HTTPEventLoop::start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (running_) {
+    return;
+  }
+  running_ = true;
+  thread_ = std::thread(&HTTPEventLoop::run, this);
+}
+
+void HTTPEventLoop::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+  }
+  pending_condition_.notify_all();
+#if CURL_AT_LEAST_VERSION(7, 68, 0)
+  curl_multi_wakeup(multi_);
+#endif
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+bool HTTPEventLoop::submit(HTTPClient *client, Completion completion) {
+  if (client == nullptr || !client->prepare()) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return false;
+    }
+    Request request;
+    request.client = client;
+    request.completion = std::move(completion);
+    pending_.push_back(std::move(request));
+    active_count_++;
+  }
+  pending_condition_.notify_one();
+#if CURL_AT_LEAST_VERSION(7, 68, 0)
+  curl_multi_wakeup(multi_);
+#endif
+  return true;
+}
+
+void HTTPEventLoop::run() {
+  logger_->log_debug("Starting HTTP event loop");
+  while (running_) {
+    if (active_.empty()) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      pending_condition_.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_MILLIS), [&] {
+        return !pending_.empty() || !running_;});
+    }
+    addPending();
+    int running_handles = 0;
+    curl_multi_perform(multi_, &running_handles);
+    completeFinished();
+    if (!active_.empty()) {
+#if CURL_AT_LEAST_VERSION(7, 68, 0)
+      curl_multi_poll(multi_, nullptr, 0, WAIT_MILLIS, nullptr);
+#else
+      curl_multi_wait(multi_, nullptr, 0, WAIT_MILLIS, nullptr);
+#endif
+    }
+  }
+  completeAll();
+  logger_->log_debug("Stopped HTTP event loop");
+}
+
+void HTTPEventLoop::addPending() {
+  std::vector<Request> requests;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    requests.swap(pending_);
+  }
+  for (auto &request : requests) {
+    CURL *handle = request.client->getSession();
+    if (curl_multi_add_handle(multi_, handle) != CURLM_OK) {
+      logger_->log_error("Could not add the request for %s to the event loop", request.client->getURL());
+      active_count_--;
+      request.completion(false);
+      continue;
+    }
+    active_[handle] = std::move(request);
+  }
+}
+
+void HTTPEventLoop::completeFinished() {
+  CURLMsg *message = nullptr;
+  int queued = 0;
+  while ((message = curl_multi_info_read(multi_, &queued)) != nullptr) {
+    if (message->msg != CURLMSG_DONE) {
+      continue;
+    }
+    CURL *handle = message->easy_handle;
+    CURLcode result = message->data.result;
+    curl_multi_remove_handle(multi_, handle);
+    auto it = active_.find(handle);
+    if (it == active_.end()) {
+      continue;
+    }
+    Request request = std::move(it->second);
+    active_.erase(it);
+    bool success = request.client->finish(result);
+    active_count_--;
+    request.completion(success);
+  }
+}
+
+void HTTPEventLoop::completeAll() {
+  for (auto &entry : active_) {
+    curl_multi_remove_handle(multi_, entry.first);
+    entry.second.client->finish(CURLE_ABORTED_BY_CALLBACK);
+    active_count_--;
+    entry.second.completion(false);
+  }
+  active_.clear();
+  std::vector<Request> requests;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    requests.swap(pending_);
+  }
+  for (auto &request : requests) {
+    active_count_--;
+    request.completion(false);
+  }
+}
+
+} /* namespace utils */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
@@ -0,0 +1,126 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef EXTENSIONS_HTTP_CURL_CLIENT_HTTPEVENTLOOP_H_
+#define EXTENSIONS_HTTP_CURL_CLIENT_HTTPEVENTLOOP_H_
+
+#ifdef WIN32
+#define CURL_STATICLIB
+#endif
+#include <curl/curl.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "HTTPClient.h"
+#include "core/logging/Logger.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace utils {
+
+/**
+ * Purpose: Keeps many HTTP requests in flight from a single thread, rather than blocking a
+ * thread on each request.
+ *
+ * Design: Prepared clients are handed to a thread that drives them through a curl multi handle,
+ * which reuses the connections of each host across requests and multiplexes HTTP/2 requests
+ * onto them. The completion of a request is called on that thread once its response arrived,
+ * so completions should hand the client over to another thread rather than process it there.
+ */
+class HTTPEventLoop {
+ public:
+  /**
+   * Called with whether the request succeeded. The client may be destroyed once it was called.
+   */
+  typedef std::function<void(bool)> Completion;
+
+  HTTPEventLoop();
+
+  ~HTTPEventLoop();
+
+  void start();
+
+  /**
+   * Stops the loop. The completions of the requests still in flight are called as failures.
+   */
+  void stop();
+
+  /**
+   * Sends the request of the client. The client must stay alive until the completion is called.
+   * @return false if the request cannot be sent, in which case the completion is not called
+   */
+  bool submit(HTTPClient *client, Completion completion);
+
+  /**
+   * Returns the number of requests that were submitted and have not completed yet.
+   */
+  size_t getActiveCount() const {
+    return active_count_;
+  }
+
+  HTTPEventLoop(const HTTPEventLoop &other) = delete;
+  HTTPEventLoop &operator=(const HTTPEventLoop &other) = delete;
+
+ private:
+  // milliseconds the loop waits on its sockets before it checks for new requests
+  static constexpr int WAIT_MILLIS = 10;
+  // milliseconds the loop waits for requests while none is in flight
+  static constexpr int IDLE_WAIT_MILLIS = 100;
+
+  struct Request {
+    HTTPClient *client;
+    Completion completion;
+  };
+
+  void run();
+
+  // moves the submitted requests into the multi handle
+  void addPending();
+
+  // removes the finished requests from the multi handle and completes them
+  void completeFinished();
+
+  void completeAll();
+
+  CURLM *multi_;
+  std::atomic<bool> running_;
+  std::thread thread_;
+
+  std::mutex mutex_;
+  std::condition_variable pending_condition_;
+  std::vector<Request> pending_;
+  // requests of the multi handle, only accessed by the loop
+  std::map<CURL*, Request> active_;
+  std::atomic<size_t> active_count_;
+
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+} /* namespace utils */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* EXTENSIONS_HTTP_CURL_CLIENT_HTTPEVENTLOOP_H_ */
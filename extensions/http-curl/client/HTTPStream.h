@@ -135,23 +135,21 @@ class HttpStream : public io::BaseStream {
     return submit_status;
   }
 
-  inline bool isFinished(int seconds = 0) {
-    if (http_client_future_.wait_for(std::chrono::seconds(seconds)) == std::future_status::ready && (http_read_callback_.getSize() == 0 && http_read_callback_.waitingOps())) {
-      return true;
-    } else {
-      return false;
-    }
+  /**
+   * Determines whether the response was read in full. The read callback is closed once
+   * the request finishes, so this does not block.
+   */
+  inline bool isFinished() {
+    return http_read_callback_.isClosed() && http_read_callback_.getSize() == 0 && http_read_callback_.waitingOps();
   }
 
   /**
-   * Waits for more data to become available.
+   * Waits for more data to become available, or for the request to finish.
+   * @return true if data is available
    */
   bool waitForDataAvailable() {
-    do {
-      logger_->log_trace("Waiting for more data");
-    } while (http_client_future_.wait_for(std::chrono::seconds(0)) != std::future_status::ready && http_read_callback_.getSize() == 0);
-
-    return http_read_callback_.getSize() > 0;
+    logger_->log_trace("Waiting for more data");
+    return http_read_callback_.waitForData();
   }
 
  protected:
@@ -104,6 +104,10 @@ core::Property InvokeHTTP::AlwaysOutputResponse("Always Output Response", "Will
 core::Property InvokeHTTP::PenalizeOnNoRetry("Penalize on \"No Retry\"", "Enabling this property will penalize FlowFiles that are routed to the \"No Retry\" relationship.", "false");
 
 core::Property InvokeHTTP::DisablePeerVerification("Disable Peer Verification", "Disables peer verification for the SSL session", "false");
+core::Property InvokeHTTP::MaxInFlightRequests("Max In-Flight Requests", "Maximum number of requests the tasks of the processor keep in flight. When greater than 1, "
+                                               "requests are sent asynchronously by an event loop, which reuses the connections of each host, and each "
+                                               "response is committed as soon as it arrives.",
+                                               "1");
 const char* InvokeHTTP::STATUS_CODE = "invokehttp.status.code";
 const char* InvokeHTTP::STATUS_MESSAGE = "invokehttp.status.message";
 const char* InvokeHTTP::RESPONSE_BODY = "invokehttp.response.body";
@@ -147,6 +151,7 @@ void InvokeHTTP::initialize() {
   properties.insert(SendBody);
   properties.insert(DisablePeerVerification);
   properties.insert(AlwaysOutputResponse);
+  properties.insert(MaxInFlightRequests);
 
   setSupportedProperties(properties);
   // Set the supported relationships
@@ -238,9 +243,34 @@ void InvokeHTTP::onSchedule(const std::shared_ptr<core::ProcessContext> &context
   if (context->getProperty(DisablePeerVerification.getName(), disablePeerVerification)) {
     utils::StringUtils::StringToBool(disablePeerVerification, disable_peer_verification_);
   }
+
+  std::string maxInFlightRequests;
+  int64_t max_in_flight_requests = 1;
+  if (context->getProperty(MaxInFlightRequests.getName(), maxInFlightRequests) && core::Property::StringToInt(maxInFlightRequests, max_in_flight_requests) && max_in_flight_requests > 0) {
+    max_in_flight_requests_ = static_cast<uint32_t>(max_in_flight_requests);
+  } else {
+    max_in_flight_requests_ = 1;
+  }
+
+  if (event_loop_ != nullptr) {
+    event_loop_->stop();
+    event_loop_ = nullptr;
+  }
+  if (max_in_flight_requests_ > 1) {
+    logger_->log_debug("Keeping up to %d requests in flight", max_in_flight_requests_);
+    event_loop_ = std::make_shared<utils::HTTPEventLoop>();
+    event_loop_->start();
+  }
 }
 
 InvokeHTTP::~InvokeHTTP() {
+  notifyStop();
+}
+
+void InvokeHTTP::notifyStop() {
+  if (event_loop_ != nullptr) {
+    event_loop_->stop();
+  }
 }
 
 std::string InvokeHTTP::generateId() {
@@ -253,31 +283,30 @@ bool InvokeHTTP::emitFlowFile(const std::string &method) {
   return ("POST" == method || "PUT" == method || "PATCH" == method);
 }
 
-void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
+std::shared_ptr<FlowFileRecord> InvokeHTTP::getFlowFile(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session, std::string &url,
+                                                        bool create) {
   std::shared_ptr<FlowFileRecord> flowFile = std::static_pointer_cast<FlowFileRecord>(session->get());
 
-  std::string url = url_;
+  url = url_;
 
   if (flowFile == nullptr) {
     if (!emitFlowFile(method_)) {
-      logger_->log_debug("InvokeHTTP -- create flow file with  %s", method_);
-      flowFile = std::static_pointer_cast<FlowFileRecord>(session->create());
+      if (create) {
+        logger_->log_debug("InvokeHTTP -- create flow file with  %s", method_);
+        flowFile = std::static_pointer_cast<FlowFileRecord>(session->create());
+      }
     } else {
       logger_->log_debug("exiting because method is %s", method_);
-      return;
     }
   } else {
     context->getProperty(URL, url, flowFile);
     logger_->log_debug("InvokeHTTP -- Received flowfile");
   }
+  return flowFile;
+}
 
-  logger_->log_debug("onTrigger InvokeHTTP with %s to %s", method_, url);
-
-  // create a transaction id
-  std::string tx_id = generateId();
-
-  utils::HTTPClient client(url, ssl_context_service_);
-
+void InvokeHTTP::setupClient(utils::HTTPClient &client, const std::shared_ptr<FlowFileRecord> &flowFile, const std::shared_ptr<core::ProcessSession> &session,
+                             std::unique_ptr<utils::ByteInputCallBack> &callback, std::unique_ptr<utils::HTTPUploadCallback> &callbackObj) {
   client.initialize(method_);
   client.setConnectionTimeout(connect_timeout_);
   client.setReadTimeout(read_timeout_);
@@ -295,8 +324,6 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
     client.setDisablePeerVerification();
   }
 
-  std::unique_ptr<utils::ByteInputCallBack> callback = nullptr;
-  std::unique_ptr<utils::HTTPUploadCallback> callbackObj = nullptr;
   if (emitFlowFile(method_)) {
     logger_->log_trace("InvokeHTTP -- reading flowfile");
     std::shared_ptr<ResourceClaim> claim = flowFile->getResourceClaim();
@@ -321,54 +348,170 @@ void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
 
   // append all headers
   client.build_header_list(attribute_to_send_regex_, flowFile->getAttributes());
+}
+
+void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
+  std::string url;
+  std::shared_ptr<FlowFileRecord> flowFile = getFlowFile(context, session, url);
+  if (flowFile == nullptr) {
+    return;
+  }
+
+  logger_->log_debug("onTrigger InvokeHTTP with %s to %s", method_, url);
+
+  // create a transaction id
+  std::string tx_id = generateId();
+
+  utils::HTTPClient client(url, ssl_context_service_);
+
+  std::unique_ptr<utils::ByteInputCallBack> callback = nullptr;
+  std::unique_ptr<utils::HTTPUploadCallback> callbackObj = nullptr;
+  setupClient(client, flowFile, session, callback, callbackObj);
 
   logger_->log_trace("InvokeHTTP -- curl performed");
   if (client.submit()) {
     logger_->log_trace("InvokeHTTP -- curl successful");
+    processResponse(client, flowFile, url, tx_id, session, context);
+  }
+}
+
+void InvokeHTTP::processResponse(utils::HTTPClient &client, std::shared_ptr<FlowFileRecord> &flowFile, const std::string &url, const std::string &tx_id,
+                                 const std::shared_ptr<core::ProcessSession> &session, const std::shared_ptr<core::ProcessContext> &context) {
+  bool putToAttribute = !IsNullOrEmpty(put_attribute_name_);
 
-    bool putToAttribute = !IsNullOrEmpty(put_attribute_name_);
+  const std::vector<char> &response_body = client.getResponseBody();
+  const std::vector<std::string> &response_headers = client.getHeaders();
 
-    const std::vector<char> &response_body = client.getResponseBody();
-    const std::vector<std::string> &response_headers = client.getHeaders();
+  int64_t http_code = client.getResponseCode();
+  const char *content_type = client.getContentType();
+  flowFile->addAttribute(STATUS_CODE, std::to_string(http_code));
+  if (response_headers.size() > 0)
+    flowFile->addAttribute(STATUS_MESSAGE, response_headers.at(0));
+  flowFile->addAttribute(REQUEST_URL, url);
+  flowFile->addAttribute(TRANSACTION_ID, tx_id);
+
+  bool isSuccess = ((int32_t) (http_code / 100)) == 2;
+  bool output_body_to_content = isSuccess && !putToAttribute;
+
+  logger_->log_debug("isSuccess: %d, response code %d", isSuccess, http_code);
+  std::shared_ptr<FlowFileRecord> response_flow = nullptr;
+
+  if (output_body_to_content) {
+    if (flowFile != nullptr) {
+      response_flow = std::static_pointer_cast<FlowFileRecord>(session->create(flowFile));
+    } else {
+      response_flow = std::static_pointer_cast<FlowFileRecord>(session->create());
+    }
 
-    int64_t http_code = client.getResponseCode();
-    const char *content_type = client.getContentType();
-    flowFile->addAttribute(STATUS_CODE, std::to_string(http_code));
+    // if content type isn't returned we should return application/octet-stream
+    // as per RFC 2046 -- 4.5.1
+    response_flow->addKeyedAttribute(MIME_TYPE, content_type ? std::string(content_type) : DefaultContentType);
+    response_flow->addAttribute(STATUS_CODE, std::to_string(http_code));
     if (response_headers.size() > 0)
       flowFile->addAttribute(STATUS_MESSAGE, response_headers.at(0));
-    flowFile->addAttribute(REQUEST_URL, url);
-    flowFile->addAttribute(TRANSACTION_ID, tx_id);
-
-    bool isSuccess = ((int32_t) (http_code / 100)) == 2;
-    bool output_body_to_content = isSuccess && !putToAttribute;
+    response_flow->addAttribute(REQUEST_URL, url);
+    response_flow->addAttribute(TRANSACTION_ID, tx_id);
+    io::DataStream stream((const uint8_t*) response_body.data(), response_body.size());
+    // need an import from the data stream.
+    session->importFrom(stream, response_flow);
+  } else {
+    logger_->log_warn("Cannot output body to content");
+    response_flow = std::static_pointer_cast<FlowFileRecord>(session->create());
+  }
+  route(flowFile, response_flow, session, context, isSuccess, http_code);
+}
 
-    logger_->log_debug("isSuccess: %d, response code %d", isSuccess, http_code);
-    std::shared_ptr<FlowFileRecord> response_flow = nullptr;
+void InvokeHTTP::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
+  auto event_loop = event_loop_;
+  if (event_loop == nullptr) {
+    core::Processor::onTrigger(context, sessionFactory);
+    return;
+  }
 
-    if (output_body_to_content) {
-      if (flowFile != nullptr) {
-        response_flow = std::static_pointer_cast<FlowFileRecord>(session->create(flowFile));
-      } else {
-        response_flow = std::static_pointer_cast<FlowFileRecord>(session->create());
+  auto completed = std::make_shared<CompletedRequests>();
+  size_t in_flight = 0;
+  bool create = true;
+  bool sent = false;
+  while (true) {
+    // refill the window while flow files are queued, then commit the responses that arrived
+    while (isRunning() && reserveRequest()) {
+      auto request = createRequest(context, sessionFactory, create);
+      if (request == nullptr) {
+        in_flight_requests_--;
+        break;
+      }
+      // like the synchronous mode, a trigger creates at most one flow file
+      create = false;
+      bool submitted = event_loop->submit(request->client.get(), [completed, request](bool success) {
+        request->succeeded = success;
+        completed->push(request);
+      });
+      if (!submitted) {
+        in_flight_requests_--;
+        request->session->rollback();
+        break;
       }
+      in_flight++;
+      sent = true;
+    }
+    if (in_flight == 0) {
+      break;
+    }
+    for (const auto &request : completed->take()) {
+      in_flight--;
+      in_flight_requests_--;
+      completeRequest(context, request);
+    }
+  }
+  // the window was full or there was nothing to send, so the trigger did no work
+  if (!sent) {
+    context->yield();
+  }
+}
+
+std::shared_ptr<InvokeHTTP::AsyncRequest> InvokeHTTP::createRequest(const std::shared_ptr<core::ProcessContext> &context,
+                                                                    const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory, bool create) {
+  auto request = std::make_shared<AsyncRequest>();
+  request->session = sessionFactory->createSession();
+  request->flow_file = getFlowFile(context, request->session, request->url, create);
+  if (request->flow_file == nullptr) {
+    return nullptr;
+  }
 
-      // if content type isn't returned we should return application/octet-stream
-      // as per RFC 2046 -- 4.5.1
-      response_flow->addKeyedAttribute(MIME_TYPE, content_type ? std::string(content_type) : DefaultContentType);
-      response_flow->addAttribute(STATUS_CODE, std::to_string(http_code));
-      if (response_headers.size() > 0)
-        flowFile->addAttribute(STATUS_MESSAGE, response_headers.at(0));
-      response_flow->addAttribute(REQUEST_URL, url);
-      response_flow->addAttribute(TRANSACTION_ID, tx_id);
-      io::DataStream stream((const uint8_t*) response_body.data(), response_body.size());
-      // need an import from the data stream.
-      session->importFrom(stream, response_flow);
+  logger_->log_debug("onTrigger InvokeHTTP with %s to %s", method_, request->url);
+
+  request->tx_id = generateId();
+  request->succeeded = false;
+  // the requests to a host reuse the connections it has open
+  request->client = std::unique_ptr<utils::HTTPClient>(new utils::HTTPClient(request->url, utils::HTTPConnectionPool::getPool(request->url), ssl_context_service_));
+  setupClient(*request->client, request->flow_file, request->session, request->callback, request->callback_obj);
+  return request;
+}
+
+void InvokeHTTP::completeRequest(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<AsyncRequest> &request) {
+  try {
+    if (request->succeeded) {
+      logger_->log_trace("InvokeHTTP -- curl successful");
+      processResponse(*request->client, request->flow_file, request->url, request->tx_id, request->session, context);
+      request->session->commit();
     } else {
-      logger_->log_warn("Cannot output body to content");
-      response_flow = std::static_pointer_cast<FlowFileRecord>(session->create());
+      // as in the synchronous mode, the flow file of a failed request goes back to its queue
+      request->session->rollback();
+    }
+  } catch (std::exception &exception) {
+    logger_->log_debug("Caught Exception %s", exception.what());
+    request->session->rollback();
+  }
+}
+
+bool InvokeHTTP::reserveRequest() {
+  uint32_t in_flight = in_flight_requests_;
+  while (in_flight < max_in_flight_requests_) {
+    if (in_flight_requests_.compare_exchange_weak(in_flight, in_flight + 1)) {
+      return true;
     }
-    route(flowFile, response_flow, session, context, isSuccess, http_code);
   }
+  return false;
 }
 
 void InvokeHTTP::route(std::shared_ptr<FlowFileRecord> &request, std::shared_ptr<FlowFileRecord> &response, const std::shared_ptr<core::ProcessSession> &session,
@@ -19,8 +19,12 @@
 #ifndef __INVOKE_HTTP_H__
 #define __INVOKE_HTTP_H__
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <curl/curl.h>
 #include "utils/ByteArrayCallback.h"
@@ -34,6 +38,7 @@
 #include "core/logging/LoggerConfiguration.h"
 #include "utils/Id.h"
 #include "../client/HTTPClient.h"
+#include "../client/HTTPEventLoop.h"
 
 namespace org {
 namespace apache {
@@ -59,6 +64,8 @@ class InvokeHTTP : public core::Processor {
         use_chunked_encoding_(false),
         penalize_no_retry_(false),
         disable_peer_verification_(false),
+        max_in_flight_requests_(1),
+        in_flight_requests_(0),
         logger_(logging::LoggerFactory<InvokeHTTP>::getLogger()) {
   }
   // Destructor
@@ -89,6 +96,8 @@ class InvokeHTTP : public core::Processor {
 
   static core::Property PenalizeOnNoRetry;
 
+  static core::Property MaxInFlightRequests;
+
   static const char* STATUS_CODE;
   static const char* STATUS_MESSAGE;
   static const char* RESPONSE_BODY;
@@ -104,6 +113,11 @@ class InvokeHTTP : public core::Processor {
   static core::Relationship RelNoRetry;
   static core::Relationship RelFailure;
 
+  /**
+   * Sends the queued flow files through the event loop when requests are sent asynchronously,
+   * committing each of them in a session of its own once its response arrived.
+   */
+  virtual void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) override;
   virtual void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) override;
   virtual void initialize() override;
   virtual void onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) override;
@@ -116,6 +130,90 @@ class InvokeHTTP : public core::Processor {
 
  protected:
 
+  virtual void notifyStop() override;
+
+  /**
+   * A request sent by the event loop, along with the session that holds its flow file.
+   */
+  struct AsyncRequest {
+    std::shared_ptr<core::ProcessSession> session;
+    std::shared_ptr<FlowFileRecord> flow_file;
+    std::string url;
+    std::string tx_id;
+    std::unique_ptr<utils::ByteInputCallBack> callback;
+    std::unique_ptr<utils::HTTPUploadCallback> callback_obj;
+    std::unique_ptr<utils::HTTPClient> client;
+    bool succeeded;
+  };
+
+  /**
+   * Requests of a trigger whose responses arrived, handed over from the event loop.
+   */
+  class CompletedRequests {
+   public:
+    void push(const std::shared_ptr<AsyncRequest> &request) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests_.push_back(request);
+      }
+      condition_.notify_one();
+    }
+
+    // blocks until a request completed, then takes every completed request
+    std::vector<std::shared_ptr<AsyncRequest>> take() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [&] {return !requests_.empty();});
+      std::vector<std::shared_ptr<AsyncRequest>> requests;
+      requests.swap(requests_);
+      return requests;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<std::shared_ptr<AsyncRequest>> requests_;
+  };
+
+  /**
+   * Takes the flow file to send, creating one when the method does not send a body.
+   * @param url url of the request, evaluated against the flow file
+   * @param create create a flow file if none is queued
+   * @return flow file, or nullptr if there is nothing to send
+   */
+  std::shared_ptr<FlowFileRecord> getFlowFile(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session, std::string &url,
+                                              bool create = true);
+
+  /**
+   * Applies the configuration of the processor to the client, and attaches the content and
+   * attributes of the flow file to the request.
+   */
+  void setupClient(utils::HTTPClient &client, const std::shared_ptr<FlowFileRecord> &flowFile, const std::shared_ptr<core::ProcessSession> &session,
+                   std::unique_ptr<utils::ByteInputCallBack> &callback, std::unique_ptr<utils::HTTPUploadCallback> &callbackObj);
+
+  /**
+   * Records the response of a successful request and routes the flow files.
+   */
+  void processResponse(utils::HTTPClient &client, std::shared_ptr<FlowFileRecord> &flowFile, const std::string &url, const std::string &tx_id,
+                       const std::shared_ptr<core::ProcessSession> &session, const std::shared_ptr<core::ProcessContext> &context);
+
+  /**
+   * Creates the request of the next queued flow file in a session of its own.
+   * @return request, or nullptr if there is nothing to send
+   */
+  std::shared_ptr<AsyncRequest> createRequest(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory,
+                                              bool create);
+
+  /**
+   * Commits the session of a request whose response arrived, or rolls it back if the request failed.
+   */
+  void completeRequest(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<AsyncRequest> &request);
+
+  /**
+   * Takes a slot of the in-flight window shared by the tasks of the processor.
+   * @return false if the window is full
+   */
+  bool reserveRequest();
+
   /**
    * Generate a transaction ID
    * @return transaction ID string.
@@ -166,6 +264,10 @@ class InvokeHTTP : public core::Processor {
   bool penalize_no_retry_;
   // disable peer verification ( makes susceptible for MITM attacks )
   bool disable_peer_verification_;
+  // requests kept in flight by the tasks of the processor; above one they are sent by the event loop
+  uint32_t max_in_flight_requests_;
+  std::atomic<uint32_t> in_flight_requests_;
+  std::shared_ptr<utils::HTTPEventLoop> event_loop_;
  private:
   std::shared_ptr<logging::Logger> logger_;
   static std::shared_ptr<utils::IdGenerator> id_generator_;
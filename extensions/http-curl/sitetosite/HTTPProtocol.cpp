@@ -55,6 +55,9 @@ std::shared_ptr<Transaction> HttpSiteToSiteClient::createTransaction(std::string
   uri << getBaseURI() << "data-transfer/" << dir_str << "/" << getPortId() << "/transactions";
   auto client = create_http_client(uri.str(), "POST");
   client->appendHeader(PROTOCOL_VERSION_HEADER, "1");
+  if (use_compression_) {
+    client->appendHeader(USE_COMPRESSION_HEADER, "true");
+  }
   client->setConnectionTimeout(5);
   client->setContentType("application/json");
   client->appendHeader("Accept: application/json");
@@ -74,6 +77,7 @@ std::shared_ptr<Transaction> HttpSiteToSiteClient::createTransaction(std::string
       } else {
         org::apache::nifi::minifi::io::CRCStream<SiteToSitePeer> crcstream(peer_.get());
         auto transaction = std::make_shared<HttpTransaction>(direction, crcstream);
+        transaction->setCompression(use_compression_, compression_level_);
         transaction->initialize(this, url);
         auto transactionId = parseTransactionId(url);
         if (IsNullOrEmpty(transactionId))
@@ -89,6 +93,9 @@ std::shared_ptr<Transaction> HttpSiteToSiteClient::createTransaction(std::string
         }
 
         client->appendHeader(PROTOCOL_VERSION_HEADER, "1");
+        if (use_compression_) {
+          client->appendHeader(USE_COMPRESSION_HEADER, "true");
+        }
         peer_->setStream(std::unique_ptr<io::DataStream>(new io::HttpStream(client)));
         transactionID = transaction->getUUIDStr();
         logger_->log_debug("Created transaction id -%s-", transactionID);
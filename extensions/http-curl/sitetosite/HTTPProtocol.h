@@ -60,6 +60,7 @@ typedef struct Site2SitePeerStatus {
 class HttpSiteToSiteClient : public sitetosite::SiteToSiteClient {
 
   static constexpr char const* PROTOCOL_VERSION_HEADER = "x-nifi-site-to-site-protocol-version";
+  static constexpr char const* USE_COMPRESSION_HEADER = "x-nifi-site-to-site-use-compression";
  public:
 
   /*!
@@ -161,7 +162,11 @@ class HttpSiteToSiteClient : public sitetosite::SiteToSiteClient {
   const std::string parseTransactionId(const std::string &uri);
 
   std::unique_ptr<utils::HTTPClient> create_http_client(const std::string &uri, const std::string &method = "POST", bool setPropertyHeaders = false) {
-    std::unique_ptr<utils::HTTPClient> http_client_ = std::unique_ptr<utils::HTTPClient>(new minifi::utils::HTTPClient(uri, ssl_context_service_));
+    // the transactions of every client of the peer reuse the same connections
+    if (connection_pool_ == nullptr) {
+      connection_pool_ = utils::HTTPConnectionPool::getPool(getBaseURI());
+    }
+    std::unique_ptr<utils::HTTPClient> http_client_ = std::unique_ptr<utils::HTTPClient>(new minifi::utils::HTTPClient(uri, connection_pool_, ssl_context_service_));
     http_client_->initialize(method, uri, ssl_context_service_);
     if (setPropertyHeaders) {
       if (_currentVersion >= 5) {
@@ -182,6 +187,7 @@ class HttpSiteToSiteClient : public sitetosite::SiteToSiteClient {
  private:
 
   RespondCode current_code;
+  std::shared_ptr<utils::HTTPConnectionPool> connection_pool_;
   std::shared_ptr<logging::Logger> logger_;
   // Prevent default copy constructor and assignment operation
   // Only support pass by reference or pointer
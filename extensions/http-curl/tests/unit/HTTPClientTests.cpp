@@ -17,18 +17,23 @@
  */
 
 #include <uuid/uuid.h>
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <map>
 #include <memory>
 #include <utility>
 #include <string>
 #include <set>
+#include <thread>
+#include <vector>
 #include "FlowController.h"
 #include "io/BaseStream.h"
 #include "TestBase.h"
 #include "processors/GetFile.h"
 #include "core/Core.h"
 #include "client/HTTPClient.h"
+#include "client/HTTPEventLoop.h"
 #include "CivetServer.h"
 
 TEST_CASE("HTTPClientTestChunkedResponse", "[basic]") {
@@ -93,4 +98,122 @@ TEST_CASE("HTTPClientTestChunkedResponse", "[basic]") {
   REQUIRE("foobar\r\nbuzz" == std::string(response.begin(), response.end()));
 
   LogTestController::getInstance().reset();
-}
\ No newline at end of file
+}
+
+TEST_CASE("HTTPClientReusesPooledConnections", "[pool]") {
+  class Responder : public CivetHandler {
+   public:
+    bool handleGet(CivetServer *server, struct mg_connection *conn) {
+      ports.insert(mg_get_request_info(conn)->remote_port);
+      mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 2\r\n\r\nok");
+      return true;
+    }
+    std::set<int> ports;
+  };
+
+  std::vector<std::string> options;
+  options.emplace_back("enable_keep_alive");
+  options.emplace_back("yes");
+  options.emplace_back("keep_alive_timeout_ms");
+  options.emplace_back("15000");
+  options.emplace_back("num_threads");
+  options.emplace_back("1");
+  options.emplace_back("listening_ports");
+  options.emplace_back("0");
+
+  CivetServer server(options);
+  Responder responder;
+  server.addHandler("**", responder);
+  const std::string url = "http://localhost:" + std::to_string(server.getListeningPorts().at(0));
+
+  auto pool = utils::HTTPConnectionPool::getPool(url + "/first");
+  REQUIRE(pool == utils::HTTPConnectionPool::getPool(url + "/second"));
+
+  for (int i = 0; i < 3; i++) {
+    utils::HTTPClient client(url + "/request", pool);
+    client.initialize("GET");
+    REQUIRE(client.submit());
+    REQUIRE(200 == client.getResponseCode());
+  }
+  // every request after the first one is sent over the connection it opened
+  REQUIRE(1U == responder.ports.size());
+  REQUIRE(1U == pool->getIdleCount());
+
+  utils::HTTPConnectionPool bounded(1);
+  auto first = bounded.acquire();
+  auto second = bounded.acquire();
+  bounded.release(first);
+  bounded.release(second);
+  REQUIRE(1U == bounded.getIdleCount());
+}
+
+TEST_CASE("HTTPEventLoopKeepsRequestsInFlight", "[eventloop]") {
+  class Responder : public CivetHandler {
+   public:
+    Responder()
+        : active(0),
+          max_active(0) {
+    }
+    bool handleGet(CivetServer *server, struct mg_connection *conn) {
+      // every request is held back, so that the requests in flight together are handled at the same time
+      int now_active = ++active;
+      int seen = max_active;
+      while (now_active > seen && !max_active.compare_exchange_weak(seen, now_active)) {
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      active--;
+      mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 2\r\n\r\nok");
+      return true;
+    }
+    std::atomic<int> active;
+    // most requests the server handled at the same time
+    std::atomic<int> max_active;
+  };
+
+  std::vector<std::string> options;
+  options.emplace_back("enable_keep_alive");
+  options.emplace_back("yes");
+  options.emplace_back("num_threads");
+  options.emplace_back("8");
+  options.emplace_back("listening_ports");
+  options.emplace_back("0");
+
+  CivetServer server(options);
+  Responder responder;
+  server.addHandler("**", responder);
+  const std::string url = "http://localhost:" + std::to_string(server.getListeningPorts().at(0)) + "/request";
+
+  utils::HTTPEventLoop loop;
+  utils::HTTPClient rejected(url);
+  bool submitted = loop.submit(&rejected, [](bool success) {});
+  REQUIRE_FALSE(submitted);
+  loop.start();
+
+  auto pool = utils::HTTPConnectionPool::getPool(url);
+  std::vector<std::unique_ptr<utils::HTTPClient>> clients;
+  std::atomic<int> succeeded(0);
+  std::atomic<int> completed(0);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 8; i++) {
+    clients.emplace_back(new utils::HTTPClient(url, pool));
+    clients.back()->initialize("GET");
+    submitted = loop.submit(clients.back().get(), [&](bool success) {
+      succeeded += success ? 1 : 0;
+      completed++;
+    });
+    REQUIRE(submitted);
+  }
+  while (completed < 8 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  REQUIRE(8 == succeeded);
+  REQUIRE(0U == loop.getActiveCount());
+  // the requests reached the server together rather than one after the other
+  REQUIRE(1 < responder.max_active);
+  for (const auto &client : clients) {
+    REQUIRE(200 == client->getResponseCode());
+    const std::vector<char> &response = client->getResponseBody();
+    REQUIRE("ok" == std::string(response.begin(), response.end()));
+  }
+  loop.stop();
+}
@@ -17,12 +17,16 @@
  */
 
 #include <uuid/uuid.h>
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <map>
 #include <memory>
 #include <utility>
 #include <string>
 #include <set>
+#include <thread>
+#include <vector>
 #include "FlowController.h"
 #include "io/BaseStream.h"
 #include "TestBase.h"
@@ -40,6 +44,7 @@
 #include "processors/InvokeHTTP.h"
 #include "processors/ListenHTTP.h"
 #include "processors/LogAttribute.h"
+#include "CivetServer.h"
 
 TEST_CASE("HTTPTestsWithNoResourceClaimPOST", "[httptest1]") {
   TestController testController;
@@ -313,3 +318,89 @@ TEST_CASE("HTTPTestsPostNoResourceClaim", "[httptest1]") {
   REQUIRE(true == LogTestController::getInstance().contains("exiting because method is POST"));
   LogTestController::getInstance().reset();
 }
+
+TEST_CASE("HTTPTestsAsyncGET", "[httptest2]") {
+  class Responder : public CivetHandler {
+   public:
+    Responder()
+        : active(0),
+          max_active(0) {
+    }
+    bool handleGet(CivetServer *server, struct mg_connection *conn) {
+      // every request is held back, so that the requests in flight together are handled at the same time
+      int now_active = ++active;
+      int seen = max_active;
+      while (now_active > seen && !max_active.compare_exchange_weak(seen, now_active)) {
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      active--;
+      mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 2\r\n\r\nok");
+      return true;
+    }
+    std::atomic<int> active;
+    // most requests the server handled at the same time
+    std::atomic<int> max_active;
+  };
+
+  std::vector<std::string> options;
+  options.emplace_back("enable_keep_alive");
+  options.emplace_back("yes");
+  options.emplace_back("num_threads");
+  options.emplace_back("16");
+  options.emplace_back("listening_ports");
+  options.emplace_back("0");
+  CivetServer server(options);
+  Responder responder;
+  server.addHandler("**", responder);
+  const std::string url = "http://localhost:" + std::to_string(server.getListeningPorts().at(0)) + "/testytesttest";
+
+  std::shared_ptr<TestRepository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<minifi::Configure>());
+
+  std::shared_ptr<core::Processor> invokehttp = std::make_shared<org::apache::nifi::minifi::processors::InvokeHTTP>("invokehttp");
+  invokehttp->initialize();
+  utils::Identifier invokehttp_uuid;
+  REQUIRE(true == invokehttp->getUUID(invokehttp_uuid));
+
+  std::shared_ptr<minifi::Connection> incoming = std::make_shared<minifi::Connection>(repo, content_repo, "incoming");
+  incoming->setDestinationUUID(invokehttp_uuid);
+  incoming->setDestination(invokehttp);
+  std::shared_ptr<minifi::Connection> outgoing = std::make_shared<minifi::Connection>(repo, content_repo, "outgoing");
+  outgoing->addRelationship(core::Relationship("success", "description"));
+  outgoing->setSourceUUID(invokehttp_uuid);
+  outgoing->setSource(invokehttp);
+  invokehttp->addConnection(incoming);
+  invokehttp->addConnection(outgoing);
+
+  for (int i = 0; i < 16; i++) {
+    std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(repo, content_repo);
+    incoming->put(flow);
+  }
+
+  std::shared_ptr<core::ProcessorNode> node = std::make_shared<core::ProcessorNode>(invokehttp);
+  std::shared_ptr<core::controller::ControllerServiceProvider> controller_services_provider = nullptr;
+  std::shared_ptr<core::ProcessContext> context = std::make_shared<core::ProcessContext>(node, controller_services_provider, repo, repo, content_repo);
+  context->setProperty(org::apache::nifi::minifi::processors::InvokeHTTP::Method, "GET");
+  context->setProperty(org::apache::nifi::minifi::processors::InvokeHTTP::URL, url);
+  context->setProperty(org::apache::nifi::minifi::processors::InvokeHTTP::MaxInFlightRequests, "16");
+  std::shared_ptr<core::ProcessSessionFactory> factory = std::make_shared<core::ProcessSessionFactory>(context);
+
+  invokehttp->incrementActiveTasks();
+  invokehttp->setScheduledState(core::ScheduledState::RUNNING);
+  invokehttp->onSchedule(context, factory);
+  invokehttp->onTrigger(context, factory);
+
+  // the requests were in flight together, and every one of them was committed with its response
+  REQUIRE(1 < responder.max_active);
+  REQUIRE(0 == incoming->getQueueSize());
+  REQUIRE(32 == outgoing->getQueueSize());
+  REQUIRE_FALSE(invokehttp->isYield());
+
+  // a POST has nothing to send without a queued flow file, so the trigger yields
+  context->setProperty(org::apache::nifi::minifi::processors::InvokeHTTP::Method, "POST");
+  invokehttp->onSchedule(context, factory);
+  invokehttp->onTrigger(context, factory);
+  REQUIRE(invokehttp->isYield());
+  invokehttp->setScheduledState(core::ScheduledState::STOPPED);
+}
@@ -130,15 +130,16 @@ JNIEXPORT jobject JNICALL Java_org_apache_nifi_processor_JniFlowFile_getAttribut
     return nullptr;
   }
 
-  jsize map_len = ff->getAttributes().size();
+  const auto &attributes = ff->getAttributeStore();
+  jsize map_len = attributes.size();
 
   jmethodID init = env->GetMethodID(mapClass, "<init>", "(I)V");
   jobject hashMap = env->NewObject(mapClass, init, map_len);
 
   jmethodID put = env->GetMethodID(mapClass, "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
 
-  for (auto kf : ff->getAttributes()) {
-    env->CallObjectMethod(hashMap, put, env->NewStringUTF(kf.first.c_str()), env->NewStringUTF(kf.second.c_str()));
+  for (const auto &attribute : attributes) {
+    env->CallObjectMethod(hashMap, put, env->NewStringUTF(attribute.key->name.c_str()), env->NewStringUTF(attribute.value.c_str()));
     minifi::jni::ThrowIf(env);
   }
 
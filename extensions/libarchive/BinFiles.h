@@ -227,6 +227,7 @@ class BinFiles : public core::Processor {
       : core::Processor(name, uuid),
         logger_(logging::LoggerFactory<BinFiles>::getLogger()) {
     maxBinCount_ = 100;
+    batchSize_ = 1;
   }
   // Destructor
   virtual ~BinFiles() {
@@ -240,6 +241,7 @@ class BinFiles : public core::Processor {
   static core::Property MaxEntries;
   static core::Property MaxBinCount;
   static core::Property MaxBinAge;
+  static core::Property BatchSize;
 
   // Supported Relationships
   static core::Relationship Failure;
@@ -293,6 +295,8 @@ class BinFiles : public core::Processor {
  private:
   std::shared_ptr<logging::Logger> logger_;
   int maxBinCount_;
+  // maximum number of flow files pulled per trigger
+  int batchSize_;
 };
 
 REGISTER_RESOURCE(BinFiles, "Bins flow files into buckets based on the number of entries or size of entries");
@@ -61,6 +61,9 @@ core::Property PublishKafka::ClientName(
 core::Property PublishKafka::BatchSize(
     core::PropertyBuilder::createProperty("Batch Size")->withDescription("Maximum number of messages batched in one MessageSet")->isRequired(false)->withDefaultValue<uint32_t>(10)->build());
 
+core::Property PublishKafka::BatchFlowFiles(
+    core::PropertyBuilder::createProperty("Batch Flow Files")->withDescription("Maximum number of flow files published per trigger")->isRequired(false)->withDefaultValue<uint32_t>(10)->build());
+
 core::Property PublishKafka::AttributeNameRegex("Attributes to Send as Headers", "Any attribute whose name matches the regex will be added to the Kafka messages as a Header", "");
 core::Property PublishKafka::QueueBufferMaxTime("Queue Buffering Max Time", "Delay to wait for messages in the producer queue to accumulate before constructing message batches", "");
 core::Property PublishKafka::QueueBufferMaxSize("Queue Max Buffer Size", "Maximum total message size sum allowed on the producer queue", "");
@@ -94,6 +97,7 @@ void PublishKafka::initialize() {
   properties.insert(ClientName);
   properties.insert(AttributeNameRegex);
   properties.insert(BatchSize);
+  properties.insert(BatchFlowFiles);
   properties.insert(QueueBufferMaxTime);
   properties.insert(QueueBufferMaxSize);
   properties.insert(QueueBufferMaxMessage);
@@ -118,6 +122,12 @@ void PublishKafka::initialize() {
 }
 
 void PublishKafka::onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
+  std::string value;
+  int64_t valInt;
+  if (context->getProperty(BatchFlowFiles.getName(), value) && !value.empty() && core::Property::StringToInt(value, valInt) && valInt > 0) {
+    batch_flow_files_ = valInt;
+    logger_->log_debug("PublishKafka: flow files per trigger [%llu]", static_cast<unsigned long long>(batch_flow_files_));
+  }
 }
 
 bool PublishKafka::configureNewConnection(const std::shared_ptr<KafkaConnection> &conn, const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::FlowFile> &ff) {
@@ -197,7 +207,9 @@ bool PublishKafka::configureNewConnection(const std::shared_ptr<KafkaConnection>
   }
   value = "";
   if (context->getProperty(AttributeNameRegex.getName(), value) && !value.empty()) {
-    attributeNameRegex.assign(value);
+    std::shared_ptr<const utils::Regex> regex = std::make_shared<const utils::Regex>(value);
+    std::lock_guard<std::mutex> lock(attribute_name_regex_mutex_);
+    attributeNameRegex = regex;
     logger_->log_debug("PublishKafka: AttributeNameRegex %s", value);
   }
   value = "";
@@ -311,12 +323,12 @@ bool PublishKafka::configureNewConnection(const std::shared_ptr<KafkaConnection>
 
 void PublishKafka::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
   logger_->log_trace("Enter trigger");
-  std::shared_ptr<core::FlowFile> flowFile = session->get();
-
-  if (!flowFile) {
-    return;
+  for (const auto &flowFile : session->get(batch_flow_files_)) {
+    publishFlowFile(context, session, flowFile);
   }
+}
 
+void PublishKafka::publishFlowFile(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session, const std::shared_ptr<core::FlowFile> &flowFile) {
   std::string client_id, brokers, topic;
 
   std::shared_ptr<KafkaConnection> conn = nullptr;
@@ -389,7 +401,12 @@ void PublishKafka::onTrigger(const std::shared_ptr<core::ProcessContext> &contex
 
   auto thisTopic = conn->getTopic(topic);
   if (thisTopic) {
-    PublishKafka::ReadCallback callback(max_seg_size_, kafkaKey, thisTopic->getTopic(), conn->getConnection(), flowFile, attributeNameRegex);
+    std::shared_ptr<const utils::Regex> regex;
+    {
+      std::lock_guard<std::mutex> lock(attribute_name_regex_mutex_);
+      regex = attributeNameRegex;
+    }
+    PublishKafka::ReadCallback callback(max_seg_size_, kafkaKey, thisTopic->getTopic(), conn->getConnection(), flowFile, regex);
     session->read(flowFile, &callback);
     if (callback.status_ < 0) {
       logger_->log_error("Failed to send flow to kafka topic %s", topic);
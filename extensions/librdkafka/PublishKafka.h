@@ -20,6 +20,8 @@
 #ifndef __PUT_KAFKA_H__
 #define __PUT_KAFKA_H__
 
+#include <memory>
+#include <mutex>
 #include "FlowFileRecord.h"
 #include "core/Processor.h"
 #include "core/ProcessSession.h"
@@ -29,7 +31,7 @@
 #include "core/logging/LoggerConfiguration.h"
 #include "core/logging/Logger.h"
 #include "rdkafka.h"
-#include <regex>
+#include "utils/RegexUtils.h"
 
 namespace org {
 namespace apache {
@@ -307,8 +309,10 @@ class PublishKafka : public core::Processor {
   explicit PublishKafka(std::string name, utils::Identifier uuid = utils::Identifier())
       : core::Processor(name, uuid),
         connection_pool_(5),
-        logger_(logging::LoggerFactory<PublishKafka>::getLogger()) {
+        logger_(logging::LoggerFactory<PublishKafka>::getLogger()),
+        attributeNameRegex(std::make_shared<const utils::Regex>()) {
     max_seg_size_ = -1;
+    batch_flow_files_ = 10;
   }
   // Destructor
   virtual ~PublishKafka() {
@@ -323,6 +327,7 @@ class PublishKafka : public core::Processor {
   static core::Property RequestTimeOut;
   static core::Property ClientName;
   static core::Property BatchSize;
+  static core::Property BatchFlowFiles;
   static core::Property AttributeNameRegex;
   static core::Property QueueBufferMaxTime;
   static core::Property QueueBufferMaxSize;
@@ -347,7 +352,8 @@ class PublishKafka : public core::Processor {
   // Nest Callback Class for read stream
   class ReadCallback : public InputStreamCallback {
    public:
-    ReadCallback(uint64_t max_seg_size, const std::string &key, rd_kafka_topic_t *rkt, rd_kafka_t *rk, const std::shared_ptr<core::FlowFile> flowFile, const std::regex &attributeNameRegex)
+    ReadCallback(uint64_t max_seg_size, const std::string &key, rd_kafka_topic_t *rkt, rd_kafka_t *rk, const std::shared_ptr<core::FlowFile> flowFile,
+                 const std::shared_ptr<const utils::Regex> &attributeNameRegex)
         : max_seg_size_(max_seg_size),
           key_(key),
           rkt_(rkt),
@@ -374,7 +380,7 @@ class PublishKafka : public core::Processor {
       rd_kafka_resp_err_t err;
 
       for (auto kv : flowFile_->getAttributes()) {
-        if (regex_match(kv.first, attributeNameRegex_)) {
+        if (attributeNameRegex_->matchesFully(kv.first)) {
           if (!hdrs) {
             hdrs = rd_kafka_headers_new(8);
           }
@@ -421,7 +427,8 @@ class PublishKafka : public core::Processor {
     std::shared_ptr<core::FlowFile> flowFile_;
     int status_;
     int read_size_;
-    std::regex attributeNameRegex_;
+    // snapshot of the regex, which a connection configured while the flow file is read replaces
+    std::shared_ptr<const utils::Regex> attributeNameRegex_;
   };
 
  public:
@@ -444,6 +451,9 @@ class PublishKafka : public core::Processor {
 
   bool configureNewConnection(const std::shared_ptr<KafkaConnection> &conn, const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::FlowFile> &ff);
 
+  // Publishes a single flow file, transferring it to success or failure
+  void publishFlowFile(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session, const std::shared_ptr<core::FlowFile> &flowFile);
+
  private:
   std::shared_ptr<logging::Logger> logger_;
 
@@ -455,7 +465,11 @@ class PublishKafka : public core::Processor {
   //rd_kafka_topic_t *rkt_;
   //std::string topic_;
   uint64_t max_seg_size_;
-  std::regex attributeNameRegex;
+  // number of flow files taken from the incoming connections per trigger
+  uint64_t batch_flow_files_;
+  // replaced as a whole whenever a connection is configured, guarded by attribute_name_regex_mutex_
+  std::shared_ptr<const utils::Regex> attributeNameRegex;
+  std::mutex attribute_name_regex_mutex_;
 };
 
 REGISTER_RESOURCE(PublishKafka, "This Processor puts the contents of a FlowFile to a Topic in Apache Kafka. The content of a FlowFile becomes the contents of a Kafka message. "
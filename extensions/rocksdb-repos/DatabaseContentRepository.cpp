@@ -20,6 +20,7 @@
 #include <memory>
 #include <string>
 #include "RocksDbStream.h"
+#include "core/Property.h"
 #include "rocksdb/merge_operator.h"
 
 namespace org {
@@ -36,6 +37,13 @@ bool DatabaseContentRepository::initialize(const std::shared_ptr<minifi::Configu
   } else {
     directory_ = configuration->getHome() + "/dbcontentrepository";
   }
+  if (configuration->get(Configure::nifi_dbcontent_repository_chunk_size, value)) {
+    core::Property::StringToInt(value, chunk_size_);
+    if (chunk_size_ == 0) {
+      chunk_size_ = io::RocksDbStream::DefaultChunkSize;
+    }
+  }
+  logger_->log_debug("NiFi Content DB Repository chunk size: %u", chunk_size_);
   rocksdb::Options options;
   options.create_if_missing = true;
   options.use_direct_io_for_flush_and_compaction = true;
@@ -66,8 +74,7 @@ std::shared_ptr<io::BaseStream> DatabaseContentRepository::write(const std::shar
   // we can simply return a nullptr, which is also valid from the API when this stream is not valid.
   if (nullptr == claim || !is_valid_ || !db_)
     return nullptr;
-  // append is already supported in all modes
-  return std::make_shared<io::RocksDbStream>(claim->getContentFullPath(), db_, true);
+  return std::make_shared<io::RocksDbStream>(claim->getContentFullPath(), db_, true, append, chunk_size_);
 }
 
 std::shared_ptr<io::BaseStream> DatabaseContentRepository::read(const std::shared_ptr<minifi::ResourceClaim> &claim) {
@@ -79,10 +86,7 @@ std::shared_ptr<io::BaseStream> DatabaseContentRepository::read(const std::share
 }
 
 bool DatabaseContentRepository::exists(const std::shared_ptr<minifi::ResourceClaim> &streamId) {
-  std::string value;
-  rocksdb::Status status;
-  status = db_->Get(rocksdb::ReadOptions(), streamId->getContentFullPath(), &value);
-  if (status.ok()) {
+  if (io::RocksDbStream::exists(streamId->getContentFullPath(), db_)) {
     logger_->log_debug("%s exists", streamId->getContentFullPath());
     return true;
   } else {
@@ -94,9 +98,7 @@ bool DatabaseContentRepository::exists(const std::shared_ptr<minifi::ResourceCla
 bool DatabaseContentRepository::remove(const std::shared_ptr<minifi::ResourceClaim> &claim) {
   if (nullptr == claim || !is_valid_ || !db_)
     return false;
-  rocksdb::Status status;
-  status = db_->Delete(rocksdb::WriteOptions(), claim->getContentFullPath());
-  if (status.ok()) {
+  if (io::RocksDbStream::remove(claim->getContentFullPath(), db_)) {
     logger_->log_debug("Deleted %s", claim->getContentFullPath());
     return true;
   } else {
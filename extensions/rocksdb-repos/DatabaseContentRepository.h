@@ -21,6 +21,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/merge_operator.h"
 #include "core/Core.h"
+#include "RocksDbStream.h"
 #include "core/Connectable.h"
 #include "core/ContentRepository.h"
 #include "properties/Configure.h"
@@ -76,6 +77,7 @@ class DatabaseContentRepository : public core::ContentRepository, public core::C
       : core::Connectable(name, uuid),
         is_valid_(false),
         db_(nullptr),
+        chunk_size_(io::RocksDbStream::DefaultChunkSize),
         logger_(logging::LoggerFactory<DatabaseContentRepository>::getLogger()) {
   }
   virtual ~DatabaseContentRepository() {
@@ -120,6 +122,8 @@ class DatabaseContentRepository : public core::ContentRepository, public core::C
  private:
   bool is_valid_;
   rocksdb::DB* db_;
+  // Size of the chunks new content is stored in
+  uint32_t chunk_size_;
   std::shared_ptr<logging::Logger> logger_;
 };
 
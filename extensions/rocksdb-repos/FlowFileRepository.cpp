@@ -17,6 +17,7 @@
  */
 #include "FlowFileRepository.h"
 #include "rocksdb/write_batch.h"
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -32,26 +33,46 @@ namespace repository {
 
 void FlowFileRepository::flush() {
   rocksdb::WriteBatch batch;
-  std::string key;
   std::string value;
   rocksdb::ReadOptions options;
 
-  std::vector<std::shared_ptr<FlowFileRecord>> purgeList;
+  std::vector<std::shared_ptr<minifi::ResourceClaim>> purgeList;
 
   uint64_t decrement_total = 0;
-  while (keys_to_delete.size_approx() > 0) {
-    if (keys_to_delete.try_dequeue(key)) {
-      db_->Get(options, key, &value);
+  uint64_t deleted = 0;
+  uint64_t blind_deletes = 0;
+  PendingDelete pending;
+  while (keys_to_delete.try_dequeue(pending)) {
+    if (pending.claim_known) {
+      // the claim came along with the delete, so there is no need to read the record back
+      if (nullptr != pending.claim) {
+        purgeList.push_back(pending.claim);
+      }
+      blind_deletes++;
+      logger_->log_debug("Issuing batch delete, including %s", pending.key);
+    } else {
+      db_->Get(options, pending.key, &value);
       decrement_total += value.size();
       std::shared_ptr<FlowFileRecord> eventRead = std::make_shared<FlowFileRecord>(shared_from_this(), content_repo_);
+      // the record read back releases the reference it took on its claim before the orphan check below
       if (eventRead->DeSerialize(reinterpret_cast<const uint8_t *>(value.data()), value.size())) {
-        purgeList.push_back(eventRead);
+        purgeList.push_back(eventRead->getResourceClaim());
       }
       logger_->log_debug("Issuing batch delete, including %s, Content path %s", eventRead->getUUIDStr(), eventRead->getContentFullPath());
-      batch.Delete(key);
     }
+    batch.Delete(pending.key);
+    deleted++;
+  }
+  if (deleted == 0) {
+    return;
   }
   if (db_->Write(rocksdb::WriteOptions(), &batch).ok()) {
+    uint64_t stored = stored_count_.load();
+    if (blind_deletes > 0 && stored > 0) {
+      // estimate the size of records deleted without reading them from the average record size
+      decrement_total += blind_deletes * (repo_size_.load() / stored);
+    }
+    stored_count_ -= std::min(stored, deleted);
     logger_->log_trace("Decrementing %u from a repo size of %u", decrement_total, repo_size_.load());
     if (decrement_total > repo_size_.load()) {
       repo_size_ = 0;
@@ -61,8 +82,7 @@ void FlowFileRepository::flush() {
   }
 
   if (nullptr != content_repo_) {
-    for (const auto &ffr : purgeList) {
-      auto claim = ffr->getResourceClaim();
+    for (const auto &claim : purgeList) {
       if (claim != nullptr) {
         content_repo_->removeIfOrphaned(claim);
       }
@@ -77,10 +97,21 @@ void FlowFileRepository::run() {
     prune_stored_flowfiles();
   }
   while (running_) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(purge_period_));
+    {
+      // sleep for the purge period unless enough deletes are pending to warrant an early flush
+      std::unique_lock<std::mutex> lock(flush_mutex_);
+      flush_condition_.wait_for(lock, std::chrono::milliseconds(purge_period_), [this] {
+        return !running_ || flush_requested_;
+      });
+      flush_requested_ = false;
+    }
 
     flush();
 
+    if (sync_policy_ == SyncPolicy::PERIODIC && !db_->SyncWAL().ok()) {
+      logger_->log_warn("Could not sync the FlowFile Repository write ahead log");
+    }
+
     uint64_t size = getRepoSize();
 
     if (size > (uint64_t) max_partition_bytes_)
@@ -112,6 +143,7 @@ void FlowFileRepository::prune_stored_flowfiles() {
     std::shared_ptr<FlowFileRecord> eventRead = std::make_shared<FlowFileRecord>(shared_from_this(), content_repo_);
     std::string key = it->key().ToString();
     repo_size_ += it->value().size();
+    stored_count_++;
     if (eventRead->DeSerialize(reinterpret_cast<const uint8_t *>(it->value().data()), it->value().size())) {
       logger_->log_debug("Found connection for %s, path %s ", eventRead->getConnectionUuid(), eventRead->getContentFullPath());
       auto search = connectionMap.find(eventRead->getConnectionUuid());
@@ -122,15 +154,17 @@ void FlowFileRepository::prune_stored_flowfiles() {
         search->second->put(eventRead);
       } else {
         logger_->log_warn("Could not find connection for %s, path %s ", eventRead->getConnectionUuid(), eventRead->getContentFullPath());
+        std::shared_ptr<minifi::ResourceClaim> claim;
         if (eventRead->getContentFullPath().length() > 0) {
-          if (nullptr != eventRead->getResourceClaim()) {
-            content_repo_->remove(eventRead->getResourceClaim());
-          }
+          claim = eventRead->getResourceClaim();
         }
-        keys_to_delete.enqueue(key);
+        // the dropped record gives up the reference it took on its claim when it was restored, so that the
+        // content, which may be a container shared with queued flow files, is removed once it is orphaned
+        eventRead = nullptr;
+        Delete(key, claim);
       }
     } else {
-      keys_to_delete.enqueue(key);
+      Delete(key);
     }
   }
 
@@ -18,10 +18,14 @@
 #ifndef LIBMINIFI_INCLUDE_CORE_REPOSITORY_FLOWFILEREPOSITORY_H_
 #define LIBMINIFI_INCLUDE_CORE_REPOSITORY_FLOWFILEREPOSITORY_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include "utils/file/FileUtils.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
+#include "rocksdb/write_batch.h"
 #include "rocksdb/utilities/checkpoint.h"
 #include "core/Repository.h"
 #include "core/Core.h"
@@ -46,6 +50,7 @@ namespace repository {
 #define MAX_FLOWFILE_REPOSITORY_STORAGE_SIZE (10*1024*1024) // 10M
 #define MAX_FLOWFILE_REPOSITORY_ENTRY_LIFE_TIME (600000) // 10 minute
 #define FLOWFILE_REPOSITORY_PURGE_PERIOD (2000) // 2000 msec
+#define FLOWFILE_REPOSITORY_DELETE_HIGH_WATER_MARK (10000) // pending deletes that wake the purge thread early
 
 /**
  * Flow File repository
@@ -65,6 +70,9 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
         Repository(repo_name.length() > 0 ? repo_name : core::getClassName<FlowFileRepository>(), directory, maxPartitionMillis, maxPartitionBytes, purgePeriod),
         content_repo_(nullptr),
         checkpoint_(nullptr),
+        sync_policy_(SyncPolicy::NONE),
+        flush_requested_(false),
+        stored_count_(0),
         logger_(logging::LoggerFactory<FlowFileRepository>::getLogger()) {
     db_ = NULL;
   }
@@ -95,6 +103,18 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
       }
     }
     logger_->log_debug("NiFi FlowFile Max Storage Time: [%d] ms", max_partition_millis_);
+    if (configure->get(Configure::nifi_flowfile_repository_sync_policy, value)) {
+      value = utils::StringUtils::trim(value);
+      if (utils::StringUtils::equalsIgnoreCase(value, "always")) {
+        sync_policy_ = SyncPolicy::ALWAYS;
+      } else if (utils::StringUtils::equalsIgnoreCase(value, "periodic")) {
+        sync_policy_ = SyncPolicy::PERIODIC;
+      } else if (!utils::StringUtils::equalsIgnoreCase(value, "none")) {
+        logger_->log_warn("Unknown FlowFile Repository sync policy %s, writes will not be synced", value);
+      }
+    }
+    write_options_.sync = sync_policy_ == SyncPolicy::ALWAYS;
+    logger_->log_debug("NiFi FlowFile Repository sync on write: %s", write_options_.sync ? "true" : "false");
     rocksdb::Options options;
     options.create_if_missing = true;
     options.use_direct_io_for_flush_and_compaction = true;
@@ -116,19 +136,55 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
     rocksdb::Slice value((const char *) buf, bufLen);
     rocksdb::Status status;
     repo_size_ += bufLen;
-    status = db_->Put(rocksdb::WriteOptions(), key, value);
+    stored_count_++;
+    status = db_->Put(write_options_, key, value);
     if (status.ok())
       return true;
     else
       return false;
   }
+
+  /**
+   * Stores all entries with a single write batch. Concurrent batches are committed together
+   * through RocksDB's write group, sharing a single WAL write and, if configured, sync.
+   * @return status of the write
+   */
+  virtual bool MultiPut(const std::vector<PutEntry> &entries) {
+    rocksdb::WriteBatch batch;
+    size_t bytes = 0;
+    for (const auto &entry : entries) {
+      batch.Put(entry.key, rocksdb::Slice((const char *) entry.buf, entry.bufLen));
+      bytes += entry.bufLen;
+    }
+    repo_size_ += bytes;
+    stored_count_ += entries.size();
+    return db_->Write(write_options_, &batch).ok();
+  }
   /**
    * 
    * Deletes the key
    * @return status of the delete operation
    */
   virtual bool Delete(std::string key) {
-    keys_to_delete.enqueue(key);
+    PendingDelete pending;
+    pending.key = key;
+    pending.claim_known = false;
+    keys_to_delete.enqueue(std::move(pending));
+    notifyPendingDelete();
+    return true;
+  }
+  /**
+   * Deletes the key without reading it back, releasing the given claim once the delete
+   * is flushed.
+   * @return status of the delete operation
+   */
+  virtual bool Delete(const std::string &key, const std::shared_ptr<minifi::ResourceClaim> &claim) {
+    PendingDelete pending;
+    pending.key = key;
+    pending.claim = claim;
+    pending.claim_known = true;
+    keys_to_delete.enqueue(std::move(pending));
+    notifyPendingDelete();
     return true;
   }
   /**
@@ -160,8 +216,33 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
     logger_->log_debug("%s Repository Monitor Thread Start", getName());
   }
 
+  void stop() {
+    if (!running_) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(flush_mutex_);
+      running_ = false;
+    }
+    flush_condition_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+    logger_->log_debug("%s Repository Monitor Thread Stop", getName());
+  }
+
  private:
 
+  // When writes to the repository are synced to disk
+  enum class SyncPolicy {
+    // leave syncing to the operating system
+    NONE,
+    // sync every write before it is acknowledged
+    ALWAYS,
+    // sync the write ahead log once per purge period
+    PERIODIC
+  };
+
   /**
    * Initialize the repository
    */
@@ -178,10 +259,33 @@ class FlowFileRepository : public core::Repository, public std::enable_shared_fr
    */
   void prune_stored_flowfiles();
 
-  moodycamel::ConcurrentQueue<std::string> keys_to_delete;
+  // Wakes the purge thread once the pending deletes pass the high water mark
+  void notifyPendingDelete() {
+    if (keys_to_delete.size_approx() >= FLOWFILE_REPOSITORY_DELETE_HIGH_WATER_MARK && !flush_requested_.exchange(true)) {
+      std::lock_guard<std::mutex> lock(flush_mutex_);
+      flush_condition_.notify_one();
+    }
+  }
+
+  // Key awaiting deletion, along with the resource claim of the deleted flow file if the caller knew it
+  struct PendingDelete {
+    std::string key;
+    std::shared_ptr<minifi::ResourceClaim> claim;
+    bool claim_known;
+  };
+
+  moodycamel::ConcurrentQueue<PendingDelete> keys_to_delete;
   std::shared_ptr<core::ContentRepository> content_repo_;
   rocksdb::DB* db_;
   std::unique_ptr<rocksdb::Checkpoint> checkpoint_;
+  SyncPolicy sync_policy_;
+  rocksdb::WriteOptions write_options_;
+  // Guards flush_condition_, which wakes the purge thread
+  std::mutex flush_mutex_;
+  std::condition_variable flush_condition_;
+  std::atomic<bool> flush_requested_;
+  // Number of records stored, used to estimate the size of records deleted without reading them
+  std::atomic<uint64_t> stored_count_;
   std::shared_ptr<logging::Logger> logger_;
 };
 
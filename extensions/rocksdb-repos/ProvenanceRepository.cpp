@@ -18,6 +18,9 @@
 
 #include "ProvenanceRepository.h"
 #include "rocksdb/write_batch.h"
+#include <cstdlib>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "rocksdb/options.h"
@@ -28,20 +31,140 @@ namespace nifi {
 namespace minifi {
 namespace provenance {
 
+bool ProvenanceRepository::open() {
+  rocksdb::Options options;
+  options.create_if_missing = true;
+  options.create_missing_column_families = true;
+  options.use_direct_io_for_flush_and_compaction = true;
+  options.use_direct_reads = true;
+  std::vector<std::string> names;
+  // a new database only has the default column family
+  if (!rocksdb::DB::ListColumnFamilies(options, directory_, &names).ok() || names.empty()) {
+    names.clear();
+    names.push_back(rocksdb::kDefaultColumnFamilyName);
+  }
+  std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+  for (const auto &name : names) {
+    descriptors.push_back(rocksdb::ColumnFamilyDescriptor(name, rocksdb::ColumnFamilyOptions(options)));
+  }
+  std::vector<rocksdb::ColumnFamilyHandle*> handles;
+  rocksdb::Status status = rocksdb::DB::Open(rocksdb::DBOptions(options), directory_, descriptors, &handles, &db_);
+  if (status.ok()) {
+    logger_->log_debug("NiFi Provenance Repository database open %s success", directory_);
+  } else {
+    logger_->log_error("NiFi Provenance Repository database open %s fail", directory_);
+    return false;
+  }
+
+  const std::string prefix = PROVENANCE_PARTITION_PREFIX;
+  std::lock_guard<std::mutex> lock(partition_mutex_);
+  for (size_t i = 0; i < handles.size(); i++) {
+    const std::string &name = names[i];
+    if (name == rocksdb::kDefaultColumnFamilyName) {
+      default_partition_ = createPartition(handles[i], 0);
+    } else if (name.compare(0, prefix.length(), prefix) == 0) {
+      uint64_t start = std::strtoull(name.c_str() + prefix.length(), nullptr, 10);
+      partitions_[start] = createPartition(handles[i], start);
+    } else {
+      db_->DestroyColumnFamilyHandle(handles[i]);
+    }
+  }
+  // events stored before the restart count towards the size of the repository again
+  uint64_t size = default_partition_ ? default_partition_->size.load() : 0;
+  for (const auto &partition : partitions_) {
+    size += partition.second->size;
+  }
+  repo_size_ = size;
+  logger_->log_debug("NiFi Provenance Repository opened %llu time partitions holding %llu bytes", partitions_.size(), size);
+  return true;
+}
+
+std::shared_ptr<ProvenanceRepository::Partition> ProvenanceRepository::createPartition(rocksdb::ColumnFamilyHandle *handle, uint64_t start) {
+  rocksdb::DB *db = db_;
+  std::shared_ptr<Partition> partition = std::make_shared<Partition>();
+  partition->handle = std::shared_ptr<rocksdb::ColumnFamilyHandle>(handle, [db](rocksdb::ColumnFamilyHandle *handle) {
+    db->DestroyColumnFamilyHandle(handle);
+  });
+  partition->start = start;
+  // a reopened partition holds events written before the restart, which the database has flushed to its files
+  uint64_t size = 0;
+  if (!db->GetIntProperty(handle, rocksdb::DB::Properties::kTotalSstFilesSize, &size)) {
+    size = 0;
+  }
+  partition->size = size;
+  return partition;
+}
+
+std::shared_ptr<ProvenanceRepository::Partition> ProvenanceRepository::getPartition(uint64_t time) {
+  uint64_t start = time - time % getPartitionMillis();
+  std::lock_guard<std::mutex> lock(partition_mutex_);
+  auto it = partitions_.find(start);
+  if (it != partitions_.end()) {
+    return it->second;
+  }
+  if (!db_) {
+    return nullptr;
+  }
+  rocksdb::ColumnFamilyHandle *handle = nullptr;
+  std::string name = PROVENANCE_PARTITION_PREFIX + std::to_string(start);
+  rocksdb::Status status = db_->CreateColumnFamily(rocksdb::ColumnFamilyOptions(), name, &handle);
+  if (!status.ok()) {
+    logger_->log_error("NiFi Provenance Repository could not create partition %s: %s", name, status.ToString());
+    return nullptr;
+  }
+  logger_->log_debug("NiFi Provenance Repository created partition %s", name);
+  std::shared_ptr<Partition> partition = createPartition(handle, start);
+  partitions_[start] = partition;
+  return partition;
+}
+
+std::vector<std::shared_ptr<ProvenanceRepository::Partition>> ProvenanceRepository::getPartitions() {
+  std::vector<std::shared_ptr<Partition>> partitions;
+  std::lock_guard<std::mutex> lock(partition_mutex_);
+  if (default_partition_) {
+    partitions.push_back(default_partition_);
+  }
+  for (const auto &partition : partitions_) {
+    partitions.push_back(partition.second);
+  }
+  return partitions;
+}
+
+void ProvenanceRepository::forEachEvent(std::function<bool(const rocksdb::Slice &key, const rocksdb::Slice &value)> function) {
+  for (const auto &partition : getPartitions()) {
+    std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(rocksdb::ReadOptions(), partition->handle.get()));
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+      if (!function(it->key(), it->value())) {
+        return;
+      }
+    }
+  }
+}
+
 void ProvenanceRepository::flush() {
   rocksdb::WriteBatch batch;
   std::string key;
   std::string value;
   rocksdb::ReadOptions options;
   uint64_t decrement_total = 0;
+  std::map<std::shared_ptr<Partition>, uint64_t> decrements;
+  std::vector<std::shared_ptr<Partition>> partitions = getPartitions();
   while (keys_to_delete.size_approx() > 0) {
     if (keys_to_delete.try_dequeue(key)) {
-      db_->Get(options, key, &value);
-      decrement_total += value.size();
-      batch.Delete(key);
-      logger_->log_debug("Removing %s", key);
+      for (auto it = partitions.rbegin(); it != partitions.rend(); ++it) {
+        if (db_->Get(options, (*it)->handle.get(), key, &value).ok()) {
+          decrement_total += value.size();
+          decrements[*it] += value.size();
+          batch.Delete((*it)->handle.get(), key);
+          logger_->log_debug("Removing %s", key);
+          break;
+        }
+      }
     }
   }
+  if (batch.Count() == 0) {
+    return;
+  }
   if (db_->Write(rocksdb::WriteOptions(), &batch).ok()) {
     logger_->log_debug("Decrementing %u from a repo size of %u", decrement_total, repo_size_.load());
     if (decrement_total > repo_size_.load()) {
@@ -49,20 +172,56 @@ void ProvenanceRepository::flush() {
     } else {
       repo_size_ -= decrement_total;
     }
+    for (const auto &decrement : decrements) {
+      uint64_t size = decrement.first->size.load();
+      decrement.first->size = decrement.second > size ? 0 : size - decrement.second;
+    }
   }
 }
 
+size_t ProvenanceRepository::purgeExpiredPartitions(uint64_t now) {
+  uint64_t partition_millis = getPartitionMillis();
+  std::vector<std::shared_ptr<Partition>> expired;
+  {
+    std::lock_guard<std::mutex> lock(partition_mutex_);
+    auto it = partitions_.begin();
+    // partitions are ordered by their start, so the expired ones come first
+    while (it != partitions_.end() && it->first + partition_millis + max_partition_millis_ <= now) {
+      expired.push_back(it->second);
+      it = partitions_.erase(it);
+    }
+  }
+  for (const auto &partition : expired) {
+    rocksdb::Status status = db_->DropColumnFamily(partition->handle.get());
+    if (status.ok()) {
+      uint64_t size = partition->size.load();
+      logger_->log_debug("Dropped provenance partition %llu, decrementing %llu from a repo size of %llu", partition->start, size, repo_size_.load());
+      if (size > repo_size_.load()) {
+        repo_size_ = 0;
+      } else {
+        repo_size_ -= size;
+      }
+    } else {
+      logger_->log_error("NiFi Provenance Repository could not drop partition %llu: %s", partition->start, status.ToString());
+    }
+  }
+  return expired.size();
+}
+
 void ProvenanceRepository::run() {
   while (running_) {
     std::this_thread::sleep_for(std::chrono::milliseconds(purge_period_));
     uint64_t curTime = getTimeMillis();
-    // threshold for purge
-    uint64_t purgeThreshold = max_partition_bytes_ * 3 / 4;
-
-    uint64_t size = getRepoSize();
+    purgeExpiredPartitions(curTime);
 
-    if (size >= purgeThreshold) {
-      rocksdb::Iterator* it = db_->NewIterator(rocksdb::ReadOptions());
+    // events stored before the repository was partitioned are expired one by one
+    std::shared_ptr<Partition> legacy;
+    {
+      std::lock_guard<std::mutex> lock(partition_mutex_);
+      legacy = default_partition_;
+    }
+    if (legacy) {
+      std::unique_ptr<rocksdb::Iterator> it(db_->NewIterator(rocksdb::ReadOptions(), legacy->handle.get()));
       for (it->SeekToFirst(); it->Valid(); it->Next()) {
         ProvenanceEventRecord eventRead;
         std::string key = it->key().ToString();
@@ -75,10 +234,9 @@ void ProvenanceRepository::run() {
           Delete(key);
         }
       }
-      delete it;
     }
     flush();
-    size = getRepoSize();
+    uint64_t size = getRepoSize();
     if (size > (uint64_t)max_partition_bytes_)
       repo_full_ = true;
     else
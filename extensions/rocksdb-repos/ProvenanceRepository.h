@@ -20,6 +20,14 @@
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
+#include "rocksdb/write_batch.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 #include "core/Repository.h"
 #include "core/Core.h"
 #include "provenance/Provenance.h"
@@ -35,6 +43,9 @@ namespace provenance {
 #define MAX_PROVENANCE_STORAGE_SIZE (10*1024*1024) // 10M
 #define MAX_PROVENANCE_ENTRY_LIFE_TIME (60000) // 1 minute
 #define PROVENANCE_PURGE_PERIOD (2500) // 2500 msec
+// Events are stored in column families that each cover this fraction of the max storage time
+#define PROVENANCE_PARTITIONS_PER_LIFE_TIME 4
+#define PROVENANCE_PARTITION_PREFIX "provenance."
 
 class ProvenanceRepository : public core::Repository, public std::enable_shared_from_this<ProvenanceRepository> {
  public:
@@ -58,8 +69,7 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
 
   // Destructor
   virtual ~ProvenanceRepository() {
-    if (db_)
-      delete db_;
+    destroy();
   }
 
   virtual void flush();
@@ -91,19 +101,7 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
       }
     }
     logger_->log_debug("NiFi Provenance Max Storage Time: [%d] ms", max_partition_millis_);
-    rocksdb::Options options;
-    options.create_if_missing = true;
-    options.use_direct_io_for_flush_and_compaction = true;
-    options.use_direct_reads = true;
-    rocksdb::Status status = rocksdb::DB::Open(options, directory_, &db_);
-    if (status.ok()) {
-      logger_->log_debug("NiFi Provenance Repository database open %s success", directory_);
-    } else {
-      logger_->log_error("NiFi Provenance Repository database open %s fail", directory_);
-      return false;
-    }
-
-    return true;
+    return open();
   }
   // Put
   virtual bool Put(std::string key, const uint8_t *buf, size_t bufLen) {
@@ -113,12 +111,43 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
 
     // persist to the DB
     rocksdb::Slice value((const char *) buf, bufLen);
+    std::shared_ptr<Partition> partition = getPartition(getTimeMillis());
+    if (nullptr == partition) {
+      return false;
+    }
     rocksdb::Status status;
-    status = db_->Put(rocksdb::WriteOptions(), key, value);
-    if (status.ok())
+    status = db_->Put(rocksdb::WriteOptions(), partition->handle.get(), key, value);
+    if (status.ok()) {
+      partition->size += bufLen;
+      repo_size_ += bufLen;
       return true;
-    else
+    } else {
+      return false;
+    }
+  }
+  /**
+   * Persists the events of a session commit in one write batch into the current time partition
+   */
+  virtual bool MultiPut(const std::vector<PutEntry> &entries) {
+    if (repo_full_) {
+      return false;
+    }
+    std::shared_ptr<Partition> partition = getPartition(getTimeMillis());
+    if (nullptr == partition) {
+      return false;
+    }
+    rocksdb::WriteBatch batch;
+    size_t bytes = 0;
+    for (const auto &entry : entries) {
+      batch.Put(partition->handle.get(), entry.key, rocksdb::Slice((const char *) entry.buf, entry.bufLen));
+      bytes += entry.bufLen;
+    }
+    if (!db_->Write(rocksdb::WriteOptions(), &batch).ok()) {
       return false;
+    }
+    partition->size += bytes;
+    repo_size_ += bytes;
+    return true;
   }
   // Delete
   virtual bool Delete(std::string key) {
@@ -127,12 +156,14 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
   }
   // Get
   virtual bool Get(const std::string &key, std::string &value) {
-    rocksdb::Status status;
-    status = db_->Get(rocksdb::ReadOptions(), key, &value);
-    if (status.ok())
-      return true;
-    else
-      return false;
+    // the newest partitions are the most likely to hold the event
+    std::vector<std::shared_ptr<Partition>> partitions = getPartitions();
+    for (auto it = partitions.rbegin(); it != partitions.rend(); ++it) {
+      if (db_->Get(rocksdb::ReadOptions(), (*it)->handle.get(), key, &value).ok()) {
+        return true;
+      }
+    }
+    return false;
   }
 
   // Remove event
@@ -145,37 +176,31 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
   }
 
   virtual bool get(std::vector<std::shared_ptr<core::CoreComponent>> &store, size_t max_size) {
-    rocksdb::Iterator* it = db_->NewIterator(rocksdb::ReadOptions());
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-      std::shared_ptr<ProvenanceEventRecord> eventRead = std::make_shared<ProvenanceEventRecord>();
-      std::string key = it->key().ToString();
+    forEachEvent([&store, max_size](const rocksdb::Slice &key, const rocksdb::Slice &value) {
       if (store.size() >= max_size)
-        break;
-      if (eventRead->DeSerialize((uint8_t *) it->value().data(), (int) it->value().size())) {
+        return false;
+      std::shared_ptr<ProvenanceEventRecord> eventRead = std::make_shared<ProvenanceEventRecord>();
+      if (eventRead->DeSerialize((uint8_t *) value.data(), (int) value.size())) {
         store.push_back(std::dynamic_pointer_cast<core::CoreComponent>(eventRead));
       }
-    }
-    delete it;
+      return true;
+    });
     return true;
   }
 
   virtual bool DeSerialize(std::vector<std::shared_ptr<core::SerializableComponent>> &records, size_t &max_size, std::function<std::shared_ptr<core::SerializableComponent>()> lambda) {
-    rocksdb::Iterator* it = db_->NewIterator(rocksdb::ReadOptions());
     size_t requested_batch = max_size;
     max_size = 0;
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-
+    forEachEvent([&records, &max_size, requested_batch, &lambda](const rocksdb::Slice &key, const rocksdb::Slice &value) {
       if (max_size >= requested_batch)
-        break;
+        return false;
       std::shared_ptr<core::SerializableComponent> eventRead = lambda();
-      std::string key = it->key().ToString();
-      if (eventRead->DeSerialize((uint8_t *) it->value().data(), (int) it->value().size())) {
+      if (eventRead->DeSerialize((uint8_t *) value.data(), (int) value.size())) {
         max_size++;
         records.push_back(eventRead);
       }
-
-    }
-    delete it;
+      return true;
+    });
 
     if (max_size > 0) {
       return true;
@@ -185,33 +210,27 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
   }
   //! get record
   void getProvenanceRecord(std::vector<std::shared_ptr<ProvenanceEventRecord>> &records, int maxSize) {
-    rocksdb::Iterator* it = db_->NewIterator(rocksdb::ReadOptions());
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-      std::shared_ptr<ProvenanceEventRecord> eventRead = std::make_shared<ProvenanceEventRecord>();
-      std::string key = it->key().ToString();
+    forEachEvent([&records, maxSize](const rocksdb::Slice &key, const rocksdb::Slice &value) {
       if (records.size() >= (uint64_t)maxSize)
-        break;
-      if (eventRead->DeSerialize((uint8_t *) it->value().data(), (int) it->value().size())) {
+        return false;
+      std::shared_ptr<ProvenanceEventRecord> eventRead = std::make_shared<ProvenanceEventRecord>();
+      if (eventRead->DeSerialize((uint8_t *) value.data(), (int) value.size())) {
         records.push_back(eventRead);
       }
-    }
-    delete it;
+      return true;
+    });
   }
 
   virtual bool DeSerialize(std::vector<std::shared_ptr<core::SerializableComponent>> &store, size_t &max_size) {
-    rocksdb::Iterator* it = db_->NewIterator(rocksdb::ReadOptions());
     max_size = 0;
-    for (it->SeekToFirst(); it->Valid(); it->Next()) {
-      std::shared_ptr<ProvenanceEventRecord> eventRead = std::make_shared<ProvenanceEventRecord>();
-      std::string key = it->key().ToString();
-
-      if (store.at(max_size)->DeSerialize((uint8_t *) it->value().data(), (int) it->value().size())) {
+    forEachEvent([&store, &max_size](const rocksdb::Slice &key, const rocksdb::Slice &value) {
+      if (max_size >= store.size())
+        return false;
+      if (store.at(max_size)->DeSerialize((uint8_t *) value.data(), (int) value.size())) {
         max_size++;
       }
-      if (store.size() >= max_size)
-        break;
-    }
-    delete it;
+      return true;
+    });
     if (max_size > 0) {
       return true;
     } else {
@@ -228,6 +247,11 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
   // destroy
   void destroy() {
     if (db_) {
+      {
+        std::lock_guard<std::mutex> lock(partition_mutex_);
+        partitions_.clear();
+        default_partition_ = nullptr;
+      }
       delete db_;
       db_ = NULL;
     }
@@ -235,14 +259,64 @@ class ProvenanceRepository : public core::Repository, public std::enable_shared_
   // Run function for the thread
   void run();
 
+  /**
+   * Drops the column families whose events are all older than the max storage time,
+   * which removes them without reading or deleting the events one by one.
+   * @param now current time in milliseconds
+   * @return number of partitions dropped
+   */
+  size_t purgeExpiredPartitions(uint64_t now);
+
+  /**
+   * Returns the number of time partitions, excluding the default column family holding events
+   * stored before the repository was partitioned.
+   */
+  size_t getPartitionCount() {
+    std::lock_guard<std::mutex> lock(partition_mutex_);
+    return partitions_.size();
+  }
+
   // Prevent default copy constructor and assignment operation
   // Only support pass by reference or pointer
   ProvenanceRepository(const ProvenanceRepository &parent) = delete;
   ProvenanceRepository &operator=(const ProvenanceRepository &parent) = delete;
 
  private:
+
+  // Column family holding the events stored within one time partition
+  struct Partition {
+    std::shared_ptr<rocksdb::ColumnFamilyHandle> handle;
+    // start of the partition in milliseconds
+    uint64_t start;
+    std::atomic<uint64_t> size;
+  };
+
+  // Opens the database with its default column family and every time partition
+  bool open();
+
+  // Returns the partition covering the given time, creating its column family if needed
+  std::shared_ptr<Partition> getPartition(uint64_t time);
+
+  // Returns the default column family followed by the time partitions, oldest first
+  std::vector<std::shared_ptr<Partition>> getPartitions();
+
+  // Takes ownership of the handle, destroying it once the last reference is released
+  std::shared_ptr<Partition> createPartition(rocksdb::ColumnFamilyHandle *handle, uint64_t start);
+
+  uint64_t getPartitionMillis() const {
+    return max_partition_millis_ > PROVENANCE_PARTITIONS_PER_LIFE_TIME ? max_partition_millis_ / PROVENANCE_PARTITIONS_PER_LIFE_TIME : 1;
+  }
+
+  // Calls the function with every event, oldest partition first, until it returns false
+  void forEachEvent(std::function<bool(const rocksdb::Slice &key, const rocksdb::Slice &value)> function);
+
   moodycamel::ConcurrentQueue<std::string> keys_to_delete;
   rocksdb::DB* db_;
+  std::mutex partition_mutex_;
+  // events stored before the repository was partitioned
+  std::shared_ptr<Partition> default_partition_;
+  // time partitions by their start
+  std::map<uint64_t, std::shared_ptr<Partition>> partitions_;
   std::shared_ptr<logging::Logger> logger_;
 };
 
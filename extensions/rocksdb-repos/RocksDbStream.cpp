@@ -17,43 +17,153 @@
  */
 
 #include "RocksDbStream.h"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <vector>
 #include <memory>
 #include <string>
 #include "io/validation.h"
+#include "rocksdb/write_batch.h"
 namespace org {
 namespace apache {
 namespace nifi {
 namespace minifi {
 namespace io {
 
-RocksDbStream::RocksDbStream(const std::string &path, rocksdb::DB *db, bool write_enable)
+constexpr uint32_t RocksDbStream::DefaultChunkSize;
+constexpr const char *RocksDbStream::ChunkSeparator;
+constexpr const char *RocksDbStream::SizeKeySuffix;
+
+namespace {
+
+// header is the content size followed by the chunk size, both big endian
+const size_t HeaderSize = sizeof(uint64_t) + sizeof(uint32_t);
+
+std::string encodeHeader(uint64_t size, uint32_t chunk_size) {
+  std::string header(HeaderSize, '\0');
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    header[i] = static_cast<char>((size >> (8 * (sizeof(uint64_t) - 1 - i))) & 0xFF);
+  }
+  for (size_t i = 0; i < sizeof(uint32_t); i++) {
+    header[sizeof(uint64_t) + i] = static_cast<char>((chunk_size >> (8 * (sizeof(uint32_t) - 1 - i))) & 0xFF);
+  }
+  return header;
+}
+
+bool decodeHeader(const std::string &header, uint64_t &size, uint32_t &chunk_size) {
+  if (header.size() != HeaderSize) {
+    return false;
+  }
+  const uint8_t *data = reinterpret_cast<const uint8_t*>(header.data());
+  size = 0;
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    size = (size << 8) | data[i];
+  }
+  chunk_size = 0;
+  for (size_t i = 0; i < sizeof(uint32_t); i++) {
+    chunk_size = (chunk_size << 8) | data[sizeof(uint64_t) + i];
+  }
+  return chunk_size > 0;
+}
+
+}  // namespace
+
+RocksDbStream::RocksDbStream(const std::string &path, rocksdb::DB *db, bool write_enable, bool append, uint32_t chunk_size)
     : BaseStream(),
       path_(path),
       write_enable_(write_enable),
+      exists_(false),
+      offset_(0),
       db_(db),
+      size_(0),
+      chunk_size_(chunk_size > 0 ? chunk_size : DefaultChunkSize),
+      legacy_(false),
+      chunk_index_(-1),
+      stale_chunks_(0),
+      closed_(false),
       logger_(logging::LoggerFactory<RocksDbStream>::getLogger()) {
-  rocksdb::Status status;
-  status = db_->Get(rocksdb::ReadOptions(), path_, &value_);
-  if (status.ok()) {
-    exists_ = true;
-  } else {
-    exists_ = false;
+  uint64_t stored_size = 0;
+  uint32_t stored_chunk_size = 0;
+  bool chunked = readHeader(path_, db_, stored_size, stored_chunk_size);
+  std::string legacy_value;
+  if (!chunked) {
+    legacy_ = db_->Get(rocksdb::ReadOptions(), path_, &legacy_value).ok();
+  }
+
+  if (!write_enable_) {
+    if (chunked) {
+      exists_ = true;
+      size_ = stored_size;
+      chunk_size_ = stored_chunk_size;
+    } else if (legacy_) {
+      // the whole value is the only chunk
+      exists_ = true;
+      chunk_ = std::move(legacy_value);
+      chunk_index_ = 0;
+      size_ = chunk_.size();
+    }
+    return;
+  }
+
+  exists_ = true;
+  if (chunked) {
+    if (append) {
+      size_ = stored_size;
+      chunk_size_ = stored_chunk_size;
+      uint64_t partial = size_ % chunk_size_;
+      if (partial > 0 && !db_->Get(rocksdb::ReadOptions(), chunkKey(path_, size_ / chunk_size_), &chunk_).ok()) {
+        logger_->log_error("Could not read the last chunk of %s", path_);
+        size_ -= partial;
+        chunk_.clear();
+      }
+    } else {
+      stale_chunks_ = chunkCount(stored_size, stored_chunk_size);
+    }
+  } else if (legacy_ && append) {
+    writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(legacy_value.data())), static_cast<int>(legacy_value.size()));
   }
-  offset_ = 0;
-  size_ = value_.size();
 }
 
 void RocksDbStream::closeStream() {
+  if (!write_enable_ || closed_ || nullptr == db_) {
+    return;
+  }
+  closed_ = true;
+  rocksdb::WriteBatch batch;
+  uint64_t chunks = chunkCount(size_, chunk_size_);
+  if (!chunk_.empty()) {
+    batch.Put(chunkKey(path_, chunks - 1), chunk_);
+  }
+  for (uint64_t index = chunks; index < stale_chunks_; index++) {
+    batch.Delete(chunkKey(path_, index));
+  }
+  if (size_ > 0) {
+    batch.Put(path_ + SizeKeySuffix, encodeHeader(size_, chunk_size_));
+  } else {
+    batch.Delete(path_ + SizeKeySuffix);
+  }
+  if (legacy_) {
+    batch.Delete(path_);
+  }
+  // full chunks were written without syncing, a single sync of the write ahead log persists them along with this batch
+  rocksdb::WriteOptions opts;
+  opts.sync = true;
+  rocksdb::Status status = db_->Write(opts, &batch);
+  if (!status.ok()) {
+    logger_->log_error("Could not store content %s: %s", path_, status.ToString());
+  }
+  chunk_.clear();
 }
 
 void RocksDbStream::seek(uint64_t offset) {
-  // noop
+  if (!write_enable_) {
+    offset_ = offset < size_ ? offset : size_;
+  }
 }
 
 int RocksDbStream::writeData(std::vector<uint8_t> &buf, int buflen) {
-  if (buf.capacity() < buflen) {
+  if (static_cast<int>(buf.capacity()) < buflen) {
     return -1;
   }
   return writeData(reinterpret_cast<uint8_t *>(&buf[0]), buflen);
@@ -62,21 +172,26 @@ int RocksDbStream::writeData(std::vector<uint8_t> &buf, int buflen) {
 // data stream overrides
 
 int RocksDbStream::writeData(uint8_t *value, int size) {
-  if (!IsNullOrEmpty(value) && write_enable_) {
-    rocksdb::Slice slice_value((const char *) value, size);
-    rocksdb::Status status;
-    size_ += size;
-    rocksdb::WriteOptions opts;
-    opts.sync = true;
-    db_->Merge(opts, path_, slice_value);
-    if (status.ok()) {
-      return 0;
-    } else {
-      return -1;
-    }
-  } else {
+  if (IsNullOrEmpty(value) || !write_enable_ || closed_ || size < 0) {
     return -1;
   }
+  rocksdb::WriteOptions opts;
+  int written = 0;
+  while (written < size) {
+    size_t len = std::min<size_t>(size - written, chunk_size_ - chunk_.size());
+    chunk_.append(reinterpret_cast<const char*>(value + written), len);
+    written += len;
+    size_ += len;
+    if (chunk_.size() == chunk_size_) {
+      rocksdb::Status status = db_->Put(opts, chunkKey(path_, (size_ - 1) / chunk_size_), chunk_);
+      chunk_.clear();
+      if (!status.ok()) {
+        logger_->log_error("Could not store chunk of %s: %s", path_, status.ToString());
+        return -1;
+      }
+    }
+  }
+  return written;
 }
 
 template<typename T>
@@ -88,7 +203,7 @@ inline std::vector<uint8_t> RocksDbStream::readBuffer(const T& t) {
 }
 
 int RocksDbStream::readData(std::vector<uint8_t> &buf, int buflen) {
-  if (buf.capacity() < buflen) {
+  if (static_cast<int>(buf.capacity()) < buflen) {
     buf.resize(buflen);
   }
   int ret = readData(reinterpret_cast<uint8_t*>(&buf[0]), buflen);
@@ -100,20 +215,66 @@ int RocksDbStream::readData(std::vector<uint8_t> &buf, int buflen) {
 }
 
 int RocksDbStream::readData(uint8_t *buf, int buflen) {
-  if (!IsNullOrEmpty(buf) && exists_) {
-    int amtToRead = buflen;
-    if (offset_ >= value_.size()) {
-      return 0;
+  if (IsNullOrEmpty(buf) || !exists_ || write_enable_ || buflen < 0) {
+    return -1;
+  }
+  int copied = 0;
+  while (copied < buflen && offset_ < size_) {
+    int64_t index = legacy_ ? 0 : static_cast<int64_t>(offset_ / chunk_size_);
+    if (index != chunk_index_) {
+      if (!db_->Get(rocksdb::ReadOptions(), chunkKey(path_, index), &chunk_).ok()) {
+        logger_->log_error("Could not read chunk %lld of %s", index, path_);
+        chunk_index_ = -1;
+        return copied > 0 ? copied : -1;
+      }
+      chunk_index_ = index;
     }
-    if (buflen > value_.size() - offset_) {
-      amtToRead = value_.size() - offset_;
+    uint64_t position = legacy_ ? offset_ : offset_ % chunk_size_;
+    if (position >= chunk_.size()) {
+      break;
     }
-    std::memcpy(buf, value_.data() + offset_, amtToRead);
-    offset_ += amtToRead;
-    return amtToRead;
-  } else {
-    return -1;
+    size_t len = std::min<size_t>(buflen - copied, chunk_.size() - position);
+    std::memcpy(buf + copied, chunk_.data() + position, len);
+    copied += len;
+    offset_ += len;
   }
+  return copied;
+}
+
+bool RocksDbStream::exists(const std::string &path, rocksdb::DB *db) {
+  std::string value;
+  return db->Get(rocksdb::ReadOptions(), path + SizeKeySuffix, &value).ok() || db->Get(rocksdb::ReadOptions(), path, &value).ok();
+}
+
+bool RocksDbStream::remove(const std::string &path, rocksdb::DB *db) {
+  rocksdb::WriteBatch batch;
+  uint64_t size = 0;
+  uint32_t chunk_size = 0;
+  if (readHeader(path, db, size, chunk_size)) {
+    uint64_t chunks = chunkCount(size, chunk_size);
+    for (uint64_t index = 0; index < chunks; index++) {
+      batch.Delete(chunkKey(path, index));
+    }
+    batch.Delete(path + SizeKeySuffix);
+  }
+  batch.Delete(path);
+  return db->Write(rocksdb::WriteOptions(), &batch).ok();
+}
+
+bool RocksDbStream::readHeader(const std::string &path, rocksdb::DB *db, uint64_t &size, uint32_t &chunk_size) {
+  std::string header;
+  if (!db->Get(rocksdb::ReadOptions(), path + SizeKeySuffix, &header).ok()) {
+    return false;
+  }
+  return decodeHeader(header, size, chunk_size);
+}
+
+std::string RocksDbStream::chunkKey(const std::string &path, uint64_t index) {
+  return path + ChunkSeparator + std::to_string(index);
+}
+
+uint64_t RocksDbStream::chunkCount(uint64_t size, uint32_t chunk_size) {
+  return (size + chunk_size - 1) / chunk_size;
 }
 
 } /* namespace io */
@@ -20,6 +20,8 @@
 
 #include "rocksdb/db.h"
 #include <iostream>
+#include <memory>
+#include <vector>
 #include <cstdint>
 #include <string>
 #include "io/EndianCheck.h"
@@ -34,33 +36,42 @@ namespace minifi {
 namespace io {
 
 /**
- * Purpose: File Stream Base stream extension. This is intended to be a thread safe access to
- * read/write to the local file system.
+ * Purpose: RocksDB stream extension, providing access to content stored in the database.
  *
- * Design: Simply extends BaseStream and overrides readData/writeData to allow a sink to the
- * fstream object.
+ * Design: Content is stored as fixed size chunks under the keys path#0, path#1, ..., along
+ * with a header under path#size holding the content size and chunk size. Writes buffer the
+ * current chunk and store full chunks without syncing; the final chunk and the header are
+ * written in a single synced batch when the stream is closed, after which the content becomes
+ * visible to readers. Reads fetch chunks as they are needed, and seek moves the read position.
+ * Content stored by earlier versions as a single value under path is still readable, and is
+ * converted to chunks when appended to.
  */
 class RocksDbStream : public io::BaseStream {
  public:
-  /**
-   * File Stream constructor that accepts an fstream shared pointer.
-   * It must already be initialized for read and write.
-   */
-  explicit RocksDbStream(const std::string &path, rocksdb::DB *db, bool write_enable = false);
+  static constexpr uint32_t DefaultChunkSize = 64 * 1024;
+  static constexpr const char *ChunkSeparator = "#";
+  static constexpr const char *SizeKeySuffix = "#size";
 
   /**
-   * File Stream constructor that accepts an fstream shared pointer.
-   * It must already be initialized for read and write.
+   * RocksDB stream constructor.
+   * @param path key of the content
+   * @param db database holding the content
+   * @param write_enable identifies if this stream writes content
+   * @param append identifies if writes append to the existing content or replace it
+   * @param chunk_size size of the chunks written for new content
    */
-  explicit RocksDbStream(const std::string &path);
+  explicit RocksDbStream(const std::string &path, rocksdb::DB *db, bool write_enable = false, bool append = false, uint32_t chunk_size = DefaultChunkSize);
 
   virtual ~RocksDbStream() {
     closeStream();
   }
 
+  /**
+   * Stores the buffered chunk and the content header in a single synced batch.
+   */
   virtual void closeStream();
   /**
-   * Skip to the specified offset.
+   * Skip to the specified offset. Only applies to reads, as writes always append.
    * @param offset offset to which we will skip
    */
   void seek(uint64_t offset);
@@ -145,6 +156,17 @@ class RocksDbStream : public io::BaseStream {
     throw std::runtime_error("Stream does not support this operation");
   }
 
+  /**
+   * Determines if content is stored under path
+   */
+  static bool exists(const std::string &path, rocksdb::DB *db);
+
+  /**
+   * Removes the content stored under path
+   * @return status of the delete
+   */
+  static bool remove(const std::string &path, rocksdb::DB *db);
+
  protected:
 
   /**
@@ -156,19 +178,41 @@ class RocksDbStream : public io::BaseStream {
   template<typename T>
   std::vector<uint8_t> readBuffer(const T&);
 
+  // Reads the content header, returning false if the content is not stored in chunks
+  static bool readHeader(const std::string &path, rocksdb::DB *db, uint64_t &size, uint32_t &chunk_size);
+
+  static std::string chunkKey(const std::string &path, uint64_t index);
+
+  // Number of chunks holding size bytes of content
+  static uint64_t chunkCount(uint64_t size, uint32_t chunk_size);
+
   std::string path_;
 
   bool write_enable_;
 
   bool exists_;
 
-  int64_t offset_;
-
-  std::string value_;
+  uint64_t offset_;
 
   rocksdb::DB *db_;
 
-  size_t size_;
+  uint64_t size_;
+
+  uint32_t chunk_size_;
+
+  // Set when the content is a single value stored by an earlier version
+  bool legacy_;
+
+  // Chunk being read, or the partial chunk being written
+  std::string chunk_;
+
+  // Index of the chunk held by chunk_ when reading
+  int64_t chunk_index_;
+
+  // Number of chunks stored before the content is replaced, which are removed on close
+  uint64_t stale_chunks_;
+
+  bool closed_;
 
  private:
 
@@ -82,13 +82,14 @@ void PutSQL::onSchedule(core::ProcessContext *context,
 
 void PutSQL::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
                        const std::shared_ptr<core::ProcessSession> &session) {
-  std::shared_ptr<FlowFileRecord> flow_file = std::static_pointer_cast<FlowFileRecord>(session->get());
+  auto flow_files = session->get(batch_size_);
 
-  if (!flow_file) {
+  if (flow_files.empty()) {
     return;
   }
 
-  uint64_t batch_processed = 1;
+  // index of the first flow file that has not been transferred yet
+  size_t processed = 0;
 
   try {
     // Use an existing context, if one is available
@@ -110,7 +111,8 @@ void PutSQL::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
       }
     }
 
-    do {
+    for (; processed < flow_files.size(); processed++) {
+      std::shared_ptr<FlowFileRecord> flow_file = std::static_pointer_cast<FlowFileRecord>(flow_files[processed]);
       auto sql = std::make_shared<std::string>();
 
       if (sql_.empty()) {
@@ -143,16 +145,9 @@ void PutSQL::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
       }
 
       session->transfer(flow_file, Success);
+    }
 
-      flow_file = std::static_pointer_cast<FlowFileRecord>(session->get());
-
-      if (!flow_file) {
-        logger_->log_info("Processed %d in batch", batch_processed);
-        break;
-      }
-
-      batch_processed++;
-    } while (batch_processed < batch_size_);
+    logger_->log_info("Processed %d in batch", flow_files.size());
 
     // Make connection available for use again
     if (conn_q_.size_approx() < getMaxConcurrentTasks()) {
@@ -163,11 +158,15 @@ void PutSQL::onTrigger(const std::shared_ptr<core::ProcessContext> &context,
     }
   } catch (std::exception &exception) {
     logger_->log_error("Caught Exception %s", exception.what());
-    session->transfer(flow_file, Failure);
+    for (; processed < flow_files.size(); processed++) {
+      session->transfer(flow_files[processed], Failure);
+    }
     this->yield();
   } catch (...) {
     logger_->log_error("Caught Exception");
-    session->transfer(flow_file, Failure);
+    for (; processed < flow_files.size(); processed++) {
+      session->transfer(flow_files[processed], Failure);
+    }
     this->yield();
   }
 }
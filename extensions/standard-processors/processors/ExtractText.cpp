@@ -21,10 +21,12 @@
 #include <string>
 #include <memory>
 #include <set>
-#include <regex>
+#include <algorithm>
 
 #include <iostream>
-#include <sstream>
+#include <map>
+#include <utility>
+#include <vector>
 
 #include "ExtractText.h"
 #include "core/ProcessContext.h"
@@ -79,6 +81,13 @@ core::Property ExtractText::EnableRepeatingCaptureGroup(
                       "Otherwise, if the Regular Expression matches more than once, only the first match will be extracted.")
     ->withDefaultValue<bool>(false)->build());
 
+core::Property ExtractText::WindowSize(
+    core::PropertyBuilder::createProperty("Window Size")
+    ->withDescription("In regex mode, the content is matched in windows of this size instead of being read into memory as a whole. "
+                      "Consecutive windows overlap by half of the window size, and matches longer than the overlap may be missed or cut short. "
+                      "0 matches the content read within the size limit at once.")
+    ->withDefaultValue<core::DataSizeValue>("0 B")->build());
+
 core::Relationship ExtractText::Success("success", "success operational on the flow record");
 
 void ExtractText::initialize() {
@@ -91,6 +100,7 @@ void ExtractText::initialize() {
   properties.insert(MaxCaptureGroupLen);
   properties.insert(EnableRepeatingCaptureGroup);
   properties.insert(InsensitiveMatch);
+  properties.insert(WindowSize);
   setSupportedProperties(properties);
   //! Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -110,8 +120,31 @@ void ExtractText::onTrigger(core::ProcessContext *context, core::ProcessSession
   session->transfer(flowFile, Success);
 }
 
+namespace {
+
+/**
+ * Scan state of one dynamic property pattern across the windows of the content.
+ */
+struct PatternScan {
+  PatternScan(const std::string &key, utils::Regex &&regex)
+      : key(key),
+        regex(std::move(regex)),
+        match_count(0),
+        resume(0),
+        done(false) {
+  }
+
+  std::string key;
+  utils::Regex regex;
+  int match_count;
+  // absolute content offset the next search starts from
+  uint64_t resume;
+  bool done;
+};
+
+}  // namespace
+
 int64_t ExtractText::ReadCallback::process(std::shared_ptr<io::BaseStream> stream) {
-  int64_t ret = 0;
   uint64_t read_size = 0;
   bool regex_mode;
   uint64_t size_limit = flowFile_->getSize();
@@ -126,87 +159,145 @@ int64_t ExtractText::ReadCallback::process(std::shared_ptr<io::BaseStream> strea
   else if (sizeLimitStr != "0")
     size_limit = std::stoi(sizeLimitStr);
 
-  std::ostringstream contentStream;
-
-  while (read_size < size_limit) {
-    // Don't read more than config limit or the size of the buffer
-    ret = stream->readData(buffer_, std::min<uint64_t>((size_limit - read_size), buffer_.capacity()));
-
-    if (ret < 0) {
-      return -1;  // Stream error
-    } else if (ret == 0) {
-      break;  // End of stream, no more data
-    }
-
-    contentStream.write(reinterpret_cast<const char*>(&buffer_[0]), ret);
-    read_size += ret;
-    if (contentStream.fail()) {
-      return -1;
+  if (!regex_mode) {
+    // the attribute holds the content, so it is read straight into the attribute value
+    std::string content;
+    content.reserve(std::min<uint64_t>(size_limit, flowFile_->getSize()));
+    while (read_size < size_limit) {
+      // Don't read more than config limit or the size of the buffer
+      int ret = stream->readData(buffer_.data(), std::min<uint64_t>((size_limit - read_size), buffer_.size()));
+      if (ret < 0) {
+        return -1;  // Stream error
+      } else if (ret == 0) {
+        break;  // End of stream, no more data
+      }
+      content.append(reinterpret_cast<const char*>(buffer_.data()), ret);
+      read_size += ret;
     }
+    flowFile_->setAttribute(attrKey, content);
+    return read_size;
   }
 
-  if (regex_mode) {
-    std::vector<utils::Regex::Mode> rgx_mode;
-
-    bool insensitive;
-    if (ctx_->getProperty(InsensitiveMatch.getName(), insensitive) && insensitive) {
-      rgx_mode.push_back(utils::Regex::Mode::ICASE);
-    }
-
-    bool ignoregroupzero;
-    ctx_->getProperty(IgnoreCaptureGroupZero.getName(), ignoregroupzero);
-
-    bool repeatingcapture;
-    ctx_->getProperty(EnableRepeatingCaptureGroup.getName(), repeatingcapture);
-
-    int maxCaptureSize;
-    ctx_->getProperty(MaxCaptureGroupLen.getName(), maxCaptureSize);
+  std::vector<utils::Regex::Mode> rgx_mode;
 
-    std::string contentStr = contentStream.str();
+  bool insensitive;
+  if (ctx_->getProperty(InsensitiveMatch.getName(), insensitive) && insensitive) {
+    rgx_mode.push_back(utils::Regex::Mode::ICASE);
+  }
 
-    std::map<std::string, std::string> regexAttributes;
+  bool ignoregroupzero;
+  ctx_->getProperty(IgnoreCaptureGroupZero.getName(), ignoregroupzero);
 
-    for (const auto& k : ctx_->getDynamicPropertyKeys()) {
-      std::string value;
-      ctx_->getDynamicProperty(k, value);
+  bool repeatingcapture;
+  ctx_->getProperty(EnableRepeatingCaptureGroup.getName(), repeatingcapture);
 
-      std::string workStr = contentStr;
+  int maxCaptureSize;
+  ctx_->getProperty(MaxCaptureGroupLen.getName(), maxCaptureSize);
 
-      int matchcount = 0;
+  uint64_t window_size = 0;
+  std::string windowSizeStr;
+  if (ctx_->getProperty(WindowSize.getName(), windowSizeStr)) {
+    core::Property::StringToInt(windowSizeStr, window_size);
+  }
+  uint64_t content_size = std::min<uint64_t>(size_limit, flowFile_->getSize());
+  if (window_size == 0 || window_size > content_size) {
+    window_size = content_size;
+  }
+  // a window keeps its second half for the next one, so matches up to half a window long are found whole,
+  // and a window of at least three bytes discards at least one of them so that the scan moves forward
+  window_size = std::max<uint64_t>(window_size, 3);
+  const uint64_t overlap = window_size / 2;
+
+  std::vector<PatternScan> patterns;
+  for (const auto& k : ctx_->getDynamicPropertyKeys()) {
+    std::string value;
+    ctx_->getDynamicProperty(k, value);
+    try {
+      patterns.emplace_back(k, utils::Regex(value, rgx_mode));
+    } catch (const Exception &e) {
+      logger_->log_error("%s error encountered when trying to construct regular expression from property (key: %s) value: %s",
+                         e.what(), k, value);
+    }
+  }
 
-      try {
-        utils::Regex rgx(value, rgx_mode);
-        while (rgx.match(workStr)) {
-          const std::vector<std::string> &matches = rgx.getResult();
-          size_t i = ignoregroupzero ? 1 : 0;
+  std::map<std::string, std::string> regexAttributes;
+  std::string window;
+  window.reserve(window_size);
+  // absolute content offset of the first byte of the window
+  uint64_t base = 0;
+  std::vector<size_t> groups;
+  bool end_of_content = false;
+
+  while (!end_of_content) {
+    while (window.size() < window_size && read_size < size_limit) {
+      int ret = stream->readData(buffer_.data(), std::min<uint64_t>(std::min<uint64_t>(size_limit - read_size, window_size - window.size()), buffer_.size()));
+      if (ret < 0) {
+        return -1;  // Stream error
+      } else if (ret == 0) {
+        break;  // End of stream, no more data
+      }
+      window.append(reinterpret_cast<const char*>(buffer_.data()), ret);
+      read_size += ret;
+    }
+    end_of_content = window.size() < window_size || read_size >= content_size;
 
-          for (; i < matches.size(); ++i, ++matchcount) {
-            std::string attributeValue = matches[i];
-            if (attributeValue.length() > maxCaptureSize) {
-              attributeValue = attributeValue.substr(0, maxCaptureSize);
-            }
-            if (matchcount == 0) {
-              regexAttributes[k] = attributeValue;
-            }
-            regexAttributes[k + '.' + std::to_string(matchcount)] = attributeValue;
+    // matches starting past the cutoff may continue into the next window, so they are left to it
+    const size_t cutoff = end_of_content ? window.size() : window.size() - overlap;
+    bool pending = false;
+    for (auto &pattern : patterns) {
+      if (pattern.done) {
+        continue;
+      }
+      size_t offset = pattern.resume > base ? pattern.resume - base : 0;
+      bool deferred = false;
+      while (offset <= window.size() && pattern.regex.search(window.data(), window.size(), offset, groups)) {
+        if (groups[0] >= cutoff && !end_of_content) {
+          pattern.resume = base + groups[0];
+          deferred = true;
+          break;
+        }
+        size_t i = ignoregroupzero ? 1 : 0;
+        for (; i < pattern.regex.getGroupCount(); ++i, ++pattern.match_count) {
+          std::string attributeValue;
+          if (groups[2 * i] != std::string::npos) {
+            attributeValue = window.substr(groups[2 * i], std::min<size_t>(groups[2 * i + 1] - groups[2 * i], maxCaptureSize));
           }
-          if (!repeatingcapture) {
-            break;
+          if (pattern.match_count == 0) {
+            regexAttributes[pattern.key] = attributeValue;
           }
-          workStr = rgx.getSuffix();
+          regexAttributes[pattern.key + '.' + std::to_string(pattern.match_count)] = attributeValue;
         }
-      } catch (const Exception &e) {
-        logger_->log_error("%s error encountered when trying to construct regular expression from property (key: %s) value: %s",
-                           e.what(), k, value);
-        continue;
+        if (!repeatingcapture) {
+          pattern.done = true;
+          break;
+        }
+        // the next search skips the character following the match, as Regex::getSuffix() does
+        offset = groups[1] + 1;
+      }
+      if (!deferred) {
+        pattern.resume = base + std::max(offset, cutoff);
       }
+      pending = pending || !pattern.done;
+    }
+    if (!pending) {
+      // every pattern has its match, there is no need to read the rest of the content
+      break;
     }
 
-    for (const auto& kv : regexAttributes) {
-      flowFile_->setAttribute(kv.first, kv.second);
+    // the window keeps the byte before the earliest resume offset, so ^ and \b see what precedes it
+    uint64_t keep = base + window.size();
+    for (const auto &pattern : patterns) {
+      if (!pattern.done) {
+        keep = std::min(keep, pattern.resume);
+      }
     }
-  } else {
-    flowFile_->setAttribute(attrKey, contentStream.str());
+    size_t discard = keep > base ? std::min<size_t>(keep - base - 1, window.size()) : 0;
+    window.erase(0, discard);
+    base += discard;
+  }
+
+  for (const auto& kv : regexAttributes) {
+    flowFile_->setAttribute(kv.first, kv.second);
   }
   return read_size;
 }
@@ -215,7 +306,7 @@ ExtractText::ReadCallback::ReadCallback(std::shared_ptr<core::FlowFile> flowFile
     : flowFile_(flowFile),
       ctx_(ctx),
       logger_(lgr) {
-  buffer_.reserve(std::min<uint64_t>(flowFile->getSize(), MAX_BUFFER_SIZE));
+  buffer_.resize(std::min<uint64_t>(std::max<uint64_t>(flowFile->getSize(), 1), MAX_BUFFER_SIZE));
 }
 
 } /* namespace processors */
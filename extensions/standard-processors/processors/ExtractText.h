@@ -56,6 +56,7 @@ public:
     static core::Property InsensitiveMatch;
     static core::Property MaxCaptureGroupLen;
     static core::Property EnableRepeatingCaptureGroup;
+    static core::Property WindowSize;
 
     //! Supported Relationships
     static core::Relationship Success;
@@ -21,11 +21,6 @@
 #include <time.h>
 #include <stdio.h>
 #include <limits.h>
-#ifndef WIN32
-#include <regex.h>
-#else
-#include <regex>
-#endif
 #include <vector>
 #include <queue>
 #include <map>
@@ -218,11 +218,9 @@ bool PutFile::putFile(core::ProcessSession *session, std::shared_ptr<FlowFileRec
     }
   }
 
-  ReadCallback cb(tmpFile, destFile);
-  session->read(flowFile, &cb);
-
+  // the session copies the content within the kernel when the content repository allows it
   logger_->log_debug("Committing %s", destFile);
-  if (cb.commit()) {
+  if (session->exportContent(destFile, tmpFile, flowFile, true)) {
     session->transfer(flowFile, Success);
     return true;
   } else {
@@ -231,72 +229,6 @@ bool PutFile::putFile(core::ProcessSession *session, std::shared_ptr<FlowFileRec
   return false;
 }
 
-PutFile::ReadCallback::ReadCallback(const std::string &tmp_file, const std::string &dest_file)
-    : tmp_file_(tmp_file),
-      dest_file_(dest_file),
-      logger_(logging::LoggerFactory<PutFile::ReadCallback>::getLogger()) {
-}
-
-// Copy the entire file contents to the temporary file
-int64_t PutFile::ReadCallback::process(std::shared_ptr<io::BaseStream> stream) {
-  // Copy file contents into tmp file
-  write_succeeded_ = false;
-  size_t size = 0;
-  uint8_t buffer[1024];
-
-  std::ofstream tmp_file_os(tmp_file_);
-
-  do {
-    int read = stream->read(buffer, 1024);
-
-    if (read < 0) {
-      return -1;
-    }
-
-    if (read == 0) {
-      break;
-    }
-
-    tmp_file_os.write(reinterpret_cast<char *>(buffer), read);
-    size += read;
-  } while (size < stream->getSize());
-
-  tmp_file_os.close();
-
-  if (tmp_file_os) {
-    write_succeeded_ = true;
-  }
-
-  return size;
-}
-
-// Renames tmp file to final destination
-// Returns true if commit succeeded
-bool PutFile::ReadCallback::commit() {
-  bool success = false;
-
-  logger_->log_info("PutFile committing put file operation to %s", dest_file_);
-
-  if (write_succeeded_) {
-    if (rename(tmp_file_.c_str(), dest_file_.c_str())) {
-      logger_->log_info("PutFile commit put file operation to %s failed because rename() call failed", dest_file_);
-    } else {
-      success = true;
-      logger_->log_info("PutFile commit put file operation to %s succeeded", dest_file_);
-    }
-  } else {
-    logger_->log_error("PutFile commit put file operation to %s failed because write failed", dest_file_);
-  }
-
-  return success;
-}
-
-// Clean up resources
-PutFile::ReadCallback::~ReadCallback() {
-  // Clean up tmp file, if necessary
-  unlink(tmp_file_.c_str());
-}
-
 } /* namespace processors */
 } /* namespace minifi */
 } /* namespace nifi */
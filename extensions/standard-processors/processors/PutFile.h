@@ -73,22 +73,6 @@ class PutFile : public core::Processor {
   virtual void onTrigger(core::ProcessContext *context, core::ProcessSession *session);
   virtual void initialize(void);
 
-  class ReadCallback : public InputStreamCallback {
-   public:
-    ReadCallback(const std::string &tmp_file,
-                 const std::string &dest_file);
-    ~ReadCallback();
-    virtual int64_t process(std::shared_ptr<io::BaseStream> stream);
-    bool commit();
-
-   private:
-    std::shared_ptr<logging::Logger> logger_;
-    bool write_succeeded_ = false;
-    std::string tmp_file_;
-    std::string dest_file_;
-    std::string dest_dir_;
-  };
-
   /**
    * Generate a safe (universally-unique) temporary filename on the same partition
    *
@@ -182,3 +182,105 @@ TEST_CASE("Test usage of ExtractText in regex mode", "[extracttextRegexTest]") {
 
   LogTestController::getInstance().reset();
 }
+
+TEST_CASE("Test usage of ExtractText in regex mode with a window", "[extracttextRegexWindowTest]") {
+  TestController testController;
+  LogTestController::getInstance().setTrace<org::apache::nifi::minifi::processors::ExtractText>();
+  LogTestController::getInstance().setTrace<org::apache::nifi::minifi::processors::LogAttribute>();
+
+  std::shared_ptr<TestPlan> plan = testController.createPlan();
+
+  char dirtemplate[] = "/tmp/gt.XXXXXX";
+
+  auto dir = testController.createTempDirectory(dirtemplate);
+  REQUIRE(!dir.empty());
+  std::shared_ptr<core::Processor> getfile = plan->addProcessor("GetFile", "getfileCreate2");
+  plan->setProperty(getfile, org::apache::nifi::minifi::processors::GetFile::Directory.getName(), dir);
+  plan->setProperty(getfile, org::apache::nifi::minifi::processors::GetFile::KeepSourceFile.getName(), "true");
+
+  std::shared_ptr<core::Processor> maprocessor = plan->addProcessor("ExtractText", "testExtractText", core::Relationship("success", "description"), true);
+  plan->setProperty(maprocessor, org::apache::nifi::minifi::processors::ExtractText::RegexMode.getName(), "true");
+  plan->setProperty(maprocessor, org::apache::nifi::minifi::processors::ExtractText::IgnoreCaptureGroupZero.getName(), "true");
+  plan->setProperty(maprocessor, org::apache::nifi::minifi::processors::ExtractText::EnableRepeatingCaptureGroup.getName(), "true");
+  // matches cross the boundaries of the 48 byte windows
+  plan->setProperty(maprocessor, org::apache::nifi::minifi::processors::ExtractText::WindowSize.getName(), "48 B");
+  plan->setProperty(maprocessor, "RegexAttr", "Speed limit ([0-9]+)", true);
+  plan->setProperty(maprocessor, "FirstLineAttr", "^Speed limit ([0-9]+)", true);
+
+  std::shared_ptr<core::Processor> laprocessor = plan->addProcessor("LogAttribute", "outputLogAttribute", core::Relationship("success", "description"), true);
+
+  std::stringstream ss;
+  ss << dir << utils::file::FileUtils::get_separator() << TEST_FILE;
+  std::string test_file_path = ss.str();
+
+  std::ofstream test_file(test_file_path);
+  if (test_file.is_open()) {
+    for (int i = 1; i <= 20; i++) {
+      test_file << "Speed limit " << i * 10 << " | ";
+    }
+    test_file.close();
+  }
+
+  plan->runNextProcessor();  // GetFile
+  plan->runNextProcessor();  // ExtractText
+  plan->runNextProcessor();  // LogAttribute
+
+  for (int i = 0; i < 20; i++) {
+    ss.str("");
+    ss << "key:RegexAttr." << i << " value:" << (i + 1) * 10 << "\n";
+    REQUIRE(LogTestController::getInstance().contains(ss.str()));
+  }
+  REQUIRE(LogTestController::getInstance().contains("key:RegexAttr.20 value:", std::chrono::seconds(0)) == false);
+  // ^ only matches at the start of the content, not at the start of a window
+  REQUIRE(LogTestController::getInstance().contains("key:FirstLineAttr.0 value:10\n"));
+  REQUIRE(LogTestController::getInstance().contains("key:FirstLineAttr.1 value:", std::chrono::seconds(0)) == false);
+
+  LogTestController::getInstance().reset();
+}
+
+TEST_CASE("Test usage of ExtractText in regex mode with a tiny window", "[extracttextRegexTinyWindowTest]") {
+  TestController testController;
+  LogTestController::getInstance().setTrace<org::apache::nifi::minifi::processors::ExtractText>();
+  LogTestController::getInstance().setTrace<org::apache::nifi::minifi::processors::LogAttribute>();
+
+  std::shared_ptr<TestPlan> plan = testController.createPlan();
+
+  char dirtemplate[] = "/tmp/gt.XXXXXX";
+
+  auto dir = testController.createTempDirectory(dirtemplate);
+  REQUIRE(!dir.empty());
+  std::shared_ptr<core::Processor> getfile = plan->addProcessor("GetFile", "getfileCreate2");
+  plan->setProperty(getfile, org::apache::nifi::minifi::processors::GetFile::Directory.getName(), dir);
+  plan->setProperty(getfile, org::apache::nifi::minifi::processors::GetFile::KeepSourceFile.getName(), "true");
+
+  std::shared_ptr<core::Processor> maprocessor = plan->addProcessor("ExtractText", "testExtractText", core::Relationship("success", "description"), true);
+  plan->setProperty(maprocessor, org::apache::nifi::minifi::processors::ExtractText::RegexMode.getName(), "true");
+  plan->setProperty(maprocessor, org::apache::nifi::minifi::processors::ExtractText::IgnoreCaptureGroupZero.getName(), "true");
+  plan->setProperty(maprocessor, org::apache::nifi::minifi::processors::ExtractText::EnableRepeatingCaptureGroup.getName(), "true");
+  // windows this small used to stop the scan from moving forward when the pattern did not match
+  plan->setProperty(maprocessor, org::apache::nifi::minifi::processors::ExtractText::WindowSize.getName(), "1 B");
+  plan->setProperty(maprocessor, "MissingAttr", "Speed limit ([0-9]+)", true);
+  plan->setProperty(maprocessor, "DigitAttr", "([0-9])", true);
+
+  std::shared_ptr<core::Processor> laprocessor = plan->addProcessor("LogAttribute", "outputLogAttribute", core::Relationship("success", "description"), true);
+
+  std::stringstream ss;
+  ss << dir << utils::file::FileUtils::get_separator() << TEST_FILE;
+  std::string test_file_path = ss.str();
+
+  std::ofstream test_file(test_file_path);
+  if (test_file.is_open()) {
+    test_file << "no limit 1 here, 2 there";
+    test_file.close();
+  }
+
+  plan->runNextProcessor();  // GetFile
+  plan->runNextProcessor();  // ExtractText
+  plan->runNextProcessor();  // LogAttribute
+
+  REQUIRE(LogTestController::getInstance().contains("key:DigitAttr.0 value:1\n"));
+  REQUIRE(LogTestController::getInstance().contains("key:DigitAttr.1 value:2\n"));
+  REQUIRE(LogTestController::getInstance().contains("key:MissingAttr", std::chrono::seconds(0)) == false);
+
+  LogTestController::getInstance().reset();
+}
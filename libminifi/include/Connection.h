@@ -33,6 +33,7 @@
 #include "core/Relationship.h"
 #include "core/Connectable.h"
 #include "core/FlowFile.h"
+#include "core/FlowFileQueue.h"
 #include "core/Repository.h"
 
 namespace org {
@@ -137,14 +138,13 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
   bool isFull();
   // Get queue size
   uint64_t getQueueSize() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return queue_.size();
+    return queued_count_;
   }
   // Get queue data size
   uint64_t getQueueDataSize() {
     return queued_data_size_;
   }
-  void put(std::shared_ptr<core::Connectable> flow) {
+  virtual void put(std::shared_ptr<core::Connectable> flow) {
     std::shared_ptr<core::FlowFile> ff = std::static_pointer_cast<core::FlowFile>(flow);
     if (nullptr != ff) {
       put(ff);
@@ -152,17 +152,68 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
   }
   // Put the flow file into queue
   void put(std::shared_ptr<core::FlowFile> flow);
+  /**
+   * Puts the flow files into the queue. Flow files that are not yet stored are persisted to
+   * the flow file repository with a single batch before they are queued.
+   * @param flows flow files to queue
+   */
+  void multiPut(const std::vector<std::shared_ptr<core::FlowFile>> &flows);
   // Poll the flow file from queue, the expired flow file record also being returned
   std::shared_ptr<core::FlowFile> poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords);
+  /**
+   * Polls up to max_count flow files from the queue in a single pass. Penalized flow files
+   * are set aside until their penalty expires and expired flow files are returned through
+   * expiredFlowRecords.
+   * @param flows vector to which the polled flow files are appended
+   * @param max_count maximum number of flow files to poll
+   * @param max_bytes stop polling once the polled flow files reach this size, 0 for no limit
+   * @param expiredFlowRecords expired flow files that were removed from the queue
+   * @return number of flow files appended to flows
+   */
+  size_t poll(std::vector<std::shared_ptr<core::FlowFile>> &flows, size_t max_count, uint64_t max_bytes, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords);
   // Drain the flow records
   void drain();
+  /**
+   * Replaces the queue implementation backing this connection. Any flow files already
+   * queued are moved to the new queue. This must be called before the connection is scheduled.
+   * @param queue_type configured queue type name, see core::FlowFileQueue::create
+   * @return false if the queue type is not recognized.
+   */
+  bool setQueueType(const std::string &queue_type);
+  // Get the name of the queue implementation backing this connection
+  std::string getQueueType();
+  /**
+   * Orders the queued flow files using the given prioritizers, applied in order. This replaces
+   * the configured queue type with a prioritized queue and, like setQueueType, must be called
+   * before the connection is scheduled.
+   * @param prioritizers prioritizers, an empty list restores the default queue.
+   */
+  void setPrioritizers(const std::vector<std::shared_ptr<core::FlowFilePrioritizer>> &prioritizers);
+  /**
+   * Enables swapping queued flow files to disk once more than swap_threshold flow files are
+   * queued in memory, see core::SwappingFlowFileQueue. Like setQueueType, this must be called
+   * before the connection is scheduled.
+   * @param swap_threshold number of flow files kept in memory before swapping, 0 disables swapping.
+   * @param directory directory in which swap files are created.
+   */
+  void setSwapThreshold(uint64_t swap_threshold, const std::string &directory);
+  // Get the swap threshold, 0 if swapping is disabled
+  uint64_t getSwapThreshold() {
+    return swap_threshold_;
+  }
+  // Get the number of queued flow files that are waiting for their penalty to expire
+  uint64_t getPenalizedCount() {
+    return penalized_count_;
+  }
 
   void yield() {
 
   }
 
+  // Work is available when a queued flow file is not penalized or its penalty has expired
   bool isWorkAvailable() {
-    return !isEmpty();
+    uint64_t penalized = penalized_count_;
+    return queued_count_ > penalized || (penalized > 0 && next_penalty_expiration_ <= getTimeMillis());
   }
 
   bool isRunning() {
@@ -192,12 +243,46 @@ class Connection : public core::Connectable, public std::enable_shared_from_this
   std::shared_ptr<core::ContentRepository> content_repo_;
 
  private:
-  // Mutex for protection
-  std::mutex mutex_;
   // Queued data size
   std::atomic<uint64_t> queued_data_size_;
+  // Queued flow file count
+  std::atomic<uint64_t> queued_count_;
   // Queue for the Flow File
-  std::queue<std::shared_ptr<core::FlowFile>> queue_;
+  std::unique_ptr<core::FlowFileQueue> queue_;
+  // Configured queue type
+  std::string queue_type_;
+  // Configured prioritizers, these take precedence over the queue type
+  std::vector<std::shared_ptr<core::FlowFilePrioritizer>> prioritizers_;
+  // Number of flow files kept in memory before swapping, 0 if swapping is disabled
+  uint64_t swap_threshold_;
+  // Directory in which swap files are created
+  std::string swap_directory_;
+
+  // Penalized flow file along with the penalty expiration it was set aside with
+  struct PenalizedFlowFile {
+    uint64_t expiration;
+    std::shared_ptr<core::FlowFile> flow;
+    bool operator<(const PenalizedFlowFile &other) const {
+      // std::priority_queue is a max heap, so the earliest expiration has to compare greatest
+      return expiration > other.expiration;
+    }
+  };
+
+  // Sets aside a penalized flow file so that it does not hold up the flow files queued behind it
+  void penalize(const std::shared_ptr<core::FlowFile> &flow);
+  // Returns flow files whose penalty has expired to the queue
+  void releasePenalized();
+  // Replaces the queue with one matching the configured queue type, prioritizers and swap threshold, moving over any queued flow files
+  void rebuildQueue();
+
+  // Guards penalized_
+  std::mutex penalized_mutex_;
+  // Penalized flow files ordered by penalty expiration
+  std::priority_queue<PenalizedFlowFile> penalized_;
+  // Number of flow files in penalized_
+  std::atomic<uint64_t> penalized_count_;
+  // Earliest penalty expiration in penalized_
+  std::atomic<uint64_t> next_penalty_expiration_;
   // flow repository
   // Logger
   std::shared_ptr<logging::Logger> logger_;
@@ -20,6 +20,12 @@
 #ifndef __EVENT_DRIVEN_SCHEDULING_AGENT_H__
 #define __EVENT_DRIVEN_SCHEDULING_AGENT_H__
 
+#include <atomic>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include "core/logging/Logger.h"
 #include "core/Processor.h"
 #include "core/ProcessContext.h"
@@ -31,7 +37,33 @@ namespace apache {
 namespace nifi {
 namespace minifi {
 
+/**
+ * Finishes an event driven trigger task once its processor has no more work, rather than
+ * running it again after a wait.
+ */
+class TriggerMonitor : public TimerAwareMonitor {
+ public:
+  // Returned by a trigger task whose processor has no more work
+  static constexpr uint64_t Idle = std::numeric_limits<uint64_t>::max();
+
+  TriggerMonitor(std::atomic<bool> *run_monitor)
+      : TimerAwareMonitor(run_monitor) {
+  }
+  virtual bool isFinished(const uint64_t &result) {
+    if (result == Idle) {
+      return true;
+    }
+    return TimerAwareMonitor::isFinished(result);
+  }
+};
+
 // EventDrivenSchedulingAgent Class
+/**
+ * Triggers processors when flow files are queued for them. Queuing a flow file marks its
+ * destination runnable and submits a trigger task to the thread pool unless all of the
+ * processor's concurrent tasks are already queued or running. A trigger task runs the
+ * processor until it has no more work and then finishes, so idle processors hold no threads.
+ */
 class EventDrivenSchedulingAgent : public ThreadedSchedulingAgent {
  public:
   // Constructor
@@ -40,7 +72,8 @@ class EventDrivenSchedulingAgent : public ThreadedSchedulingAgent {
    */
   EventDrivenSchedulingAgent(std::shared_ptr<core::controller::ControllerServiceProvider> controller_service_provider, std::shared_ptr<core::Repository> repo,
                              std::shared_ptr<core::Repository> flow_repo, std::shared_ptr<core::ContentRepository> content_repo, std::shared_ptr<Configure> configuration)
-      : ThreadedSchedulingAgent(controller_service_provider, repo, flow_repo, content_repo, configuration) {
+      : ThreadedSchedulingAgent(controller_service_provider, repo, flow_repo, content_repo, configuration),
+        logger_(logging::LoggerFactory<EventDrivenSchedulingAgent>::getLogger()) {
   }
   // Destructor
   virtual ~EventDrivenSchedulingAgent() {
@@ -48,12 +81,47 @@ class EventDrivenSchedulingAgent : public ThreadedSchedulingAgent {
   // Run function for the thread
   uint64_t run(const std::shared_ptr<core::Processor> &processor, const std::shared_ptr<core::ProcessContext> &processContext, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory);
 
+  virtual void unschedule(std::shared_ptr<core::Processor> processor);
+
+ protected:
+  virtual void submitTasks(const std::shared_ptr<core::Processor> &processor, const std::shared_ptr<core::ProcessContext> &processContext,
+                           const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory);
+
  private:
+  // Wait between triggers of processors that run without incoming flow files
+  static constexpr uint64_t TriggerWhenEmptyWaitMsec = 1000;
+
+  // Scheduled processor and its trigger tasks
+  struct TriggerState {
+    std::shared_ptr<core::Processor> processor;
+    std::shared_ptr<core::ProcessContext> context;
+    std::shared_ptr<core::ProcessSessionFactory> session_factory;
+    // trigger tasks that are queued or running
+    std::atomic<int> tasks;
+    int max_tasks;
+    // set once the processor is unscheduled, after which no trigger tasks are submitted
+    std::atomic<bool> stopped;
+    // orders submissions against unscheduling, so none is submitted once the tasks are stopped
+    std::mutex submit_mutex;
+  };
+
+  // Claims a trigger task for the processor, failing if all of its concurrent tasks are queued or running
+  static bool acquireTask(TriggerState &state);
+  // Submits a trigger task that has been claimed through acquireTask, unless the processor is unscheduled
+  void submitTrigger(const std::shared_ptr<TriggerState> &state);
+  // Runs the processor once and returns the wait before running it again or Idle
+  uint64_t trigger(const std::shared_ptr<TriggerState> &state);
+
+  // Trigger state of scheduled processors by UUID. It has a mutex of its own as schedule() holds mutex_ while it submits the tasks
+  std::mutex trigger_states_mutex_;
+  std::map<std::string, std::shared_ptr<TriggerState>> trigger_states_;
+
   // Prevent default copy constructor and assignment operation
   // Only support pass by reference or pointer
   EventDrivenSchedulingAgent(const EventDrivenSchedulingAgent &parent);
   EventDrivenSchedulingAgent &operator=(const EventDrivenSchedulingAgent &parent);
 
+  std::shared_ptr<logging::Logger> logger_;
 };
 
 } /* namespace minifi */
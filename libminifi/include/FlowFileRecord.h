@@ -30,6 +30,8 @@
 #include <sstream>
 #include <fstream>
 #include <set>
+#include <string>
+#include <utility>
 #include "core/ContentRepository.h"
 #include "io/BaseStream.h"
 #include "io/Serializable.h"
@@ -72,6 +74,13 @@ enum FlowAttribute {
 // FlowFile Attribute Key
 static const char *FlowAttributeKeyArray[MAX_FLOW_ATTRIBUTES] = { "path", "absolute.path", "filename", "uuid", "priority", "mime.type", "discard.reason", "alternate.identifier", "flow.id" };
 
+/**
+ * Set in the serialized attribute count when the keys of FlowAttributeKeyArray are written as
+ * their index rather than their name. The array is the attribute dictionary of the serialized
+ * records, so attributes may only be appended to it.
+ */
+#define ATTRIBUTE_DICTIONARY_FLAG 0x80000000
+
 // FlowFile Attribute Enum to Key
 inline const char *FlowAttributeKey(FlowAttribute attribute) {
   if (attribute < MAX_FLOW_ATTRIBUTES)
@@ -134,6 +143,16 @@ class FlowFileRecord : public core::FlowFile, public io::Serializable {
 
   //! Serialize and Persistent to the repository
   bool Serialize();
+  //! Serialize into the stream without persisting to the repository
+  bool Serialize(io::DataStream &outStream);
+  /**
+   * Persists the flow files to the repository with a single MultiPut, sharing one serialization
+   * buffer. Flow files that were persisted are marked as stored.
+   * @param flows flow files along with the uuid of the connection they are queued in
+   * @return true if all flow files were persisted
+   */
+  static bool Serialize(const std::shared_ptr<core::Repository> &flow_repository, const std::shared_ptr<core::ContentRepository> &content_repo,
+                        const std::vector<std::pair<std::shared_ptr<core::FlowFile>, std::string>> &flows);
   //! DeSerialize
   bool DeSerialize(const uint8_t *buffer, const int bufferSize);
   //! DeSerialize
@@ -177,6 +196,9 @@ class FlowFileRecord : public core::FlowFile, public io::Serializable {
 
  protected:
 
+  // Returns one plus the index of the key in the attribute dictionary, or zero if it is not in the dictionary
+  static uint8_t getDictionaryIndex(const core::AttributeKey *key);
+
   // connection uuid
   std::string uuid_connection_;
   // Full path to the content
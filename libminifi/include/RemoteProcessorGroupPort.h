@@ -20,15 +20,21 @@
 #ifndef __REMOTE_PROCESSOR_GROUP_PORT_H__
 #define __REMOTE_PROCESSOR_GROUP_PORT_H__
 
+#include <condition_variable>
 #include <mutex>
 #include <memory>
 #include <stack>
+#include <thread>
+#include <vector>
 #include "utils/HTTPClient.h"
+#include "utils/ThreadPool.h"
 #include "concurrentqueue.h"
 #include "FlowFileRecord.h"
 #include "core/Processor.h"
 #include "core/ProcessSession.h"
 #include "sitetosite/SiteToSiteClient.h"
+#include "sitetosite/PeerSelector.h"
+#include "sitetosite/SiteToSiteClientPool.h"
 #include "io/StreamFactory.h"
 #include "controllers/SSLContextService.h"
 #include "core/logging/LoggerConfiguration.h"
@@ -86,19 +92,27 @@ class RemoteProcessorGroupPort : public core::Processor {
         timeout_(0),
         http_enabled_(false),
         bypass_rest_api_(false),
+        use_compression_(false),
+        compression_level_(io::CompressionOutputStream::DEFAULT_COMPRESSION_LEVEL),
+        compression_threshold_(0),
+        peer_refresh_interval_(60000),
+        warm_clients_(1),
+        max_in_flight_transactions_(1),
+        maintaining_(false),
+        refresh_requested_(false),
         ssl_service(nullptr),
         logger_(logging::LoggerFactory<RemoteProcessorGroupPort>::getLogger()) {
     client_type_ = sitetosite::CLIENT_TYPE::RAW;
     stream_factory_ = stream_factory;
     protocol_uuid_ = uuid;
     site2site_secure_ = false;
-    peer_index_ = -1;
     // REST API port and host
     setURL(url);
   }
   // Destructor
   virtual ~RemoteProcessorGroupPort() {
-
+    stopPeerMaintenance();
+    stopTransactionPool();
   }
 
   // Processor Name
@@ -108,10 +122,21 @@ class RemoteProcessorGroupPort : public core::Processor {
   static core::Property SSLContext;
   static core::Property port;
   static core::Property portUUID;
+  static core::Property useCompression;
+  static core::Property compressionLevel;
+  static core::Property compressionThreshold;
+  static core::Property peerRefreshInterval;
+  static core::Property warmClientsPerPeer;
+  static core::Property maxInFlightTransactions;
   // Supported Relationships
   static core::Relationship relation;
  public:
   virtual void onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory);
+  /**
+   * Keeps up to the configured number of send transactions in flight, each with its own session
+   * and client, and otherwise runs a single transaction like any other processor.
+   */
+  virtual void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory);
   // OnTrigger method, implemented by NiFi RemoteProcessorGroupPort
   virtual void onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session);
 
@@ -169,7 +194,7 @@ class RemoteProcessorGroupPort : public core::Processor {
   // refresh remoteSite2SiteInfo via nifi rest api
   std::pair<std::string, int> refreshRemoteSite2SiteInfo();
 
-  // refresh site2site peer list
+  // refresh site2site peer list, only called while the peers are not maintained in the background
   void refreshPeerList();
 
   virtual void notifyStop();
@@ -194,10 +219,36 @@ class RemoteProcessorGroupPort : public core::Processor {
   }
 
   std::shared_ptr<io::StreamFactory> stream_factory_;
-  std::unique_ptr<sitetosite::SiteToSiteClient> getNextProtocol(bool create);
-  void returnProtocol(std::unique_ptr<sitetosite::SiteToSiteClient> protocol);
+  /**
+   * Returns a client of the peer selected for the next transaction, preferring idle clients of the pool.
+   * @param peer receives the selected peer
+   * @param create whether a client is created if the peer has no idle client
+   */
+  std::unique_ptr<sitetosite::SiteToSiteClient> getNextProtocol(std::shared_ptr<sitetosite::Peer> &peer, bool create = true);
+  void returnProtocol(const std::shared_ptr<sitetosite::Peer> &peer, std::unique_ptr<sitetosite::SiteToSiteClient> protocol);
+  virtual std::unique_ptr<sitetosite::SiteToSiteClient> createProtocol(const std::shared_ptr<sitetosite::Peer> &peer);
+  // Returns the peer configured through the host and port, which is used when the REST API is bypassed
+  std::shared_ptr<sitetosite::Peer> getConfiguredPeer();
 
-  moodycamel::ConcurrentQueue<std::unique_ptr<sitetosite::SiteToSiteClient>> available_protocols_;
+  // Connects the idle clients that each peer keeps in the pool
+  void warmClients();
+  // Background task refreshing the peer list and warming clients
+  void maintainPeers();
+  void startPeerMaintenance();
+  void stopPeerMaintenance();
+  // Has the background task refresh the peer list without waiting for the refresh interval
+  void requestPeerRefresh();
+
+  /**
+   * Sends one transaction through its own session and client, committing the session once the
+   * peer confirmed the transaction and rolling it back otherwise.
+   * @return true if flow files were sent
+   */
+  bool sendTransaction(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory);
+  void stopTransactionPool();
+
+  sitetosite::PeerSelector peer_selector_;
+  sitetosite::SiteToSiteClientPool client_pool_;
 
   std::shared_ptr<Configure> configure_;
   // Transaction Direction
@@ -222,11 +273,28 @@ class RemoteProcessorGroupPort : public core::Processor {
 
   sitetosite::CLIENT_TYPE client_type_;
 
+  // compression of the transferred flow files
+  bool use_compression_;
+  int compression_level_;
+  uint64_t compression_threshold_;
+
+  // milliseconds between refreshes of the peer list
+  uint64_t peer_refresh_interval_;
+  // idle clients kept connected to each peer
+  uint32_t warm_clients_;
+  // send transactions kept in flight by each trigger, across as many clients
+  uint32_t max_in_flight_transactions_;
+  // runs the transactions of a trigger besides the one run by the triggering thread
+  std::unique_ptr<utils::ThreadPool<bool>> transaction_pool_;
+  bool maintaining_;
+  // whether a trigger found no peers, guarded by maintenance_mutex_
+  bool refresh_requested_;
+  std::mutex maintenance_mutex_;
+  std::condition_variable maintenance_condition_;
+  std::thread maintenance_thread_;
+
   // Remote Site2Site Info
   bool site2site_secure_;
-  std::vector<sitetosite::PeerStatus> peers_;
-  std::atomic<int> peer_index_;
-  std::mutex peer_mutex_;
   std::string rest_user_name_;
   std::string rest_password_;
 
@@ -84,6 +84,14 @@ class ResourceClaim : public std::enable_shared_from_this<ResourceClaim> {
   void setContentFullPath(std::string path) {
     _contentFullPath = path;
   }
+  // Get the offset of the content within the content file, non zero when the file is shared with other claims
+  uint64_t getOffset() const {
+    return offset_;
+  }
+  // Set the offset of the content within the content file
+  void setOffset(uint64_t offset) {
+    offset_ = offset;
+  }
 
   void deleteClaim() {
     if (!deleted_) {
@@ -112,6 +120,8 @@ class ResourceClaim : public std::enable_shared_from_this<ResourceClaim> {
   std::atomic<bool> deleted_;
   // Full path to the content
   std::string _contentFullPath;
+  // Offset of the content within _contentFullPath
+  uint64_t offset_;
 
   std::shared_ptr<core::StreamManager<ResourceClaim>> claim_manager_;
 
@@ -27,6 +27,7 @@
 #include <atomic>
 #include <algorithm>
 #include <thread>
+#include "utils/StringUtils.h"
 #include "utils/TimeUtil.h"
 #include "utils/ThreadPool.h"
 #include "utils/BackTrace.h"
@@ -129,7 +130,12 @@ class SchedulingAgent {
      * to be able to debug why an agent doesn't work and still allow a restart via updates in these cases.
      */
     auto csThreads = configure_->getInt(Configure::nifi_flow_engine_threads, 2);
-    auto pool = utils::ThreadPool<uint64_t>(csThreads, false, controller_service_provider, "SchedulingAgent");
+    bool work_stealing = false;
+    std::string work_stealing_value;
+    if (configure_->get(Configure::nifi_flow_engine_work_stealing, work_stealing_value)) {
+      utils::StringUtils::StringToBool(work_stealing_value, work_stealing);
+    }
+    auto pool = utils::ThreadPool<uint64_t>(csThreads, false, controller_service_provider, "SchedulingAgent", work_stealing);
     thread_pool_ = std::move(pool);
     thread_pool_.start();
   }
@@ -66,6 +66,12 @@ class ThreadedSchedulingAgent : public SchedulingAgent {
   virtual void stop();
 
  protected:
+  /**
+   * Submits the tasks that run a processor to the thread pool once the processor has been scheduled.
+   * By default each of the processor's concurrent tasks runs it until the processor is unscheduled.
+   */
+  virtual void submitTasks(const std::shared_ptr<core::Processor> &processor, const std::shared_ptr<core::ProcessContext> &processContext,
+                           const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory);
 
  private:
   // Prevent default copy constructor and assignment operation
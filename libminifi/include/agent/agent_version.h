@@ -0,0 +1,40 @@
+#ifndef AGENT_BUILD_H
+#define AGENT_BUILD_H
+
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+
+class AgentBuild {
+ public:
+  static constexpr const char* VERSION = "0.7.0";
+  static constexpr const char* BUILD_IDENTIFIER = "2DrAB0hYvXUF4IbPGML9VSqT";
+  static constexpr const char* BUILD_REV = "";
+  static constexpr const char* BUILD_DATE = "1792320909";
+  static constexpr const char* COMPILER = "/usr/bin/c++";
+  static constexpr const char* COMPILER_VERSION = "12.2.0";
+  static constexpr const char* COMPILER_FLAGS = " -std=c++11 -DOPENSSL_SUPPORT";
+  static std::vector<std::string> getExtensions() {
+  	static std::vector<std::string> extensions;
+  	if (extensions.empty()){
+      extensions.push_back("minifi-standard-processors");
+      extensions.push_back("minifi-http-curl");
+      extensions.push_back("minifi-civet-extensions");
+      extensions.push_back("minifi-rocksdb-repos");
+      extensions.push_back("minifi-archive-extensions");
+      extensions.push_back("minifi-script-extensions");
+      extensions.push_back("minifi-system");
+    }
+  	return extensions;
+  }
+};
+
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* AGENT_BUILD_H */
@@ -20,6 +20,8 @@
 #define LIBMINIFI_INCLUDE_CORE_CONNECTABLE_H_
 
 #include <set>
+#include <functional>
+#include <memory>
 #include "Core.h"
 #include <condition_variable>
 #include "core/logging/Logger.h"
@@ -74,8 +76,8 @@ class Connectable : public CoreComponent {
    */
   std::set<std::shared_ptr<Connectable>> getOutGoingConnections(const std::string &relationship) const;
 
-  void put(std::shared_ptr<Connectable> flow) {
-
+  // Puts a flow file into this connectable. Connections override it to queue the flow file
+  virtual void put(std::shared_ptr<Connectable> flow) {
   }
 
   /**
@@ -121,6 +123,13 @@ class Connectable : public CoreComponent {
 
   void notifyWork();
 
+  /**
+   * Sets the function that notifyWork calls in place of waking a thread blocked in waitForWork,
+   * so that an event driven connectable can be triggered without a thread waiting for its work.
+   * @param notifier function to call, or nullptr to wake waiting threads again
+   */
+  void setWorkNotifier(const std::function<void()> &notifier);
+
   /**
    * Determines if work is available by this connectable
    * @return boolean if work is available.
@@ -184,6 +193,8 @@ class Connectable : public CoreComponent {
   std::atomic<SchedulingStrategy> strategy_;
   // Concurrent condition variable for whether there is incoming work to do
   std::condition_variable work_condition_;
+  // Called in place of work_condition_ when set, guarded by work_available_mutex_
+  std::shared_ptr<std::function<void()>> work_notifier_;
   // version under which this connectable was created.
   std::shared_ptr<state::FlowIdentifier> connectable_version_;
 
@@ -55,6 +55,51 @@ class ContentRepository : public StreamManager<minifi::ResourceClaim> {
    */
   virtual void stop() = 0;
 
+  using StreamManager<minifi::ResourceClaim>::read;
+
+  /**
+   * Creates a read stream over length bytes of the claim starting at offset.
+   * Repositories that store several claims in one file bound the stream to
+   * that range so that readers cannot see the content of other claims.
+   */
+  virtual std::shared_ptr<io::BaseStream> read(const std::shared_ptr<minifi::ResourceClaim> &claim, uint64_t offset, uint64_t length) {
+    std::shared_ptr<io::BaseStream> stream = read(claim);
+    if (nullptr != stream) {
+      stream->seek(offset);
+    }
+    return stream;
+  }
+
+  /**
+   * Returns whether content may be appended to the claim in place. Claims that
+   * share their file with other claims must be copied into a new claim instead.
+   */
+  virtual bool isAppendable(const std::shared_ptr<minifi::ResourceClaim> &claim) {
+    return true;
+  }
+
+  /**
+   * Imports the file at path, starting at offset, as the content of the claim without
+   * streaming it through the process. When move is set the file is no longer needed and
+   * may be moved into the repository.
+   * @param size set to the number of bytes imported
+   * @return false if the repository cannot import files directly, in which case the
+   * content must be written through a stream
+   */
+  virtual bool importFile(const std::string &path, uint64_t offset, bool move, const std::shared_ptr<minifi::ResourceClaim> &claim, uint64_t &size) {
+    return false;
+  }
+
+  /**
+   * Exports length bytes of the claim starting at offset to the file at path without
+   * streaming them through the process.
+   * @return false if the repository cannot export files directly, in which case the
+   * content must be read through a stream
+   */
+  virtual bool exportFile(const std::shared_ptr<minifi::ResourceClaim> &claim, uint64_t offset, uint64_t length, const std::string &path) {
+    return false;
+  }
+
   /**
    * Removes an item if it was orphan
    */
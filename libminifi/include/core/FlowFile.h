@@ -19,6 +19,7 @@
 #define RECORD_H
 
 #include "utils/TimeUtil.h"
+#include "FlowFileAttributes.h"
 #include "ResourceClaim.h"
 #include "Connectable.h"
 #include "WeakReference.h"
@@ -151,23 +152,44 @@ class FlowFile : public core::Connectable, public ReferenceContainer {
    * setAttribute, if attribute already there, update it, else, add it
    */
   void setAttribute(const std::string &key, const std::string &value) {
-    attributes_[key] = value;
+    attributes_.set(key, value);
   }
 
   /**
-   * Returns the map of attributes
+   * Returns a copy of the attributes as a map. Prefer getAttributeStore
+   * to read the attributes without copying them.
    * @return attributes.
    */
   std::map<std::string, std::string> getAttributes() {
+    return attributes_.toMap();
+  }
+
+  /**
+   * Replaces the attributes
+   * @param attributes new attributes
+   */
+  void setAttributes(const std::map<std::string, std::string> &attributes) {
+    attributes_ = FlowFileAttributes(attributes);
+  }
+
+  /**
+   * Returns the attribute store, which may be iterated and copied without
+   * copying the attributes.
+   * @return attribute store.
+   */
+  const FlowFileAttributes &getAttributeStore() const {
     return attributes_;
   }
 
   /**
-   * Returns the map of attributes
-   * @return attributes.
+   * Takes the attributes of a parent flow file, keeping the excluded attributes
+   * and those the parent does not have. The attributes are shared with the parent
+   * until either is modified.
+   * @param parent parent flow file
+   * @param excluded attributes not taken from the parent
    */
-  std::map<std::string, std::string> *getAttributesPtr() {
-    return &attributes_;
+  void inheritAttributes(const FlowFile &parent, const std::vector<std::string> &excluded) {
+    attributes_.inherit(parent.attributes_, excluded);
   }
 
   /**
@@ -308,7 +330,7 @@ class FlowFile : public core::Connectable, public ReferenceContainer {
   // Penalty expiration
   uint64_t penaltyExpiration_ms_;
   // Attributes key/values pairs for the flow record
-  std::map<std::string, std::string> attributes_;
+  FlowFileAttributes attributes_;
   // Pointer to the associated content resource claim
   std::shared_ptr<ResourceClaim> claim_;
   // Pointers to stashed content resource claims
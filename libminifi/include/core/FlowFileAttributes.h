@@ -0,0 +1,181 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_FLOWFILEATTRIBUTES_H_
+#define LIBMINIFI_INCLUDE_CORE_FLOWFILEATTRIBUTES_H_
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * An attribute key interned by the AttributeKeyRegistry. Interned keys are never released,
+ * so they may be compared by address. Keys the registry has no room for are owned by the
+ * attributes using them and are only equal by name.
+ */
+struct AttributeKey {
+  // id of keys that are not interned
+  static constexpr uint32_t Uninterned = std::numeric_limits<uint32_t>::max();
+
+  // small integer identifying the key within this process
+  uint32_t id;
+  std::string name;
+};
+
+/**
+ * Purpose: Interns attribute keys, so that the handful of keys used by a flow are
+ * stored once rather than in every flow file.
+ *
+ * Design: Interned keys are never released, so the registry stops interning once it holds
+ * MaxKeys keys. This bounds its memory when a flow derives attribute names from data.
+ */
+class AttributeKeyRegistry {
+ public:
+  static constexpr size_t MaxKeys = 4096;
+
+  explicit AttributeKeyRegistry(size_t max_keys = MaxKeys)
+      : max_keys_(max_keys) {
+  }
+
+  static AttributeKeyRegistry &getInstance();
+
+  // Returns the interned key, interning it when first seen, or nullptr if the registry is full
+  const AttributeKey *intern(const std::string &name);
+
+  // Returns the interned key, or nullptr if the key was never interned
+  const AttributeKey *find(const std::string &name) const;
+
+  // Returns the key with the given id, or nullptr
+  const AttributeKey *get(uint32_t id) const;
+
+  // Returns the number of interned keys
+  size_t size() const;
+
+  AttributeKeyRegistry(const AttributeKeyRegistry &other) = delete;
+  AttributeKeyRegistry &operator=(const AttributeKeyRegistry &other) = delete;
+
+ private:
+  const size_t max_keys_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::unique_ptr<AttributeKey>> keys_;
+  std::vector<const AttributeKey*> ids_;
+};
+
+/**
+ * Purpose: Attributes of a flow file.
+ *
+ * Design: Attributes are kept in a flat vector of interned keys and values, which is cheaper
+ * to search and copy than a map for the few attributes a flow file usually has. Copies share
+ * the vector until one of them is modified, so cloned and child flow files, and the records
+ * persisting them, do not copy their attributes. Like the map it replaces, a store is not
+ * synchronized; the shared vector is never modified, so copies may be used by other threads.
+ */
+class FlowFileAttributes {
+ public:
+  struct Entry {
+    const AttributeKey *key;
+    std::string value;
+    // owns the key when the registry had no room to intern it
+    std::shared_ptr<const AttributeKey> owned_key;
+  };
+
+  typedef std::vector<Entry>::const_iterator const_iterator;
+
+  FlowFileAttributes() = default;
+
+  explicit FlowFileAttributes(const std::map<std::string, std::string> &attributes);
+
+  // Returns the value of the attribute, or nullptr if it is not set
+  const std::string *find(const std::string &key) const;
+
+  // Returns the value of the attribute with the interned key, or nullptr if it is not set
+  const std::string *find(const AttributeKey *key) const;
+
+  bool get(const std::string &key, std::string &value) const;
+
+  // Sets the attribute, adding it if it is not set
+  void set(const std::string &key, const std::string &value);
+
+  // Sets the attribute only if it is not set
+  bool add(const std::string &key, const std::string &value);
+
+  // Sets the attribute only if it is set
+  bool update(const std::string &key, const std::string &value);
+
+  bool remove(const std::string &key);
+
+  /**
+   * Replaces these attributes with the attributes of a parent, keeping the attributes
+   * that are excluded or that the parent does not have.
+   */
+  void inherit(const FlowFileAttributes &parent, const std::vector<std::string> &excluded);
+
+  size_t size() const {
+    return entries_ ? entries_->size() : 0;
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  const_iterator begin() const {
+    return entries_ ? entries_->cbegin() : empty_entries_.cbegin();
+  }
+
+  const_iterator end() const {
+    return entries_ ? entries_->cend() : empty_entries_.cend();
+  }
+
+  // Returns true if the attributes are shared with a copy
+  bool isShared() const {
+    return entries_ && entries_.use_count() > 1;
+  }
+
+  std::map<std::string, std::string> toMap() const;
+
+ private:
+  // Returns the entries, copying them first if they are shared
+  std::vector<Entry> &mutate();
+
+  Entry *findEntry(const std::string &key);
+
+  static Entry createEntry(const std::string &key, const std::string &value);
+
+  static const std::vector<Entry> empty_entries_;
+
+  std::shared_ptr<std::vector<Entry>> entries_;
+};
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_CORE_FLOWFILEATTRIBUTES_H_ */
@@ -0,0 +1,135 @@
+/**
+ * @file FlowFilePrioritizer.h
+ * FlowFilePrioritizer class declaration
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_FLOWFILEPRIORITIZER_H_
+#define LIBMINIFI_INCLUDE_CORE_FLOWFILEPRIORITIZER_H_
+
+#include <memory>
+#include <string>
+#include "core/FlowFile.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * Purpose: Determines the order in which queued flow files are handed out by a connection.
+ *
+ * Design: Mirrors the prioritizers available in NiFi. Prioritizers are applied in the order
+ * they are configured, each subsequent prioritizer only breaking ties left by the previous
+ * ones. Flow files that all prioritizers consider equal are handed out first in, first out.
+ */
+class FlowFilePrioritizer {
+ public:
+
+  virtual ~FlowFilePrioritizer() {
+  }
+
+  /**
+   * Returns the name of this prioritizer, as it would be configured on a connection.
+   */
+  virtual std::string getName() const = 0;
+
+  /**
+   * Compares two queued flow files.
+   * @return a negative value if first should be handed out before second, a positive value
+   * if second should be handed out before first, and zero if this prioritizer has no preference.
+   */
+  virtual int compare(const std::shared_ptr<core::FlowFile> &first, const std::shared_ptr<core::FlowFile> &second) = 0;
+
+  /**
+   * Creates a prioritizer from its configured name.
+   * @param name prioritizer name.
+   * @return prioritizer or nullptr if the name is not recognized.
+   */
+  static std::shared_ptr<FlowFilePrioritizer> create(const std::string &name);
+};
+
+/**
+ * Hands out flow files in the order they were queued. As this is also the tie breaker of
+ * every other prioritizer it never expresses a preference of its own.
+ */
+class FirstInFirstOutPrioritizer : public FlowFilePrioritizer {
+ public:
+  static constexpr const char *Name = "FirstInFirstOutPrioritizer";
+
+  virtual std::string getName() const {
+    return Name;
+  }
+
+  virtual int compare(const std::shared_ptr<core::FlowFile> &first, const std::shared_ptr<core::FlowFile> &second) {
+    return 0;
+  }
+};
+
+/**
+ * Hands out the flow file with the most recent entry date first.
+ */
+class NewestFlowFileFirstPrioritizer : public FlowFilePrioritizer {
+ public:
+  static constexpr const char *Name = "NewestFlowFileFirstPrioritizer";
+
+  virtual std::string getName() const {
+    return Name;
+  }
+
+  virtual int compare(const std::shared_ptr<core::FlowFile> &first, const std::shared_ptr<core::FlowFile> &second);
+};
+
+/**
+ * Hands out the flow file with the oldest entry date first.
+ */
+class OldestFlowFileFirstPrioritizer : public FlowFilePrioritizer {
+ public:
+  static constexpr const char *Name = "OldestFlowFileFirstPrioritizer";
+
+  virtual std::string getName() const {
+    return Name;
+  }
+
+  virtual int compare(const std::shared_ptr<core::FlowFile> &first, const std::shared_ptr<core::FlowFile> &second);
+};
+
+/**
+ * Hands out flow files according to their priority attribute. Numeric priorities come first and
+ * are compared numerically, lower values first, then the other values are compared
+ * lexicographically. Flow files without a priority attribute are handed out after those that
+ * have one.
+ */
+class PriorityAttributePrioritizer : public FlowFilePrioritizer {
+ public:
+  static constexpr const char *Name = "PriorityAttributePrioritizer";
+  static constexpr const char *PriorityAttribute = "priority";
+
+  virtual std::string getName() const {
+    return Name;
+  }
+
+  virtual int compare(const std::shared_ptr<core::FlowFile> &first, const std::shared_ptr<core::FlowFile> &second);
+};
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_CORE_FLOWFILEPRIORITIZER_H_ */
@@ -0,0 +1,184 @@
+/**
+ * @file FlowFileQueue.h
+ * FlowFileQueue class declaration
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_FLOWFILEQUEUE_H_
+#define LIBMINIFI_INCLUDE_CORE_FLOWFILEQUEUE_H_
+
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+#include "concurrentqueue.h"
+#include "core/FlowFile.h"
+#include "core/FlowFilePrioritizer.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * Purpose: Storage for the flow files queued within a Connection.
+ *
+ * Design: Implementations only need to be a thread safe multi-producer, multi-consumer
+ * container. Back pressure accounting, penalization and expiration remain the
+ * responsibility of the Connection, so implementations never need to inspect a flow file
+ * beyond its size.
+ */
+class FlowFileQueue {
+ public:
+
+  virtual ~FlowFileQueue() {
+  }
+
+  /**
+   * Returns the name of this queue type, as it would be configured on a connection.
+   */
+  virtual std::string getName() const = 0;
+
+  /**
+   * Enqueues the flow file.
+   * @param flow flow file to enqueue.
+   */
+  virtual void push(const std::shared_ptr<core::FlowFile> &flow) = 0;
+
+  /**
+   * Dequeues the next flow file.
+   * @param flow the dequeued flow file.
+   * @return true if a flow file was dequeued, false if the queue was empty.
+   */
+  virtual bool tryPop(std::shared_ptr<core::FlowFile> &flow) = 0;
+
+  /**
+   * Dequeues up to max_count flow files, stopping early once the dequeued flow files
+   * reach max_bytes.
+   * @param flows vector to which the dequeued flow files are appended.
+   * @param max_count maximum number of flow files to dequeue.
+   * @param max_bytes byte limit for the dequeued flow files, 0 for no limit.
+   * @return number of flow files dequeued.
+   */
+  virtual size_t tryPopBulk(std::vector<std::shared_ptr<core::FlowFile>> &flows, size_t max_count, uint64_t max_bytes);
+
+  /**
+   * Creates a queue from its configured name.
+   * @param name queue type name. An empty name results in the default, locking, queue.
+   * @return queue or nullptr if the name is not recognized.
+   */
+  static std::unique_ptr<FlowFileQueue> create(const std::string &name);
+};
+
+/**
+ * Default queue implementation: strict FIFO over a std::queue guarded by a mutex.
+ */
+class LockingFlowFileQueue : public FlowFileQueue {
+ public:
+  static constexpr const char *Name = "locking";
+
+  virtual std::string getName() const {
+    return Name;
+  }
+
+  virtual void push(const std::shared_ptr<core::FlowFile> &flow);
+
+  virtual bool tryPop(std::shared_ptr<core::FlowFile> &flow);
+
+  virtual size_t tryPopBulk(std::vector<std::shared_ptr<core::FlowFile>> &flows, size_t max_count, uint64_t max_bytes);
+
+ private:
+  std::mutex mutex_;
+  std::queue<std::shared_ptr<core::FlowFile>> queue_;
+};
+
+/**
+ * Lock free queue implementation backed by moodycamel's ConcurrentQueue.
+ *
+ * Ordering is FIFO per producing thread, but flow files enqueued by different producers
+ * may be interleaved, so this should only be used where strict global ordering is not needed.
+ */
+class ConcurrentFlowFileQueue : public FlowFileQueue {
+ public:
+  static constexpr const char *Name = "concurrent";
+
+  virtual std::string getName() const {
+    return Name;
+  }
+
+  virtual void push(const std::shared_ptr<core::FlowFile> &flow);
+
+  virtual bool tryPop(std::shared_ptr<core::FlowFile> &flow);
+
+ private:
+  moodycamel::ConcurrentQueue<std::shared_ptr<core::FlowFile>> queue_;
+};
+
+/**
+ * Queue implementation that hands out flow files in the order determined by its prioritizers,
+ * backed by a binary heap guarded by a mutex. Flow files the prioritizers consider equal are
+ * handed out in the order they were queued.
+ */
+class PrioritizedFlowFileQueue : public FlowFileQueue {
+ public:
+  static constexpr const char *Name = "prioritized";
+
+  explicit PrioritizedFlowFileQueue(const std::vector<std::shared_ptr<FlowFilePrioritizer>> &prioritizers)
+      : prioritizers_(prioritizers),
+        sequence_(0) {
+  }
+
+  virtual std::string getName() const {
+    return Name;
+  }
+
+  virtual void push(const std::shared_ptr<core::FlowFile> &flow);
+
+  virtual bool tryPop(std::shared_ptr<core::FlowFile> &flow);
+
+  virtual size_t tryPopBulk(std::vector<std::shared_ptr<core::FlowFile>> &flows, size_t max_count, uint64_t max_bytes);
+
+  const std::vector<std::shared_ptr<FlowFilePrioritizer>> &getPrioritizers() const {
+    return prioritizers_;
+  }
+
+ private:
+  struct Entry {
+    std::shared_ptr<core::FlowFile> flow;
+    // insertion order, used to break ties
+    uint64_t sequence;
+  };
+
+  // heap ordering: returns true if first should be handed out after second
+  bool after(const Entry &first, const Entry &second) const;
+
+  void popEntry(std::shared_ptr<core::FlowFile> &flow);
+
+  std::vector<std::shared_ptr<FlowFilePrioritizer>> prioritizers_;
+  std::mutex mutex_;
+  std::vector<Entry> heap_;
+  uint64_t sequence_;
+};
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_CORE_FLOWFILEQUEUE_H_ */
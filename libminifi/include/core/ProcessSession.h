@@ -72,6 +72,13 @@ class ProcessSession : public ReferenceContainer {
   //
   // Get the FlowFile from the highest priority queue
   virtual std::shared_ptr<core::FlowFile> get();
+  /**
+   * Gets a batch of flow files from the incoming connections, polling each connection once.
+   * @param max_count maximum number of flow files to get
+   * @param max_bytes stop once the flow files reach this many bytes, 0 for no limit
+   * @return flow files added to this session
+   */
+  virtual std::vector<std::shared_ptr<core::FlowFile>> get(size_t max_count, uint64_t max_bytes = 0);
   // Create a new UUID FlowFile with no content resource claim and without parent
   std::shared_ptr<core::FlowFile> create();
   // Create a new UUID FlowFile with no content resource claim and inherit all attributes from parent
@@ -153,6 +160,10 @@ class ProcessSession : public ReferenceContainer {
  private:
 // Clone the flow file during transfer to multiple connections for a relationship
   std::shared_ptr<core::FlowFile> cloneDuringTransfer(std::shared_ptr<core::FlowFile> &parent);
+  // Track a flow file polled from an incoming connection as part of this session
+  void addPolledFlowFile(const std::shared_ptr<core::FlowFile> &flow);
+  // Report expired flow files polled from an incoming connection
+  void expireFlowFiles(const std::set<std::shared_ptr<core::FlowFile>> &expired);
   // ProcessContext
   std::shared_ptr<ProcessContext> process_context_;
   // Logger
@@ -128,7 +128,7 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
   }
 
 
-  // Set Processor Run Duration in Nano Second
+  // Set Processor Run Duration in Nano Second, for which each trigger keeps running the processor with one session
   void setRunDurationNano(uint64_t period) {
     run_duration_nano_ = period;
   }
@@ -294,6 +294,13 @@ class Processor : public Connectable, public ConfigurableComponent, public std::
 
  private:
 
+  /**
+   * Returns whether a trigger that started at start should run the processor again within the
+   * same session, which is the case while its run duration lasts and it has incoming flow files
+   * to process.
+   */
+  bool continueTrigger(const std::chrono::steady_clock::time_point &start, uint64_t run_duration_nano);
+
   // Mutex for protection
   std::mutex mutex_;
   // Yield Expiration
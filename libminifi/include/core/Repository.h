@@ -48,6 +48,9 @@ namespace org {
 namespace apache {
 namespace nifi {
 namespace minifi {
+namespace provenance {
+class ProvenancePolicy;
+} /* namespace provenance */
 namespace core {
 
 #define REPOSITORY_DIRECTORY "./repo"
@@ -86,15 +89,47 @@ class Repository : public virtual core::SerializableComponent, public core::Trac
   virtual bool initialize(const std::shared_ptr<Configure> &configure) {
     return true;
   }
+  // Value stored through MultiPut, referring to a buffer owned by the caller
+  struct PutEntry {
+    std::string key;
+    const uint8_t *buf;
+    size_t bufLen;
+  };
+
   // Put
   virtual bool Put(std::string key, const uint8_t *buf, size_t bufLen) {
     return true;
   }
+
+  /**
+   * Stores all entries at once. Repositories that support atomic batches apply them as a
+   * single write, otherwise each entry is stored through Put.
+   * @param entries entries to store, whose buffers only need to remain valid for the duration of the call.
+   * @return true if all entries were stored.
+   */
+  virtual bool MultiPut(const std::vector<PutEntry> &entries) {
+    bool stored = true;
+    for (const auto &entry : entries) {
+      stored &= Put(entry.key, entry.buf, entry.bufLen);
+    }
+    return stored;
+  }
   // Delete
   virtual bool Delete(std::string key) {
     return true;
   }
 
+  /**
+   * Deletes the key of a flow file whose resource claim is known, sparing repositories that
+   * release content on delete from reading the stored value back to find the claim.
+   * @param key key to delete
+   * @param claim resource claim of the deleted flow file, nullptr if it has no content
+   * @return status of the delete operation
+   */
+  virtual bool Delete(const std::string &key, const std::shared_ptr<minifi::ResourceClaim> &claim) {
+    return Delete(key);
+  }
+
   virtual bool Delete(std::vector<std::shared_ptr<core::SerializableComponent>> &storedValues) {
     bool found = true;
     for (auto storedValue : storedValues) {
@@ -136,6 +171,18 @@ class Repository : public virtual core::SerializableComponent, public core::Trac
     return running_;
   }
 
+  /**
+   * Sets the policy deciding which of the provenance events reported to this repository are
+   * stored. Without a policy every event is stored.
+   */
+  void setProvenancePolicy(const std::shared_ptr<provenance::ProvenancePolicy> &policy) {
+    provenance_policy_ = policy;
+  }
+
+  std::shared_ptr<provenance::ProvenancePolicy> getProvenancePolicy() const {
+    return provenance_policy_;
+  }
+
   /**
    * Specialization that allows us to serialize max_size objects into store.
    * the lambdaConstructor will create objects to put into store
@@ -240,6 +287,8 @@ class Repository : public virtual core::SerializableComponent, public core::Trac
 
   // size of the directory
   std::atomic<uint64_t> repo_size_;
+  // policy for the provenance events stored in the repository
+  std::shared_ptr<provenance::ProvenancePolicy> provenance_policy_;
   // Run function for the thread
   void threadExecutor() {
     run();
@@ -0,0 +1,147 @@
+/**
+ * @file SwappingFlowFileQueue.h
+ * SwappingFlowFileQueue class declaration
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_SWAPPINGFLOWFILEQUEUE_H_
+#define LIBMINIFI_INCLUDE_CORE_SWAPPINGFLOWFILEQUEUE_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "core/ContentRepository.h"
+#include "core/FlowFile.h"
+#include "core/FlowFileQueue.h"
+#include "core/Repository.h"
+#include "core/logging/Logger.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+/**
+ * Purpose: Bounds the memory used by deep connection queues, similar to NiFi's swap files.
+ *
+ * Design: Wraps the queue configured on the connection, which holds the head of the queue.
+ * Once it holds swap threshold flow files, subsequently queued flow files are collected in a
+ * tail buffer that is written to a swap file whenever it reaches the swap batch size. When the
+ * head runs empty the oldest swap file is read back in a single pass, followed by the tail once
+ * no swap files remain. Only the head and the tail, at most swap threshold plus swap batch size
+ * flow files, are kept in memory.
+ *
+ * Swapped flow files remain in the flow file repository, so swap files are discarded rather
+ * than recovered on restart. The swap files a previous run left behind are removed once the
+ * first queue of a swap directory is created. Ordering across the swap boundary is first in, first out
+ * regardless of the prioritizers of the wrapped queue.
+ */
+class SwappingFlowFileQueue : public FlowFileQueue {
+ public:
+  static constexpr const char *SwapFileExtension = ".swap";
+
+  /**
+   * @param queue queue holding the flow files kept in memory.
+   * @param swap_threshold number of flow files held by queue before swapping begins.
+   * @param directory directory in which swap files are created.
+   * @param prefix prefix, unique to the owning connection, for the swap file names.
+   */
+  SwappingFlowFileQueue(std::unique_ptr<FlowFileQueue> queue, uint64_t swap_threshold, const std::string &directory, const std::string &prefix,
+                        const std::shared_ptr<core::Repository> &flow_repository, const std::shared_ptr<core::ContentRepository> &content_repo);
+
+  virtual ~SwappingFlowFileQueue();
+
+  virtual std::string getName() const {
+    return queue_->getName();
+  }
+
+  virtual void push(const std::shared_ptr<core::FlowFile> &flow);
+
+  virtual bool tryPop(std::shared_ptr<core::FlowFile> &flow);
+
+  virtual size_t tryPopBulk(std::vector<std::shared_ptr<core::FlowFile>> &flows, size_t max_count, uint64_t max_bytes);
+
+  // Number of flow files currently held in swap files
+  uint64_t getSwappedCount() {
+    return swapped_count_;
+  }
+
+  // Number of swap files currently in use
+  size_t getSwapFileCount();
+
+ private:
+  // Swap file along with the flow files kept in memory for it
+  struct SwapFile {
+    std::string path;
+    uint64_t count;
+    // the whole batch until the file is written, afterwards the flow files that could not be written to it
+    std::vector<std::shared_ptr<core::FlowFile>> flows;
+    // set once the file was written, or could not be
+    bool written;
+    // set when the batch was swapped in before its file was written
+    bool swapped_in;
+  };
+
+  // Queues the tail as a new swap file, which the caller writes once it released mutex_. Requires mutex_
+  std::shared_ptr<SwapFile> takeTail();
+  // Writes the batch of a swap file taken from the tail. Must not hold mutex_
+  void swapOut(const std::shared_ptr<SwapFile> &swap_file);
+  // Moves the oldest swap file, or the tail if there are none, into the head. Requires mutex_
+  bool swapIn();
+  // Reads the flow files of a swap file into the head and removes the file
+  uint64_t readSwapFile(const SwapFile &swap_file);
+  // Removes the swap files of a previous run from the directory, once per directory and process
+  void removeStaleSwapFiles();
+
+  std::unique_ptr<FlowFileQueue> queue_;
+  uint64_t swap_threshold_;
+  uint64_t swap_batch_size_;
+  std::string directory_;
+  std::string prefix_;
+  std::shared_ptr<core::Repository> flow_repository_;
+  std::shared_ptr<core::ContentRepository> content_repo_;
+
+  // Number of flow files held in queue_
+  std::atomic<uint64_t> head_count_;
+  // Set while flow files are held in the tail or in swap files
+  std::atomic<bool> swapping_;
+  // Number of flow files held in swap files
+  std::atomic<uint64_t> swapped_count_;
+
+  // Guards the decision between head and tail, tail_, swap_files_ and swap_sequence_
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<core::FlowFile>> tail_;
+  std::deque<std::shared_ptr<SwapFile>> swap_files_;
+  uint64_t swap_sequence_;
+
+  std::shared_ptr<logging::Logger> logger_;
+
+  static std::mutex cleaned_directories_mutex_;
+  static std::set<std::string> cleaned_directories_;
+};
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_CORE_SWAPPINGFLOWFILEQUEUE_H_ */
@@ -0,0 +1,113 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_CORE_LOGGING_ASYNCLOGQUEUE_H_
+#define LIBMINIFI_INCLUDE_CORE_LOGGING_ASYNCLOGQUEUE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "spdlog/spdlog.h"
+#include "spdlog/details/mpmc_bounded_q.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+namespace logging {
+
+/**
+ * Purpose: Decouples logging threads from the log sinks.
+ *
+ * Formatted messages are put into a lock free ring buffer and a single background
+ * thread writes them to the spdlog loggers they were logged to, in order. When the
+ * ring buffer is full, messages are either dropped or the logging thread waits
+ * for room, depending on the overflow policy.
+ */
+class AsyncLogQueue {
+ public:
+  enum class OverflowPolicy {
+    DROP,
+    BLOCK
+  };
+
+  /**
+   * @param capacity number of messages the ring buffer holds, rounded up to a power of two
+   */
+  AsyncLogQueue(size_t capacity, OverflowPolicy policy);
+
+  ~AsyncLogQueue();
+
+  /**
+   * Queues message for logger. The message is moved from only when it is queued.
+   * @return false if the message could not be queued, in which case the caller logs it
+   * synchronously, or it was dropped
+   */
+  bool push(spdlog::logger *logger, spdlog::level::level_enum level, std::string &message);
+
+  /**
+   * Stops the background thread once it has written every queued message.
+   */
+  void stop();
+
+  /**
+   * Returns the number of messages dropped as the ring buffer was full.
+   */
+  uint64_t getDroppedCount() const {
+    return dropped_;
+  }
+
+  static OverflowPolicy parsePolicy(const std::string &policy);
+
+ private:
+  struct Record {
+    Record()
+        : logger(nullptr),
+          level(spdlog::level::off) {
+    }
+    spdlog::logger *logger;
+    spdlog::level::level_enum level;
+    std::string message;
+  };
+
+  static size_t roundCapacity(size_t capacity);
+
+  void run();
+
+  OverflowPolicy policy_;
+  spdlog::details::mpmc_bounded_queue<Record> queue_;
+  std::atomic<bool> running_;
+  std::atomic<uint64_t> dropped_;
+  // set while the background thread waits for messages
+  std::atomic<bool> waiting_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::thread thread_;
+};
+
+} /* namespace logging */
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_CORE_LOGGING_ASYNCLOGQUEUE_H_ */
@@ -18,10 +18,13 @@
 #ifndef __LOGGER_H__
 #define __LOGGER_H__
 
+#include <atomic>
 #include <mutex>
 #include <memory>
 #include <sstream>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "spdlog/spdlog.h"
 
@@ -34,6 +37,16 @@ namespace logging {
 
 #define LOG_BUFFER_SIZE 1024
 
+/**
+ * Lowest LOG_LEVEL compiled in. Statements below it, such as debug and trace
+ * statements in a build with -DMINIFI_LOG_MIN_LEVEL=2, compile to nothing.
+ */
+#ifndef MINIFI_LOG_MIN_LEVEL
+#define MINIFI_LOG_MIN_LEVEL 0
+#endif
+
+class AsyncLogQueue;
+
 class LoggerControl {
  public:
   LoggerControl()
@@ -99,6 +112,7 @@ class BaseLogger {
 /**
  * LogBuilder is a class to facilitate using the LOG macros below and an associated put-to operator.
  *
+ * The stream is only created when the level is enabled.
  */
 class LogBuilder {
  public:
@@ -108,6 +122,8 @@ class LogBuilder {
         level(level) {
     if (!l->should_log(level)) {
       setIgnore();
+    } else {
+      str.reset(new std::stringstream());
     }
   }
 
@@ -121,22 +137,33 @@ class LogBuilder {
   }
 
   void log_string(LOG_LEVEL level) {
-    ptr->log_string(level, str.str());
+    ptr->log_string(level, str->str());
   }
 
   template<typename T>
   LogBuilder &operator<<(const T &o) {
     if (!ignore)
-      str << o;
+      *str << o;
     return *this;
   }
 
   bool ignore;
   BaseLogger *ptr;
-  std::stringstream str;
+  std::unique_ptr<std::stringstream> str;
   LOG_LEVEL level;
 };
 
+/**
+ * Stands in for LogBuilder for levels below MINIFI_LOG_MIN_LEVEL.
+ */
+class NullLogBuilder {
+ public:
+  template<typename T>
+  NullLogBuilder &operator<<(const T &o) {
+    return *this;
+  }
+};
+
 class Logger : public BaseLogger {
  public:
   /**
@@ -146,7 +173,9 @@ class Logger : public BaseLogger {
    */
   template<typename ... Args>
   void log_error(const char * const format, const Args& ... args) {
+#if MINIFI_LOG_MIN_LEVEL <= 4
     log(spdlog::level::err, format, args...);
+#endif
   }
 
   /**
@@ -156,7 +185,9 @@ class Logger : public BaseLogger {
    */
   template<typename ... Args>
   void log_warn(const char * const format, const Args& ... args) {
+#if MINIFI_LOG_MIN_LEVEL <= 3
     log(spdlog::level::warn, format, args...);
+#endif
   }
 
   /**
@@ -166,7 +197,9 @@ class Logger : public BaseLogger {
    */
   template<typename ... Args>
   void log_info(const char * const format, const Args& ... args) {
+#if MINIFI_LOG_MIN_LEVEL <= 2
     log(spdlog::level::info, format, args...);
+#endif
   }
 
   /**
@@ -176,7 +209,9 @@ class Logger : public BaseLogger {
    */
   template<typename ... Args>
   void log_debug(const char * const format, const Args& ... args) {
+#if MINIFI_LOG_MIN_LEVEL <= 1
     log(spdlog::level::debug, format, args...);
+#endif
   }
 
   /**
@@ -186,11 +221,13 @@ class Logger : public BaseLogger {
    */
   template<typename ... Args>
   void log_trace(const char * const format, const Args& ... args) {
+#if MINIFI_LOG_MIN_LEVEL <= 0
     log(spdlog::level::trace, format, args...);
+#endif
   }
 
   bool should_log(const LOG_LEVEL &level) {
-    if (controller_ && !controller_->is_enabled())
+    if (level < MINIFI_LOG_MIN_LEVEL)
       return false;
     spdlog::level::level_enum logger_level = spdlog::level::level_enum::info;
     switch (level) {
@@ -215,12 +252,7 @@ class Logger : public BaseLogger {
         logger_level = spdlog::level::level_enum::warn;
         break;
     }
-
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!delegate_->should_log(logger_level)) {
-      return false;
-    }
-    return true;
+    return enabled(logger_level);
   }
 
  protected:
@@ -250,13 +282,50 @@ class Logger : public BaseLogger {
     }
   }
   Logger(std::shared_ptr<spdlog::logger> delegate, std::shared_ptr<LoggerControl> controller)
-      : delegate_(delegate), controller_(controller) {
+      : delegate_(delegate),
+        controller_(controller),
+        current_delegate_(delegate.get()),
+        queue_(nullptr) {
   }
 
   Logger(std::shared_ptr<spdlog::logger> delegate)
-        : delegate_(delegate), controller_(nullptr) {
-    }
+      : delegate_(delegate),
+        controller_(nullptr),
+        current_delegate_(delegate.get()),
+        queue_(nullptr) {
+  }
 
+  /**
+   * Replaces the spdlog logger. The replaced logger is kept alive as level checks
+   * and queued messages may still refer to it.
+   */
+  void set_delegate(std::shared_ptr<spdlog::logger> delegate) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    retired_delegates_.push_back(delegate_);
+    delegate_ = delegate;
+    current_delegate_ = delegate.get();
+  }
+
+  /**
+   * Sets the queue messages are written through, nullptr to write them synchronously.
+   */
+  void set_queue(AsyncLogQueue *queue) {
+    queue_ = queue;
+  }
+
+  /**
+   * Checks the level without locking, so disabled statements cost an atomic load or two.
+   */
+  bool enabled(spdlog::level::level_enum level) const {
+    if (controller_ && !controller_->is_enabled())
+      return false;
+    return current_delegate_.load(std::memory_order_acquire)->should_log(level);
+  }
+
+  /**
+   * Writes a formatted message through the queue, or synchronously without one.
+   */
+  void write(spdlog::level::level_enum level, std::string &str);
 
   std::shared_ptr<spdlog::logger> delegate_;
   std::shared_ptr<LoggerControl> controller_;
@@ -265,29 +334,50 @@ class Logger : public BaseLogger {
  private:
   template<typename ... Args>
   inline void log(spdlog::level::level_enum level, const char * const format, const Args& ... args) {
-    if (controller_ && !controller_->is_enabled())
-         return;
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!delegate_->should_log(level)) {
+    if (!enabled(level)) {
       return;
     }
-    const auto str = format_string(format, conditional_conversion(args)...);
-    delegate_->log(level, str);
+    auto str = format_string(format, conditional_conversion(args)...);
+    write(level, str);
   }
 
+  std::atomic<spdlog::logger*> current_delegate_;
+  std::vector<std::shared_ptr<spdlog::logger>> retired_delegates_;
+  std::atomic<AsyncLogQueue*> queue_;
+
   Logger(Logger const&);
   Logger& operator=(Logger const&);
 };
 
+#if MINIFI_LOG_MIN_LEVEL <= 1
 #define LOG_DEBUG(x) LogBuilder(x.get(),logging::LOG_LEVEL::debug)
+#else
+#define LOG_DEBUG(x) NullLogBuilder()
+#endif
 
+#if MINIFI_LOG_MIN_LEVEL <= 2
 #define LOG_INFO(x) LogBuilder(x.get(),logging::LOG_LEVEL::info)
+#else
+#define LOG_INFO(x) NullLogBuilder()
+#endif
 
+#if MINIFI_LOG_MIN_LEVEL <= 0
 #define LOG_TRACE(x) LogBuilder(x.get(),logging::LOG_LEVEL::trace)
+#else
+#define LOG_TRACE(x) NullLogBuilder()
+#endif
 
+#if MINIFI_LOG_MIN_LEVEL <= 4
 #define LOG_ERROR(x) LogBuilder(x.get(),logging::LOG_LEVEL::err)
+#else
+#define LOG_ERROR(x) NullLogBuilder()
+#endif
 
+#if MINIFI_LOG_MIN_LEVEL <= 3
 #define LOG_WARN(x) LogBuilder(x.get(),logging::LOG_LEVEL::warn)
+#else
+#define LOG_WARN(x) NullLogBuilder()
+#endif
 
 } /* namespace logging */
 } /* namespace core */
@@ -28,6 +28,7 @@
 #include "spdlog/formatter.h"
 
 #include "core/Core.h"
+#include "core/logging/AsyncLogQueue.h"
 #include "core/logging/Logger.h"
 #include "properties/Properties.h"
 
@@ -122,21 +123,24 @@ class LoggerConfiguration {
         : Logger(delegate,controller),
           name(name) {
     }
-    void set_delegate(std::shared_ptr<spdlog::logger> delegate) {
-      std::lock_guard<std::mutex> lock(mutex_);
-      delegate_ = delegate;
-    }
+    using Logger::set_delegate;
+    using Logger::set_queue;
     const std::string name;
 
   };
 
   LoggerConfiguration();
+  ~LoggerConfiguration();
   std::shared_ptr<internal::LoggerNamespace> root_namespace_;
   std::vector<std::shared_ptr<LoggerImpl>> loggers;
   std::shared_ptr<spdlog::formatter> formatter_;
   std::mutex mutex;
   std::shared_ptr<LoggerImpl> logger_ = nullptr;
   std::shared_ptr<LoggerControl> controller_;
+  // queue loggers write through when logging asynchronously
+  std::shared_ptr<AsyncLogQueue> queue_;
+  // stopped queues, kept as loggers may still be pushing to them
+  std::vector<std::shared_ptr<AsyncLogQueue>> stopped_queues_;
 };
 
 template<typename T>
@@ -18,6 +18,11 @@
 #ifndef LIBMINIFI_INCLUDE_CORE_REPOSITORY_FileSystemRepository_H_
 #define LIBMINIFI_INCLUDE_CORE_REPOSITORY_FileSystemRepository_H_
 
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
 #include "core/Core.h"
 #include "../ContentRepository.h"
 #include "properties/Configure.h"
@@ -31,11 +36,27 @@ namespace repository {
 
 /**
  * FileSystemRepository is a content repository that stores data onto the local file system.
+ *
+ * By default each claim is a file of its own. When nifi.content.claim.max.appendable.size is
+ * set, claims are instead appended to shared container files, similar to NiFi's resource claims.
+ * A container accepts new claims until it reaches the max appendable size or holds
+ * nifi.content.claim.max.flow.files claims, after which a new container is started. A claim's
+ * path is its container and its offset is where its content starts within the container.
+ * Claim counts are kept per container, which is removed once no claims reference it and it
+ * no longer accepts new claims.
+ *
+ * Files are imported and exported with kernel side copies where available, and files that
+ * are not kept by their importer are renamed into the repository when it is on the same
+ * file system. Imports into containers are always streamed.
  */
 class FileSystemRepository : public core::ContentRepository, public core::CoreComponent {
  public:
+  static constexpr uint32_t DefaultMaxFlowFilesPerClaim = 100;
+
   FileSystemRepository(std::string name = getClassName<FileSystemRepository>())
       : core::CoreComponent(name),
+        max_appendable_size_(0),
+        max_flow_files_per_claim_(DefaultMaxFlowFilesPerClaim),
         logger_(logging::LoggerFactory<FileSystemRepository>::getLogger()) {
 
   }
@@ -53,13 +74,56 @@ class FileSystemRepository : public core::ContentRepository, public core::CoreCo
 
   virtual std::shared_ptr<io::BaseStream> read(const std::shared_ptr<minifi::ResourceClaim> &claim);
 
+  virtual std::shared_ptr<io::BaseStream> read(const std::shared_ptr<minifi::ResourceClaim> &claim, uint64_t offset, uint64_t length);
+
+  virtual bool isAppendable(const std::shared_ptr<minifi::ResourceClaim> &claim) {
+    return max_appendable_size_ == 0;
+  }
+
+  virtual bool importFile(const std::string &path, uint64_t offset, bool move, const std::shared_ptr<minifi::ResourceClaim> &claim, uint64_t &size);
+
+  virtual bool exportFile(const std::shared_ptr<minifi::ResourceClaim> &claim, uint64_t offset, uint64_t length, const std::string &path);
+
   virtual bool close(const std::shared_ptr<minifi::ResourceClaim> &claim) {
     return remove(claim);
   }
 
+  /**
+   * Removes the content of the claim. A container is only removed once no claims reference it
+   * and it no longer accepts new claims.
+   */
   virtual bool remove(const std::shared_ptr<minifi::ResourceClaim> &claim);
 
+  virtual bool removeIfOrphaned(const std::shared_ptr<minifi::ResourceClaim> &claim);
+
+  // Returns whether claims are appended to shared container files
+  bool isUsingContainers() const {
+    return max_appendable_size_ > 0;
+  }
+
  private:
+  // Container file accepting new claims
+  struct Container {
+    std::string path;
+    uint64_t length;
+    uint32_t claims;
+  };
+
+  // Returns a container that has been written by the stream of a claim
+  void releaseContainer(const Container &container);
+  // Removes a container that no longer accepts claims if no claims reference it
+  bool removeIfUnclaimed(const std::string &path);
+
+  // Containers larger than this no longer accept claims, 0 disables containers
+  uint64_t max_appendable_size_;
+  uint32_t max_flow_files_per_claim_;
+
+  // Guards writable_containers_ and active_containers_
+  std::mutex container_mutex_;
+  // Containers that are not being written and accept claims
+  std::deque<Container> writable_containers_;
+  // Containers that are being written or accept claims, these are never removed
+  std::set<std::string> active_containers_;
 
   std::shared_ptr<logging::Logger> logger_;
 };
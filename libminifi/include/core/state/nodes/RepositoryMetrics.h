@@ -23,6 +23,7 @@
 
 #include "../nodes/MetricsBase.h"
 #include "Connection.h"
+#include "provenance/ProvenancePolicy.h"
 namespace org {
 namespace apache {
 namespace nifi {
@@ -82,12 +83,51 @@ class RepositoryMetrics : public ResponseNode {
       parent.children.push_back(datasizemax);
       parent.children.push_back(queuesize);
 
+      auto policy = repo->getProvenancePolicy();
+      if (nullptr != policy) {
+        parent.children.push_back(serializeProvenanceCounters(policy));
+      }
+
       serialized.push_back(parent);
     }
     return serialized;
   }
 
  protected:
+
+  // Event counts per component and event type of a repository storing provenance selectively
+  SerializedResponseNode serializeProvenanceCounters(const std::shared_ptr<provenance::ProvenancePolicy> &policy) {
+    SerializedResponseNode provenance;
+    provenance.name = "provenance";
+    for (const auto &component : policy->getCounters()) {
+      SerializedResponseNode componentNode;
+      componentNode.name = component.first;
+      for (const auto &type : component.second) {
+        SerializedResponseNode typeNode;
+        typeNode.name = provenance::ProvenanceEventRecord::ProvenanceEventTypeStr[type.first];
+
+        SerializedResponseNode events;
+        events.name = "events";
+        events.value = type.second.events;
+
+        SerializedResponseNode stored;
+        stored.name = "stored";
+        stored.value = type.second.stored;
+
+        SerializedResponseNode aggregated;
+        aggregated.name = "aggregated";
+        aggregated.value = type.second.aggregated;
+
+        typeNode.children.push_back(events);
+        typeNode.children.push_back(stored);
+        typeNode.children.push_back(aggregated);
+        componentNode.children.push_back(typeNode);
+      }
+      provenance.children.push_back(componentNode);
+    }
+    return provenance;
+  }
+
   std::map<std::string, std::shared_ptr<core::Repository>> repositories;
 };
 
@@ -64,6 +64,25 @@ class BaseStream : public DataStream, public Serializable {
 
   virtual int writeData(uint8_t *value, int size);
 
+  /**
+   * Writes len bytes to the stream. Lengths beyond the range of writeData
+   * are written with multiple calls to writeData.
+   * @param value buffer to write
+   * @param len number of bytes to write
+   * @return number of bytes written, or -1 if a write failed
+   */
+  virtual int64_t writeBytes(const uint8_t *value, uint64_t len);
+
+  /**
+   * Reads up to len bytes from the stream. Lengths beyond the range of
+   * readData are read with multiple calls to readData.
+   * @param buf buffer in which we extract data
+   * @param len number of bytes to read
+   * @return number of bytes read, which is less than len at the end of the
+   * stream, or -1 if a read failed
+   */
+  virtual int64_t readBytes(uint8_t *buf, uint64_t len);
+
   virtual void seek(uint64_t offset) {
     if (LIKELY(composable_stream_ != this)) {
       composable_stream_->seek(offset);
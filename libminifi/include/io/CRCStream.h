@@ -142,6 +142,11 @@ class CRCStream : public BaseStream {
     return crc_;
   }
 
+  // Continues the checksum of data that passed through another stream
+  void setCRC(uint64_t crc) {
+    crc_ = crc;
+  }
+
   void reset();
  protected:
 
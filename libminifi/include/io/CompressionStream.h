@@ -0,0 +1,140 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_IO_COMPRESSIONSTREAM_H_
+#define LIBMINIFI_INCLUDE_IO_COMPRESSIONSTREAM_H_
+
+#include <zlib.h>
+#include <cstdint>
+#include <vector>
+#include "BaseStream.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+/**
+ * Purpose: Deflates the data written to it in the chunked format of NiFi's CompressionOutputStream,
+ * which site-to-site uses for compressed data packets.
+ *
+ * Design: Written data is buffered and each full buffer is deflated into a chunk of "SYNC", the
+ * uncompressed and compressed lengths and the zlib data. Each chunk after the first is preceded
+ * by a byte of 1, and close() ends the stream with a byte of 0. The child stream is not owned.
+ */
+class CompressionOutputStream : public BaseStream {
+ public:
+  static constexpr int DEFAULT_COMPRESSION_LEVEL = 1;
+  static constexpr int DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+  explicit CompressionOutputStream(BaseStream *stream, int level = DEFAULT_COMPRESSION_LEVEL, int buffer_size = DEFAULT_BUFFER_SIZE);
+
+  virtual ~CompressionOutputStream();
+
+  virtual short initialize() {
+    return 0;
+  }
+
+  virtual int writeData(std::vector<uint8_t> &buf, int buflen);
+
+  virtual int writeData(uint8_t *value, int size);
+
+  /**
+   * Deflates the buffered data and ends the stream. The stream may not be written afterwards.
+   * @return 0 on success, -1 if the child stream could not be written
+   */
+  int close();
+
+  bool isClosed() const {
+    return closed_;
+  }
+
+ private:
+  int compressAndWrite();
+
+  BaseStream *child_stream_;
+  z_stream strm_;
+  bool valid_;
+  bool data_written_;
+  bool closed_;
+  std::vector<uint8_t> buffer_;
+  int buffer_index_;
+  std::vector<uint8_t> compressed_;
+};
+
+/**
+ * Purpose: Inflates data written by a CompressionOutputStream, or by NiFi's equivalent.
+ *
+ * Design: Chunks are read from the child stream as they are needed. The byte following a chunk
+ * tells whether another chunk follows, so the stream never reads past its own end and the child
+ * stream may be read again once the data has been consumed. The child stream is not owned.
+ */
+class CompressionInputStream : public BaseStream {
+ public:
+  // largest uncompressed or compressed chunk accepted from a peer
+  static constexpr uint32_t MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+
+  explicit CompressionInputStream(BaseStream *stream);
+
+  virtual ~CompressionInputStream();
+
+  virtual short initialize() {
+    return 0;
+  }
+
+  virtual int readData(std::vector<uint8_t> &buf, int buflen);
+
+  /**
+   * Reads up to buflen bytes, which is less than buflen only at the end of the stream.
+   * @return bytes read or -1 if the compressed data could not be read
+   */
+  virtual int readData(uint8_t *buf, int buflen);
+
+  virtual int read(uint16_t &value, bool is_little_endian = EndiannessCheck::IS_LITTLE);
+
+  virtual int read(uint32_t &value, bool is_little_endian = EndiannessCheck::IS_LITTLE);
+
+  virtual int read(uint64_t &value, bool is_little_endian = EndiannessCheck::IS_LITTLE);
+
+  // Returns true once the end of stream was read and all of the data consumed
+  bool isFinished() const {
+    return eos_ && buffer_index_ >= buffer_.size();
+  }
+
+ private:
+  int decompressChunk();
+
+  int readFully(uint8_t *buf, int buflen);
+
+  int readNumber(uint8_t *bytes, int size, bool is_little_endian, uint64_t &value);
+
+  BaseStream *child_stream_;
+  z_stream strm_;
+  bool valid_;
+  bool eos_;
+  std::vector<uint8_t> buffer_;
+  size_t buffer_index_;
+  std::vector<uint8_t> compressed_;
+};
+
+} /* namespace io */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+#endif /* LIBMINIFI_INCLUDE_IO_COMPRESSIONSTREAM_H_ */
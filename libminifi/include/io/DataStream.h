@@ -69,6 +69,14 @@ class DataStream {
 
   }
 
+  /**
+   * Writes any data the stream holds back to where the stream writes to.
+   * @return false if the data could not be written
+   */
+  virtual bool flush() {
+    return true;
+  }
+
   /**
    * Reads data and places it into buf
    * @param buf buffer in which we extract data
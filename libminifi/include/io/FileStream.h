@@ -18,9 +18,12 @@
 #ifndef LIBMINIFI_INCLUDE_IO_TLS_FILESTREAM_H_
 #define LIBMINIFI_INCLUDE_IO_TLS_FILESTREAM_H_
 
-#include <iostream>
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include "EndianCheck.h"
 #include "BaseStream.h"
 #include "Serializable.h"
@@ -36,20 +39,27 @@ namespace io {
  * Purpose: File Stream Base stream extension. This is intended to be a thread safe access to
  * read/write to the local file system.
  *
- * Design: Simply extends BaseStream and overrides readData/writeData to allow a sink to the
- * fstream object.
+ * Design: Extends BaseStream and overrides readData/writeData with positional reads and
+ * writes (pread/pwrite) on a file descriptor. Writes are collected in a user space buffer
+ * that is written to the file when it fills, before reads and seeks that need it, and when
+ * the stream is closed or synced, so small writes do not each cost a system call. Sizes and
+ * offsets are 64 bit.
  */
 class FileStream : public io::BaseStream {
  public:
+  // Size of the buffer collecting writes
+  static constexpr size_t WriteBufferSize = 64 * 1024;
+
   /**
-   * File Stream constructor that accepts an fstream shared pointer.
-   * It must already be initialized for read and write.
+   * File Stream constructor opening an existing file.
+   * @param path path to file
+   * @param offset offset at which reading and writing begins
+   * @param write_enable identifies if the file is opened for writing
    */
-  explicit FileStream(const std::string &path, uint32_t offset, bool write_enable = false);
+  explicit FileStream(const std::string &path, uint64_t offset, bool write_enable = false);
 
   /**
-   * File Stream constructor that accepts an fstream shared pointer.
-   * It must already be initialized for read and write.
+   * File Stream constructor opening a file for writing, creating it if needed.
    * @param path path to file
    * @param append identifies if this is an append or overwriting the file
    */
@@ -59,13 +69,34 @@ class FileStream : public io::BaseStream {
     closeStream();
   }
 
+  /**
+   * Writes any buffered data and closes the file.
+   */
   virtual void closeStream();
+
+  /**
+   * Writes any buffered data and closes the file.
+   * @return false if any buffered data could not be written or the file could not be closed
+   */
+  bool close();
+
+  /**
+   * Writes any buffered data to the file.
+   * @return false if this or any earlier buffered data could not be written
+   */
+  virtual bool flush();
   /**
    * Skip to the specified offset.
    * @param offset offset to which we will skip
    */
   void seek(uint64_t offset);
 
+  /**
+   * Writes any buffered data and syncs the file to disk.
+   * @return false if the data could not be written or synced
+   */
+  bool sync();
+
   const uint64_t getSize() const {
     return length_;
   }
@@ -84,6 +115,8 @@ class FileStream : public io::BaseStream {
    */
   virtual int readData(uint8_t *buf, int buflen);
 
+  virtual int64_t readBytes(uint8_t *buf, uint64_t len);
+
   /**
    * Write value to the stream using std::vector
    * @param buf incoming buffer
@@ -99,6 +132,8 @@ class FileStream : public io::BaseStream {
    */
   virtual int writeData(uint8_t *value, int size);
 
+  virtual int64_t writeBytes(const uint8_t *value, uint64_t len);
+
   /**
    * Returns the underlying buffer
    * @return vector's array
@@ -117,11 +152,23 @@ class FileStream : public io::BaseStream {
    */
   template<typename T>
   std::vector<uint8_t> readBuffer(const T&);
-  std::recursive_mutex file_lock_;
-  std::unique_ptr<std::fstream> file_stream_;
-  size_t offset_;
+
+  // Writes the write buffer to the file. Requires file_lock_
+  bool flushBuffer();
+
+  std::mutex file_lock_;
+  int fd_;
+  uint64_t offset_;
   std::string path_;
-  size_t length_;
+  std::atomic<uint64_t> length_;
+  bool write_enable_;
+  // Set when writes always go to the end of the file
+  bool append_;
+  std::vector<uint8_t> write_buffer_;
+  // Offset in the file at which write_buffer_ starts
+  uint64_t write_buffer_offset_;
+  // Set once buffered data could not be written, which flush and close report
+  bool write_failed_;
 
  private:
 
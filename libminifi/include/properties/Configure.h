@@ -46,6 +46,7 @@ class Configure : public Properties {
   static const char *nifi_flow_configuration_file_exit_failure;
   static const char *nifi_flow_configuration_file_backup_update;
   static const char *nifi_flow_engine_threads;
+  static const char *nifi_flow_engine_work_stealing;
   static const char *nifi_administrative_yield_duration;
   static const char *nifi_bored_yield_duration;
   static const char *nifi_graceful_shutdown_seconds;
@@ -62,11 +63,21 @@ class Configure : public Properties {
   static const char *nifi_provenance_repository_max_storage_size;
   static const char *nifi_provenance_repository_directory_default;
   static const char *nifi_provenance_repository_enable;
+  static const char *nifi_provenance_policy;
+  static const char *nifi_provenance_policy_sample_interval;
+  static const char *nifi_provenance_policy_aggregation_window;
+  static const char *nifi_provenance_policy_component;
+  static const char *nifi_provenance_policy_event;
   static const char *nifi_flowfile_repository_max_storage_time;
   static const char *nifi_dbcontent_repository_directory_default;
+  static const char *nifi_dbcontent_repository_chunk_size;
+  static const char *nifi_content_claim_max_appendable_size;
+  static const char *nifi_content_claim_max_flow_files;
   static const char *nifi_flowfile_repository_max_storage_size;
   static const char *nifi_flowfile_repository_directory_default;
   static const char *nifi_flowfile_repository_enable;
+  static const char *nifi_flowfile_repository_sync_policy;
+  static const char *nifi_flowfile_swap_directory_default;
   static const char *nifi_remote_input_secure;
   static const char *nifi_remote_input_http;
   static const char *nifi_security_need_ClientAuth;
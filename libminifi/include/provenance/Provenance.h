@@ -48,6 +48,12 @@ namespace minifi {
 namespace provenance {
 // Provenance Event Record Serialization Seg Size
 #define PROVENANCE_EVENT_RECORD_SEG_SIZE 2048
+// Leading byte of the compact event serialization. Events written before it start with the
+// high byte of their UUID length, which is always zero.
+#define PROVENANCE_EVENT_RECORD_COMPACT_VERSION 1
+
+class ProvenancePolicy;
+struct ProvenanceComponentState;
 
 // Provenance Event Record
 class ProvenanceEventRecord : public core::SerializableComponent {
@@ -156,6 +162,25 @@ class ProvenanceEventRecord : public core::SerializableComponent {
     REPLAY
   };
   static const char *ProvenanceEventTypeStr[REPLAY + 1];
+
+  /**
+   * Details of the events reported by the process session. They are kept as the parts
+   * of the message and are only formatted when read.
+   */
+  enum DetailFormat {
+    // details given as text
+    TEXT_DETAILS,
+    // <component> creates flow record <uuid>
+    CREATE_DETAILS,
+    // <component> modify flow record <uuid> attribute <key>:<value>
+    MODIFY_ATTRIBUTE_DETAILS,
+    // <component> remove flow record <uuid> attribute <key>
+    REMOVE_ATTRIBUTE_DETAILS,
+    // <component> modify flow record content <uuid>
+    MODIFY_CONTENT_DETAILS,
+    // <component> expire flow record <uuid>
+    EXPIRE_DETAILS
+  };
  public:
   // Constructor
   /*!
@@ -164,7 +189,8 @@ class ProvenanceEventRecord : public core::SerializableComponent {
   ProvenanceEventRecord(ProvenanceEventType event, std::string componentId, std::string componentType);
 
   ProvenanceEventRecord()
-      : core::SerializableComponent(core::getClassName<ProvenanceEventRecord>()) {
+      : core::SerializableComponent(core::getClassName<ProvenanceEventRecord>()),
+        _detailFormat(TEXT_DETAILS) {
     _eventTime = getTimeMillis();
   }
 
@@ -183,6 +209,10 @@ class ProvenanceEventRecord : public core::SerializableComponent {
   std::map<std::string, std::string> getAttributes() {
     return _attributes;
   }
+  // Set Attribute
+  void setAttribute(const std::string &key, const std::string &value) {
+    _attributes[key] = value;
+  }
   // Get Size
   uint64_t getFileSize() {
     return _size;
@@ -235,13 +265,25 @@ class ProvenanceEventRecord : public core::SerializableComponent {
   std::set<std::string> getLineageIdentifiers() {
     return _lineageIdentifiers;
   }
-  // Get Details
-  std::string getDetails() {
-    return _details;
-  }
+  // Get Details, formatting them if they were set from their parts
+  std::string getDetails();
   // Set Details
   void setDetails(std::string details) {
+    _detailFormat = TEXT_DETAILS;
     _details = details;
+    _detailKey.clear();
+    _detailValue.clear();
+  }
+  // Set Details to be formatted from the component, the flow file and the given attribute when read
+  void setDetails(DetailFormat format, const std::string &key = "", const std::string &value = "") {
+    _detailFormat = format;
+    _details.clear();
+    _detailKey = key;
+    _detailValue = value;
+  }
+  // Get the format of the details
+  DetailFormat getDetailFormat() {
+    return _detailFormat;
   }
   // Get TransitUri
   std::string getTransitUri() {
@@ -350,6 +392,8 @@ class ProvenanceEventRecord : public core::SerializableComponent {
   }
   // Serialize and Persistent to the repository
   bool Serialize(const std::shared_ptr<core::SerializableComponent> &repo);
+  // Serialize, appending the compact form of the event to the stream
+  bool Serialize(org::apache::nifi::minifi::io::DataStream &outStream);
   // DeSerialize
   bool DeSerialize(const uint8_t *buffer, const size_t bufferSize);
   // DeSerialize
@@ -364,8 +408,24 @@ class ProvenanceEventRecord : public core::SerializableComponent {
     int size = bufferSize > 72 ? 72 : bufferSize;
     org::apache::nifi::minifi::io::DataStream outStream(buffer, size);
 
+    uint64_t event_time;
+    int ret;
+
+    if (bufferSize > 0 && buffer[0] == PROVENANCE_EVENT_RECORD_COMPACT_VERSION) {
+      uint8_t version;
+      ret = read(version, &outStream);
+      if (ret != 1) {
+        return 0;
+      }
+      ret = read(event_time, &outStream);
+      if (ret != 8) {
+        return 0;
+      }
+      return event_time;
+    }
+
     std::string uuid;
-    int ret = readUTF(uuid, &outStream);
+    ret = readUTF(uuid, &outStream);
 
     if (ret <= 0) {
       return 0;
@@ -377,8 +437,6 @@ class ProvenanceEventRecord : public core::SerializableComponent {
       return 0;
     }
 
-    uint64_t event_time;
-
     ret = read(event_time, &outStream);
     if (ret != 8) {
       return 0;
@@ -425,6 +483,11 @@ class ProvenanceEventRecord : public core::SerializableComponent {
   std::vector<std::string> _childrenUuids;
   // detail
   std::string _details;
+  // format of the detail
+  DetailFormat _detailFormat;
+  // attribute key and value the detail is formatted with
+  std::string _detailKey;
+  std::string _detailValue;
   // sourceQueueIdentifier
   std::string _sourceQueueIdentifier;
   // relationship
@@ -433,6 +496,11 @@ class ProvenanceEventRecord : public core::SerializableComponent {
   std::string _alternateIdentifierUri;
 
  private:
+  // Reads the fields ahead of the attributes as written before the compact serialization
+  bool DeSerializeLegacyHeader(org::apache::nifi::minifi::io::DataStream &outStream);
+  // Reads the fields ahead of the attributes of the compact serialization
+  bool DeSerializeCompactHeader(org::apache::nifi::minifi::io::DataStream &outStream);
+
   // Prevent default copy constructor and assignment operation
   // Only support pass by reference or pointer
   ProvenanceEventRecord(const ProvenanceEventRecord &parent);
@@ -448,12 +516,7 @@ class ProvenanceReporter {
   /*!
    * Create a new provenance reporter associated with the process session
    */
-  ProvenanceReporter(std::shared_ptr<core::Repository> repo, std::string componentId, std::string componentType)
-      : logger_(logging::LoggerFactory<ProvenanceReporter>::getLogger()) {
-    _componentId = componentId;
-    _componentType = componentType;
-    repo_ = repo;
-  }
+  ProvenanceReporter(std::shared_ptr<core::Repository> repo, std::string componentId, std::string componentType);
 
   // Destructor
   virtual ~ProvenanceReporter() {
@@ -482,12 +545,20 @@ class ProvenanceReporter {
   void commit();
   // create
   void create(std::shared_ptr<core::FlowFile> flow, std::string detail);
+  // create, with details formatted when read
+  void create(std::shared_ptr<core::FlowFile> flow);
   // route
   void route(std::shared_ptr<core::FlowFile> flow, core::Relationship relation, std::string detail, uint64_t processingDuration);
   // modifyAttributes
   void modifyAttributes(std::shared_ptr<core::FlowFile> flow, std::string detail);
+  // modifyAttributes for a put attribute, with details formatted when read
+  void modifyAttributes(std::shared_ptr<core::FlowFile> flow, const std::string &key, const std::string &value);
+  // modifyAttributes for a removed attribute, with details formatted when read
+  void removeAttribute(std::shared_ptr<core::FlowFile> flow, const std::string &key);
   // modifyContent
   void modifyContent(std::shared_ptr<core::FlowFile> flow, std::string detail, uint64_t processingDuration);
+  // modifyContent, with details formatted when read
+  void modifyContent(std::shared_ptr<core::FlowFile> flow, uint64_t processingDuration);
   // clone
   void clone(std::shared_ptr<core::FlowFile> parent, std::shared_ptr<core::FlowFile> child);
   // join
@@ -496,6 +567,8 @@ class ProvenanceReporter {
   void fork(std::vector<std::shared_ptr<core::FlowFile> > child, std::shared_ptr<core::FlowFile> parent, std::string detail, uint64_t processingDuration);
   // expire
   void expire(std::shared_ptr<core::FlowFile> flow, std::string detail);
+  // expire, with details formatted when read
+  void expire(std::shared_ptr<core::FlowFile> flow);
   // drop
   void drop(std::shared_ptr<core::FlowFile> flow, std::string reason);
   // send
@@ -507,14 +580,8 @@ class ProvenanceReporter {
 
  protected:
 
-  // allocate
-  std::shared_ptr<ProvenanceEventRecord> allocate(ProvenanceEventRecord::ProvenanceEventType eventType, std::shared_ptr<core::FlowFile> flow) {
-    auto event = std::make_shared<ProvenanceEventRecord>(eventType, _componentId, _componentType);
-    if (event)
-      event->fromFlowFile(flow);
-
-    return event;
-  }
+  // allocate, returning nullptr if the provenance policy does not store the event
+  std::shared_ptr<ProvenanceEventRecord> allocate(ProvenanceEventRecord::ProvenanceEventType eventType, std::shared_ptr<core::FlowFile> flow);
 
   // Component ID
   std::string _componentId;
@@ -528,6 +595,9 @@ class ProvenanceReporter {
   std::set<std::shared_ptr<ProvenanceEventRecord>> _events;
   // provenance repository.
   std::shared_ptr<core::Repository> repo_;
+  // policy of the provenance repository and the recording state of the component
+  std::shared_ptr<ProvenancePolicy> policy_;
+  std::shared_ptr<ProvenanceComponentState> component_state_;
 
   // Prevent default copy constructor and assignment operation
   // Only support pass by reference or pointer
@@ -0,0 +1,187 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_PROVENANCE_PROVENANCEPOLICY_H_
+#define LIBMINIFI_INCLUDE_PROVENANCE_PROVENANCEPOLICY_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "properties/Configure.h"
+#include "provenance/Provenance.h"
+#include "core/logging/LoggerConfiguration.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace provenance {
+
+#define DEFAULT_PROVENANCE_SAMPLE_INTERVAL 10
+#define DEFAULT_PROVENANCE_AGGREGATION_WINDOW (60000) // 1 minute
+
+// How the provenance events of a component and event type are recorded
+enum ProvenanceMode {
+  // events are not recorded
+  PROVENANCE_OFF,
+  // every event is stored
+  PROVENANCE_FULL,
+  // one in every sample interval events is stored
+  PROVENANCE_SAMPLE,
+  // events are counted, storing a single event per aggregation window
+  PROVENANCE_AGGREGATE
+};
+
+// Event counts of one event type of a component
+struct ProvenanceCounters {
+  // events reported by the component
+  uint64_t events;
+  // events stored in full
+  uint64_t stored;
+  // events counted into aggregates
+  uint64_t aggregated;
+};
+
+// Recording state of one event type of a component
+struct ProvenanceEventTypeState {
+  ProvenanceMode mode;
+  std::atomic<uint64_t> events;
+  std::atomic<uint64_t> stored;
+  std::atomic<uint64_t> aggregated;
+  // aggregation window being counted, guarded by mutex
+  std::mutex mutex;
+  uint64_t window_start;
+  uint64_t window_count;
+  uint64_t window_bytes;
+};
+
+// Recording state of the event types of a component
+struct ProvenanceComponentState {
+  std::string component_id;
+  ProvenanceEventTypeState types[ProvenanceEventRecord::REPLAY + 1];
+};
+
+/**
+ * Purpose: Decides which provenance events are stored, so that provenance may remain enabled
+ * on constrained devices at a fraction of its cost.
+ *
+ * Design: The mode is resolved per component and event type, with component modes taking
+ * precedence over event type modes, which take precedence over the default mode. Rejected events
+ * are never created. Aggregates are stored as regular provenance events once their window closes,
+ * so that they are reported like any other event.
+ */
+class ProvenancePolicy {
+ public:
+  // Creates a policy storing every event
+  ProvenancePolicy();
+
+  // Creates a policy from the nifi.provenance.policy properties
+  explicit ProvenancePolicy(const std::shared_ptr<Configure> &configuration);
+
+  /**
+   * Parses a mode, one of off, full, sample or aggregate.
+   * @return false if the value is not a mode
+   */
+  static bool parseMode(const std::string &value, ProvenanceMode &mode);
+
+  // Returns the name of the mode
+  static std::string getModeName(ProvenanceMode mode);
+
+  void setDefaultMode(ProvenanceMode mode) {
+    default_mode_ = mode;
+  }
+
+  void setComponentMode(const std::string &component_id, ProvenanceMode mode) {
+    component_modes_[component_id] = mode;
+  }
+
+  void setEventTypeMode(ProvenanceEventRecord::ProvenanceEventType type, ProvenanceMode mode) {
+    event_type_modes_[type] = mode;
+  }
+
+  void setSampleInterval(uint64_t interval) {
+    sample_interval_ = interval > 0 ? interval : 1;
+  }
+
+  void setAggregationWindow(uint64_t window_millis) {
+    aggregation_window_ = window_millis > 0 ? window_millis : 1;
+  }
+
+  // Returns true if any event is not stored in full
+  bool isSelective() const;
+
+  // Returns the mode for the event type of the component
+  ProvenanceMode getMode(const std::string &component_id, ProvenanceEventRecord::ProvenanceEventType type) const;
+
+  /**
+   * Returns the recording state of the component, resolving its modes when first seen.
+   * Modes must be configured before components are seen.
+   */
+  std::shared_ptr<ProvenanceComponentState> getComponent(const std::string &component_id);
+
+  /**
+   * Records an event of the component.
+   * @param size size of the flow file the event is about
+   * @return true if the event should be created and stored
+   */
+  bool accept(ProvenanceComponentState &component, ProvenanceEventRecord::ProvenanceEventType type, uint64_t size);
+
+  /**
+   * Creates an event for every aggregate whose window closed by now.
+   * @param force closes the open windows as well
+   */
+  void flushAggregates(uint64_t now, std::vector<std::shared_ptr<ProvenanceEventRecord>> &events, bool force = false);
+
+  // Returns the event counts per component and event type
+  std::map<std::string, std::map<ProvenanceEventRecord::ProvenanceEventType, ProvenanceCounters>> getCounters();
+
+  // Prevent default copy constructor and assignment operation
+  // Only support pass by reference or pointer
+  ProvenancePolicy(const ProvenancePolicy &parent) = delete;
+  ProvenancePolicy &operator=(const ProvenancePolicy &parent) = delete;
+
+ private:
+  // Creates the event of an aggregate and resets its window. Called with the state mutex held.
+  std::shared_ptr<ProvenanceEventRecord> closeWindow(const std::string &component_id, ProvenanceEventRecord::ProvenanceEventType type, ProvenanceEventTypeState &state);
+
+  ProvenanceMode default_mode_;
+  std::map<std::string, ProvenanceMode> component_modes_;
+  std::map<int, ProvenanceMode> event_type_modes_;
+  uint64_t sample_interval_;
+  uint64_t aggregation_window_;
+
+  std::mutex mutex_;
+  std::map<std::string, std::shared_ptr<ProvenanceComponentState>> components_;
+  // events of the aggregates closed when their next window started
+  std::vector<std::shared_ptr<ProvenanceEventRecord>> closed_aggregates_;
+  // time at which the open windows are next checked
+  std::atomic<uint64_t> next_flush_;
+
+  std::shared_ptr<logging::Logger> logger_;
+};
+
+} /* namespace provenance */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_PROVENANCE_PROVENANCEPOLICY_H_ */
@@ -88,6 +88,11 @@ class Peer {
     other = port_id_;
   }
 
+  // Returns host:port, which identifies the peer
+  std::string toString() const {
+    return host_ + ":" + std::to_string(port_);
+  }
+
  protected:
   std::string host_;
 
@@ -118,11 +123,11 @@ class PeerStatus {
     return peer_;
   }
 
-  uint32_t getFlowFileCount() {
+  uint32_t getFlowFileCount() const {
     return flow_file_count_;
   }
 
-  bool getQueryForPeers() {
+  bool getQueryForPeers() const {
     return query_for_peers_;
   }
  protected:
@@ -0,0 +1,104 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_SITETOSITE_PEERSELECTOR_H_
+#define LIBMINIFI_INCLUDE_SITETOSITE_PEERSELECTOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "Peer.h"
+#include "SiteToSite.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace sitetosite {
+
+/**
+ * Purpose: Selects the peer of each site-to-site transaction, as NiFi's PeerSelector does.
+ *
+ * Design: Peers are chosen at random, weighted by the flow files they reported when the peer
+ * list was last refreshed. Peers holding fewer flow files are preferred for sending and peers
+ * holding more are preferred for receiving. Peers that recently failed are penalized and only
+ * chosen when every peer is penalized. The selector is thread safe.
+ */
+class PeerSelector {
+ public:
+  static constexpr uint64_t DEFAULT_PENALTY_MILLIS = 30000;
+
+  explicit PeerSelector(uint64_t penalty_millis = DEFAULT_PENALTY_MILLIS);
+
+  /**
+   * Replaces the peers, keeping the penalties of the peers that remain.
+   */
+  void setPeers(const std::vector<PeerStatus> &peers);
+
+  std::vector<std::shared_ptr<Peer>> getPeers() const;
+
+  /**
+   * Selects the peer of a transaction.
+   * @param direction direction of the transaction
+   * @return selected peer or nullptr if there are no peers
+   */
+  std::shared_ptr<Peer> select(TransferDirection direction);
+
+  // Penalizes a peer that failed, so that other peers are selected while the penalty lasts
+  void penalize(const Peer &peer);
+
+  bool isPenalized(const Peer &peer) const;
+
+  size_t size() const;
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  /**
+   * Returns the relative weight of a peer.
+   * @param flow_file_count flow files reported by the peer
+   * @param total_flow_file_count flow files reported by all peers
+   * @param direction direction of the transaction
+   */
+  static double getWeight(uint32_t flow_file_count, uint64_t total_flow_file_count, TransferDirection direction);
+
+ private:
+  struct PeerEntry {
+    std::shared_ptr<Peer> peer;
+    uint32_t flow_file_count;
+    uint64_t penalized_until;
+  };
+
+  PeerEntry *find(const Peer &peer);
+
+  mutable std::mutex mutex_;
+  uint64_t penalty_millis_;
+  std::vector<PeerEntry> peers_;
+  std::mt19937 random_;
+};
+
+} /* namespace sitetosite */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_SITETOSITE_PEERSELECTOR_H_ */
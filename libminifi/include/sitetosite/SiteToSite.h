@@ -23,6 +23,7 @@
 #include "core/Property.h"
 #include "properties/Configure.h"
 #include "io/CRCStream.h"
+#include "io/CompressionStream.h"
 #include "io/StreamFactory.h"
 #include "utils/Id.h"
 #include "utils/HTTPClient.h"
@@ -233,7 +234,9 @@ class Transaction {
    */
   explicit Transaction(TransferDirection direction, org::apache::nifi::minifi::io::CRCStream<SiteToSitePeer> &stream)
       : closed_(false),
-        crcStream(std::move(stream)) {
+        crcStream(std::move(stream)),
+        compress_(false),
+        compression_level_(io::CompressionOutputStream::DEFAULT_COMPRESSION_LEVEL) {
     _state = TRANSACTION_STARTED;
     _direction = direction;
     _dataAvailable = false;
@@ -282,7 +285,7 @@ class Transaction {
   }
   // getCRC
   uint64_t getCRC() {
-    return crcStream.getCRC();
+    return packet_stream_ ? packet_stream_->getCRC() : crcStream.getCRC();
   }
   // updateCRC
   void updateCRC(uint8_t *buffer, uint32_t length) {
@@ -293,6 +296,34 @@ class Transaction {
     return crcStream;
   }
 
+  // Compresses the data packets, as negotiated with the peer
+  void setCompression(bool compress, int level) {
+    compress_ = compress;
+    compression_level_ = level;
+  }
+
+  bool isCompressed() const {
+    return compress_;
+  }
+
+  // Sets the compression level of the packets that are sent next
+  void setCompressionLevel(int level) {
+    compression_level_ = level;
+  }
+
+  /**
+   * Returns the stream through which data packets are written or read. When compression was
+   * negotiated, each packet passes through its own compression stream, which is opened on first
+   * use and ended by closePacket(). The CRC covers the uncompressed data either way.
+   */
+  io::BaseStream &getPacketStream();
+
+  /**
+   * Ends the current data packet.
+   * @return false if the end of a compressed packet could not be written
+   */
+  bool closePacket();
+
   Transaction(const Transaction &parent) = delete;
   Transaction &operator=(const Transaction &parent) = delete;
 
@@ -318,6 +349,13 @@ class Transaction {
 
  private:
 
+  bool compress_;
+  int compression_level_;
+  // streams of the current compressed packet, which write to or read from the peer
+  std::unique_ptr<io::CompressionOutputStream> compression_output_;
+  std::unique_ptr<io::CompressionInputStream> compression_input_;
+  std::unique_ptr<io::CRCStream<io::BaseStream>> packet_stream_;
+
   // Transaction Direction
   TransferDirection _direction;
 
@@ -335,7 +373,10 @@ class SiteToSiteClientConfiguration {
       : stream_factory_(stream_factory),
         peer_(peer),
         local_network_interface_(ifc),
-        ssl_service_(nullptr) {
+        ssl_service_(nullptr),
+        use_compression_(false),
+        compression_level_(io::CompressionOutputStream::DEFAULT_COMPRESSION_LEVEL),
+        compression_threshold_(0) {
     client_type_ = type;
   }
 
@@ -375,6 +416,21 @@ class SiteToSiteClientConfiguration {
     return this->proxy_;
   }
 
+  void setCompression(bool use_compression, int level, uint64_t threshold) {
+    use_compression_ = use_compression;
+    compression_level_ = level;
+    compression_threshold_ = threshold;
+  }
+  bool getUseCompression() const {
+    return use_compression_;
+  }
+  int getCompressionLevel() const {
+    return compression_level_;
+  }
+  uint64_t getCompressionThreshold() const {
+    return compression_threshold_;
+  }
+
  protected:
 
   std::shared_ptr<io::StreamFactory> stream_factory_;
@@ -390,6 +446,12 @@ class SiteToSiteClientConfiguration {
   std::shared_ptr<controllers::SSLContextService> ssl_service_;
 
   utils::HTTPProxy proxy_;
+
+  bool use_compression_;
+
+  int compression_level_;
+
+  uint64_t compression_threshold_;
 };
 #if defined(__GNUC__) || defined(__GNUG__)
 #pragma GCC diagnostic pop
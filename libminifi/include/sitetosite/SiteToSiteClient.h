@@ -59,6 +59,10 @@ class SiteToSiteClient : public core::Connectable {
       : core::Connectable("SitetoSiteClient"),
         peer_state_(IDLE),
         _batchSendNanos(5000000000),
+        _batchGetCount(100),
+        use_compression_(false),
+        compression_level_(io::CompressionOutputStream::DEFAULT_COMPRESSION_LEVEL),
+        compression_threshold_(0),
         ssl_context_service_(nullptr),
         logger_(logging::LoggerFactory<SiteToSiteClient>::getLogger()) {
     _supportedVersion[0] = 5;
@@ -81,6 +85,22 @@ class SiteToSiteClient : public core::Connectable {
     ssl_context_service_ = context_service;
   }
 
+  /**
+   * Requests compressed transfers from the peer.
+   * @param use_compression whether compression is requested
+   * @param level deflate level of the data that is sent
+   * @param threshold batches with fewer content bytes are sent uncompressed (deflate level 0)
+   */
+  void setCompression(bool use_compression, int level, uint64_t threshold) {
+    use_compression_ = use_compression;
+    compression_level_ = level;
+    compression_threshold_ = threshold;
+  }
+
+  bool isCompressionEnabled() const {
+    return use_compression_;
+  }
+
   /**
    * Creates a transaction using the transaction ID and the direction
    * @param transactionID transaction identifier
@@ -257,6 +277,17 @@ class SiteToSiteClient : public core::Connectable {
   // BATCH_SEND_NANOS
   uint64_t _batchSendNanos;
 
+  // number of flow files taken from the session at a time while sending
+  uint64_t _batchGetCount;
+
+  // whether compressed transfers are requested from the peer
+  bool use_compression_;
+
+  int compression_level_;
+
+  // smallest batch, in content bytes, that is compressed
+  uint64_t compression_threshold_;
+
   /***
    * versioning
    */
@@ -289,7 +320,7 @@ class WriteCallback : public OutputStreamCallback {
     int total = 0;
     while (len > 0) {
 	  int size = len < 16384 ? len : 16384; 
-      int ret = _packet->transaction_->getStream().readData(buffer, size);
+      int ret = _packet->transaction_->getPacketStream().readData(buffer, size);
       if (ret != size) {
         logging::LOG_ERROR(_packet->logger_reference_) << "Site2Site Receive Flow Size " << size << " Failed " << ret << ", should have received " << len;
         return -1;
@@ -323,7 +354,7 @@ class ReadCallback : public InputStreamCallback {
       if (readSize < 0) {
         return -1;
       }
-      int ret = _packet->transaction_->getStream().writeData(buffer, readSize);
+      int ret = _packet->transaction_->getPacketStream().writeData(buffer, readSize);
       if (ret != readSize) {
         logging::LOG_INFO(_packet->logger_reference_) << "Site2Site Send Flow Size " << readSize << " Failed " << ret;
         return -1;
@@ -0,0 +1,94 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_INCLUDE_SITETOSITE_SITETOSITECLIENTPOOL_H_
+#define LIBMINIFI_INCLUDE_SITETOSITE_SITETOSITECLIENTPOOL_H_
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Peer.h"
+#include "SiteToSiteClient.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace sitetosite {
+
+/**
+ * Purpose: Keeps idle site-to-site clients of each peer, so that a transaction can reuse a
+ * client that has already established its connection and completed the handshake.
+ *
+ * Design: Each peer keeps a bounded stack of idle clients, so that the most recently used
+ * client, whose connection is the least likely to have timed out, is reused first. Clients
+ * that stay idle longer than the idle expiration are torn down rather than reused. The pool
+ * is thread safe; clients are destroyed outside of its lock since tearing them down may block.
+ */
+class SiteToSiteClientPool {
+ public:
+  static constexpr uint64_t DEFAULT_IDLE_EXPIRATION_MILLIS = 30000;
+
+  explicit SiteToSiteClientPool(size_t max_idle_per_peer = 1, uint64_t idle_expiration_millis = DEFAULT_IDLE_EXPIRATION_MILLIS);
+
+  void setMaxIdlePerPeer(size_t max_idle_per_peer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_idle_per_peer_ = max_idle_per_peer;
+  }
+
+  /**
+   * Takes an idle client of the peer.
+   * @return client or nullptr if the peer has no idle client
+   */
+  std::unique_ptr<SiteToSiteClient> take(const Peer &peer);
+
+  /**
+   * Returns a client of the peer to the pool.
+   * @return false if the peer already has as many idle clients as allowed, in which case the client is destroyed
+   */
+  bool put(const Peer &peer, std::unique_ptr<SiteToSiteClient> client);
+
+  size_t size(const Peer &peer) const;
+
+  // Tears down the clients that stayed idle for too long and the clients of peers that are no longer known
+  void evict(const std::vector<std::shared_ptr<Peer>> &peers);
+
+  void clear();
+
+ private:
+  struct IdleClient {
+    std::unique_ptr<SiteToSiteClient> client;
+    uint64_t idle_since;
+  };
+
+  mutable std::mutex mutex_;
+  size_t max_idle_per_peer_;
+  uint64_t idle_expiration_millis_;
+  std::map<std::string, std::deque<IdleClient>> idle_clients_;
+};
+
+} /* namespace sitetosite */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
+
+#endif /* LIBMINIFI_INCLUDE_SITETOSITE_SITETOSITECLIENTPOOL_H_ */
@@ -67,6 +67,7 @@ static std::unique_ptr<SiteToSiteClient> createRawSocket(const SiteToSiteClientC
   auto ptr = std::unique_ptr<SiteToSiteClient>(new RawSiteToSiteClient(std::move(rsptr)));
   ptr->setPortId(uuid);
   ptr->setSSLContextService(client_configuration.getSecurityContext());
+  ptr->setCompression(client_configuration.getUseCompression(), client_configuration.getCompressionLevel(), client_configuration.getCompressionThreshold());
   return ptr;
 }
 
@@ -87,6 +88,7 @@ static std::unique_ptr<SiteToSiteClient> createClient(const SiteToSiteClientConf
       if (nullptr != http_protocol) {
         auto ptr = std::unique_ptr<SiteToSiteClient>(static_cast<SiteToSiteClient*>(http_protocol));
         ptr->setSSLContextService(client_configuration.getSecurityContext());
+        ptr->setCompression(client_configuration.getUseCompression(), client_configuration.getCompressionLevel(), client_configuration.getCompressionThreshold());
         auto peer = std::unique_ptr<SiteToSitePeer>(new SiteToSitePeer(client_configuration.getPeer()->getHost(), client_configuration.getPeer()->getPort(),
             client_configuration.getInterface()));
         peer->setHTTPProxy(client_configuration.getHTTPProxy());
@@ -117,6 +117,16 @@ class ByteOutputCallback : public OutputStreamCallback {
 
   bool waitingOps();
 
+  /**
+   * Blocks until data can be read or the writer closed this callback.
+   * @return true if data can be read
+   */
+  bool waitForData();
+
+  bool isClosed() const {
+    return !is_alive_;
+  }
+
   virtual void write(char *data, size_t size);
 
   size_t readFully(char *buffer, size_t size);
@@ -19,16 +19,9 @@
 #ifndef LIBMINIFI_INCLUDE_IO_REGEXUTILS_H_
 #define LIBMINIFI_INCLUDE_IO_REGEXUTILS_H_
 
+#include <memory>
+#include <string>
 #include <vector>
-#include <regex>
-
-#if (__cplusplus > 201103L) || defined(_WIN32)
-#define NO_MORE_REGFREEE
-#endif
-
-#ifndef NO_MORE_REGFREEE
-#include <regex.h>
-#endif
 
 namespace org {
 namespace apache {
@@ -36,6 +29,18 @@ namespace nifi {
 namespace minifi {
 namespace utils {
 
+class RegexProgram;
+
+/**
+ * Regular expression whose matching time is linear in the length of the subject.
+ *
+ * Patterns use the ECMAScript syntax along with POSIX bracket expressions such as
+ * [[:alpha:]], and are compiled into a program for a Pike VM, which advances every
+ * candidate match in a single pass over the subject instead of backtracking.
+ * Backreferences and lookaround cannot be matched this way and fall back to std::regex.
+ * Compiled programs are cached by pattern, so constructing a Regex for a pattern
+ * seen before is cheap.
+ */
 class Regex {
 public:
   enum class Mode { ICASE };
@@ -49,30 +54,54 @@ public:
   Regex(Regex&& other);
   Regex& operator=(Regex&& other);
   ~Regex();
+
+  /**
+   * Searches the subject for the first match, keeping the groups and the suffix
+   * following the match. An empty regex never matches.
+   * @param pattern subject to search
+   * @return true if the subject contains a match
+   */
   bool match(const std::string &pattern);
   const std::vector<std::string>& getResult() const;
   const std::string& getSuffix() const;
 
+  /**
+   * @return true if the whole subject matches
+   */
+  bool matchesFully(const std::string &subject) const;
+
+  /**
+   * @return true if any part of the subject matches
+   */
+  bool find(const std::string &subject) const;
+
+  /**
+   * Searches data for the first match starting at or after start.
+   * @param groups receives the begin and end offsets of every group, the whole match
+   * being group 0, or std::string::npos for groups that did not participate
+   * @return true if a match was found
+   */
+  bool search(const char *data, size_t length, size_t start, std::vector<size_t> &groups) const;
+
+  /**
+   * Replaces matches in the subject with format, in which $& and $n refer to the
+   * match and its groups, $` and $' to the text before and after it, and $$ to $.
+   * @param first_only replace only the first match
+   */
+  std::string replace(const std::string &subject, const std::string &format, bool first_only = false) const;
+
+  /**
+   * @return number of groups including the whole match
+   */
+  size_t getGroupCount() const;
+
  private:
   std::string pat_;
   std::string suffix_;
   std::string regexStr_;
   std::vector<std::string> results_;
   bool valid_;
-
-#ifdef NO_MORE_REGFREEE
-
-  std::regex compiledRegex_;
-  std::regex_constants::syntax_option_type regex_mode_;
-  std::smatch matches_;
-
-#else
-
-  regex_t compiledRegex_;
-  int regex_mode_;
-  std::vector<regmatch_t> matches_;
-
-#endif
+  std::shared_ptr<const RegexProgram> program_;
 };
 
 } /* namespace utils */
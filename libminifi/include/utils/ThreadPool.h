@@ -24,10 +24,13 @@
 #include <mutex>
 #include <map>
 #include <vector>
+#include <deque>
 #include <queue>
 #include <future>
 #include <thread>
 #include <functional>
+#include <algorithm>
+#include <limits>
 
 #include "BackTrace.h"
 #include "core/expect.h"
@@ -212,20 +215,30 @@ class WorkerThread {
  * Purpose: Provides a thread pool with basic functionality similar to
  * ThreadPoolExecutor
  * Design: Locked control over a manager thread that controls the worker threads
+ *
+ * In work stealing mode each worker thread runs tasks from a deque of its own and steals from the
+ * deques of other workers once its own is empty. Tasks that must wait before running again are held
+ * in a timer queue ordered by steady clock deadline, and idle workers park until the earliest deadline
+ * or until work arrives rather than polling for it.
  */
 template<typename T>
 class ThreadPool {
  public:
 
   ThreadPool(int max_worker_threads = 2, bool daemon_threads = false, const std::shared_ptr<core::controller::ControllerServiceProvider> &controller_service_provider = nullptr,
-             const std::string &name = "NamelessPool")
+             const std::string &name = "NamelessPool", bool work_stealing = false)
       : daemon_threads_(daemon_threads),
         thread_reduction_count_(0),
         max_worker_threads_(max_worker_threads),
         adjust_threads_(false),
         running_(false),
         controller_service_provider_(controller_service_provider),
-        name_(name) {
+        name_(name),
+        work_stealing_(work_stealing),
+        next_deque_(0),
+        parked_workers_(0),
+        queued_tasks_(0),
+        next_deadline_(std::numeric_limits<int64_t>::max()) {
     current_workers_ = 0;
     task_count_ = 0;
     thread_manager_ = nullptr;
@@ -239,7 +252,12 @@ class ThreadPool {
         running_(false),
         controller_service_provider_(std::move(other.controller_service_provider_)),
         thread_manager_(std::move(other.thread_manager_)),
-        name_(std::move(other.name_)) {
+        name_(std::move(other.name_)),
+        work_stealing_(other.work_stealing_),
+        next_deque_(0),
+        parked_workers_(0),
+        queued_tasks_(0),
+        next_deadline_(std::numeric_limits<int64_t>::max()) {
     current_workers_ = 0;
     task_count_ = 0;
   }
@@ -265,6 +283,13 @@ class ThreadPool {
    */
   void stopTasks(const std::string &identifier);
 
+  /**
+   * Returns whether tasks are run by work stealing workers.
+   */
+  bool isWorkStealing() const {
+    return work_stealing_;
+  }
+
   /**
    * Returns true if a task is running.
    */
@@ -335,6 +360,12 @@ class ThreadPool {
     thread_manager_ = std::move(other.thread_manager_);
 
     adjust_threads_ = false;
+    work_stealing_ = other.work_stealing_;
+    {
+      std::lock_guard<std::mutex> timer_lock(timer_mutex_);
+      timer_queue_ = std::move(other.timer_queue_);
+      next_deadline_ = timer_queue_.empty() ? std::numeric_limits<int64_t>::max() : timer_queue_.begin()->first.time_since_epoch().count();
+    }
 
     if (!running_) {
       start();
@@ -358,8 +389,15 @@ class ThreadPool {
   void drain() {
     while (current_workers_ > 0) {
       tasks_available_.notify_one();
+      timer_available_.notify_all();
     }
   }
+
+  // Deque of tasks owned by a work stealing worker
+  struct WorkerDeque {
+    std::mutex mutex_;
+    std::deque<Worker<T>> tasks_;
+  };
 // determines if threads are detached
   bool daemon_threads_;
   std::atomic<int> thread_reduction_count_;
@@ -395,6 +433,24 @@ class ThreadPool {
   std::mutex worker_queue_mutex_;
   // thread pool name
   std::string name_;
+  // whether workers run tasks from their own deques and steal from each other
+  bool work_stealing_;
+  // per worker deques of runnable tasks, only resized while no workers run
+  std::vector<std::unique_ptr<WorkerDeque>> worker_deques_;
+  // deque handed to the next worker thread
+  std::atomic<uint32_t> next_deque_;
+  // guards timer_queue_ and is held by workers before they park
+  std::mutex timer_mutex_;
+  // notification for parked work stealing workers
+  std::condition_variable timer_available_;
+  // tasks waiting to run, ordered by the deadline after which they may run
+  std::multimap<std::chrono::steady_clock::time_point, Worker<T>> timer_queue_;
+  // workers waiting for work
+  std::atomic<int> parked_workers_;
+  // tasks in worker deques
+  std::atomic<int> queued_tasks_;
+  // earliest deadline in timer_queue_ in steady clock ticks, so workers can check it without locking
+  std::atomic<int64_t> next_deadline_;
 
   /**
    * Call for the manager to start worker threads
@@ -410,6 +466,31 @@ class ThreadPool {
    * Runs worker tasks
    */
   void run_tasks(std::shared_ptr<WorkerThread> thread);
+
+  /**
+   * Runs worker tasks from the deque at index, stealing from other deques when it is empty.
+   */
+  void run_work_stealing_tasks(std::shared_ptr<WorkerThread> thread, size_t index);
+
+  /**
+   * Queues a task that may run once the deadline has passed. Requires timer_mutex_.
+   */
+  void schedule_timer(std::chrono::steady_clock::time_point deadline, Worker<T> &&task);
+
+  /**
+   * Takes the task with the earliest deadline if it is due. Requires timer_mutex_.
+   */
+  bool pop_due_timer(Worker<T> &task);
+
+  /**
+   * Queues a runnable task onto the deque at index, waking a parked worker if there is one.
+   */
+  void push_task(size_t index, Worker<T> &&task);
+
+  /**
+   * Takes a task from the deque at index or, failing that, from the deque of another worker.
+   */
+  bool pop_task(size_t index, Worker<T> &task);
 };
 
 template<typename T>
@@ -419,9 +500,16 @@ bool ThreadPool<T>::execute(Worker<T> &&task, std::future<T> &future) {
     task_status_[task.getIdentifier()] = true;
   }
   future = std::move(task.getPromise()->get_future());
-  bool enqueued = worker_queue_.enqueue(std::move(task));
-  if (running_) {
-    tasks_available_.notify_one();
+  bool enqueued = true;
+  if (work_stealing_) {
+    // new tasks are due immediately, whichever worker parks on the timer queue first picks them up
+    std::lock_guard<std::mutex> lock(timer_mutex_);
+    schedule_timer(std::chrono::steady_clock::now(), std::move(task));
+  } else {
+    enqueued = worker_queue_.enqueue(std::move(task));
+    if (running_) {
+      tasks_available_.notify_one();
+    }
   }
 
   task_count_++;
@@ -490,6 +578,10 @@ void ThreadPool<T>::manageWorkers() {
 }
 template<typename T>
 void ThreadPool<T>::run_tasks(std::shared_ptr<WorkerThread> thread) {
+  if (work_stealing_) {
+    run_work_stealing_tasks(thread, next_deque_++ % worker_deques_.size());
+    return;
+  }
   auto waitperiod = std::chrono::milliseconds(1) * 100;
   thread->is_running_ = true;
   uint64_t wait_decay_ = 0;
@@ -602,6 +694,128 @@ void ThreadPool<T>::run_tasks(std::shared_ptr<WorkerThread> thread) {
   }
   current_workers_--;
 }
+template<typename T>
+void ThreadPool<T>::run_work_stealing_tasks(std::shared_ptr<WorkerThread> thread, size_t index) {
+  thread->is_running_ = true;
+  while (running_.load()) {
+    if (UNLIKELY(thread_reduction_count_ > 0)) {
+      if (--thread_reduction_count_ >= 0) {
+        deceased_thread_queue_.enqueue(thread);
+        thread->is_running_ = false;
+        break;
+      } else {
+        thread_reduction_count_++;
+      }
+    }
+    Worker<T> task;
+    bool found = false;
+    // due timers go first so that tasks which are always runnable cannot starve them
+    if (std::chrono::steady_clock::now().time_since_epoch().count() >= next_deadline_.load()) {
+      std::lock_guard<std::mutex> lock(timer_mutex_);
+      found = pop_due_timer(task);
+    }
+    if (!found) {
+      found = pop_task(index, task);
+    }
+    if (!found) {
+      std::unique_lock<std::mutex> lock(timer_mutex_);
+      found = pop_due_timer(task);
+      if (!found) {
+        // a task queued after pop_task sees either a parked worker to wake or queued_tasks_ above zero
+        parked_workers_++;
+        if (queued_tasks_ == 0 && running_) {
+          if (timer_queue_.empty()) {
+            timer_available_.wait(lock);
+          } else {
+            timer_available_.wait_until(lock, timer_queue_.begin()->first);
+          }
+        }
+        parked_workers_--;
+        continue;
+      }
+    }
+    {
+      std::unique_lock<std::mutex> lock(worker_queue_mutex_);
+      if (!task_status_[task.getIdentifier()]) {
+        continue;
+      }
+    }
+    if (task.run()) {
+      uint64_t wait_time = task.getWaitTime();
+      if (wait_time > 0) {
+        std::lock_guard<std::mutex> lock(timer_mutex_);
+        schedule_timer(std::chrono::steady_clock::now() + std::chrono::milliseconds(wait_time), std::move(task));
+      } else {
+        push_task(index, std::move(task));
+      }
+    }
+  }
+  current_workers_--;
+}
+
+template<typename T>
+void ThreadPool<T>::schedule_timer(std::chrono::steady_clock::time_point deadline, Worker<T> &&task) {
+  bool earliest = timer_queue_.empty() || deadline < timer_queue_.begin()->first;
+  timer_queue_.emplace(deadline, std::move(task));
+  if (earliest) {
+    next_deadline_ = deadline.time_since_epoch().count();
+    // parked workers wait for the previous earliest deadline
+    timer_available_.notify_one();
+  }
+}
+
+template<typename T>
+bool ThreadPool<T>::pop_due_timer(Worker<T> &task) {
+  if (timer_queue_.empty() || timer_queue_.begin()->first > std::chrono::steady_clock::now()) {
+    return false;
+  }
+  task = std::move(timer_queue_.begin()->second);
+  timer_queue_.erase(timer_queue_.begin());
+  next_deadline_ = timer_queue_.empty() ? std::numeric_limits<int64_t>::max() : timer_queue_.begin()->first.time_since_epoch().count();
+  // more tasks may be due, which a parked worker can run
+  if (!timer_queue_.empty() && parked_workers_ > 0) {
+    timer_available_.notify_one();
+  }
+  return true;
+}
+
+template<typename T>
+void ThreadPool<T>::push_task(size_t index, Worker<T> &&task) {
+  {
+    std::lock_guard<std::mutex> lock(worker_deques_[index]->mutex_);
+    worker_deques_[index]->tasks_.push_back(std::move(task));
+  }
+  queued_tasks_++;
+  if (parked_workers_ > 0) {
+    std::lock_guard<std::mutex> lock(timer_mutex_);
+    timer_available_.notify_one();
+  }
+}
+
+template<typename T>
+bool ThreadPool<T>::pop_task(size_t index, Worker<T> &task) {
+  if (queued_tasks_ == 0) {
+    return false;
+  }
+  // the owner runs its tasks in order while thieves take the most recently queued task
+  for (size_t i = 0; i < worker_deques_.size(); i++) {
+    WorkerDeque &deque = *worker_deques_[(index + i) % worker_deques_.size()];
+    std::lock_guard<std::mutex> lock(deque.mutex_);
+    if (!deque.tasks_.empty()) {
+      if (i == 0) {
+        task = std::move(deque.tasks_.front());
+        deque.tasks_.pop_front();
+      } else {
+        task = std::move(deque.tasks_.back());
+        deque.tasks_.pop_back();
+      }
+      queued_tasks_--;
+      return true;
+    }
+  }
+  return false;
+}
+
 template<typename T>
 void ThreadPool<T>::start() {
   if (nullptr != controller_service_provider_) {
@@ -612,6 +826,14 @@ void ThreadPool<T>::start() {
   }
   std::lock_guard<std::recursive_mutex> lock(manager_mutex_);
   if (!running_) {
+    if (work_stealing_) {
+      worker_deques_.clear();
+      for (int i = 0; i < (std::max)(max_worker_threads_, 1); i++) {
+        worker_deques_.emplace_back(new WorkerDeque());
+      }
+      queued_tasks_ = 0;
+      next_deque_ = 0;
+    }
     running_ = true;
     manager_thread_ = std::move(std::thread(&ThreadPool::manageWorkers, this));
     if (worker_queue_.size_approx() > 0) {
@@ -649,6 +871,15 @@ void ThreadPool<T>::shutdown() {
         worker_queue_.try_dequeue(task);
       }
     }
+    if (work_stealing_) {
+      std::lock_guard<std::mutex> lock(timer_mutex_);
+      timer_queue_.clear();
+      next_deadline_ = std::numeric_limits<int64_t>::max();
+      for (auto &deque : worker_deques_) {
+        deque->tasks_.clear();
+      }
+      queued_tasks_ = 0;
+    }
   }
 }
 
@@ -17,8 +17,11 @@
 #ifndef LIBMINIFI_INCLUDE_UTILS_FILEUTILS_H_
 #define LIBMINIFI_INCLUDE_UTILS_FILEUTILS_H_
 
+#include <algorithm>
 #include <sstream>
 #include <fstream>
+#include <limits>
+#include <vector>
 #ifdef BOOST_VERSION
 #include <boost/filesystem.hpp>
 #else
@@ -45,6 +48,11 @@
 #include <unistd.h>
 #endif
 #include <fcntl.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
 #ifdef WIN32
 #include <direct.h>
 #include "utils/Id.h"
@@ -68,6 +76,10 @@
 #define S_ISDIR(mode)  (((mode) & S_IFMT) == S_IFDIR)
 #endif
 
+#if defined(__linux__) && !defined(FICLONE)
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+
 
 namespace org {
 namespace apache {
@@ -321,6 +333,105 @@ class FileUtils {
     return 0;
   }
 
+  /**
+   * Copies up to length bytes of the source file starting at offset into the destination, which
+   * is created or truncated. On Linux the data does not pass through user space: the file is
+   * cloned when all of it is copied on a file system that shares extents, then
+   * copy_file_range and sendfile are tried before falling back to a read/write loop.
+   * @param source file to copy from
+   * @param offset offset in the source to start copying from
+   * @param length number of bytes to copy, the copy ends early at the end of the source. Only a copy
+   * from offset 0 with the maximum length, which takes whatever the source holds, is cloned: the
+   * source may still grow, so a bounded range is never taken from a clone of it
+   * @param dest file to copy to
+   * @return number of bytes copied or -1 if the copy failed
+   */
+  static int64_t copy_range(const std::string &source, uint64_t offset, uint64_t length, const std::string &dest) {
+#ifdef WIN32
+    std::ifstream src(source, std::ios::binary);
+    if (!src.is_open())
+      return -1;
+    std::ofstream out(dest, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+      return -1;
+    src.seekg(offset);
+    std::vector<char> buffer(8192);
+    uint64_t copied = 0;
+    while (copied < length && src.good()) {
+      src.read(buffer.data(), (std::min)(static_cast<uint64_t>(buffer.size()), length - copied));
+      out.write(buffer.data(), src.gcount());
+      copied += src.gcount();
+    }
+    out.close();
+    return out.good() ? static_cast<int64_t>(copied) : -1;
+#else
+    int in = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0)
+      return -1;
+    int out = open(dest.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (out < 0) {
+      close(in);
+      return -1;
+    }
+    uint64_t copied = 0;
+    bool failed = false;
+#ifdef __linux__
+    // largest single copy the kernel performs
+    const uint64_t max_kernel_copy = 0x7ffff000;
+    // each method stops at the end of the source or when the file systems do not support it
+    struct stat clone_stat;
+    if (offset == 0 && length == std::numeric_limits<uint64_t>::max() && ioctl(out, FICLONE, in) == 0 && fstat(out, &clone_stat) == 0) {
+      // the clone holds the source as it was when cloned, anything appended later is not copied
+      copied = clone_stat.st_size;
+      lseek(out, copied, SEEK_SET);
+      length = copied;
+    }
+#ifdef SYS_copy_file_range
+    while (copied < length) {
+      loff_t in_offset = offset + copied;
+      ssize_t ret = syscall(SYS_copy_file_range, in, &in_offset, out, nullptr, static_cast<size_t>((std::min)(length - copied, max_kernel_copy)), 0);
+      if (ret <= 0)
+        break;
+      copied += ret;
+    }
+#endif
+    while (copied < length) {
+      off_t in_offset = offset + copied;
+      ssize_t ret = sendfile(out, in, &in_offset, static_cast<size_t>((std::min)(length - copied, max_kernel_copy)));
+      if (ret <= 0)
+        break;
+      copied += ret;
+    }
+#endif
+    std::vector<uint8_t> buffer(65536);
+    while (copied < length && !failed) {
+      ssize_t ret = pread(in, buffer.data(), static_cast<size_t>((std::min)(static_cast<uint64_t>(buffer.size()), length - copied)), offset + copied);
+      if (ret < 0 && errno == EINTR)
+        continue;
+      if (ret <= 0) {
+        failed = ret < 0;
+        break;
+      }
+      ssize_t written = 0;
+      while (written < ret) {
+        ssize_t write_ret = write(out, buffer.data() + written, ret - written);
+        if (write_ret < 0 && errno == EINTR)
+          continue;
+        if (write_ret <= 0) {
+          failed = true;
+          break;
+        }
+        written += write_ret;
+      }
+      copied += written;
+    }
+    close(in);
+    if (close(out) != 0)
+      failed = true;
+    return failed ? -1 : static_cast<int64_t>(copied);
+#endif
+  }
+
   static void addFilesMatchingExtension(const std::shared_ptr<logging::Logger> &logger, const std::string &originalPath, const std::string &extension, std::vector<std::string> &accruedFiles) {
 #ifndef WIN32
 
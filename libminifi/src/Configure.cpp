@@ -28,6 +28,7 @@ const char *Configure::nifi_flow_configuration_file = "nifi.flow.configuration.f
 const char *Configure::nifi_flow_configuration_file_exit_failure = "nifi.flow.configuration.file.exit.onfailure";
 const char *Configure::nifi_flow_configuration_file_backup_update = "nifi.flow.configuration.backup.on.update";
 const char *Configure::nifi_flow_engine_threads = "nifi.flow.engine.threads";
+const char *Configure::nifi_flow_engine_work_stealing = "nifi.flow.engine.work.stealing";
 const char *Configure::nifi_administrative_yield_duration = "nifi.administrative.yield.duration";
 const char *Configure::nifi_bored_yield_duration = "nifi.bored.yield.duration";
 const char *Configure::nifi_graceful_shutdown_seconds = "nifi.flowcontroller.graceful.shutdown.period";
@@ -43,10 +44,20 @@ const char *Configure::nifi_server_report_interval = "nifi.server.report.interva
 const char *Configure::nifi_provenance_repository_max_storage_size = "nifi.provenance.repository.max.storage.size";
 const char *Configure::nifi_provenance_repository_max_storage_time = "nifi.provenance.repository.max.storage.time";
 const char *Configure::nifi_provenance_repository_directory_default = "nifi.provenance.repository.directory.default";
+const char *Configure::nifi_provenance_policy = "nifi.provenance.policy";
+const char *Configure::nifi_provenance_policy_sample_interval = "nifi.provenance.policy.sample.interval";
+const char *Configure::nifi_provenance_policy_aggregation_window = "nifi.provenance.policy.aggregation.window";
+const char *Configure::nifi_provenance_policy_component = "nifi.provenance.policy.component.";
+const char *Configure::nifi_provenance_policy_event = "nifi.provenance.policy.event.";
 const char *Configure::nifi_flowfile_repository_max_storage_size = "nifi.flowfile.repository.max.storage.size";
 const char *Configure::nifi_flowfile_repository_max_storage_time = "nifi.flowfile.repository.max.storage.time";
 const char *Configure::nifi_flowfile_repository_directory_default = "nifi.flowfile.repository.directory.default";
+const char *Configure::nifi_flowfile_repository_sync_policy = "nifi.flowfile.repository.sync.policy";
+const char *Configure::nifi_flowfile_swap_directory_default = "nifi.flowfile.swap.directory.default";
 const char *Configure::nifi_dbcontent_repository_directory_default = "nifi.database.content.repository.directory.default";
+const char *Configure::nifi_dbcontent_repository_chunk_size = "nifi.database.content.repository.chunk.size";
+const char *Configure::nifi_content_claim_max_appendable_size = "nifi.content.claim.max.appendable.size";
+const char *Configure::nifi_content_claim_max_flow_files = "nifi.content.claim.max.flow.files";
 const char *Configure::nifi_remote_input_secure = "nifi.remote.input.secure";
 const char *Configure::nifi_remote_input_http = "nifi.remote.input.http.enabled";
 const char *Configure::nifi_security_need_ClientAuth = "nifi.security.need.ClientAuth";
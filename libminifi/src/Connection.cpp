@@ -28,9 +28,12 @@
 #include <chrono>
 #include <thread>
 #include <iostream>
+#include <utility>
 #include "core/FlowFile.h"
+#include "FlowFileRecord.h"
 #include "Connection.h"
 #include "core/Processor.h"
+#include "core/SwappingFlowFileQueue.h"
 #include "core/logging/LoggerConfiguration.h"
 
 namespace org {
@@ -49,6 +52,11 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   max_data_queue_size_ = 0;
   expired_duration_ = 0;
   queued_data_size_ = 0;
+  queued_count_ = 0;
+  penalized_count_ = 0;
+  next_penalty_expiration_ = 0;
+  swap_threshold_ = 0;
+  queue_ = core::FlowFileQueue::create("");
 
   logger_->log_debug("Connection %s created", name_);
 }
@@ -64,6 +72,11 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   max_data_queue_size_ = 0;
   expired_duration_ = 0;
   queued_data_size_ = 0;
+  queued_count_ = 0;
+  penalized_count_ = 0;
+  next_penalty_expiration_ = 0;
+  swap_threshold_ = 0;
+  queue_ = core::FlowFileQueue::create("");
 
   logger_->log_debug("Connection %s created", name_);
 }
@@ -83,6 +96,11 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   max_data_queue_size_ = 0;
   expired_duration_ = 0;
   queued_data_size_ = 0;
+  queued_count_ = 0;
+  penalized_count_ = 0;
+  next_penalty_expiration_ = 0;
+  swap_threshold_ = 0;
+  queue_ = core::FlowFileQueue::create("");
 
   logger_->log_debug("Connection %s created", name_);
 }
@@ -103,24 +121,25 @@ Connection::Connection(const std::shared_ptr<core::Repository> &flow_repository,
   max_data_queue_size_ = 0;
   expired_duration_ = 0;
   queued_data_size_ = 0;
+  queued_count_ = 0;
+  penalized_count_ = 0;
+  next_penalty_expiration_ = 0;
+  swap_threshold_ = 0;
+  queue_ = core::FlowFileQueue::create("");
 
   logger_->log_debug("Connection %s created", name_);
 }
 
 bool Connection::isEmpty() {
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  return queue_.empty();
+  return queued_count_ == 0;
 }
 
 bool Connection::isFull() {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   if (max_queue_size_ <= 0 && max_data_queue_size_ <= 0)
     // No back pressure setting
     return false;
 
-  if (max_queue_size_ > 0 && queue_.size() >= max_queue_size_)
+  if (max_queue_size_ > 0 && queued_count_ >= max_queue_size_)
     return true;
 
   if (max_data_queue_size_ > 0 && queued_data_size_ >= max_data_queue_size_)
@@ -129,17 +148,81 @@ bool Connection::isFull() {
   return false;
 }
 
-void Connection::put(std::shared_ptr<core::FlowFile> flow) {
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool Connection::setQueueType(const std::string &queue_type) {
+  if (nullptr == core::FlowFileQueue::create(queue_type)) {
+    logger_->log_error("Unknown queue type %s for connection %s", queue_type, name_);
+    return false;
+  }
+  queue_type_ = queue_type;
+  rebuildQueue();
+  return true;
+}
+
+std::string Connection::getQueueType() {
+  return queue_->getName();
+}
 
-    queue_.push(flow);
+void Connection::setPrioritizers(const std::vector<std::shared_ptr<core::FlowFilePrioritizer>> &prioritizers) {
+  prioritizers_ = prioritizers;
+  rebuildQueue();
+}
 
-    queued_data_size_ += flow->getSize();
+void Connection::setSwapThreshold(uint64_t swap_threshold, const std::string &directory) {
+  swap_threshold_ = swap_threshold;
+  swap_directory_ = directory;
+  rebuildQueue();
+}
 
-    logger_->log_debug("Enqueue flow file UUID %s to connection %s", flow->getUUIDStr(), name_);
+void Connection::rebuildQueue() {
+  std::unique_ptr<core::FlowFileQueue> queue;
+  if (prioritizers_.empty()) {
+    queue = core::FlowFileQueue::create(queue_type_);
+  } else {
+    queue = std::unique_ptr<core::FlowFileQueue>(new core::PrioritizedFlowFileQueue(prioritizers_));
+  }
+  if (swap_threshold_ > 0) {
+    queue = std::unique_ptr<core::FlowFileQueue>(new core::SwappingFlowFileQueue(std::move(queue), swap_threshold_, swap_directory_, uuidStr_, flow_repository_, content_repo_));
   }
 
+  std::shared_ptr<core::FlowFile> item;
+  while (queue_->tryPop(item)) {
+    queue->push(item);
+  }
+  queue_ = std::move(queue);
+  logger_->log_debug("Connection %s uses a %s queue", name_, queue_->getName());
+}
+
+void Connection::penalize(const std::shared_ptr<core::FlowFile> &flow) {
+  std::lock_guard<std::mutex> lock(penalized_mutex_);
+  PenalizedFlowFile entry;
+  entry.expiration = flow->getPenaltyExpiration();
+  entry.flow = flow;
+  penalized_.push(std::move(entry));
+  next_penalty_expiration_ = penalized_.top().expiration;
+  penalized_count_++;
+  logger_->log_debug("Flow file UUID %s is penalized on connection %s", flow->getUUIDStr(), name_);
+}
+
+void Connection::releasePenalized() {
+  if (penalized_count_ == 0 || next_penalty_expiration_ > getTimeMillis()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(penalized_mutex_);
+  uint64_t now = getTimeMillis();
+  while (!penalized_.empty() && penalized_.top().expiration <= now) {
+    queue_->push(penalized_.top().flow);
+    penalized_.pop();
+    penalized_count_--;
+  }
+  next_penalty_expiration_ = penalized_.empty() ? 0 : penalized_.top().expiration;
+}
+
+void Connection::put(std::shared_ptr<core::FlowFile> flow) {
+  // account for the flow file before it becomes visible so that a concurrent poll never underflows the counters
+  queued_count_++;
+  queued_data_size_ += flow->getSize();
+
+  // persist the flow file before it becomes visible, the queue may swap it out as soon as it is pushed
   if (!flow->isStored()) {
     // Save to the flowfile repo
     FlowFileRecord event(flow_repository_, content_repo_, flow, this->uuidStr_);
@@ -148,6 +231,10 @@ void Connection::put(std::shared_ptr<core::FlowFile> flow) {
     }
   }
 
+  queue_->push(flow);
+
+  logger_->log_debug("Enqueue flow file UUID %s to connection %s", flow->getUUIDStr(), name_);
+
   // Notify receiving processor that work may be available
   if (dest_connectable_) {
     logger_->log_debug("Notifying %s that %s was inserted", dest_connectable_->getName(), flow->getUUIDStr());
@@ -155,12 +242,38 @@ void Connection::put(std::shared_ptr<core::FlowFile> flow) {
   }
 }
 
-std::shared_ptr<core::FlowFile> Connection::poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
-  std::lock_guard<std::mutex> lock(mutex_);
+void Connection::multiPut(const std::vector<std::shared_ptr<core::FlowFile>> &flows) {
+  if (flows.empty()) {
+    return;
+  }
+  std::vector<std::pair<std::shared_ptr<core::FlowFile>, std::string>> unstored;
+  for (const auto &flow : flows) {
+    if (!flow->isStored()) {
+      unstored.push_back(std::make_pair(flow, this->uuidStr_));
+    }
+  }
+  // Save to the flowfile repo
+  FlowFileRecord::Serialize(flow_repository_, content_repo_, unstored);
 
-  while (!queue_.empty()) {
-    std::shared_ptr<core::FlowFile> item = queue_.front();
-    queue_.pop();
+  for (const auto &flow : flows) {
+    queued_count_++;
+    queued_data_size_ += flow->getSize();
+    queue_->push(flow);
+    logger_->log_debug("Enqueue flow file UUID %s to connection %s", flow->getUUIDStr(), name_);
+  }
+
+  // Notify receiving processor that work may be available
+  if (dest_connectable_) {
+    logger_->log_debug("Notifying %s that %llu flow files were inserted", dest_connectable_->getName(), flows.size());
+    dest_connectable_->notifyWork();
+  }
+}
+
+std::shared_ptr<core::FlowFile> Connection::poll(std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
+  releasePenalized();
+  std::shared_ptr<core::FlowFile> item;
+  while (queue_->tryPop(item)) {
+    queued_count_--;
     queued_data_size_ -= item->getSize();
 
     if (expired_duration_ > 0) {
@@ -169,52 +282,86 @@ std::shared_ptr<core::FlowFile> Connection::poll(std::set<std::shared_ptr<core::
         // Flow record expired
         expiredFlowRecords.insert(item);
         logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
-        if (flow_repository_->Delete(item->getUUIDStr())) {
+        if (flow_repository_->Delete(item->getUUIDStr(), item->getResourceClaim())) {
           item->setStoredToRepository(false);
         }
-      } else {
-        // Flow record not expired
-        if (item->isPenalized()) {
-          // Flow record was penalized
-          queue_.push(item);
-          queued_data_size_ += item->getSize();
-          break;
-        }
-        std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
-        item->setOriginalConnection(connectable);
-        logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
-        return item;
+        continue;
       }
-    } else {
-      // Flow record not expired
-      if (item->isPenalized()) {
-        // Flow record was penalized
-        queue_.push(item);
-        queued_data_size_ += item->getSize();
-        break;
-      }
-      std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
-      item->setOriginalConnection(connectable);
-      logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
-      return item;
     }
+    // Flow record not expired
+    if (item->isPenalized()) {
+      // Flow record was penalized
+      queued_count_++;
+      queued_data_size_ += item->getSize();
+      penalize(item);
+      continue;
+    }
+    std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
+    item->setOriginalConnection(connectable);
+    logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
+    return item;
   }
 
   return NULL;
 }
 
-void Connection::drain() {
-  std::lock_guard<std::mutex> lock(mutex_);
+size_t Connection::poll(std::vector<std::shared_ptr<core::FlowFile>> &flows, size_t max_count, uint64_t max_bytes, std::set<std::shared_ptr<core::FlowFile>> &expiredFlowRecords) {
+  releasePenalized();
+  std::vector<std::shared_ptr<core::FlowFile>> items;
+  if (max_count == 0 || queue_->tryPopBulk(items, max_count, max_bytes) == 0) {
+    return 0;
+  }
+
+  std::shared_ptr<Connectable> connectable = std::static_pointer_cast<Connectable>(shared_from_this());
+  uint64_t now = getTimeMillis();
+  size_t polled = 0;
+  for (auto &item : items) {
+    queued_count_--;
+    queued_data_size_ -= item->getSize();
 
-  while (!queue_.empty()) {
-    std::shared_ptr<core::FlowFile> item = queue_.front();
-    queue_.pop();
+    if (expired_duration_ > 0 && now > (item->getEntryDate() + expired_duration_)) {
+      // Flow record expired
+      expiredFlowRecords.insert(item);
+      logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
+      if (flow_repository_->Delete(item->getUUIDStr(), item->getResourceClaim())) {
+        item->setStoredToRepository(false);
+      }
+      continue;
+    }
+    if (item->isPenalized()) {
+      // Flow record was penalized
+      queued_count_++;
+      queued_data_size_ += item->getSize();
+      penalize(item);
+      continue;
+    }
+    item->setOriginalConnection(connectable);
+    logger_->log_debug("Dequeue flow file UUID %s from connection %s", item->getUUIDStr(), name_);
+    flows.push_back(item);
+    polled++;
+  }
+  return polled;
+}
+
+void Connection::drain() {
+  {
+    std::lock_guard<std::mutex> lock(penalized_mutex_);
+    while (!penalized_.empty()) {
+      queue_->push(penalized_.top().flow);
+      penalized_.pop();
+    }
+    penalized_count_ = 0;
+    next_penalty_expiration_ = 0;
+  }
+  std::shared_ptr<core::FlowFile> item;
+  while (queue_->tryPop(item)) {
+    queued_count_--;
+    queued_data_size_ -= item->getSize();
     logger_->log_debug("Delete flow file UUID %s from connection %s, because it expired", item->getUUIDStr(), name_);
-    if (flow_repository_->Delete(item->getUUIDStr())) {
+    if (flow_repository_->Delete(item->getUUIDStr(), item->getResourceClaim())) {
       item->setStoredToRepository(false);
     }
   }
-  queued_data_size_ = 0;
   logger_->log_debug("Drain connection %s", name_);
 }
 
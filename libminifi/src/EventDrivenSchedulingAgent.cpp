@@ -19,6 +19,7 @@
  */
 #include "EventDrivenSchedulingAgent.h"
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <thread>
 #include <iostream>
@@ -32,28 +33,117 @@ namespace apache {
 namespace nifi {
 namespace minifi {
 
+constexpr uint64_t TriggerMonitor::Idle;
+constexpr uint64_t EventDrivenSchedulingAgent::TriggerWhenEmptyWaitMsec;
+
 uint64_t EventDrivenSchedulingAgent::run(const std::shared_ptr<core::Processor> &processor, const std::shared_ptr<core::ProcessContext> &processContext,
                                          const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
-  while (this->running_) {
-    bool shouldYield = this->onTrigger(processor, processContext, sessionFactory);
-
-    if (processor->isYield()) {
-      // Honor the yield
-      return processor->getYieldTime();
-    } else if (shouldYield && this->bored_yield_duration_ > 0) {
-      // No work to do or need to apply back pressure
-      return this->bored_yield_duration_;
-    }
+  bool shouldYield = this->onTrigger(processor, processContext, sessionFactory);
 
-    // Block until work is available
+  if (processor->isYield()) {
+    // Honor the yield
+    return processor->getYieldTime();
+  } else if (shouldYield && this->bored_yield_duration_ > 0) {
+    // No work to do or need to apply back pressure
+    return this->bored_yield_duration_;
+  }
+  return 0;
+}
 
-    processor->waitForWork(1000);
+void EventDrivenSchedulingAgent::submitTasks(const std::shared_ptr<core::Processor> &processor, const std::shared_ptr<core::ProcessContext> &processContext,
+                                             const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
+  std::shared_ptr<TriggerState> state = std::make_shared<TriggerState>();
+  state->processor = processor;
+  state->context = processContext;
+  state->session_factory = sessionFactory;
+  state->tasks = 0;
+  state->stopped = false;
+  state->max_tasks = processor->getMaxConcurrentTasks() > 0 ? processor->getMaxConcurrentTasks() : 1;
+  for (int i = 0; i < processor->getMaxConcurrentTasks(); i++) {
+    processor->incrementActiveTasks();
+  }
+  {
+    std::lock_guard<std::mutex> lock(trigger_states_mutex_);
+    trigger_states_[processor->getUUIDStr()] = state;
+  }
 
-    if (!processor->isWorkAvailable()) {
-      return 1000;
+  EventDrivenSchedulingAgent *agent = this;
+  processor->setWorkNotifier([agent, state]() {
+    if (!state->stopped && acquireTask(*state)) {
+      agent->submitTrigger(state);
+    }
+  });
+  // flow files queued before the processor was scheduled never notified it
+  acquireTask(*state);
+  submitTrigger(state);
+  logger_->log_debug("Scheduled %s to be triggered by incoming flow files with %d concurrent tasks", processor->getName(), state->max_tasks);
+}
+
+void EventDrivenSchedulingAgent::unschedule(std::shared_ptr<core::Processor> processor) {
+  processor->setWorkNotifier(nullptr);
+  std::shared_ptr<TriggerState> state;
+  {
+    std::lock_guard<std::mutex> lock(trigger_states_mutex_);
+    auto it = trigger_states_.find(processor->getUUIDStr());
+    if (it != trigger_states_.end()) {
+      state = it->second;
+      trigger_states_.erase(it);
     }
   }
-  return 0;
+  if (state != nullptr) {
+    // a notifier copied before it was cleared may still be running, it must not submit past this point
+    std::lock_guard<std::mutex> lock(state->submit_mutex);
+    state->stopped = true;
+  }
+  ThreadedSchedulingAgent::unschedule(processor);
+}
+
+bool EventDrivenSchedulingAgent::acquireTask(TriggerState &state) {
+  int tasks = state.tasks.load();
+  while (tasks < state.max_tasks) {
+    if (state.tasks.compare_exchange_weak(tasks, tasks + 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void EventDrivenSchedulingAgent::submitTrigger(const std::shared_ptr<TriggerState> &state) {
+  std::lock_guard<std::mutex> lock(state->submit_mutex);
+  if (state->stopped) {
+    // submitting would re-enable the tasks of the unscheduled processor in the thread pool
+    state->tasks--;
+    return;
+  }
+  EventDrivenSchedulingAgent *agent = this;
+  std::function<uint64_t()> f_ex = [agent, state]() {
+    return agent->trigger(state);
+  };
+  std::unique_ptr<TriggerMonitor> monitor = std::unique_ptr<TriggerMonitor>(new TriggerMonitor(&running_));
+  utils::Worker<uint64_t> functor(f_ex, state->processor->getUUIDStr(), std::move(monitor));
+  std::future<uint64_t> future;
+  thread_pool_.execute(std::move(functor), future);
+}
+
+uint64_t EventDrivenSchedulingAgent::trigger(const std::shared_ptr<TriggerState> &state) {
+  const std::shared_ptr<core::Processor> &processor = state->processor;
+  if (state->stopped) {
+    state->tasks--;
+    return TriggerMonitor::Idle;
+  }
+  uint64_t wait = run(processor, state->context, state->session_factory);
+  if (wait > 0 || processor->isWorkAvailable()) {
+    return wait;
+  }
+  if (!processor->hasIncomingConnections() || processor->getTriggerWhenEmpty()) {
+    return TriggerWhenEmptyWaitMsec;
+  }
+  state->tasks--;
+  // a flow file queued while every task was taken relies on this task to notice it
+  if (processor->isWorkAvailable() && acquireTask(*state)) {
+    return 0;
+  }
+  return TriggerMonitor::Idle;
 }
 
 } /* namespace minifi */
@@ -40,6 +40,7 @@
 #include "core/state/nodes/QueueMetrics.h"
 #include "core/state/nodes/RepositoryMetrics.h"
 #include "core/state/nodes/SystemMetrics.h"
+#include "provenance/ProvenancePolicy.h"
 #include "core/state/ProcessorController.h"
 #include "yaml-cpp/yaml.h"
 #include "c2/C2Agent.h"
@@ -102,6 +103,12 @@ FlowController::FlowController(std::shared_ptr<core::Repository> provenance_repo
   id_generator_->generate(uuid_);
   setUUID(uuid_);
 
+  // events are only filtered when the configuration does not store all of them
+  std::shared_ptr<provenance::ProvenancePolicy> provenance_policy = std::make_shared<provenance::ProvenancePolicy>(configure);
+  if (provenance_policy->isSelective()) {
+    provenance_repo_->setProvenancePolicy(provenance_policy);
+  }
+
   flow_update_ = false;
   // Setup the default values
   if (flow_configuration_ != nullptr) {
@@ -25,6 +25,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <iostream>
 #include <fstream>
 #include "core/logging/LoggerConfiguration.h"
@@ -39,6 +40,23 @@ namespace minifi {
 std::shared_ptr<logging::Logger> FlowFileRecord::logger_ = logging::LoggerFactory<FlowFileRecord>::getLogger();
 std::atomic<uint64_t> FlowFileRecord::local_flow_seq_number_(0);
 
+uint8_t FlowFileRecord::getDictionaryIndex(const core::AttributeKey *key) {
+  static const std::vector<const core::AttributeKey*> dictionary = [] {
+    std::vector<const core::AttributeKey*> keys;
+    for (int i = 0; i < MAX_FLOW_ATTRIBUTES; i++) {
+      keys.push_back(core::AttributeKeyRegistry::getInstance().intern(FlowAttributeKeyArray[i]));
+    }
+    return keys;
+  }();
+  // a key the registry had no room for matches no entry and is written by name
+  for (size_t i = 0; i < dictionary.size(); i++) {
+    if (dictionary[i] == key) {
+      return static_cast<uint8_t>(i + 1);
+    }
+  }
+  return 0;
+}
+
 FlowFileRecord::FlowFileRecord(std::shared_ptr<core::Repository> flow_repository, const std::shared_ptr<core::ContentRepository> &content_repo, std::map<std::string, std::string> attributes,
                                std::shared_ptr<ResourceClaim> claim)
     : FlowFile(),
@@ -77,7 +95,7 @@ FlowFileRecord::FlowFileRecord(std::shared_ptr<core::Repository> flow_repository
   lineage_start_date_ = event->getlineageStartDate();
   lineage_Identifiers_ = event->getlineageIdentifiers();
   uuidStr_ = event->getUUIDStr();
-  attributes_ = event->getAttributes();
+  attributes_ = event->getAttributeStore();
   size_ = event->getSize();
   offset_ = event->getOffset();
   event->getUUID(uuid_);
@@ -118,8 +136,11 @@ FlowFileRecord::~FlowFileRecord() {
     logger_->log_debug("Delete FlowFile UUID %s", uuidStr_);
   else
     logger_->log_debug("Delete SnapShot FlowFile UUID %s", uuidStr_);
-  if (claim_) {
+  if (claim_ && !isDeleted()) {
     releaseClaim(claim_);
+  } else if (claim_) {
+    // removing the flow file already gave up its reference, the content goes once the delete is flushed
+    logger_->log_debug("Claim of deleted flow file %s was released on removal", uuidStr_);
   } else {
     logger_->log_debug("Claim is null ptr for %s", uuidStr_);
   }
@@ -215,9 +236,7 @@ bool FlowFileRecord::DeSerialize(std::string key) {
   return ret;
 }
 
-bool FlowFileRecord::Serialize() {
-  io::DataStream outStream;
-
+bool FlowFileRecord::Serialize(io::DataStream &outStream) {
   int ret;
 
   ret = write(this->event_time_, &outStream);
@@ -244,19 +263,26 @@ bool FlowFileRecord::Serialize() {
   if (ret <= 0) {
     return false;
   }
-  // write flow attributes
-  uint32_t numAttributes = this->attributes_.size();
+  // write flow attributes, with the keys of the attribute dictionary written as their index
+  uint32_t numAttributes = attributes_.size() | ATTRIBUTE_DICTIONARY_FLAG;
   ret = write(numAttributes, &outStream);
   if (ret != 4) {
     return false;
   }
 
-  for (auto itAttribute : attributes_) {
-    ret = writeUTF(itAttribute.first, &outStream, true);
-    if (ret <= 0) {
+  for (const auto &attribute : attributes_) {
+    uint8_t index = getDictionaryIndex(attribute.key);
+    ret = write(index, &outStream);
+    if (ret != 1) {
       return false;
     }
-    ret = writeUTF(itAttribute.second, &outStream, true);
+    if (index == 0) {
+      ret = writeUTF(attribute.key->name, &outStream, true);
+      if (ret <= 0) {
+        return false;
+      }
+    }
+    ret = writeUTF(attribute.value, &outStream, true);
     if (ret <= 0) {
       return false;
     }
@@ -277,6 +303,16 @@ bool FlowFileRecord::Serialize() {
     return false;
   }
 
+  return true;
+}
+
+bool FlowFileRecord::Serialize() {
+  io::DataStream outStream;
+
+  if (!Serialize(outStream)) {
+    return false;
+  }
+
   if (flow_repository_->Put(uuidStr_, const_cast<uint8_t*>(outStream.getBuffer()), outStream.getSize())) {
     logger_->log_debug("NiFi FlowFile Store event %s size %llu success", uuidStr_, outStream.getSize());
     return true;
@@ -288,6 +324,51 @@ bool FlowFileRecord::Serialize() {
   return true;
 }
 
+bool FlowFileRecord::Serialize(const std::shared_ptr<core::Repository> &flow_repository, const std::shared_ptr<core::ContentRepository> &content_repo,
+                               const std::vector<std::pair<std::shared_ptr<core::FlowFile>, std::string>> &flows) {
+  if (flows.empty()) {
+    return true;
+  }
+  io::DataStream outStream;
+  // the records own references to the resource claims, so they are kept until the entries are stored
+  std::vector<std::unique_ptr<FlowFileRecord>> records;
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+  std::vector<std::shared_ptr<core::FlowFile>> serialized;
+  bool ret = true;
+  for (const auto &flow : flows) {
+    std::shared_ptr<core::FlowFile> flow_file = flow.first;
+    std::unique_ptr<FlowFileRecord> record(new FlowFileRecord(flow_repository, content_repo, flow_file, flow.second));
+    uint64_t offset = outStream.getSize();
+    if (!record->Serialize(outStream)) {
+      logger_->log_error("NiFi FlowFile Store event %s serialization fail", record->getUUIDStr());
+      ret = false;
+      continue;
+    }
+    ranges.push_back(std::make_pair(offset, outStream.getSize() - offset));
+    serialized.push_back(flow_file);
+    records.push_back(std::move(record));
+  }
+
+  std::vector<core::Repository::PutEntry> entries;
+  entries.reserve(records.size());
+  for (size_t i = 0; i < records.size(); i++) {
+    core::Repository::PutEntry entry;
+    entry.key = records[i]->getUUIDStr();
+    entry.buf = outStream.getBuffer() + ranges[i].first;
+    entry.bufLen = ranges[i].second;
+    entries.push_back(std::move(entry));
+  }
+  if (!flow_repository->MultiPut(entries)) {
+    logger_->log_error("NiFi FlowFile Store of %llu events size %llu fail", entries.size(), outStream.getSize());
+    return false;
+  }
+  logger_->log_debug("NiFi FlowFile Store of %llu events size %llu success", entries.size(), outStream.getSize());
+  for (const auto &flow_file : serialized) {
+    flow_file->setStoredToRepository(true);
+  }
+  return ret;
+}
+
 bool FlowFileRecord::DeSerialize(const uint8_t *buffer, const int bufferSize) {
   int ret;
 
@@ -325,18 +406,31 @@ bool FlowFileRecord::DeSerialize(const uint8_t *buffer, const int bufferSize) {
     return false;
   }
 
+  bool dictionary = (numAttributes & ATTRIBUTE_DICTIONARY_FLAG) != 0;
+  numAttributes &= ~ATTRIBUTE_DICTIONARY_FLAG;
   for (uint32_t i = 0; i < numAttributes; i++) {
     std::string key;
-    ret = readUTF(key, &outStream, true);
-    if (ret <= 0) {
-      return false;
+    uint8_t index = 0;
+    if (dictionary) {
+      ret = read(index, &outStream);
+      if (ret != 1 || index > MAX_FLOW_ATTRIBUTES) {
+        return false;
+      }
+    }
+    if (index > 0) {
+      key = FlowAttributeKeyArray[index - 1];
+    } else {
+      ret = readUTF(key, &outStream, true);
+      if (ret <= 0) {
+        return false;
+      }
     }
     std::string value;
     ret = readUTF(value, &outStream, true);
     if (ret <= 0) {
       return false;
     }
-    this->attributes_[key] = value;
+    attributes_.set(key, value);
   }
 
   ret = readUTF(this->content_full_fath_, &outStream);
@@ -356,6 +450,11 @@ bool FlowFileRecord::DeSerialize(const uint8_t *buffer, const int bufferSize) {
 
   if (nullptr == claim_) {
     claim_ = std::make_shared<ResourceClaim>(content_full_fath_, content_repo_, true);
+    if (nullptr != content_repo_ && !content_full_fath_.empty()) {
+      // the restored record owns its claim like any other record, which rebuilds the claim counts
+      // of content shared between flow files, such as containers, after a restart
+      claim_->increaseFlowFileRecordOwnedCount();
+    }
   }
   return true;
 }
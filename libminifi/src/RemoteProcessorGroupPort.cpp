@@ -25,6 +25,8 @@
 #include <cstdint>
 #include <memory>
 #include <deque>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <set>
 #include <vector>
@@ -58,59 +60,151 @@ core::Property RemoteProcessorGroupPort::hostName("Host Name", "Remote Host Name
 core::Property RemoteProcessorGroupPort::SSLContext("SSL Context Service", "The SSL Context Service used to provide client certificate information for TLS/SSL (https) connections.", "");
 core::Property RemoteProcessorGroupPort::port("Port", "Remote Port", "");
 core::Property RemoteProcessorGroupPort::portUUID("Port UUID", "Specifies remote NiFi Port UUID.", "");
+core::Property RemoteProcessorGroupPort::useCompression("Use Compression", "Whether flow files are compressed when they are transferred to or from the remote instance.", "false");
+core::Property RemoteProcessorGroupPort::compressionLevel("Compression Level", "Deflate level, from 0 to 9, of the flow files that are sent compressed.", "1");
+core::Property RemoteProcessorGroupPort::peerRefreshInterval("Peer Refresh Interval", "How often the list of peers, and the flow files each of them holds, is refreshed.", "1 min");
+core::Property RemoteProcessorGroupPort::warmClientsPerPeer("Warm Clients Per Peer", "Number of idle clients kept connected to each peer, so that transactions do not wait "
+                                                            "for a connection and handshake.", "1");
+core::Property RemoteProcessorGroupPort::maxInFlightTransactions("Max In-Flight Transactions", "Number of send transactions each task keeps in flight, each of them with its own "
+                                                                 "connection, so that waiting for the confirmation of a transaction does not hold back the next one.", "1");
+core::Property RemoteProcessorGroupPort::compressionThreshold("Compression Threshold", "Batches of flow files with less content than this size are sent without compression.", "0 B");
 core::Relationship RemoteProcessorGroupPort::relation;
 
-std::unique_ptr<sitetosite::SiteToSiteClient> RemoteProcessorGroupPort::getNextProtocol(bool create = true) {
-  std::unique_ptr<sitetosite::SiteToSiteClient> nextProtocol = nullptr;
-  if (!available_protocols_.try_dequeue(nextProtocol)) {
-    if (create) {
-      // create
-      if (bypass_rest_api_) {
-        if (nifi_instances_.size() > 0) {
-          auto rpg = nifi_instances_.front();
-          auto host = rpg.host_;
+std::unique_ptr<sitetosite::SiteToSiteClient> RemoteProcessorGroupPort::getNextProtocol(std::shared_ptr<sitetosite::Peer> &peer, bool create) {
+  if (bypass_rest_api_) {
+    if (nifi_instances_.empty()) {
+      return nullptr;
+    }
+    peer = getConfiguredPeer();
+  } else {
+    peer = peer_selector_.select(direction_);
+    if (!peer) {
+      if (create) {
+        // the refresh is left to the maintenance thread, as it uses the REST API state of this port
+        logger_->log_debug("Requesting a refresh of the peer list since there are none configured.");
+        requestPeerRefresh();
+      }
+      return nullptr;
+    }
+  }
+  std::unique_ptr<sitetosite::SiteToSiteClient> nextProtocol = client_pool_.take(*peer);
+  if (nextProtocol) {
+    logger_->log_debug("Obtained protocol for %s from the client pool", peer->toString());
+  } else if (create) {
+    logger_->log_debug("Creating client for peer %s", peer->toString());
+    nextProtocol = createProtocol(peer);
+  }
+  return nextProtocol;
+}
+
+std::unique_ptr<sitetosite::SiteToSiteClient> RemoteProcessorGroupPort::createProtocol(const std::shared_ptr<sitetosite::Peer> &peer) {
+  sitetosite::SiteToSiteClientConfiguration config(stream_factory_, peer, this->getInterface(), client_type_);
+  config.setSecurityContext(ssl_service);
+  config.setHTTPProxy(this->proxy_);
+  config.setCompression(use_compression_, compression_level_, compression_threshold_);
+  return sitetosite::createClient(config);
+}
+
+std::shared_ptr<sitetosite::Peer> RemoteProcessorGroupPort::getConfiguredPeer() {
+  auto rpg = nifi_instances_.front();
+  auto host = rpg.host_;
 #ifdef WIN32
-          if ("localhost" == host) {
-            host = org::apache::nifi::minifi::io::Socket::getMyHostName();
-          }
+  if ("localhost" == host) {
+    host = org::apache::nifi::minifi::io::Socket::getMyHostName();
+  }
 #endif
-          sitetosite::SiteToSiteClientConfiguration config(stream_factory_, std::make_shared<sitetosite::Peer>(protocol_uuid_, host, rpg.port_, ssl_service != nullptr), this->getInterface(),
-                                                           client_type_);
-          config.setHTTPProxy(this->proxy_);
-          nextProtocol = sitetosite::createClient(config);
-        }
-      } else if (peer_index_ >= 0) {
-        std::lock_guard<std::mutex> lock(peer_mutex_);
-        logger_->log_debug("Creating client from peer %ll", peer_index_.load());
-        sitetosite::SiteToSiteClientConfiguration config(stream_factory_, peers_[this->peer_index_].getPeer(), local_network_interface_, client_type_);
-        config.setSecurityContext(ssl_service);
-        peer_index_++;
-        if (peer_index_ >= static_cast<int>(peers_.size())) {
-          peer_index_ = 0;
-        }
-        config.setHTTPProxy(this->proxy_);
-        nextProtocol = sitetosite::createClient(config);
-      } else {
-        logger_->log_debug("Refreshing the peer list since there are none configured.");
-        refreshPeerList();
+  return std::make_shared<sitetosite::Peer>(protocol_uuid_, host, rpg.port_, ssl_service != nullptr);
+}
+
+void RemoteProcessorGroupPort::returnProtocol(const std::shared_ptr<sitetosite::Peer> &peer, std::unique_ptr<sitetosite::SiteToSiteClient> return_protocol) {
+  if (!client_pool_.put(*peer, std::move(return_protocol))) {
+    logger_->log_debug("not pooling protocol %s, peer %s has enough idle clients", getUUIDStr(), peer->toString());
+  }
+}
+
+void RemoteProcessorGroupPort::warmClients() {
+  std::vector<std::shared_ptr<sitetosite::Peer>> peers;
+  if (bypass_rest_api_) {
+    if (!nifi_instances_.empty()) {
+      peers.push_back(getConfiguredPeer());
+    }
+  } else {
+    peers = peer_selector_.getPeers();
+  }
+  client_pool_.evict(peers);
+  for (const auto &peer : peers) {
+    if (peer_selector_.isPenalized(*peer)) {
+      continue;
+    }
+    while (transmitting_ && client_pool_.size(*peer) < warm_clients_) {
+      auto client = createProtocol(peer);
+      if (!client || !client->bootstrap()) {
+        logger_->log_debug("Could not connect to peer %s, penalizing it", peer->toString());
+        peer_selector_.penalize(*peer);
+        break;
+      }
+      if (!client_pool_.put(*peer, std::move(client))) {
+        break;
       }
     }
   }
-  logger_->log_debug("Obtained protocol from available_protocols_");
-  return nextProtocol;
 }
 
-void RemoteProcessorGroupPort::returnProtocol(std::unique_ptr<sitetosite::SiteToSiteClient> return_protocol) {
-  auto count = peers_.size();
-  if (max_concurrent_tasks_ > count)
-    count = max_concurrent_tasks_;
-  if (available_protocols_.size_approx() >= count) {
-    logger_->log_debug("not enqueueing protocol %s", getUUIDStr());
-    // let the memory be freed
-    return;
+void RemoteProcessorGroupPort::maintainPeers() {
+  uint64_t last_refresh = getTimeMillis();
+  std::unique_lock<std::mutex> lock(maintenance_mutex_);
+  while (maintaining_) {
+    // idle clients are checked often enough to be replaced before they expire
+    uint64_t period = std::min<uint64_t>(peer_refresh_interval_, sitetosite::SiteToSiteClientPool::DEFAULT_IDLE_EXPIRATION_MILLIS / 2);
+    maintenance_condition_.wait_for(lock, std::chrono::milliseconds(period), [this] {
+      return !maintaining_ || refresh_requested_;
+    });
+    if (!maintaining_) {
+      break;
+    }
+    bool refresh = refresh_requested_;
+    refresh_requested_ = false;
+    lock.unlock();
+    if (!bypass_rest_api_ && (refresh || getTimeMillis() - last_refresh >= peer_refresh_interval_)) {
+      refreshPeerList();
+      last_refresh = getTimeMillis();
+    }
+    warmClients();
+    lock.lock();
+  }
+}
+
+void RemoteProcessorGroupPort::startPeerMaintenance() {
+  std::lock_guard<std::mutex> lock(maintenance_mutex_);
+  maintaining_ = true;
+  refresh_requested_ = false;
+  maintenance_thread_ = std::thread(&RemoteProcessorGroupPort::maintainPeers, this);
+}
+
+void RemoteProcessorGroupPort::stopPeerMaintenance() {
+  {
+    std::lock_guard<std::mutex> lock(maintenance_mutex_);
+    maintaining_ = false;
+  }
+  maintenance_condition_.notify_all();
+  if (maintenance_thread_.joinable()) {
+    maintenance_thread_.join();
+  }
+}
+
+void RemoteProcessorGroupPort::requestPeerRefresh() {
+  {
+    std::lock_guard<std::mutex> lock(maintenance_mutex_);
+    refresh_requested_ = true;
+  }
+  maintenance_condition_.notify_all();
+}
+
+void RemoteProcessorGroupPort::stopTransactionPool() {
+  if (transaction_pool_) {
+    transaction_pool_->shutdown();
+    transaction_pool_ = nullptr;
   }
-  logger_->log_debug("enqueueing protocol %s, have a total of %lu", getUUIDStr(), available_protocols_.size_approx());
-  available_protocols_.enqueue(std::move(return_protocol));
 }
 
 void RemoteProcessorGroupPort::initialize() {
@@ -120,6 +214,12 @@ void RemoteProcessorGroupPort::initialize() {
   properties.insert(port);
   properties.insert(SSLContext);
   properties.insert(portUUID);
+  properties.insert(useCompression);
+  properties.insert(compressionLevel);
+  properties.insert(compressionThreshold);
+  properties.insert(peerRefreshInterval);
+  properties.insert(warmClientsPerPeer);
+  properties.insert(maxInFlightTransactions);
   setSupportedProperties(properties);
 // Set the supported relationships
   std::set<core::Relationship> relationships;
@@ -130,11 +230,27 @@ void RemoteProcessorGroupPort::initialize() {
 }
 
 void RemoteProcessorGroupPort::onSchedule(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
+  stopPeerMaintenance();
   std::string value;
   if (context->getProperty(portUUID.getName(), value) && !value.empty()) {
     protocol_uuid_ = value;
   }
 
+  if (context->getProperty(useCompression.getName(), value)) {
+    utils::StringUtils::StringToBool(value, use_compression_);
+  }
+  int level;
+  if (context->getProperty(compressionLevel.getName(), value) && core::Property::StringToInt(value, level)) {
+    if (level >= Z_NO_COMPRESSION && level <= Z_BEST_COMPRESSION) {
+      compression_level_ = level;
+    } else {
+      logger_->log_warn("Ignoring compression level %d, which is not between 0 and 9", level);
+    }
+  }
+  if (context->getProperty(compressionThreshold.getName(), value)) {
+    core::Property::StringToInt(value, compression_threshold_);
+  }
+
   std::string http_enabled_str;
   if (configure_->get(Configure::nifi_remote_input_http, http_enabled_str)) {
     if (utils::StringUtils::StringToBool(http_enabled_str, http_enabled_)) {
@@ -160,17 +276,38 @@ void RemoteProcessorGroupPort::onSchedule(const std::shared_ptr<core::ProcessCon
     }
   }
 
-  std::lock_guard<std::mutex> lock(peer_mutex_);
+  if (context->getProperty(peerRefreshInterval.getName(), value)) {
+    core::TimeUnit unit;
+    uint64_t interval;
+    if (core::Property::StringToTime(value, interval, unit) && core::Property::ConvertTimeUnitToMS(interval, unit, interval) && interval > 0) {
+      peer_refresh_interval_ = interval;
+    }
+  }
+  if (context->getProperty(warmClientsPerPeer.getName(), value)) {
+    core::Property::StringToInt(value, warm_clients_);
+  }
+  if (context->getProperty(maxInFlightTransactions.getName(), value)) {
+    core::Property::StringToInt(value, max_in_flight_transactions_);
+  }
+  stopTransactionPool();
+  if (direction_ == sitetosite::SEND && max_in_flight_transactions_ > 1) {
+    // the triggering thread runs one of the transactions itself
+    int workers = (max_in_flight_transactions_ - 1) * std::max<int>(max_concurrent_tasks_, 1);
+    transaction_pool_ = std::unique_ptr<utils::ThreadPool<bool>>(new utils::ThreadPool<bool>(workers, false, nullptr, "RPG transactions"));
+    transaction_pool_->start();
+  }
+  // warm clients are kept in the pool, along with the clients of concurrent tasks and their in-flight transactions
+  size_t active_clients = static_cast<size_t>(max_concurrent_tasks_) * std::max<uint32_t>(max_in_flight_transactions_, 1);
+  client_pool_.setMaxIdlePerPeer(std::max<size_t>(std::max<size_t>(warm_clients_, active_clients), 1));
+
   if (!nifi_instances_.empty()) {
     refreshPeerList();
-    if (peers_.size() > 0)
-      peer_index_ = 0;
   }
   /**
    * If at this point we have no peers and HTTP support is disabled this means
    * we must rely on the configured host/port
    */
-  if (peers_.empty() && is_http_disabled()) {
+  if (peer_selector_.empty() && is_http_disabled()) {
     std::string host, portStr;
     int configured_port = -1;
     // place hostname/port into the log message if we have it
@@ -185,29 +322,12 @@ void RemoteProcessorGroupPort::onSchedule(const std::shared_ptr<core::ProcessCon
       throw(Exception(SITE2SITE_EXCEPTION, "HTTPClient not resolvable. No peers configured or any port specific hostname and port -- cannot schedule"));
     }
   }
-  // populate the site2site protocol for load balancing between them
-  if (peers_.size() > 0) {
-    auto count = peers_.size();
-    if (max_concurrent_tasks_ > count)
-      count = max_concurrent_tasks_;
-    for (uint32_t i = 0; i < count; i++) {
-      std::unique_ptr<sitetosite::SiteToSiteClient> nextProtocol = nullptr;
-      sitetosite::SiteToSiteClientConfiguration config(stream_factory_, peers_[this->peer_index_].getPeer(), this->getInterface(), client_type_);
-      config.setSecurityContext(ssl_service);
-      peer_index_++;
-      if (peer_index_ >= static_cast<int>(peers_.size())) {
-        peer_index_ = 0;
-      }
-      logger_->log_trace("Creating client");
-      config.setHTTPProxy(this->proxy_);
-      nextProtocol = sitetosite::createClient(config);
-      logger_->log_trace("Created client, moving into available protocols");
-      returnProtocol(std::move(nextProtocol));
-    }
-  } else {
+  if (peer_selector_.empty() && !bypass_rest_api_) {
     // we don't have any peers
     logger_->log_error("No peers selected during scheduling");
   }
+  // the peer list is refreshed and clients are connected in the background
+  startPeerMaintenance();
 }
 
 void RemoteProcessorGroupPort::notifyStop() {
@@ -216,10 +336,71 @@ void RemoteProcessorGroupPort::notifyStop() {
   // we use the latch
   while (count.getCount() > 0) {
   }
-  std::unique_ptr<sitetosite::SiteToSiteClient> nextProtocol = nullptr;
-  while (available_protocols_.try_dequeue(nextProtocol)) {
-    // clear all protocols now
+  stopPeerMaintenance();
+  stopTransactionPool();
+  client_pool_.clear();
+}
+
+void RemoteProcessorGroupPort::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
+  if (!transaction_pool_) {
+    core::Processor::onTrigger(context, sessionFactory);
+    return;
+  }
+  if (!transmitting_) {
+    return;
+  }
+
+  RPGLatch count;
+
+  // the transactions wait for their confirmations at the same time, rather than each batch waiting for the previous one
+  std::vector<std::future<bool>> transactions;
+  for (uint32_t i = 1; i < max_in_flight_transactions_; i++) {
+    std::function<bool()> f_ex = [this, context, sessionFactory]() {
+      return sendTransaction(context, sessionFactory);
+    };
+    utils::Worker<bool> worker(f_ex, getUUIDStr());
+    std::future<bool> future;
+    if (transaction_pool_->execute(std::move(worker), future)) {
+      transactions.push_back(std::move(future));
+    }
+  }
+  bool sent = sendTransaction(context, sessionFactory);
+  for (auto &transaction : transactions) {
+    if (transaction.get()) {
+      sent = true;
+    }
+  }
+  if (!sent) {
+    context->yield();
+  }
+}
+
+bool RemoteProcessorGroupPort::sendTransaction(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
+  auto session = sessionFactory->createSession();
+  std::shared_ptr<sitetosite::Peer> peer;
+  try {
+    std::unique_ptr<sitetosite::SiteToSiteClient> protocol = getNextProtocol(peer);
+    if (!protocol) {
+      return false;
+    }
+    bool sent = protocol->transfer(sitetosite::SEND, context, session);
+    session->commit();
+    returnProtocol(peer, std::move(protocol));
+    return sent;
+  } catch (const std::exception &exception) {
+    logger_->log_debug("Caught Exception %s during transaction of %s", exception.what(), getUUIDStr());
+  } catch (...) {
+    logger_->log_debug("Caught Exception during transaction of %s", getUUIDStr());
+  }
+  try {
+    session->rollback();
+  } catch (...) {
+    logger_->log_warn("Could not roll back the session of a failed transaction of %s", getUUIDStr());
   }
+  if (peer) {
+    peer_selector_.penalize(*peer);
+  }
+  return false;
 }
 
 void RemoteProcessorGroupPort::onTrigger(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
@@ -235,9 +416,10 @@ void RemoteProcessorGroupPort::onTrigger(const std::shared_ptr<core::ProcessCont
   logger_->log_trace("On trigger %s", getUUIDStr());
 
   std::unique_ptr<sitetosite::SiteToSiteClient> protocol_ = nullptr;
+  std::shared_ptr<sitetosite::Peer> peer;
   try {
     logger_->log_trace("get protocol in on trigger");
-    protocol_ = getNextProtocol();
+    protocol_ = getNextProtocol(peer);
 
     if (!protocol_) {
       logger_->log_info("no protocol, yielding");
@@ -250,7 +432,7 @@ void RemoteProcessorGroupPort::onTrigger(const std::shared_ptr<core::ProcessCont
       context->yield();
     }
 
-    returnProtocol(std::move(protocol_));
+    returnProtocol(peer, std::move(protocol_));
     return;
   } catch (const minifi::Exception &ex2) {
     context->yield();
@@ -259,6 +441,10 @@ void RemoteProcessorGroupPort::onTrigger(const std::shared_ptr<core::ProcessCont
     context->yield();
     session->rollback();
   }
+  // the client is dropped and other peers are preferred for a while
+  if (peer) {
+    peer_selector_.penalize(*peer);
+  }
 }
 
 std::pair<std::string, int> RemoteProcessorGroupPort::refreshRemoteSite2SiteInfo() {
@@ -377,8 +563,7 @@ void RemoteProcessorGroupPort::refreshPeerList() {
     return;
   }
 
-  this->peers_.clear();
-
+  std::vector<sitetosite::PeerStatus> peers;
   std::unique_ptr<sitetosite::SiteToSiteClient> protocol;
   sitetosite::SiteToSiteClientConfiguration config(stream_factory_, std::make_shared<sitetosite::Peer>(protocol_uuid_, connection.first, connection.second, ssl_service != nullptr),
                                                    this->getInterface(), client_type_);
@@ -386,13 +571,11 @@ void RemoteProcessorGroupPort::refreshPeerList() {
   config.setHTTPProxy(this->proxy_);
   protocol = sitetosite::createClient(config);
 
-  if (protocol)
-    protocol->getPeerList(peers_);
-
-  logging::LOG_INFO(logger_) << "Have " << peers_.size() << " peers";
+  if (protocol && protocol->getPeerList(peers)) {
+    peer_selector_.setPeers(peers);
+  }
 
-  if (peers_.size() > 0)
-    peer_index_ = 0;
+  logging::LOG_INFO(logger_) << "Have " << peer_selector_.size() << " peers";
 }
 
 } /* namespace minifi */
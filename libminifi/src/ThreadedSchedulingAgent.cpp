@@ -82,8 +82,11 @@ void ThreadedSchedulingAgent::schedule(std::shared_ptr<core::Processor> processo
 
   processor->onSchedule(processContext, sessionFactory);
 
-  std::vector<std::thread *> threads;
+  submitTasks(processor, processContext, sessionFactory);
+}
 
+void ThreadedSchedulingAgent::submitTasks(const std::shared_ptr<core::Processor> &processor, const std::shared_ptr<core::ProcessContext> &processContext,
+                                          const std::shared_ptr<core::ProcessSessionFactory> &sessionFactory) {
   ThreadedSchedulingAgent *agent = this;
   for (int i = 0; i < processor->getMaxConcurrentTasks(); i++) {
     // reference the disable function from serviceNode
@@ -102,7 +105,6 @@ void ThreadedSchedulingAgent::schedule(std::shared_ptr<core::Processor> processo
     thread_pool_.execute(std::move(functor), future);
   }
   logger_->log_debug("Scheduled thread %d concurrent workers for for process %s", processor->getMaxConcurrentTasks(), processor->getName());
-  return;
 }
 
 void ThreadedSchedulingAgent::stop() {
@@ -143,6 +143,16 @@ void Connectable::notifyWork() {
     return;
   }
 
+  std::shared_ptr<std::function<void()>> notifier;
+  {
+    std::lock_guard<std::mutex> lock(work_available_mutex_);
+    notifier = work_notifier_;
+  }
+  if (nullptr != notifier) {
+    (*notifier)();
+    return;
+  }
+
   {
     has_work_.store(isWorkAvailable());
 
@@ -152,6 +162,11 @@ void Connectable::notifyWork() {
   }
 }
 
+void Connectable::setWorkNotifier(const std::function<void()> &notifier) {
+  std::lock_guard<std::mutex> lock(work_available_mutex_);
+  work_notifier_ = notifier ? std::make_shared<std::function<void()>>(notifier) : nullptr;
+}
+
 std::set<std::shared_ptr<Connectable>> Connectable::getOutGoingConnections(const std::string &relationship) const {
   std::set<std::shared_ptr<Connectable>> empty;
 
@@ -146,13 +146,7 @@ std::set<std::string> &FlowFile::getlineageIdentifiers() {
 }
 
 bool FlowFile::getAttribute(std::string key, std::string &value) {
-  auto it = attributes_.find(key);
-  if (it != attributes_.end()) {
-    value = it->second;
-    return true;
-  } else {
-    return false;
-  }
+  return attributes_.get(key, value);
 }
 
 // Get Size
@@ -165,34 +159,15 @@ uint64_t FlowFile::getOffset() {
 }
 
 bool FlowFile::removeAttribute(const std::string key) {
-  auto it = attributes_.find(key);
-  if (it != attributes_.end()) {
-    attributes_.erase(key);
-    return true;
-  } else {
-    return false;
-  }
+  return attributes_.remove(key);
 }
 
 bool FlowFile::updateAttribute(const std::string key, const std::string value) {
-  auto it = attributes_.find(key);
-  if (it != attributes_.end()) {
-    attributes_[key] = value;
-    return true;
-  } else {
-    return false;
-  }
+  return attributes_.update(key, value);
 }
 
 bool FlowFile::addAttribute(const std::string &key, const std::string &value) {
-  auto it = attributes_.find(key);
-  if (it != attributes_.end()) {
-    // attribute already there in the map
-    return false;
-  } else {
-    attributes_[key] = value;
-    return true;
-  }
+  return attributes_.add(key, value);
 }
 
 void FlowFile::setLineageStartDate(const uint64_t date) {
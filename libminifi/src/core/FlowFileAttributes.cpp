@@ -0,0 +1,226 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/FlowFileAttributes.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+constexpr uint32_t AttributeKey::Uninterned;
+constexpr size_t AttributeKeyRegistry::MaxKeys;
+
+AttributeKeyRegistry &AttributeKeyRegistry::getInstance() {
+  static AttributeKeyRegistry registry;
+  return registry;
+}
+
+const AttributeKey *AttributeKeyRegistry::intern(const std::string &name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = keys_.find(name);
+  if (it != keys_.end()) {
+    return it->second.get();
+  }
+  if (ids_.size() >= max_keys_) {
+    return nullptr;
+  }
+  std::unique_ptr<AttributeKey> key(new AttributeKey());
+  key->id = static_cast<uint32_t>(ids_.size());
+  key->name = name;
+  const AttributeKey *interned = key.get();
+  keys_.insert(std::make_pair(name, std::move(key)));
+  ids_.push_back(interned);
+  return interned;
+}
+
+const AttributeKey *AttributeKeyRegistry::find(const std::string &name) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = keys_.find(name);
+  return it != keys_.end() ? it->second.get() : nullptr;
+}
+
+const AttributeKey *AttributeKeyRegistry::get(uint32_t id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return id < ids_.size() ? ids_[id] : nullptr;
+}
+
+size_t AttributeKeyRegistry::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ids_.size();
+}
+
+const std::vector<FlowFileAttributes::Entry> FlowFileAttributes::empty_entries_;
+
+FlowFileAttributes::FlowFileAttributes(const std::map<std::string, std::string> &attributes) {
+  if (attributes.empty()) {
+    return;
+  }
+  entries_ = std::make_shared<std::vector<Entry>>();
+  entries_->reserve(attributes.size());
+  for (const auto &attribute : attributes) {
+    entries_->push_back(createEntry(attribute.first, attribute.second));
+  }
+}
+
+const std::string *FlowFileAttributes::find(const std::string &key) const {
+  if (!entries_) {
+    return nullptr;
+  }
+  // keys are compared by name so that lookups do not go through the registry
+  for (const auto &entry : *entries_) {
+    if (entry.key->name == key) {
+      return &entry.value;
+    }
+  }
+  return nullptr;
+}
+
+const std::string *FlowFileAttributes::find(const AttributeKey *key) const {
+  if (key->id == AttributeKey::Uninterned) {
+    return find(key->name);
+  }
+  if (!entries_) {
+    return nullptr;
+  }
+  for (const auto &entry : *entries_) {
+    if (entry.key == key) {
+      return &entry.value;
+    }
+  }
+  return nullptr;
+}
+
+bool FlowFileAttributes::get(const std::string &key, std::string &value) const {
+  const std::string *found = find(key);
+  if (found == nullptr) {
+    return false;
+  }
+  value = *found;
+  return true;
+}
+
+void FlowFileAttributes::set(const std::string &key, const std::string &value) {
+  Entry *entry = findEntry(key);
+  if (entry != nullptr) {
+    entry->value = value;
+    return;
+  }
+  mutate().push_back(createEntry(key, value));
+}
+
+bool FlowFileAttributes::add(const std::string &key, const std::string &value) {
+  if (find(key) != nullptr) {
+    return false;
+  }
+  mutate().push_back(createEntry(key, value));
+  return true;
+}
+
+bool FlowFileAttributes::update(const std::string &key, const std::string &value) {
+  Entry *entry = findEntry(key);
+  if (entry == nullptr) {
+    return false;
+  }
+  entry->value = value;
+  return true;
+}
+
+bool FlowFileAttributes::remove(const std::string &key) {
+  if (find(key) == nullptr) {
+    return false;
+  }
+  std::vector<Entry> &entries = mutate();
+  entries.erase(std::remove_if(entries.begin(), entries.end(), [&key](const Entry &entry) {
+    return entry.key->name == key;
+  }), entries.end());
+  return true;
+}
+
+void FlowFileAttributes::inherit(const FlowFileAttributes &parent, const std::vector<std::string> &excluded) {
+  FlowFileAttributes inherited(parent);
+  for (const auto &name : excluded) {
+    const std::string *own = find(name);
+    if (own != nullptr) {
+      inherited.set(name, *own);
+    } else {
+      inherited.remove(name);
+    }
+  }
+  for (const auto &entry : *this) {
+    if (inherited.find(entry.key) == nullptr) {
+      inherited.mutate().push_back(entry);
+    }
+  }
+  entries_ = std::move(inherited.entries_);
+}
+
+std::map<std::string, std::string> FlowFileAttributes::toMap() const {
+  std::map<std::string, std::string> attributes;
+  for (const auto &entry : *this) {
+    attributes.insert(std::make_pair(entry.key->name, entry.value));
+  }
+  return attributes;
+}
+
+std::vector<FlowFileAttributes::Entry> &FlowFileAttributes::mutate() {
+  if (!entries_) {
+    entries_ = std::make_shared<std::vector<Entry>>();
+  } else if (entries_.use_count() > 1) {
+    entries_ = std::make_shared<std::vector<Entry>>(*entries_);
+  }
+  return *entries_;
+}
+
+FlowFileAttributes::Entry *FlowFileAttributes::findEntry(const std::string &key) {
+  if (find(key) == nullptr) {
+    return nullptr;
+  }
+  for (auto &entry : mutate()) {
+    if (entry.key->name == key) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+FlowFileAttributes::Entry FlowFileAttributes::createEntry(const std::string &key, const std::string &value) {
+  Entry entry;
+  entry.key = AttributeKeyRegistry::getInstance().intern(key);
+  if (entry.key == nullptr) {
+    std::shared_ptr<AttributeKey> owned = std::make_shared<AttributeKey>();
+    owned->id = AttributeKey::Uninterned;
+    owned->name = key;
+    entry.owned_key = owned;
+    entry.key = owned.get();
+  }
+  entry.value = value;
+  return entry;
+}
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
@@ -0,0 +1,118 @@
+/**
+ * @file FlowFilePrioritizer.cpp
+ * FlowFilePrioritizer class implementation
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core/FlowFilePrioritizer.h"
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include "utils/StringUtils.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+constexpr const char *FirstInFirstOutPrioritizer::Name;
+constexpr const char *NewestFlowFileFirstPrioritizer::Name;
+constexpr const char *OldestFlowFileFirstPrioritizer::Name;
+constexpr const char *PriorityAttributePrioritizer::Name;
+constexpr const char *PriorityAttributePrioritizer::PriorityAttribute;
+
+namespace {
+
+bool parsePriority(const std::string &value, int64_t &priority) {
+  if (value.empty()) {
+    return false;
+  }
+  char *end = nullptr;
+  errno = 0;
+  priority = std::strtoll(value.c_str(), &end, 10);
+  return errno == 0 && *end == '\0';
+}
+
+}  // namespace
+
+std::shared_ptr<FlowFilePrioritizer> FlowFilePrioritizer::create(const std::string &name) {
+  std::string type = utils::StringUtils::trim(name);
+  // accept the fully qualified NiFi class names, e.g. org.apache.nifi.prioritizer.FirstInFirstOutPrioritizer
+  auto separator = type.find_last_of('.');
+  if (separator != std::string::npos) {
+    type = type.substr(separator + 1);
+  }
+  if (utils::StringUtils::equalsIgnoreCase(type, FirstInFirstOutPrioritizer::Name)) {
+    return std::make_shared<FirstInFirstOutPrioritizer>();
+  } else if (utils::StringUtils::equalsIgnoreCase(type, NewestFlowFileFirstPrioritizer::Name)) {
+    return std::make_shared<NewestFlowFileFirstPrioritizer>();
+  } else if (utils::StringUtils::equalsIgnoreCase(type, OldestFlowFileFirstPrioritizer::Name)) {
+    return std::make_shared<OldestFlowFileFirstPrioritizer>();
+  } else if (utils::StringUtils::equalsIgnoreCase(type, PriorityAttributePrioritizer::Name)) {
+    return std::make_shared<PriorityAttributePrioritizer>();
+  }
+  return nullptr;
+}
+
+int NewestFlowFileFirstPrioritizer::compare(const std::shared_ptr<core::FlowFile> &first, const std::shared_ptr<core::FlowFile> &second) {
+  uint64_t first_date = first->getEntryDate();
+  uint64_t second_date = second->getEntryDate();
+  if (first_date == second_date) {
+    return 0;
+  }
+  return first_date > second_date ? -1 : 1;
+}
+
+int OldestFlowFileFirstPrioritizer::compare(const std::shared_ptr<core::FlowFile> &first, const std::shared_ptr<core::FlowFile> &second) {
+  uint64_t first_date = first->getEntryDate();
+  uint64_t second_date = second->getEntryDate();
+  if (first_date == second_date) {
+    return 0;
+  }
+  return first_date < second_date ? -1 : 1;
+}
+
+int PriorityAttributePrioritizer::compare(const std::shared_ptr<core::FlowFile> &first, const std::shared_ptr<core::FlowFile> &second) {
+  std::string first_value, second_value;
+  bool first_has = first->getAttribute(PriorityAttribute, first_value);
+  bool second_has = second->getAttribute(PriorityAttribute, second_value);
+  if (!first_has || !second_has) {
+    return first_has == second_has ? 0 : (first_has ? -1 : 1);
+  }
+
+  // numeric priorities come before the others, so that mixing both kinds still orders them totally
+  int64_t first_priority = 0, second_priority = 0;
+  bool first_numeric = parsePriority(first_value, first_priority);
+  bool second_numeric = parsePriority(second_value, second_priority);
+  if (first_numeric != second_numeric) {
+    return first_numeric ? -1 : 1;
+  }
+  if (first_numeric) {
+    if (first_priority == second_priority) {
+      return 0;
+    }
+    return first_priority < second_priority ? -1 : 1;
+  }
+  return first_value.compare(second_value);
+}
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
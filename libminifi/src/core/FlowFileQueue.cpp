@@ -0,0 +1,151 @@
+/**
+ * @file FlowFileQueue.cpp
+ * FlowFileQueue class implementation
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core/FlowFileQueue.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "utils/StringUtils.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+constexpr const char *LockingFlowFileQueue::Name;
+constexpr const char *ConcurrentFlowFileQueue::Name;
+constexpr const char *PrioritizedFlowFileQueue::Name;
+
+std::unique_ptr<FlowFileQueue> FlowFileQueue::create(const std::string &name) {
+  const std::string type = utils::StringUtils::trim(name);
+  if (type.empty() || utils::StringUtils::equalsIgnoreCase(type, LockingFlowFileQueue::Name)) {
+    return std::unique_ptr<FlowFileQueue>(new LockingFlowFileQueue());
+  } else if (utils::StringUtils::equalsIgnoreCase(type, ConcurrentFlowFileQueue::Name)) {
+    return std::unique_ptr<FlowFileQueue>(new ConcurrentFlowFileQueue());
+  }
+  return nullptr;
+}
+
+size_t FlowFileQueue::tryPopBulk(std::vector<std::shared_ptr<core::FlowFile>> &flows, size_t max_count, uint64_t max_bytes) {
+  size_t count = 0;
+  uint64_t bytes = 0;
+  std::shared_ptr<core::FlowFile> flow;
+  while (count < max_count && (max_bytes == 0 || bytes < max_bytes) && tryPop(flow)) {
+    bytes += flow->getSize();
+    flows.push_back(std::move(flow));
+    count++;
+  }
+  return count;
+}
+
+void LockingFlowFileQueue::push(const std::shared_ptr<core::FlowFile> &flow) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  queue_.push(flow);
+}
+
+bool LockingFlowFileQueue::tryPop(std::shared_ptr<core::FlowFile> &flow) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (queue_.empty()) {
+    return false;
+  }
+  flow = std::move(queue_.front());
+  queue_.pop();
+  return true;
+}
+
+size_t LockingFlowFileQueue::tryPopBulk(std::vector<std::shared_ptr<core::FlowFile>> &flows, size_t max_count, uint64_t max_bytes) {
+  size_t count = 0;
+  uint64_t bytes = 0;
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (count < max_count && (max_bytes == 0 || bytes < max_bytes) && !queue_.empty()) {
+    bytes += queue_.front()->getSize();
+    flows.push_back(std::move(queue_.front()));
+    queue_.pop();
+    count++;
+  }
+  return count;
+}
+
+void ConcurrentFlowFileQueue::push(const std::shared_ptr<core::FlowFile> &flow) {
+  queue_.enqueue(flow);
+}
+
+bool ConcurrentFlowFileQueue::tryPop(std::shared_ptr<core::FlowFile> &flow) {
+  return queue_.try_dequeue(flow);
+}
+
+bool PrioritizedFlowFileQueue::after(const Entry &first, const Entry &second) const {
+  for (const auto &prioritizer : prioritizers_) {
+    int result = prioritizer->compare(first.flow, second.flow);
+    if (result != 0) {
+      return result > 0;
+    }
+  }
+  return first.sequence > second.sequence;
+}
+
+void PrioritizedFlowFileQueue::popEntry(std::shared_ptr<core::FlowFile> &flow) {
+  std::pop_heap(heap_.begin(), heap_.end(), [this](const Entry &first, const Entry &second) {
+    return after(first, second);
+  });
+  flow = std::move(heap_.back().flow);
+  heap_.pop_back();
+}
+
+void PrioritizedFlowFileQueue::push(const std::shared_ptr<core::FlowFile> &flow) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry entry;
+  entry.flow = flow;
+  entry.sequence = sequence_++;
+  heap_.push_back(std::move(entry));
+  std::push_heap(heap_.begin(), heap_.end(), [this](const Entry &first, const Entry &second) {
+    return after(first, second);
+  });
+}
+
+bool PrioritizedFlowFileQueue::tryPop(std::shared_ptr<core::FlowFile> &flow) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (heap_.empty()) {
+    return false;
+  }
+  popEntry(flow);
+  return true;
+}
+
+size_t PrioritizedFlowFileQueue::tryPopBulk(std::vector<std::shared_ptr<core::FlowFile>> &flows, size_t max_count, uint64_t max_bytes) {
+  size_t count = 0;
+  uint64_t bytes = 0;
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (count < max_count && (max_bytes == 0 || bytes < max_bytes) && !heap_.empty()) {
+    std::shared_ptr<core::FlowFile> flow;
+    popEntry(flow);
+    bytes += flow->getSize();
+    flows.push_back(std::move(flow));
+    count++;
+  }
+  return count;
+}
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
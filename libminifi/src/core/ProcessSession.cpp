@@ -29,6 +29,8 @@
 #include <chrono>
 #include <thread>
 #include <iostream>
+#include <utility>
+#include <algorithm>
 #include <uuid/uuid.h>
 /* This implementation is only for native Windows systems.  */
 #if (defined _WIN32 || defined __WIN32__) && !defined __CYGWIN__
@@ -58,6 +60,54 @@ namespace core {
 
 std::shared_ptr<utils::IdGenerator> ProcessSession::id_generator_ = utils::IdGenerator::getIdGenerator();
 
+namespace {
+
+/**
+ * Copies the existing content of a flow file into a new claim before writing the appended content.
+ */
+class AppendCopyCallback : public OutputStreamCallback {
+ public:
+  AppendCopyCallback(const std::shared_ptr<core::ContentRepository> &content_repo, const std::shared_ptr<core::FlowFile> &flow, OutputStreamCallback *callback)
+      : content_repo_(content_repo),
+        flow_(flow),
+        callback_(callback) {
+  }
+
+  int64_t process(std::shared_ptr<io::BaseStream> stream) {
+    std::shared_ptr<io::BaseStream> content = content_repo_->read(flow_->getResourceClaim(), flow_->getOffset(), flow_->getSize());
+    if (nullptr == content) {
+      return -1;
+    }
+    std::vector<uint8_t> buffer(getpagesize());
+    uint64_t remaining = flow_->getSize();
+    while (remaining > 0) {
+      int len = content->readData(buffer.data(), static_cast<int>(std::min<uint64_t>(buffer.size(), remaining)));
+      if (len <= 0 || stream->writeData(buffer.data(), len) != len) {
+        return -1;
+      }
+      remaining -= len;
+    }
+    int64_t appended = callback_->process(stream);
+    if (appended < 0) {
+      return appended;
+    }
+    return flow_->getSize() + appended;
+  }
+
+ private:
+  std::shared_ptr<core::ContentRepository> content_repo_;
+  std::shared_ptr<core::FlowFile> flow_;
+  OutputStreamCallback *callback_;
+};
+
+// Attributes that children and clones do not take from their parent
+const std::vector<std::string> &getSpecialAttributes() {
+  static const std::vector<std::string> special = { FlowAttributeKey(ALTERNATE_IDENTIFIER), FlowAttributeKey(DISCARD_REASON), FlowAttributeKey(UUID) };
+  return special;
+}
+
+}  // namespace
+
 ProcessSession::~ProcessSession() {
   removeReferences();
 }
@@ -77,9 +127,7 @@ std::shared_ptr<core::FlowFile> ProcessSession::create() {
 
   _addedFlowFiles[record->getUUIDStr()] = record;
   logger_->log_debug("Create FlowFile with UUID %s", record->getUUIDStr());
-  std::stringstream details;
-  details << process_context_->getProcessorNode()->getName() << " creates flow record " << record->getUUIDStr();
-  provenance_report_->create(record, details.str());
+  provenance_report_->create(record);
 
   return record;
 }
@@ -104,15 +152,8 @@ std::shared_ptr<core::FlowFile> ProcessSession::create(const std::shared_ptr<cor
   }
 
   if (record) {
-    // Copy attributes
-    std::map<std::string, std::string> parentAttributes = parent->getAttributes();
-    std::map<std::string, std::string>::iterator it;
-    for (it = parentAttributes.begin(); it != parentAttributes.end(); it++) {
-      if (it->first == FlowAttributeKey(ALTERNATE_IDENTIFIER) || it->first == FlowAttributeKey(DISCARD_REASON) || it->first == FlowAttributeKey(UUID))
-        // Do not copy special attributes from parent
-        continue;
-      record->setAttribute(it->first, it->second);
-    }
+    // Share the attributes of the parent, except for its special attributes
+    record->inheritAttributes(*parent, getSpecialAttributes());
     record->setLineageStartDate(parent->getlineageStartDate());
     record->setLineageIdentifiers(parent->getlineageIdentifiers());
     parent->getlineageIdentifiers().insert(parent->getUUIDStr());
@@ -150,15 +191,8 @@ std::shared_ptr<core::FlowFile> ProcessSession::cloneDuringTransfer(std::shared_
     }
     this->_clonedFlowFiles[record->getUUIDStr()] = record;
     logger_->log_debug("Clone FlowFile with UUID %s during transfer", record->getUUIDStr());
-    // Copy attributes
-    std::map<std::string, std::string> parentAttributes = parent->getAttributes();
-    std::map<std::string, std::string>::iterator it;
-    for (it = parentAttributes.begin(); it != parentAttributes.end(); it++) {
-      if (it->first == FlowAttributeKey(ALTERNATE_IDENTIFIER) || it->first == FlowAttributeKey(DISCARD_REASON) || it->first == FlowAttributeKey(UUID))
-        // Do not copy special attributes from parent
-        continue;
-      record->setAttribute(it->first, it->second);
-    }
+    // Share the attributes of the parent, except for its special attributes
+    record->inheritAttributes(*parent, getSpecialAttributes());
     record->setLineageStartDate(parent->getlineageStartDate());
 
     record->setLineageIdentifiers(parent->getlineageIdentifiers());
@@ -214,7 +248,7 @@ void ProcessSession::remove(const std::shared_ptr<core::FlowFile> &flow) {
   } else {
     logger_->log_debug("Flow does not contain content. no resource claim to decrement.");
   }
-  process_context_->getFlowFileRepository()->Delete(flow->getUUIDStr());
+  process_context_->getFlowFileRepository()->Delete(flow->getUUIDStr(), flow->getResourceClaim());
   _deletedFlowFiles[flow->getUUIDStr()] = flow;
   std::string reason = process_context_->getProcessorNode()->getName() + " drop flow record " + flow->getUUIDStr();
   provenance_report_->drop(flow, reason);
@@ -222,26 +256,25 @@ void ProcessSession::remove(const std::shared_ptr<core::FlowFile> &flow) {
 
 void ProcessSession::putAttribute(const std::shared_ptr<core::FlowFile> &flow, std::string key, std::string value) {
   flow->setAttribute(key, value);
-  std::stringstream details;
-  details << process_context_->getProcessorNode()->getName() << " modify flow record " << flow->getUUIDStr() << " attribute " << key << ":" << value;
-  provenance_report_->modifyAttributes(flow, details.str());
+  provenance_report_->modifyAttributes(flow, key, value);
 }
 
 void ProcessSession::removeAttribute(const std::shared_ptr<core::FlowFile> &flow, std::string key) {
   flow->removeAttribute(key);
-  std::stringstream details;
-  details << process_context_->getProcessorNode()->getName() << " remove flow record " << flow->getUUIDStr() << " attribute " + key;
-  provenance_report_->modifyAttributes(flow, details.str());
+  provenance_report_->removeAttribute(flow, key);
 }
 
 void ProcessSession::penalize(const std::shared_ptr<core::FlowFile> &flow) {
   uint64_t penalization_period = process_context_->getProcessorNode()->getPenalizationPeriodMsec();
-  logging::LOG_INFO(logger_) << "Penalizing " << flow->getUUIDStr() << " for " << penalization_period << "ms at " << process_context_->getProcessorNode()->getName();
+  // the level is checked first as the operands copy strings for every flow file
+  if (logger_->should_log(logging::LOG_LEVEL::info))
+    logging::LOG_INFO(logger_) << "Penalizing " << flow->getUUIDStr() << " for " << penalization_period << "ms at " << process_context_->getProcessorNode()->getName();
   flow->setPenaltyExpiration(getTimeMillis() + penalization_period);
 }
 
 void ProcessSession::transfer(const std::shared_ptr<core::FlowFile> &flow, Relationship relationship) {
-  logging::LOG_INFO(logger_) << "Transferring " << flow->getUUIDStr() << " from " << process_context_->getProcessorNode()->getName() << " to relationship " << relationship.getName();
+  if (logger_->should_log(logging::LOG_LEVEL::info))
+    logging::LOG_INFO(logger_) << "Transferring " << flow->getUUIDStr() << " from " << process_context_->getProcessorNode()->getName() << " to relationship " << relationship.getName();
   _transferRelationship[flow->getUUIDStr()] = relationship;
 }
 
@@ -250,22 +283,23 @@ void ProcessSession::write(const std::shared_ptr<core::FlowFile> &flow, OutputSt
 
   try {
     uint64_t startTime = getTimeMillis();
-    claim->increaseFlowFileRecordOwnedCount();
+    // the content repository may move the claim into a shared container, so it is counted once placed
     std::shared_ptr<io::BaseStream> stream = process_context_->getContentRepository()->write(claim);
     // Call the callback to write the content
     if (nullptr == stream) {
-      claim->decreaseFlowFileRecordOwnedCount();
       rollback();
       return;
     }
-    if (callback->process(stream) < 0) {
+    claim->increaseFlowFileRecordOwnedCount();
+    // the content must have reached the claim before its size is recorded
+    if (callback->process(stream) < 0 || !stream->flush()) {
       claim->decreaseFlowFileRecordOwnedCount();
       rollback();
       return;
     }
 
     flow->setSize(stream->getSize());
-    flow->setOffset(0);
+    flow->setOffset(claim->getOffset());
     std::shared_ptr<ResourceClaim> flow_claim = flow->getResourceClaim();
     if (flow_claim != nullptr) {
       // Remove the old claim
@@ -275,10 +309,8 @@ void ProcessSession::write(const std::shared_ptr<core::FlowFile> &flow, OutputSt
     flow->setResourceClaim(claim);
 
     stream->closeStream();
-    std::stringstream details;
-    details << process_context_->getProcessorNode()->getName() << " modify flow record content " << flow->getUUIDStr();
     uint64_t endTime = getTimeMillis();
-    provenance_report_->modifyContent(flow, details.str(), endTime - startTime);
+    provenance_report_->modifyContent(flow, endTime - startTime);
   } catch (std::exception &exception) {
     if (flow && flow->getResourceClaim() == claim) {
       flow->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
@@ -304,6 +336,11 @@ void ProcessSession::append(const std::shared_ptr<core::FlowFile> &flow, OutputS
   }
 
   claim = flow->getResourceClaim();
+  if (!process_context_->getContentRepository()->isAppendable(claim)) {
+    // the claim shares its file with other claims, so the content is copied into a new claim
+    AppendCopyCallback copy(process_context_->getContentRepository(), flow, callback);
+    return write(flow, &copy);
+  }
 
   try {
     uint64_t startTime = getTimeMillis();
@@ -318,17 +355,15 @@ void ProcessSession::append(const std::shared_ptr<core::FlowFile> &flow, OutputS
     // this prevents an issue if we write, above, with zero length.
     if (oldPos > 0)
       stream->seek(oldPos + 1);
-    if (callback->process(stream) < 0) {
+    if (callback->process(stream) < 0 || !stream->flush()) {
       rollback();
       return;
     }
     uint64_t appendSize = stream->getSize() - oldPos;
     flow->setSize(stream->getSize());
 
-    std::stringstream details;
-    details << process_context_->getProcessorNode()->getName() << " modify flow record content " << flow->getUUIDStr();
     uint64_t endTime = getTimeMillis();
-    provenance_report_->modifyContent(flow, details.str(), endTime - startTime);
+    provenance_report_->modifyContent(flow, endTime - startTime);
   } catch (std::exception &exception) {
     logger_->log_debug("Caught Exception %s", exception.what());
     throw;
@@ -353,15 +388,13 @@ void ProcessSession::read(const std::shared_ptr<core::FlowFile> &flow, InputStre
 
     claim = flow->getResourceClaim();
 
-    std::shared_ptr<io::BaseStream> stream = process_context_->getContentRepository()->read(claim);
+    std::shared_ptr<io::BaseStream> stream = process_context_->getContentRepository()->read(claim, flow->getOffset(), flow->getSize());
 
     if (nullptr == stream) {
       rollback();
       return;
     }
 
-    stream->seek(flow->getOffset());
-
     if (callback->process(stream) < 0) {
       rollback();
       return;
@@ -388,15 +421,14 @@ void ProcessSession::importFrom(io::DataStream &stream, const std::shared_ptr<co
 
   try {
     auto startTime = getTimeMillis();
-    claim->increaseFlowFileRecordOwnedCount();
     std::shared_ptr<io::BaseStream> content_stream = process_context_->getContentRepository()->write(claim);
 
     if (nullptr == content_stream) {
       logger_->log_debug("Could not obtain claim for %s", claim->getContentFullPath());
-      claim->decreaseFlowFileRecordOwnedCount();
       rollback();
       return;
     }
+    claim->increaseFlowFileRecordOwnedCount();
     size_t position = 0;
     const size_t max_size = stream.getSize();
     size_t read_size = max_read;
@@ -412,10 +444,14 @@ void ProcessSession::importFrom(io::DataStream &stream, const std::shared_ptr<co
       content_stream->write(charBuffer.data(), read_size);
       position += read_size;
     }
-    // Open the source file and stream to the flow file
+    if (!content_stream->flush()) {
+      claim->decreaseFlowFileRecordOwnedCount();
+      rollback();
+      return;
+    }
 
     flow->setSize(content_stream->getSize());
-    flow->setOffset(0);
+    flow->setOffset(claim->getOffset());
     if (flow->getResourceClaim() != nullptr) {
       // Remove the old claim
       flow->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
@@ -426,10 +462,8 @@ void ProcessSession::importFrom(io::DataStream &stream, const std::shared_ptr<co
     logger_->log_debug("Import offset %llu length %llu into content %s for FlowFile UUID %s", flow->getOffset(), flow->getSize(), flow->getResourceClaim()->getContentFullPath(), flow->getUUIDStr());
 
     content_stream->closeStream();
-    std::stringstream details;
-    details << process_context_->getProcessorNode()->getName() << " modify flow record content " << flow->getUUIDStr();
     auto endTime = getTimeMillis();
-    provenance_report_->modifyContent(flow, details.str(), endTime - startTime);
+    provenance_report_->modifyContent(flow, endTime - startTime);
   } catch (std::exception &exception) {
     if (flow && flow->getResourceClaim() == claim) {
       flow->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
@@ -454,15 +488,36 @@ void ProcessSession::import(std::string source, const std::shared_ptr<core::Flow
 
   try {
     auto startTime = getTimeMillis();
+    uint64_t imported = 0;
+    // repositories backed by files copy or move the source without streaming it
+    if (process_context_->getContentRepository()->importFile(source, offset, !keepSource, claim, imported)) {
+      claim->increaseFlowFileRecordOwnedCount();
+      flow->setSize(imported);
+      flow->setOffset(claim->getOffset());
+      if (flow->getResourceClaim() != nullptr) {
+        // Remove the old claim
+        flow->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
+        flow->clearResourceClaim();
+      }
+      flow->setResourceClaim(claim);
+
+      logger_->log_debug("Import offset %llu length %llu into content %s for FlowFile UUID %s", flow->getOffset(), flow->getSize(), flow->getResourceClaim()->getContentFullPath(),
+                         flow->getUUIDStr());
+
+      if (!keepSource)
+        std::remove(source.c_str());
+      auto endTime = getTimeMillis();
+      provenance_report_->modifyContent(flow, endTime - startTime);
+      return;
+    }
     std::ifstream input;
     input.open(source.c_str(), std::fstream::in | std::fstream::binary);
-    claim->increaseFlowFileRecordOwnedCount();
     std::shared_ptr<io::BaseStream> stream = process_context_->getContentRepository()->write(claim);
     if (nullptr == stream) {
-      claim->decreaseFlowFileRecordOwnedCount();
       rollback();
       return;
     }
+    claim->increaseFlowFileRecordOwnedCount();
     if (input.is_open() && input.good()) {
       bool invalidWrite = false;
       // Open the source file and stream to the flow file
@@ -487,10 +542,13 @@ void ProcessSession::import(std::string source, const std::shared_ptr<core::Flow
           }
         }
       }
+      if (!invalidWrite && !stream->flush()) {
+        invalidWrite = true;
+      }
 
       if (!invalidWrite) {
         flow->setSize(stream->getSize());
-        flow->setOffset(0);
+        flow->setOffset(claim->getOffset());
         if (flow->getResourceClaim() != nullptr) {
           // Remove the old claim
           flow->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
@@ -505,10 +563,8 @@ void ProcessSession::import(std::string source, const std::shared_ptr<core::Flow
         input.close();
         if (!keepSource)
           std::remove(source.c_str());
-        std::stringstream details;
-        details << process_context_->getProcessorNode()->getName() << " modify flow record content " << flow->getUUIDStr();
         auto endTime = getTimeMillis();
-        provenance_report_->modifyContent(flow, details.str(), endTime - startTime);
+        provenance_report_->modifyContent(flow, endTime - startTime);
       } else {
         stream->closeStream();
         input.close();
@@ -609,9 +665,14 @@ void ProcessSession::import(const std::string& source, std::vector<std::shared_p
           if (delimiterPos == end) {
             break;
           }
+          if (!stream->flush()) {
+            logger_->log_error("Error while writing");
+            stream->closeStream();
+            throw Exception(FILE_OPERATION_EXCEPTION, "File Export Error creating Flowfile");
+          }
           flowFile = std::static_pointer_cast<FlowFileRecord>(create());
           flowFile->setSize(stream->getSize());
-          flowFile->setOffset(0);
+          flowFile->setOffset(claim->getOffset());
           if (flowFile->getResourceClaim() != nullptr) {
             /* Remove the old claim */
             flowFile->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
@@ -622,9 +683,8 @@ void ProcessSession::import(const std::string& source, std::vector<std::shared_p
           logging::LOG_DEBUG(logger_) << "Import offset " << flowFile->getOffset() << " length " << flowFile->getSize() << " content " << flowFile->getResourceClaim()->getContentFullPath()
                                       << ", FlowFile UUID " << flowFile->getUUIDStr();
           stream->closeStream();
-          std::string details = process_context_->getProcessorNode()->getName() + " modify flow record content " + flowFile->getUUIDStr();
           uint64_t endTime = getTimeMillis();
-          provenance_report_->modifyContent(flowFile, details, endTime - startTime);
+          provenance_report_->modifyContent(flowFile, endTime - startTime);
           flows.push_back(flowFile);
 
           /* Reset these to start processing the next FlowFile with a clean slate */
@@ -663,11 +723,22 @@ void ProcessSession::import(std::string source, std::vector<std::shared_ptr<Flow
 bool ProcessSession::exportContent(const std::string &destination, const std::string &tmpFile, const std::shared_ptr<core::FlowFile> &flow, bool keepContent) {
   logger_->log_debug("Exporting content of %s to %s", flow->getUUIDStr(), destination);
 
-  ProcessSessionReadCallback cb(tmpFile, destination, logger_);
-  read(flow, &cb);
+  bool commit_ok = false;
+  std::shared_ptr<ResourceClaim> claim = flow->getResourceClaim();
+  // repositories backed by files copy the content without streaming it
+  if (nullptr != claim && process_context_->getContentRepository()->exportFile(claim, flow->getOffset(), flow->getSize(), tmpFile)) {
+    logger_->log_info("Committing %s", destination);
+    commit_ok = std::rename(tmpFile.c_str(), destination.c_str()) == 0;
+    if (!commit_ok) {
+      std::remove(tmpFile.c_str());
+    }
+  } else {
+    ProcessSessionReadCallback cb(tmpFile, destination, logger_);
+    read(flow, &cb);
 
-  logger_->log_info("Committing %s", destination);
-  bool commit_ok = cb.commit();
+    logger_->log_info("Committing %s", destination);
+    commit_ok = cb.commit();
+  }
 
   if (commit_ok) {
     logger_->log_info("Commit OK.");
@@ -819,39 +890,30 @@ void ProcessSession::commit() {
       }
     }
 
-    std::shared_ptr<Connection> connection = nullptr;
     // Complete process the added and update flow files for the session, send the flow file to its queue
-    for (const auto &it : _updatedFlowFiles) {
-      std::shared_ptr<core::FlowFile> record = it.second;
-      logger_->log_trace("See %s in %s", record->getUUIDStr(), "_updatedFlowFiles");
-      if (record->isDeleted()) {
-        continue;
+    std::map<std::shared_ptr<Connection>, std::vector<std::shared_ptr<core::FlowFile>>> connectionFlowFiles;
+    std::vector<std::pair<std::shared_ptr<core::FlowFile>, std::string>> unstoredFlowFiles;
+    for (const auto *flowFiles : { &_updatedFlowFiles, &_addedFlowFiles, &_clonedFlowFiles }) {
+      for (const auto &it : *flowFiles) {
+        std::shared_ptr<core::FlowFile> record = it.second;
+        if (record->isDeleted()) {
+          continue;
+        }
+        std::shared_ptr<Connection> connection = std::static_pointer_cast<Connection>(record->getConnection());
+        if ((connection) != nullptr) {
+          connectionFlowFiles[connection].push_back(record);
+          if (!record->isStored()) {
+            unstoredFlowFiles.push_back(std::make_pair(record, connection->getUUIDStr()));
+          }
+        }
       }
-
-      connection = std::static_pointer_cast<Connection>(record->getConnection());
-      if ((connection) != nullptr)
-        connection->put(record);
     }
-    for (const auto &it : _addedFlowFiles) {
-      std::shared_ptr<core::FlowFile> record = it.second;
-      logger_->log_trace("See %s in %s", record->getUUIDStr(), "_addedFlowFiles");
-      if (record->isDeleted()) {
-        continue;
-      }
-      connection = std::static_pointer_cast<Connection>(record->getConnection());
-      if ((connection) != nullptr)
-        connection->put(record);
+    // persist the flow files of all connections with a single batch before they become visible downstream
+    if (nullptr != process_context_->getFlowFileRepository()) {
+      FlowFileRecord::Serialize(process_context_->getFlowFileRepository(), process_context_->getContentRepository(), unstoredFlowFiles);
     }
-    // Process the clone flow files
-    for (const auto &it : _clonedFlowFiles) {
-      std::shared_ptr<core::FlowFile> record = it.second;
-      logger_->log_trace("See %s in %s", record->getUUIDStr(), "_clonedFlowFiles");
-      if (record->isDeleted()) {
-        continue;
-      }
-      connection = std::static_pointer_cast<Connection>(record->getConnection());
-      if ((connection) != nullptr)
-        connection->put(record);
+    for (const auto &it : connectionFlowFiles) {
+      it.first->multiPut(it.second);
     }
 
     // All done
@@ -902,6 +964,21 @@ void ProcessSession::rollback() {
   }
 }
 
+void ProcessSession::addPolledFlowFile(const std::shared_ptr<core::FlowFile> &flow) {
+  // add the flow record to the current process session update map
+  flow->setDeleted(false);
+  _updatedFlowFiles[flow->getUUIDStr()] = flow;
+  // save a snapshot
+  _originalFlowFiles[flow->getUUIDStr()] = flow;
+}
+
+void ProcessSession::expireFlowFiles(const std::set<std::shared_ptr<core::FlowFile>> &expired) {
+  // Remove expired flow record
+  for (const auto &record : expired) {
+    provenance_report_->expire(record);
+  }
+}
+
 std::shared_ptr<core::FlowFile> ProcessSession::get() {
   std::shared_ptr<Connectable> first = process_context_->getProcessorNode()->getNextIncomingConnection();
 
@@ -916,30 +993,10 @@ std::shared_ptr<core::FlowFile> ProcessSession::get() {
     std::set<std::shared_ptr<core::FlowFile> > expired;
     std::shared_ptr<core::FlowFile> ret = current->poll(expired);
     if (expired.size() > 0) {
-      // Remove expired flow record
-      for (std::set<std::shared_ptr<core::FlowFile> >::iterator it = expired.begin(); it != expired.end(); ++it) {
-        std::shared_ptr<core::FlowFile> record = *it;
-        std::stringstream details;
-        details << process_context_->getProcessorNode()->getName() << " expire flow record " << record->getUUIDStr();
-        provenance_report_->expire(record, details.str());
-      }
+      expireFlowFiles(expired);
     }
     if (ret) {
-      // add the flow record to the current process session update map
-      ret->setDeleted(false);
-      _updatedFlowFiles[ret->getUUIDStr()] = ret;
-      std::map<std::string, std::string> empty;
-      std::shared_ptr<core::FlowFile> snapshot = std::make_shared<FlowFileRecord>(process_context_->getFlowFileRepository(), process_context_->getContentRepository(), empty);
-      auto flow_version = process_context_->getProcessorNode()->getFlowIdentifier();
-      if (flow_version != nullptr) {
-        auto flow_id = flow_version->getFlowId();
-        std::string attr = FlowAttributeKey(FLOW_ID);
-        snapshot->setAttribute(attr, flow_version->getFlowId());
-      }
-      logger_->log_debug("Create Snapshot FlowFile with UUID %s", snapshot->getUUIDStr());
-      snapshot = ret;
-      // save a snapshot
-      _originalFlowFiles[snapshot->getUUIDStr()] = snapshot;
+      addPolledFlowFile(ret);
       return ret;
     }
     current = std::static_pointer_cast<Connection>(process_context_->getProcessorNode()->getNextIncomingConnection());
@@ -948,6 +1005,43 @@ std::shared_ptr<core::FlowFile> ProcessSession::get() {
   return NULL;
 }
 
+std::vector<std::shared_ptr<core::FlowFile>> ProcessSession::get(size_t max_count, uint64_t max_bytes) {
+  std::vector<std::shared_ptr<core::FlowFile>> flows;
+  if (max_count == 0) {
+    return flows;
+  }
+
+  std::shared_ptr<Connectable> first = process_context_->getProcessorNode()->getNextIncomingConnection();
+
+  if (first == NULL) {
+    logger_->log_trace("Get is null for %s", process_context_->getProcessorNode()->getName());
+    return flows;
+  }
+
+  std::shared_ptr<Connection> current = std::static_pointer_cast<Connection>(first);
+  uint64_t bytes = 0;
+
+  do {
+    std::set<std::shared_ptr<core::FlowFile> > expired;
+    size_t polled = flows.size();
+    current->poll(flows, max_count - flows.size(), max_bytes > 0 ? max_bytes - bytes : 0, expired);
+    if (expired.size() > 0) {
+      expireFlowFiles(expired);
+    }
+    for (; polled < flows.size(); polled++) {
+      addPolledFlowFile(flows[polled]);
+      bytes += flows[polled]->getSize();
+    }
+    if (flows.size() >= max_count || (max_bytes > 0 && bytes >= max_bytes)) {
+      break;
+    }
+    current = std::static_pointer_cast<Connection>(process_context_->getProcessorNode()->getNextIncomingConnection());
+  } while (current != NULL && current != first);
+
+  logger_->log_trace("Get %llu flow files for %s", flows.size(), process_context_->getProcessorNode()->getName());
+  return flows;
+}
+
 } /* namespace core */
 } /* namespace minifi */
 } /* namespace nifi */
@@ -234,8 +234,12 @@ void Processor::onTrigger(ProcessContext *context, ProcessSessionFactory *sessio
   auto session = sessionFactory->createSession();
 
   try {
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t run_duration_nano = run_duration_nano_;
     // Call the virtual trigger function
-    onTrigger(context, session.get());
+    do {
+      onTrigger(context, session.get());
+    } while (continueTrigger(start, run_duration_nano));
     session->commit();
   } catch (std::exception &exception) {
     logger_->log_debug("Caught Exception %s", exception.what());
@@ -252,8 +256,12 @@ void Processor::onTrigger(const std::shared_ptr<ProcessContext> &context, const
   auto session = sessionFactory->createSession();
 
   try {
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t run_duration_nano = run_duration_nano_;
     // Call the virtual trigger function
-    onTrigger(context, session);
+    do {
+      onTrigger(context, session);
+    } while (continueTrigger(start, run_duration_nano));
     session->commit();
   } catch (std::exception &exception) {
     logger_->log_debug("Caught Exception %s", exception.what());
@@ -266,6 +274,17 @@ void Processor::onTrigger(const std::shared_ptr<ProcessContext> &context, const
   }
 }
 
+bool Processor::continueTrigger(const std::chrono::steady_clock::time_point &start, uint64_t run_duration_nano) {
+  if (run_duration_nano == 0 || isYield()) {
+    return false;
+  }
+  if (static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()) >= run_duration_nano) {
+    return false;
+  }
+  // flow files transferred by the session only reach outgoing connections once it commits
+  return isWorkAvailable() && !flowFilesOutGoingFull();
+}
+
 bool Processor::isWorkAvailable() {
   // We have work if any incoming connection has work
   bool hasWork = false;
@@ -273,7 +292,7 @@ bool Processor::isWorkAvailable() {
   try {
     for (const auto &conn : _incomingConnections) {
       std::shared_ptr<Connection> connection = std::static_pointer_cast<Connection>(conn);
-      if (connection->getQueueSize() > 0) {
+      if (connection->isWorkAvailable()) {
         hasWork = true;
         break;
       }
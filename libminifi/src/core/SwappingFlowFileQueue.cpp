@@ -0,0 +1,317 @@
+/**
+ * @file SwappingFlowFileQueue.cpp
+ * SwappingFlowFileQueue class implementation
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core/SwappingFlowFileQueue.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "FlowFileRecord.h"
+#include "core/logging/LoggerConfiguration.h"
+#include "io/DataStream.h"
+#include "utils/file/FileUtils.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+
+constexpr const char *SwappingFlowFileQueue::SwapFileExtension;
+
+std::mutex SwappingFlowFileQueue::cleaned_directories_mutex_;
+std::set<std::string> SwappingFlowFileQueue::cleaned_directories_;
+
+SwappingFlowFileQueue::SwappingFlowFileQueue(std::unique_ptr<FlowFileQueue> queue, uint64_t swap_threshold, const std::string &directory, const std::string &prefix,
+                                             const std::shared_ptr<core::Repository> &flow_repository, const std::shared_ptr<core::ContentRepository> &content_repo)
+    : queue_(std::move(queue)),
+      swap_threshold_(swap_threshold),
+      swap_batch_size_(swap_threshold > 1 ? swap_threshold / 2 : 1),
+      directory_(directory),
+      prefix_(prefix),
+      flow_repository_(flow_repository),
+      content_repo_(content_repo),
+      head_count_(0),
+      swapping_(false),
+      swapped_count_(0),
+      swap_sequence_(0),
+      logger_(logging::LoggerFactory<SwappingFlowFileQueue>::getLogger()) {
+  utils::file::FileUtils::create_dir(directory_);
+  removeStaleSwapFiles();
+}
+
+void SwappingFlowFileQueue::removeStaleSwapFiles() {
+  {
+    std::lock_guard<std::mutex> lock(cleaned_directories_mutex_);
+    if (!cleaned_directories_.insert(directory_).second) {
+      return;
+    }
+  }
+  // the flow files of earlier swap files were recovered from the flow file repository
+  const std::string extension = SwapFileExtension;
+  std::vector<std::string> stale_files;
+  utils::file::FileUtils::list_dir(directory_, [&](const std::string &dir, const std::string &filename) {
+    if (filename.size() > extension.size() && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0) {
+      stale_files.push_back(utils::file::FileUtils::concat_path(dir, filename));
+    }
+    return true;
+  }, logger_, false);
+  for (const auto &path : stale_files) {
+    logger_->log_debug("Removing swap file %s of a previous run", path);
+    std::remove(path.c_str());
+  }
+}
+
+SwappingFlowFileQueue::~SwappingFlowFileQueue() {
+  // swapped flow files are recovered from the flow file repository, not from swap files
+  for (const auto &swap_file : swap_files_) {
+    if (!swap_file->path.empty()) {
+      std::remove(swap_file->path.c_str());
+    }
+  }
+}
+
+size_t SwappingFlowFileQueue::getSwapFileCount() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return swap_files_.size();
+}
+
+void SwappingFlowFileQueue::push(const std::shared_ptr<core::FlowFile> &flow) {
+  std::shared_ptr<SwapFile> swap_file;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // decided under the lock, so that no flow file enters the head once a later one went to the tail
+    if (!swapping_ && head_count_ < swap_threshold_) {
+      head_count_++;
+      queue_->push(flow);
+      return;
+    }
+    swapping_ = true;
+    tail_.push_back(flow);
+    if (tail_.size() < swap_batch_size_) {
+      return;
+    }
+    swap_file = takeTail();
+  }
+  // producers and consumers do not wait on the disk
+  swapOut(swap_file);
+}
+
+bool SwappingFlowFileQueue::tryPop(std::shared_ptr<core::FlowFile> &flow) {
+  if (queue_->tryPop(flow)) {
+    head_count_--;
+    return true;
+  }
+  if (!swapping_) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (head_count_ == 0 && !swapIn()) {
+      return false;
+    }
+  }
+  if (queue_->tryPop(flow)) {
+    head_count_--;
+    return true;
+  }
+  return false;
+}
+
+size_t SwappingFlowFileQueue::tryPopBulk(std::vector<std::shared_ptr<core::FlowFile>> &flows, size_t max_count, uint64_t max_bytes) {
+  size_t start = flows.size();
+  size_t count = queue_->tryPopBulk(flows, max_count, max_bytes);
+  head_count_ -= count;
+  if (count >= max_count || !swapping_) {
+    return count;
+  }
+  uint64_t bytes = 0;
+  for (size_t i = start; i < flows.size(); i++) {
+    bytes += flows[i]->getSize();
+  }
+  if (max_bytes > 0 && bytes >= max_bytes) {
+    return count;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (head_count_ == 0 && !swapIn()) {
+      return count;
+    }
+  }
+  size_t swapped_in = queue_->tryPopBulk(flows, max_count - count, max_bytes > 0 ? max_bytes - bytes : 0);
+  head_count_ -= swapped_in;
+  return count + swapped_in;
+}
+
+std::shared_ptr<SwappingFlowFileQueue::SwapFile> SwappingFlowFileQueue::takeTail() {
+  auto swap_file = std::make_shared<SwapFile>();
+  swap_file->count = 0;
+  swap_file->path = utils::file::FileUtils::concat_path(directory_, prefix_ + "-" + std::to_string(swap_sequence_++) + SwapFileExtension);
+  swap_file->flows.swap(tail_);
+  swap_file->written = false;
+  swap_file->swapped_in = false;
+  swap_files_.push_back(swap_file);
+  return swap_file;
+}
+
+void SwappingFlowFileQueue::swapOut(const std::shared_ptr<SwapFile> &swap_file) {
+  // each record is its length, whether it owns a resource claim, then the serialized flow file record
+  io::DataStream batch;
+  std::vector<std::shared_ptr<core::FlowFile>> swapped;
+  std::vector<std::shared_ptr<core::FlowFile>> unswappable;
+  for (const auto &flow : swap_file->flows) {
+    std::shared_ptr<FlowFileRecord> record = std::dynamic_pointer_cast<FlowFileRecord>(flow);
+    io::DataStream stream;
+    // flow files that are not in the flow file repository could not be recovered, so they stay in memory
+    if (nullptr == record || !record->isStored() || !record->Serialize(stream)) {
+      unswappable.push_back(flow);
+      continue;
+    }
+    uint32_t length = static_cast<uint32_t>(stream.getSize());
+    uint8_t has_claim = nullptr != record->getResourceClaim() ? 1 : 0;
+    batch.writeData(reinterpret_cast<uint8_t*>(&length), sizeof(length));
+    batch.writeData(&has_claim, sizeof(has_claim));
+    batch.writeData(const_cast<uint8_t*>(stream.getBuffer()), length);
+    swapped.push_back(flow);
+  }
+
+  bool good = false;
+  if (!swapped.empty()) {
+    std::ofstream out(swap_file->path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(batch.getBuffer()), batch.getSize());
+    out.close();
+    good = out.good();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (swap_file->swapped_in) {
+    // a consumer took the batch from memory while the file was written
+    std::remove(swap_file->path.c_str());
+    return;
+  }
+  swap_file->written = true;
+  if (swapped.empty()) {
+    swap_file->path.clear();
+  } else if (good) {
+    for (const auto &flow : swapped) {
+      // the content must outlive the in memory flow file, the swapped in record takes over this reference
+      auto claim = flow->getResourceClaim();
+      if (nullptr != claim) {
+        claim->increaseFlowFileRecordOwnedCount();
+      }
+    }
+    swap_file->count = swapped.size();
+    swap_file->flows.swap(unswappable);
+    swapped_count_ += swap_file->count;
+    logger_->log_debug("Swapped out %llu flow files to %s", swap_file->count, swap_file->path);
+  } else {
+    logger_->log_error("Could not write swap file %s, keeping %llu flow files in memory", swap_file->path, swapped.size());
+    std::remove(swap_file->path.c_str());
+    swap_file->path.clear();
+  }
+}
+
+bool SwappingFlowFileQueue::swapIn() {
+  uint64_t count = 0;
+  if (!swap_files_.empty()) {
+    std::shared_ptr<SwapFile> swap_file = swap_files_.front();
+    swap_files_.pop_front();
+    if (swap_file->written) {
+      count = readSwapFile(*swap_file);
+    } else {
+      // the batch is still in memory, so its file is dropped once it was written
+      swap_file->swapped_in = true;
+      for (const auto &flow : swap_file->flows) {
+        head_count_++;
+        queue_->push(flow);
+      }
+      count = swap_file->flows.size();
+    }
+  } else if (!tail_.empty()) {
+    for (const auto &flow : tail_) {
+      head_count_++;
+      queue_->push(flow);
+    }
+    count = tail_.size();
+    tail_.clear();
+  }
+  if (swap_files_.empty() && tail_.empty()) {
+    swapping_ = false;
+  }
+  return count > 0;
+}
+
+uint64_t SwappingFlowFileQueue::readSwapFile(const SwapFile &swap_file) {
+  uint64_t count = 0;
+  if (!swap_file.path.empty()) {
+    std::ifstream in(swap_file.path, std::ios::binary);
+    std::string buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::remove(swap_file.path.c_str());
+
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(buffer.data());
+    const size_t header_size = sizeof(uint32_t) + sizeof(uint8_t);
+    size_t offset = 0;
+    while (offset + header_size <= buffer.size()) {
+      uint32_t length = 0;
+      std::memcpy(&length, data + offset, sizeof(length));
+      bool has_claim = data[offset + sizeof(length)] != 0;
+      offset += header_size;
+      if (offset + length > buffer.size()) {
+        break;
+      }
+      std::shared_ptr<FlowFileRecord> record = std::make_shared<FlowFileRecord>(flow_repository_, content_repo_);
+      if (record->DeSerialize(data + offset, length)) {
+        if (!has_claim) {
+          record->clearResourceClaim();
+        } else if (nullptr != content_repo_) {
+          // the record takes over the reference held on its claim since it was swapped out
+          record->getResourceClaim()->decreaseFlowFileRecordOwnedCount();
+        }
+        record->setStoredToRepository(true);
+        head_count_++;
+        queue_->push(record);
+        count++;
+      }
+      offset += length;
+    }
+    if (count != swap_file.count) {
+      logger_->log_error("Swap file %s held %llu of %llu flow files, the remainder will be recovered from the flow file repository on restart", swap_file.path, count,
+                         swap_file.count);
+    }
+    swapped_count_ -= swap_file.count;
+    logger_->log_debug("Swapped in %llu flow files from %s", count, swap_file.path);
+  }
+  for (const auto &flow : swap_file.flows) {
+    head_count_++;
+    queue_->push(flow);
+  }
+  return count + swap_file.flows.size();
+}
+
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
@@ -0,0 +1,139 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "core/logging/AsyncLogQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <utility>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace core {
+namespace logging {
+
+AsyncLogQueue::AsyncLogQueue(size_t capacity, OverflowPolicy policy)
+    : policy_(policy),
+      queue_(roundCapacity(capacity)),
+      running_(true),
+      dropped_(0),
+      waiting_(false) {
+  thread_ = std::thread(&AsyncLogQueue::run, this);
+}
+
+AsyncLogQueue::~AsyncLogQueue() {
+  stop();
+}
+
+bool AsyncLogQueue::push(spdlog::logger *logger, spdlog::level::level_enum level, std::string &message) {
+  if (!running_) {
+    return false;
+  }
+  Record record;
+  record.logger = logger;
+  record.level = level;
+  record.message = std::move(message);
+  while (!queue_.enqueue(std::move(record))) {
+    if (policy_ == OverflowPolicy::DROP) {
+      dropped_++;
+      return true;
+    }
+    if (!running_) {
+      message = std::move(record.message);
+      return false;
+    }
+    std::this_thread::yield();
+  }
+  // pairs with the fence in run: either the background thread sees this message before it sleeps or it is seen waiting here
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting_) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_.notify_one();
+  }
+  return true;
+}
+
+void AsyncLogQueue::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+    ready_.notify_one();
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  // messages that were being queued while the thread stopped
+  Record record;
+  while (queue_.dequeue(record)) {
+    record.logger->log(record.level, record.message);
+  }
+}
+
+AsyncLogQueue::OverflowPolicy AsyncLogQueue::parsePolicy(const std::string &policy) {
+  std::string lower = policy;
+  std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+  return lower == "drop" ? OverflowPolicy::DROP : OverflowPolicy::BLOCK;
+}
+
+size_t AsyncLogQueue::roundCapacity(size_t capacity) {
+  size_t rounded = 2;
+  while (rounded < capacity) {
+    rounded <<= 1;
+  }
+  return rounded;
+}
+
+void AsyncLogQueue::run() {
+  Record record;
+  spdlog::logger *last_logger = nullptr;
+  uint64_t reported = 0;
+  while (true) {
+    if (queue_.dequeue(record)) {
+      record.logger->log(record.level, record.message);
+      last_logger = record.logger;
+      continue;
+    }
+    uint64_t dropped = dropped_;
+    if (dropped != reported && last_logger != nullptr) {
+      last_logger->log(spdlog::level::warn, "Dropped " + std::to_string(dropped - reported) + " log messages as the log queue was full");
+      reported = dropped;
+    }
+    if (!running_) {
+      // the queue is empty and no more messages are accepted
+      break;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiting_ = true;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // sleeps until a message is queued or the queue is stopped, both of which notify under the lock
+    ready_.wait(lock, [this] { return !running_ || queue_.approx_size() != 0; });
+    waiting_ = false;
+  }
+}
+
+} /* namespace logging */
+} /* namespace core */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
@@ -70,6 +70,17 @@ LoggerConfiguration::LoggerConfiguration()
   loggers.push_back(logger_);
 }
 
+LoggerConfiguration::~LoggerConfiguration() {
+  std::lock_guard<std::mutex> lock(mutex);
+  // loggers may outlive the configuration, so they log synchronously before the queue goes away
+  for (auto const & logger_impl : loggers) {
+    logger_impl->set_queue(nullptr);
+  }
+  if (queue_) {
+    queue_->stop();
+  }
+}
+
 void LoggerConfiguration::initialize(const std::shared_ptr<LoggerProperties> &logger_properties) {
   std::lock_guard<std::mutex> lock(mutex);
   root_namespace_ = initialize_namespaces(logger_properties);
@@ -90,6 +101,35 @@ void LoggerConfiguration::initialize(const std::shared_ptr<LoggerProperties> &lo
     }
     logger_impl->set_delegate(spdlogger);
   }
+
+  std::shared_ptr<AsyncLogQueue> previous_queue = queue_;
+  queue_ = nullptr;
+  std::string async_str;
+  bool async = false;
+  if (logger_properties->get("async.enabled", async_str)) {
+    utils::StringUtils::StringToBool(async_str, async);
+  }
+  if (async) {
+    size_t queue_size = 8192;
+    std::string queue_size_str;
+    if (logger_properties->get("async.queue_size", queue_size_str)) {
+      try {
+        queue_size = std::stoul(queue_size_str);
+      } catch (const std::invalid_argument &ia) {
+      } catch (const std::out_of_range &oor) {
+      }
+    }
+    std::string policy_str = "block";
+    logger_properties->get("async.overflow_policy", policy_str);
+    queue_ = std::make_shared<AsyncLogQueue>(queue_size, AsyncLogQueue::parsePolicy(policy_str));
+  }
+  for (auto const & logger_impl : loggers) {
+    logger_impl->set_queue(queue_.get());
+  }
+  if (previous_queue) {
+    previous_queue->stop();
+    stopped_queues_.push_back(previous_queue);
+  }
   logger_->log_debug("Set following pattern on loggers: %s", spdlog_pattern);
 }
 
@@ -101,6 +141,7 @@ std::shared_ptr<Logger> LoggerConfiguration::getLogger(const std::string &name)
   if (haz_clazz == 0)
     adjusted_name = name.substr(clazz.length(), name.length() - clazz.length());
   std::shared_ptr<LoggerImpl> result = std::make_shared<LoggerImpl>(adjusted_name, controller_, get_logger(logger_, root_namespace_, adjusted_name, formatter_));
+  result->set_queue(queue_.get());
   loggers.push_back(result);
   return result;
 }
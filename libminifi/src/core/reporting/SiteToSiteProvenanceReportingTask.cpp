@@ -164,7 +164,8 @@ void SiteToSiteProvenanceReportingTask::onTrigger(const std::shared_ptr<core::Pr
     return;
   }
 
-  auto protocol_ = getNextProtocol(true);
+  std::shared_ptr<sitetosite::Peer> peer;
+  auto protocol_ = getNextProtocol(peer);
 
   if (!protocol_) {
     context->yield();
@@ -178,12 +179,13 @@ void SiteToSiteProvenanceReportingTask::onTrigger(const std::shared_ptr<core::Pr
     }
   } catch (...) {
     // if transfer bytes failed, return instead of purge the provenance records
+    peer_selector_.penalize(*peer);
     return;
   }
 
   // we transfer the record, purge the record from DB
   repo->Delete(records);
-  returnProtocol(std::move(protocol_));
+  returnProtocol(peer, std::move(protocol_));
 }
 
 } /* namespace reporting */
@@ -17,9 +17,18 @@
  */
 
 #include "core/repository/FileSystemRepository.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+#include "core/Property.h"
 #include "io/FileStream.h"
+#include "utils/Id.h"
 #include "utils/file/FileUtils.h"
 
 namespace org {
@@ -29,6 +38,157 @@ namespace minifi {
 namespace core {
 namespace repository {
 
+constexpr uint32_t FileSystemRepository::DefaultMaxFlowFilesPerClaim;
+
+namespace {
+
+/**
+ * Appends the content of a single claim to a container. The container is handed back to
+ * the repository once the stream is closed.
+ */
+class ContainerWriteStream : public io::BaseStream {
+ public:
+  ContainerWriteStream(const std::string &path, std::function<void(uint64_t)> release)
+      : stream_(path, true),
+        written_(0),
+        release_(std::move(release)) {
+  }
+
+  virtual ~ContainerWriteStream() {
+    closeStream();
+  }
+
+  virtual void closeStream() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stream_.closeStream();
+    if (release_) {
+      release_(written_);
+      release_ = nullptr;
+    }
+  }
+
+  virtual bool flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stream_.flush();
+  }
+
+  // content is only ever appended to a container
+  virtual void seek(uint64_t offset) {
+  }
+
+  virtual const uint64_t getSize() const {
+    return written_;
+  }
+
+  virtual int writeData(std::vector<uint8_t> &buf, int buflen) {
+    if (static_cast<int>(buf.capacity()) < buflen) {
+      return -1;
+    }
+    return writeData(reinterpret_cast<uint8_t *>(&buf[0]), buflen);
+  }
+
+  virtual int writeData(uint8_t *value, int size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!release_) {
+      return -1;
+    }
+    int ret = stream_.writeData(value, size);
+    if (ret > 0) {
+      written_ += ret;
+    }
+    return ret;
+  }
+
+  virtual int readData(std::vector<uint8_t> &buf, int buflen) {
+    return -1;
+  }
+
+  virtual int readData(uint8_t *buf, int buflen) {
+    return -1;
+  }
+
+ private:
+  std::mutex mutex_;
+  io::FileStream stream_;
+  uint64_t written_;
+  std::function<void(uint64_t)> release_;
+};
+
+/**
+ * Reads the content of a single claim from a container. Offsets and the size are relative
+ * to the start of the claim.
+ */
+class ContainerReadStream : public io::BaseStream {
+ public:
+  ContainerReadStream(const std::string &path, uint64_t offset, uint64_t length)
+      : stream_(path, 0, false),
+        offset_(offset),
+        length_(length),
+        position_(0) {
+    stream_.seek(offset_);
+  }
+
+  virtual ~ContainerReadStream() {
+    closeStream();
+  }
+
+  virtual void closeStream() {
+    stream_.closeStream();
+  }
+
+  virtual void seek(uint64_t offset) {
+    position_ = std::min(offset, length_);
+    stream_.seek(offset_ + position_);
+  }
+
+  virtual const uint64_t getSize() const {
+    return length_;
+  }
+
+  virtual int readData(std::vector<uint8_t> &buf, int buflen) {
+    if (static_cast<int>(buf.capacity()) < buflen) {
+      buf.resize(buflen);
+    }
+    int ret = readData(reinterpret_cast<uint8_t*>(&buf[0]), buflen);
+    if (ret >= 0 && ret < buflen) {
+      buf.resize(ret);
+    }
+    return ret;
+  }
+
+  virtual int readData(uint8_t *buf, int buflen) {
+    if (buflen < 0) {
+      return -1;
+    }
+    uint64_t remaining = length_ - position_;
+    int len = static_cast<int>(std::min<uint64_t>(buflen, remaining));
+    if (len == 0) {
+      return 0;
+    }
+    int ret = stream_.readData(buf, len);
+    if (ret > 0) {
+      position_ += ret;
+    }
+    return ret;
+  }
+
+  virtual int writeData(std::vector<uint8_t> &buf, int buflen) {
+    return -1;
+  }
+
+  virtual int writeData(uint8_t *value, int size) {
+    return -1;
+  }
+
+ private:
+  io::FileStream stream_;
+  uint64_t offset_;
+  uint64_t length_;
+  uint64_t position_;
+};
+
+}  // namespace
+
 bool FileSystemRepository::initialize(const std::shared_ptr<minifi::Configure> &configuration) {
   std::string value;
   if (configuration->get(Configure::nifi_dbcontent_repository_directory_default, value)) {
@@ -36,14 +196,121 @@ bool FileSystemRepository::initialize(const std::shared_ptr<minifi::Configure> &
   } else {
     directory_ = configuration->getHome() + "/contentrepository";
   }
+  if (configuration->get(Configure::nifi_content_claim_max_appendable_size, value)) {
+    core::Property::StringToInt(value, max_appendable_size_);
+  }
+  if (configuration->get(Configure::nifi_content_claim_max_flow_files, value)) {
+    core::Property::StringToInt(value, max_flow_files_per_claim_);
+    if (max_flow_files_per_claim_ == 0) {
+      max_flow_files_per_claim_ = 1;
+    }
+  }
+  if (isUsingContainers()) {
+    logger_->log_debug("Appending claims of up to %llu bytes or %u flow files to containers", max_appendable_size_, max_flow_files_per_claim_);
+  }
   utils::file::FileUtils::create_dir(directory_);
   return true;
 }
+
 void FileSystemRepository::stop() {
+  std::vector<std::string> retired;
+  {
+    std::lock_guard<std::mutex> lock(container_mutex_);
+    for (const auto &container : writable_containers_) {
+      active_containers_.erase(container.path);
+      retired.push_back(container.path);
+    }
+    writable_containers_.clear();
+  }
+  for (const auto &path : retired) {
+    removeIfUnclaimed(path);
+  }
 }
 
 std::shared_ptr<io::BaseStream> FileSystemRepository::write(const std::shared_ptr<minifi::ResourceClaim> &claim, bool append) {
-  return std::make_shared<io::FileStream>(claim->getContentFullPath(), append);
+  if (!isUsingContainers() || append) {
+    return std::make_shared<io::FileStream>(claim->getContentFullPath(), append);
+  }
+  Container container;
+  {
+    std::lock_guard<std::mutex> lock(container_mutex_);
+    if (!writable_containers_.empty()) {
+      container = writable_containers_.front();
+      writable_containers_.pop_front();
+    } else {
+      // the path generated for the claim becomes the path of a new container
+      container.path = claim->getContentFullPath();
+      container.length = 0;
+      container.claims = 0;
+      active_containers_.insert(container.path);
+    }
+  }
+  claim->setContentFullPath(container.path);
+  claim->setOffset(container.length);
+  container.claims++;
+  return std::make_shared<ContainerWriteStream>(container.path, [this, container](uint64_t written) {
+    Container released = container;
+    released.length += written;
+    releaseContainer(released);
+  });
+}
+
+void FileSystemRepository::releaseContainer(const Container &container) {
+  {
+    std::lock_guard<std::mutex> lock(container_mutex_);
+    if (container.length < max_appendable_size_ && container.claims < max_flow_files_per_claim_) {
+      writable_containers_.push_back(container);
+      return;
+    }
+    active_containers_.erase(container.path);
+  }
+  logger_->log_debug("Container %s is full with %u claims in %llu bytes", container.path, container.claims, container.length);
+  removeIfUnclaimed(container.path);
+}
+
+bool FileSystemRepository::removeIfUnclaimed(const std::string &path) {
+  std::lock_guard<std::mutex> lock(count_map_mutex_);
+  auto count = count_map_.find(path);
+  if (count == count_map_.end() || count->second == 0) {
+    std::remove(path.c_str());
+    count_map_.erase(path);
+    return true;
+  }
+  return false;
+}
+
+bool FileSystemRepository::importFile(const std::string &path, uint64_t offset, bool move, const std::shared_ptr<minifi::ResourceClaim> &claim, uint64_t &size) {
+  if (isUsingContainers()) {
+    return false;
+  }
+  if (move && offset == 0 && std::rename(path.c_str(), claim->getContentFullPath().c_str()) == 0) {
+    std::ifstream file(claim->getContentFullPath(), std::ios::binary | std::ios::ate);
+    if (file.good()) {
+      size = file.tellg();
+      logger_->log_debug("Moved %s into %s", path, claim->getContentFullPath());
+      return true;
+    }
+    // leave the file where the importer expects it
+    std::rename(claim->getContentFullPath().c_str(), path.c_str());
+    return false;
+  }
+  // the source may be on another file system, which rename does not cross
+  int64_t copied = utils::file::FileUtils::copy_range(path, offset, std::numeric_limits<uint64_t>::max(), claim->getContentFullPath());
+  if (copied < 0) {
+    std::remove(claim->getContentFullPath().c_str());
+    return false;
+  }
+  size = copied;
+  return true;
+}
+
+bool FileSystemRepository::exportFile(const std::shared_ptr<minifi::ResourceClaim> &claim, uint64_t offset, uint64_t length, const std::string &path) {
+  if (!isUsingContainers() && offset == 0 && static_cast<uint64_t>(std::ifstream(claim->getContentFullPath(), std::ios::binary | std::ios::ate).tellg()) == length) {
+    // the range is the whole of a file that is no longer written, so the file can be cloned
+    return utils::file::FileUtils::copy_range(claim->getContentFullPath(), 0, std::numeric_limits<uint64_t>::max(), path) == static_cast<int64_t>(length);
+  }
+  // a container may be appended to while its range is copied, which must not take more than the range
+  return utils::file::FileUtils::copy_range(claim->getContentFullPath(), offset, length, path) == static_cast<int64_t>(length);
 }
 
 bool FileSystemRepository::exists(const std::shared_ptr<minifi::ResourceClaim> &streamId) {
@@ -55,11 +322,37 @@ std::shared_ptr<io::BaseStream> FileSystemRepository::read(const std::shared_ptr
   return std::make_shared<io::FileStream>(claim->getContentFullPath(), 0, false);
 }
 
+std::shared_ptr<io::BaseStream> FileSystemRepository::read(const std::shared_ptr<minifi::ResourceClaim> &claim, uint64_t offset, uint64_t length) {
+  if (!isUsingContainers()) {
+    return ContentRepository::read(claim, offset, length);
+  }
+  return std::make_shared<ContainerReadStream>(claim->getContentFullPath(), offset, length);
+}
+
 bool FileSystemRepository::remove(const std::shared_ptr<minifi::ResourceClaim> &claim) {
+  if (isUsingContainers()) {
+    {
+      std::lock_guard<std::mutex> lock(container_mutex_);
+      // containers still accepting claims are removed once they are full
+      if (active_containers_.find(claim->getContentFullPath()) != active_containers_.end()) {
+        return false;
+      }
+    }
+    // the container may still hold the content of other claims
+    return removeIfUnclaimed(claim->getContentFullPath());
+  }
   std::remove(claim->getContentFullPath().c_str());
   return true;
 }
 
+bool FileSystemRepository::removeIfOrphaned(const std::shared_ptr<minifi::ResourceClaim> &claim) {
+  if (!isUsingContainers()) {
+    return ContentRepository::removeIfOrphaned(claim);
+  }
+  // remove is already aware of the claim counts of containers
+  return remove(claim);
+}
+
 } /* namespace repository */
 } /* namespace core */
 } /* namespace minifi */
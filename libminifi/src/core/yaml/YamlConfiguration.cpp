@@ -22,6 +22,7 @@
 
 #include "core/yaml/YamlConfiguration.h"
 #include "core/state/Value.h"
+#include "utils/file/FileUtils.h"
 #ifdef YAML_CONFIGURATION_USE_REGEX
 #include <regex>
 #endif  // YAML_CONFIGURATION_USE_REGEX
@@ -581,6 +582,50 @@ void YamlConfiguration::parseConnectionYaml(YAML::Node *connectionsNode, core::P
           logging::LOG_DEBUG(logger_) << "Setting " << max_work_queue_data_size << " as the max queue data size for " << name;
         }
 
+        if (connectionNode["queue type"]) {
+          auto queue_type = connectionNode["queue type"].as<std::string>();
+          if (!connection->setQueueType(queue_type)) {
+            throw std::invalid_argument("Invalid queue type " + queue_type + " for connection " + name);
+          }
+          logging::LOG_DEBUG(logger_) << "Setting " << queue_type << " as the queue type for " << name;
+        }
+
+        if (connectionNode["prioritizers"]) {
+          YAML::Node prioritizersNode = connectionNode["prioritizers"];
+          std::vector<std::string> prioritizer_names;
+          if (prioritizersNode.IsSequence()) {
+            for (YAML::const_iterator iter = prioritizersNode.begin(); iter != prioritizersNode.end(); ++iter) {
+              prioritizer_names.push_back(iter->as<std::string>());
+            }
+          } else {
+            prioritizer_names = utils::StringUtils::split(prioritizersNode.as<std::string>(), ",");
+          }
+          std::vector<std::shared_ptr<core::FlowFilePrioritizer>> prioritizers;
+          for (const auto &prioritizer_name : prioritizer_names) {
+            auto prioritizer = core::FlowFilePrioritizer::create(prioritizer_name);
+            if (nullptr == prioritizer) {
+              throw std::invalid_argument("Invalid prioritizer " + prioritizer_name + " for connection " + name);
+            }
+            logging::LOG_DEBUG(logger_) << "Adding " << prioritizer->getName() << " as a prioritizer for " << name;
+            prioritizers.push_back(prioritizer);
+          }
+          connection->setPrioritizers(prioritizers);
+        }
+
+        if (connectionNode["swap threshold"]) {
+          auto swap_threshold_str = connectionNode["swap threshold"].as<std::string>();
+          uint64_t swap_threshold = 0;
+          if (!core::Property::StringToInt(swap_threshold_str, swap_threshold)) {
+            throw std::invalid_argument("Invalid swap threshold " + swap_threshold_str + " for connection " + name);
+          }
+          std::string swap_directory;
+          if (nullptr == configuration_ || !configuration_->get(minifi::Configure::nifi_flowfile_swap_directory_default, swap_directory)) {
+            swap_directory = utils::file::FileUtils::concat_path(nullptr != configuration_ ? configuration_->getHome() : ".", "flowfile_swap");
+          }
+          connection->setSwapThreshold(swap_threshold, swap_directory);
+          logging::LOG_DEBUG(logger_) << "Setting " << swap_threshold << " as the swap threshold for " << name;
+        }
+
         if (connectionNode["source id"]) {
           std::string connectionSrcProcId = connectionNode["source id"].as<std::string>();
           srcUUID = connectionSrcProcId;
@@ -722,6 +767,9 @@ void YamlConfiguration::parsePortYaml(YAML::Node *portNode, core::ProcessGroup *
   YAML::Node propertiesNode = nodeVal["Properties"];
   parsePropertiesNodeYaml(&propertiesNode, std::static_pointer_cast<core::ConfigurableComponent>(processor), nameStr,
   CONFIG_YAML_REMOTE_PROCESS_GROUP_KEY);
+  if (inputPortsObj["use compression"]) {
+    processor->setProperty(minifi::RemoteProcessorGroupPort::useCompression, inputPortsObj["use compression"].as<std::string>());
+  }
 
   // add processor to parent
   parent->addProcessor(processor);
@@ -16,6 +16,8 @@
  * limitations under the License.
  */
 #include "io/BaseStream.h"
+#include <algorithm>
+#include <limits>
 #include <vector>
 #include <string>
 #include "io/Serializable.h"
@@ -45,6 +47,35 @@ int BaseStream::writeData(uint8_t *value, int size) {
   }
 }
 
+int64_t BaseStream::writeBytes(const uint8_t *value, uint64_t len) {
+  uint64_t written = 0;
+  while (written < len) {
+    int size = static_cast<int>(std::min<uint64_t>(len - written, std::numeric_limits<int>::max()));
+    int ret = writeData(const_cast<uint8_t*>(value) + written, size);
+    if (ret < 0) {
+      return -1;
+    }
+    written += size;
+  }
+  return written;
+}
+
+int64_t BaseStream::readBytes(uint8_t *buf, uint64_t len) {
+  uint64_t total = 0;
+  while (total < len) {
+    int size = static_cast<int>(std::min<uint64_t>(len - total, std::numeric_limits<int>::max()));
+    int ret = readData(buf + total, size);
+    if (ret < 0) {
+      return total > 0 ? total : -1;
+    }
+    total += ret;
+    if (ret < size) {
+      break;
+    }
+  }
+  return total;
+}
+
 /**
  * write 2 bytes to stream
  * @param base_value non encoded value
@@ -147,7 +178,10 @@ int BaseStream::read(uint8_t *value, int len) {
  * @param buflen
  */
 int BaseStream::readData(std::vector<uint8_t> &buf, int buflen) {
-  return Serializable::read(&buf[0], buflen, composable_stream_);
+  if (buf.size() < static_cast<size_t>(buflen)) {
+    buf.resize(buflen);
+  }
+  return Serializable::read(buf.data(), buflen, composable_stream_);
 }
 /**
  * Reads data and places it into buf
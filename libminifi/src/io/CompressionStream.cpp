@@ -0,0 +1,280 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "io/CompressionStream.h"
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace io {
+
+namespace {
+
+const uint8_t SYNC_BYTES[] = { 'S', 'Y', 'N', 'C' };
+
+void writeInt(uint32_t value, uint8_t *bytes) {
+  bytes[0] = static_cast<uint8_t>(value >> 24);
+  bytes[1] = static_cast<uint8_t>(value >> 16);
+  bytes[2] = static_cast<uint8_t>(value >> 8);
+  bytes[3] = static_cast<uint8_t>(value);
+}
+
+uint32_t readInt(const uint8_t *bytes) {
+  return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) | (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+}
+
+}  // namespace
+
+constexpr int CompressionOutputStream::DEFAULT_COMPRESSION_LEVEL;
+constexpr int CompressionOutputStream::DEFAULT_BUFFER_SIZE;
+constexpr uint32_t CompressionInputStream::MAX_CHUNK_SIZE;
+
+CompressionOutputStream::CompressionOutputStream(BaseStream *stream, int level, int buffer_size)
+    : child_stream_(stream),
+      valid_(false),
+      data_written_(false),
+      closed_(false),
+      buffer_(buffer_size > 0 ? buffer_size : DEFAULT_BUFFER_SIZE),
+      buffer_index_(0) {
+  memset(&strm_, 0, sizeof(strm_));
+  valid_ = deflateInit(&strm_, level) == Z_OK;
+  if (valid_) {
+    compressed_.resize(deflateBound(&strm_, buffer_.size()));
+  }
+}
+
+CompressionOutputStream::~CompressionOutputStream() {
+  if (valid_) {
+    deflateEnd(&strm_);
+  }
+}
+
+int CompressionOutputStream::writeData(std::vector<uint8_t> &buf, int buflen) {
+  if (static_cast<int>(buf.capacity()) < buflen)
+    buf.resize(buflen);
+  return writeData(buf.data(), buflen);
+}
+
+int CompressionOutputStream::writeData(uint8_t *value, int size) {
+  if (!valid_ || closed_ || size < 0) {
+    return -1;
+  }
+  int written = 0;
+  while (written < size) {
+    int count = std::min(size - written, static_cast<int>(buffer_.size()) - buffer_index_);
+    memcpy(buffer_.data() + buffer_index_, value + written, count);
+    buffer_index_ += count;
+    written += count;
+    if (buffer_index_ == static_cast<int>(buffer_.size()) && compressAndWrite() < 0) {
+      return -1;
+    }
+  }
+  return size;
+}
+
+int CompressionOutputStream::close() {
+  if (closed_) {
+    return 0;
+  }
+  closed_ = true;
+  if (!valid_ || compressAndWrite() < 0) {
+    return -1;
+  }
+  uint8_t end = 0;
+  return child_stream_->write(&end, 1) == 1 ? 0 : -1;
+}
+
+int CompressionOutputStream::compressAndWrite() {
+  if (buffer_index_ == 0) {
+    return 0;
+  }
+  strm_.next_in = buffer_.data();
+  strm_.avail_in = buffer_index_;
+  strm_.next_out = compressed_.data();
+  strm_.avail_out = compressed_.size();
+  int ret = deflate(&strm_, Z_FINISH);
+  int compressed_size = compressed_.size() - strm_.avail_out;
+  deflateReset(&strm_);
+  if (ret != Z_STREAM_END) {
+    return -1;
+  }
+
+  // chunks after the first are preceded by a byte telling the reader that more data follows
+  uint8_t header[13];
+  int header_size = 0;
+  if (data_written_) {
+    header[header_size++] = 1;
+  }
+  memcpy(header + header_size, SYNC_BYTES, sizeof(SYNC_BYTES));
+  header_size += sizeof(SYNC_BYTES);
+  writeInt(buffer_index_, header + header_size);
+  writeInt(compressed_size, header + header_size + 4);
+  header_size += 8;
+
+  if (child_stream_->write(header, header_size) != header_size || child_stream_->write(compressed_.data(), compressed_size) != compressed_size) {
+    return -1;
+  }
+  data_written_ = true;
+  buffer_index_ = 0;
+  return 0;
+}
+
+CompressionInputStream::CompressionInputStream(BaseStream *stream)
+    : child_stream_(stream),
+      valid_(false),
+      eos_(false),
+      buffer_index_(0) {
+  memset(&strm_, 0, sizeof(strm_));
+  valid_ = inflateInit(&strm_) == Z_OK;
+}
+
+CompressionInputStream::~CompressionInputStream() {
+  if (valid_) {
+    inflateEnd(&strm_);
+  }
+}
+
+int CompressionInputStream::readData(std::vector<uint8_t> &buf, int buflen) {
+  if (static_cast<int>(buf.capacity()) < buflen)
+    buf.resize(buflen);
+  return readData(buf.data(), buflen);
+}
+
+int CompressionInputStream::readData(uint8_t *buf, int buflen) {
+  if (!valid_ || buflen < 0) {
+    return -1;
+  }
+  int total = 0;
+  while (total < buflen) {
+    if (buffer_index_ >= buffer_.size()) {
+      if (eos_) {
+        break;
+      }
+      if (decompressChunk() < 0) {
+        return -1;
+      }
+      continue;
+    }
+    size_t count = std::min<size_t>(buflen - total, buffer_.size() - buffer_index_);
+    memcpy(buf + total, buffer_.data() + buffer_index_, count);
+    buffer_index_ += count;
+    total += count;
+  }
+  return total;
+}
+
+int CompressionInputStream::read(uint16_t &value, bool is_little_endian) {
+  uint8_t bytes[sizeof value];
+  uint64_t result;
+  int ret = readNumber(bytes, sizeof value, is_little_endian, result);
+  value = static_cast<uint16_t>(result);
+  return ret;
+}
+
+int CompressionInputStream::read(uint32_t &value, bool is_little_endian) {
+  uint8_t bytes[sizeof value];
+  uint64_t result;
+  int ret = readNumber(bytes, sizeof value, is_little_endian, result);
+  value = static_cast<uint32_t>(result);
+  return ret;
+}
+
+int CompressionInputStream::read(uint64_t &value, bool is_little_endian) {
+  uint8_t bytes[sizeof value];
+  return readNumber(bytes, sizeof value, is_little_endian, value);
+}
+
+int CompressionInputStream::readNumber(uint8_t *bytes, int size, bool is_little_endian, uint64_t &value) {
+  value = 0;
+  if (readData(bytes, size) != size) {
+    return -1;
+  }
+  // numbers are in network order, unless the caller reads them as they are stored on this host
+  for (int i = 0; i < size; i++) {
+    int index = is_little_endian ? i : size - 1 - i;
+    value = (value << 8) | bytes[index];
+  }
+  return size;
+}
+
+int CompressionInputStream::decompressChunk() {
+  uint8_t header[12];
+  if (readFully(header, 1) != 1) {
+    return -1;
+  }
+  // a stream to which nothing was written only holds the end of stream marker
+  if (header[0] == 0 && buffer_.empty()) {
+    eos_ = true;
+    return 0;
+  }
+  if (readFully(header + 1, sizeof(header) - 1) != sizeof(header) - 1 || memcmp(header, SYNC_BYTES, sizeof(SYNC_BYTES)) != 0) {
+    return -1;
+  }
+  uint32_t size = readInt(header + 4);
+  uint32_t compressed_size = readInt(header + 8);
+  if (size > MAX_CHUNK_SIZE || compressed_size > MAX_CHUNK_SIZE) {
+    return -1;
+  }
+  compressed_.resize(compressed_size);
+  if (readFully(compressed_.data(), compressed_size) != static_cast<int>(compressed_size)) {
+    return -1;
+  }
+
+  buffer_.resize(size);
+  strm_.next_in = compressed_.data();
+  strm_.avail_in = compressed_size;
+  strm_.next_out = buffer_.data();
+  strm_.avail_out = size;
+  int ret = inflate(&strm_, Z_FINISH);
+  bool inflated = ret == Z_STREAM_END && strm_.avail_out == 0;
+  inflateReset(&strm_);
+  if (!inflated) {
+    return -1;
+  }
+  buffer_index_ = 0;
+
+  // a chunk is always followed by 1 when another chunk follows or 0 at the end of the stream
+  uint8_t more;
+  if (readFully(&more, 1) != 1 || more > 1) {
+    return -1;
+  }
+  eos_ = more == 0;
+  return size;
+}
+
+int CompressionInputStream::readFully(uint8_t *buf, int buflen) {
+  int total = 0;
+  while (total < buflen) {
+    int ret = child_stream_->read(buf + total, buflen - total);
+    if (ret <= 0) {
+      break;
+    }
+    total += ret;
+  }
+  return total;
+}
+
+} /* namespace io */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
@@ -17,10 +17,21 @@
  */
 
 #include "io/FileStream.h"
-#include <fstream>
-#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 #include "io/validation.h"
 namespace org {
 namespace apache {
@@ -28,61 +39,181 @@ namespace nifi {
 namespace minifi {
 namespace io {
 
+constexpr size_t FileStream::WriteBufferSize;
+
+namespace {
+
+#ifdef WIN32
+int openFile(const std::string &path, int flags) {
+  return _open(path.c_str(), flags | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+
+int64_t readAt(int fd, uint8_t *buf, size_t len, uint64_t offset) {
+  if (_lseeki64(fd, offset, SEEK_SET) < 0) {
+    return -1;
+  }
+  return _read(fd, buf, static_cast<unsigned int>(std::min<size_t>(len, std::numeric_limits<int>::max())));
+}
+
+int64_t writeAt(int fd, const uint8_t *buf, size_t len, uint64_t offset) {
+  if (_lseeki64(fd, offset, SEEK_SET) < 0) {
+    return -1;
+  }
+  return _write(fd, buf, static_cast<unsigned int>(std::min<size_t>(len, std::numeric_limits<int>::max())));
+}
+
+uint64_t fileSize(int fd) {
+  int64_t size = _lseeki64(fd, 0, SEEK_END);
+  return size > 0 ? size : 0;
+}
+
+bool syncFile(int fd) {
+  return _commit(fd) == 0;
+}
+
+int closeFile(int fd) {
+  return _close(fd);
+}
+#else
+int openFile(const std::string &path, int flags) {
+  int fd;
+  do {
+    fd = open(path.c_str(), flags | O_CLOEXEC, 0666);
+  } while (fd < 0 && errno == EINTR);
+  return fd;
+}
+
+int64_t readAt(int fd, uint8_t *buf, size_t len, uint64_t offset) {
+  ssize_t ret;
+  do {
+    ret = pread(fd, buf, len, offset);
+  } while (ret < 0 && errno == EINTR);
+  return ret;
+}
+
+int64_t writeAt(int fd, const uint8_t *buf, size_t len, uint64_t offset) {
+  ssize_t ret;
+  do {
+    ret = pwrite(fd, buf, len, offset);
+  } while (ret < 0 && errno == EINTR);
+  return ret;
+}
+
+uint64_t fileSize(int fd) {
+  struct stat status;
+  if (fstat(fd, &status) != 0) {
+    return 0;
+  }
+  return status.st_size;
+}
+
+bool syncFile(int fd) {
+  return fsync(fd) == 0;
+}
+
+int closeFile(int fd) {
+  return close(fd);
+}
+#endif
+
+bool writeFully(int fd, const uint8_t *buf, uint64_t len, uint64_t offset) {
+  uint64_t written = 0;
+  while (written < len) {
+    int64_t ret = writeAt(fd, buf + written, len - written, offset + written);
+    if (ret <= 0) {
+      return false;
+    }
+    written += ret;
+  }
+  return true;
+}
+
+}  // namespace
+
 FileStream::FileStream(const std::string &path, bool append)
     : logger_(logging::LoggerFactory<FileStream>::getLogger()),
       path_(path),
-      offset_(0) {
-  file_stream_ = std::unique_ptr<std::fstream>(new std::fstream());
-  if (append)
-    file_stream_->open(path.c_str(), std::fstream::in | std::fstream::out | std::fstream::app | std::fstream::binary);
-  else
-    file_stream_->open(path.c_str(), std::fstream::out | std::fstream::binary);
-  file_stream_->seekg(0, file_stream_->end);
-  file_stream_->seekp(0, file_stream_->end);
-  int len = file_stream_->tellg();
-  if (len > 0) {
-    length_ = len;
-  } else {
-    length_ = 0;
+      offset_(0),
+      length_(0),
+      write_enable_(true),
+      append_(append),
+      write_buffer_offset_(0),
+      write_failed_(false) {
+  fd_ = openFile(path, append ? (O_RDWR | O_CREAT) : (O_RDWR | O_CREAT | O_TRUNC));
+  if (fd_ < 0) {
+    logger_->log_error("Could not open %s for writing: %s", path, std::strerror(errno));
+    return;
   }
-  seek(offset_);
+  length_ = fileSize(fd_);
 }
 
-FileStream::FileStream(const std::string &path, uint32_t offset, bool write_enable)
+FileStream::FileStream(const std::string &path, uint64_t offset, bool write_enable)
     : logger_(logging::LoggerFactory<FileStream>::getLogger()),
       path_(path),
-      offset_(offset) {
-  file_stream_ = std::unique_ptr<std::fstream>(new std::fstream());
-  if (write_enable) {
-    file_stream_->open(path.c_str(), std::fstream::in | std::fstream::out | std::fstream::binary);
-  } else {
-    file_stream_->open(path.c_str(), std::fstream::in | std::fstream::binary);
-  }
-  file_stream_->seekg(0, file_stream_->end);
-  file_stream_->seekp(0, file_stream_->end);
-  int len = file_stream_->tellg();
-  if (len > 0) {
-    length_ = len;
-  } else {
-    length_ = 0;
+      offset_(offset),
+      length_(0),
+      write_enable_(write_enable),
+      append_(false),
+      write_buffer_offset_(0),
+      write_failed_(false) {
+  fd_ = openFile(path, write_enable ? O_RDWR : O_RDONLY);
+  if (fd_ < 0) {
+    logger_->log_debug("Could not open %s: %s", path, std::strerror(errno));
+    return;
   }
-  seek(offset);
+  length_ = fileSize(fd_);
 }
 
 void FileStream::closeStream() {
-  std::lock_guard<std::recursive_mutex> lock(file_lock_);
-  if (file_stream_ != nullptr) {
-    file_stream_->close();
-    file_stream_ = nullptr;
+  close();
+}
+
+bool FileStream::close() {
+  std::lock_guard<std::mutex> lock(file_lock_);
+  if (fd_ < 0) {
+    return !write_failed_;
   }
+  flushBuffer();
+  bool closed = closeFile(fd_) == 0;
+  if (!closed) {
+    logger_->log_error("Could not close %s: %s", path_, std::strerror(errno));
+  }
+  fd_ = -1;
+  return !write_failed_ && closed;
+}
+
+bool FileStream::flush() {
+  std::lock_guard<std::mutex> lock(file_lock_);
+  if (fd_ >= 0) {
+    flushBuffer();
+  }
+  return !write_failed_;
+}
+
+bool FileStream::sync() {
+  std::lock_guard<std::mutex> lock(file_lock_);
+  if (fd_ < 0 || !flushBuffer()) {
+    return false;
+  }
+  return syncFile(fd_);
 }
 
 void FileStream::seek(uint64_t offset) {
-  std::lock_guard<std::recursive_mutex> lock(file_lock_);
+  std::lock_guard<std::mutex> lock(file_lock_);
   offset_ = offset;
-  file_stream_->clear();
-  file_stream_->seekg(offset_);
-  file_stream_->seekp(offset_);
+}
+
+bool FileStream::flushBuffer() {
+  if (write_buffer_.empty()) {
+    return true;
+  }
+  bool written = writeFully(fd_, write_buffer_.data(), write_buffer_.size(), write_buffer_offset_);
+  if (!written) {
+    logger_->log_error("Could not write %llu bytes to %s: %s", write_buffer_.size(), path_, std::strerror(errno));
+    write_failed_ = true;
+  }
+  write_buffer_.clear();
+  return written;
 }
 
 int FileStream::writeData(std::vector<uint8_t> &buf, int buflen) {
@@ -95,22 +226,47 @@ int FileStream::writeData(std::vector<uint8_t> &buf, int buflen) {
 // data stream overrides
 
 int FileStream::writeData(uint8_t *value, int size) {
-  if (!IsNullOrEmpty(value)) {
-    std::lock_guard<std::recursive_mutex> lock(file_lock_);
-    if (file_stream_->write(reinterpret_cast<const char*>(value), size)) {
-      offset_ += size;
-      if (offset_ > length_) {
-        length_ = offset_;
-      }
-      file_stream_->seekg(offset_);
-      file_stream_->flush();
-      return size;
-    } else {
+  if (IsNullOrEmpty(value) || size < 0) {
+    return -1;
+  }
+  return static_cast<int>(writeBytes(value, size));
+}
+
+int64_t FileStream::writeBytes(const uint8_t *value, uint64_t len) {
+  if (IsNullOrEmpty(value)) {
+    return -1;
+  }
+  std::lock_guard<std::mutex> lock(file_lock_);
+  if (fd_ < 0 || !write_enable_) {
+    return -1;
+  }
+  uint64_t position = append_ ? length_.load() : offset_;
+  if (!write_buffer_.empty() && position != write_buffer_offset_ + write_buffer_.size()) {
+    if (!flushBuffer()) {
+      return -1;
+    }
+  }
+  if (write_buffer_.empty() && len >= WriteBufferSize) {
+    // large writes bypass the buffer
+    if (!writeFully(fd_, value, len, position)) {
+      logger_->log_error("Could not write %llu bytes to %s: %s", len, path_, std::strerror(errno));
       return -1;
     }
   } else {
-    return -1;
+    if (write_buffer_.empty()) {
+      write_buffer_.reserve(WriteBufferSize);
+      write_buffer_offset_ = position;
+    }
+    write_buffer_.insert(write_buffer_.end(), value, value + len);
+    if (write_buffer_.size() >= WriteBufferSize && !flushBuffer()) {
+      return -1;
+    }
+  }
+  offset_ = position + len;
+  if (offset_ > length_) {
+    length_ = offset_;
   }
+  return len;
 }
 
 template<typename T>
@@ -122,43 +278,57 @@ inline std::vector<uint8_t> FileStream::readBuffer(const T& t) {
 }
 
 int FileStream::readData(std::vector<uint8_t> &buf, int buflen) {
+  if (buflen < 0) {
+    return -1;
+  }
   if (static_cast<int>(buf.capacity()) < buflen) {
     buf.resize(buflen);
   }
   int ret = readData(reinterpret_cast<uint8_t*>(&buf[0]), buflen);
 
-  if (ret < buflen) {
+  if (ret >= 0 && ret < buflen) {
     buf.resize(ret);
   }
   return ret;
 }
 
 int FileStream::readData(uint8_t *buf, int buflen) {
-  if (!IsNullOrEmpty(buf)) {
-    std::lock_guard<std::recursive_mutex> lock(file_lock_);
-    if (!file_stream_) {
-      return -1;
+  if (IsNullOrEmpty(buf) || buflen < 0) {
+    return -1;
+  }
+  return static_cast<int>(readBytes(buf, buflen));
+}
+
+int64_t FileStream::readBytes(uint8_t *buf, uint64_t len) {
+  if (IsNullOrEmpty(buf)) {
+    return -1;
+  }
+  std::lock_guard<std::mutex> lock(file_lock_);
+  if (fd_ < 0) {
+    return -1;
+  }
+  // reads must see buffered writes
+  if (!flushBuffer()) {
+    return -1;
+  }
+  uint64_t total = 0;
+  while (total < len) {
+    int64_t ret = readAt(fd_, buf + total, len - total, offset_);
+    if (ret < 0) {
+      logger_->log_error("Could not read %s: %s", path_, std::strerror(errno));
+      return total > 0 ? total : -1;
     }
-    file_stream_->read(reinterpret_cast<char*>(buf), buflen);
-    if ((file_stream_->rdstate() & (file_stream_->eofbit | file_stream_->failbit)) != 0) {
-      file_stream_->clear();
-      file_stream_->seekg(0, file_stream_->end);
-      file_stream_->seekp(0, file_stream_->end);
-      int len = file_stream_->tellg();
-      size_t ret = len - offset_;
-      offset_ = len;
-      length_ = len;
+    if (ret == 0) {
       logging::LOG_DEBUG(logger_) << path_ << " eof bit, ended at " << offset_;
-      return ret;
-    } else {
-      offset_ += buflen;
-      file_stream_->seekp(offset_);
-      return buflen;
+      break;
     }
-
-  } else {
-    return -1;
+    total += ret;
+    offset_ += ret;
+  }
+  if (offset_ > length_) {
+    length_ = offset_;
   }
+  return total;
 }
 
 } /* namespace io */
@@ -27,6 +27,7 @@
 #include "core/logging/Logger.h"
 #include "core/Relationship.h"
 #include "FlowController.h"
+#include "provenance/ProvenancePolicy.h"
 
 namespace org {
 namespace apache {
@@ -44,7 +45,8 @@ ProvenanceEventRecord::ProvenanceEventRecord(ProvenanceEventRecord::ProvenanceEv
     : core::SerializableComponent(core::getClassName<ProvenanceEventRecord>()),
       _eventDuration(0),
       _entryDate(0),
-      _lineageStartDate(0) {
+      _lineageStartDate(0),
+      _detailFormat(TEXT_DETAILS) {
   _eventType = event;
   _componentId = componentId;
   _componentType = componentType;
@@ -84,24 +86,59 @@ bool ProvenanceEventRecord::DeSerialize(const std::shared_ptr<core::Serializable
   return ret;
 }
 
+std::string ProvenanceEventRecord::getDetails() {
+  switch (_detailFormat) {
+    case CREATE_DETAILS:
+      return _componentId + " creates flow record " + flow_uuid_;
+    case MODIFY_ATTRIBUTE_DETAILS:
+      return _componentId + " modify flow record " + flow_uuid_ + " attribute " + _detailKey + ":" + _detailValue;
+    case REMOVE_ATTRIBUTE_DETAILS:
+      return _componentId + " remove flow record " + flow_uuid_ + " attribute " + _detailKey;
+    case MODIFY_CONTENT_DETAILS:
+      return _componentId + " modify flow record content " + flow_uuid_;
+    case EXPIRE_DETAILS:
+      return _componentId + " expire flow record " + flow_uuid_;
+    default:
+      return _details;
+  }
+}
+
 bool ProvenanceEventRecord::Serialize(const std::shared_ptr<core::SerializableComponent> &repo) {
   org::apache::nifi::minifi::io::DataStream outStream;
 
+  if (!Serialize(outStream)) {
+    return false;
+  }
+  // Persist to the DB
+  if (!repo->Serialize(uuidStr_, const_cast<uint8_t*>(outStream.getBuffer()), outStream.getSize())) {
+    logger_->log_error("NiFi Provenance Store event %s size %llu fail", uuidStr_, outStream.getSize());
+  }
+  return true;
+}
+
+bool ProvenanceEventRecord::Serialize(org::apache::nifi::minifi::io::DataStream &outStream) {
   int ret;
 
-  ret = writeUTF(this->uuidStr_, &outStream);
-  if (ret <= 0) {
+  // the event time leads so that purging reads it without decoding the event
+  uint8_t version = PROVENANCE_EVENT_RECORD_COMPACT_VERSION;
+  ret = write(version, &outStream);
+  if (ret != 1) {
+    return false;
+  }
+
+  ret = write(this->_eventTime, &outStream);
+  if (ret != 8) {
     return false;
   }
 
-  uint32_t eventType = this->_eventType;
+  uint8_t eventType = this->_eventType;
   ret = write(eventType, &outStream);
-  if (ret != 4) {
+  if (ret != 1) {
     return false;
   }
 
-  ret = write(this->_eventTime, &outStream);
-  if (ret != 8) {
+  ret = writeUTF(this->uuidStr_, &outStream);
+  if (ret <= 0) {
     return false;
   }
 
@@ -125,21 +162,48 @@ bool ProvenanceEventRecord::Serialize(const std::shared_ptr<core::SerializableCo
     return false;
   }
 
-  ret = writeUTF(this->_componentType, &outStream);
-  if (ret <= 0) {
+  // the component type is only written when it differs from the component id
+  bool sameComponentType = this->_componentType == this->_componentId;
+  ret = write(sameComponentType, &outStream);
+  if (ret != 1) {
     return false;
   }
+  if (!sameComponentType) {
+    ret = writeUTF(this->_componentType, &outStream);
+    if (ret <= 0) {
+      return false;
+    }
+  }
 
   ret = writeUTF(this->flow_uuid_, &outStream);
   if (ret <= 0) {
     return false;
   }
 
-  ret = writeUTF(this->_details, &outStream);
-  if (ret <= 0) {
+  uint8_t detailFormat = this->_detailFormat;
+  ret = write(detailFormat, &outStream);
+  if (ret != 1) {
     return false;
   }
 
+  if (this->_detailFormat == TEXT_DETAILS) {
+    ret = writeUTF(this->_details, &outStream);
+    if (ret <= 0) {
+      return false;
+    }
+  } else if (this->_detailFormat == MODIFY_ATTRIBUTE_DETAILS || this->_detailFormat == REMOVE_ATTRIBUTE_DETAILS) {
+    ret = writeUTF(this->_detailKey, &outStream, true);
+    if (ret <= 0) {
+      return false;
+    }
+    if (this->_detailFormat == MODIFY_ATTRIBUTE_DETAILS) {
+      ret = writeUTF(this->_detailValue, &outStream, true);
+      if (ret <= 0) {
+        return false;
+      }
+    }
+  }
+
   // write flow attributes
   uint32_t numAttributes = this->_attributes.size();
   ret = write(numAttributes, &outStream);
@@ -217,18 +281,12 @@ bool ProvenanceEventRecord::Serialize(const std::shared_ptr<core::SerializableCo
       return false;
     }
   }
-  // Persist to the DB
-  if (!repo->Serialize(uuidStr_, const_cast<uint8_t*>(outStream.getBuffer()), outStream.getSize())) {
-    logger_->log_error("NiFi Provenance Store event %s size %llu fail", uuidStr_, outStream.getSize());
-  }
   return true;
 }
 
-bool ProvenanceEventRecord::DeSerialize(const uint8_t *buffer, const size_t bufferSize) {
+bool ProvenanceEventRecord::DeSerializeLegacyHeader(org::apache::nifi::minifi::io::DataStream &outStream) {
   int ret;
 
-  org::apache::nifi::minifi::io::DataStream outStream(buffer, bufferSize);
-
   ret = readUTF(this->uuidStr_, &outStream);
 
   if (ret <= 0) {
@@ -277,12 +335,122 @@ bool ProvenanceEventRecord::DeSerialize(const uint8_t *buffer, const size_t buff
     return false;
   }
 
+  this->_detailFormat = TEXT_DETAILS;
   ret = readUTF(this->_details, &outStream);
 
   if (ret <= 0) {
     return false;
   }
 
+  return true;
+}
+
+bool ProvenanceEventRecord::DeSerializeCompactHeader(org::apache::nifi::minifi::io::DataStream &outStream) {
+  int ret;
+
+  uint8_t version;
+  ret = read(version, &outStream);
+  if (ret != 1 || version != PROVENANCE_EVENT_RECORD_COMPACT_VERSION) {
+    return false;
+  }
+
+  ret = read(this->_eventTime, &outStream);
+  if (ret != 8) {
+    return false;
+  }
+
+  uint8_t eventType;
+  ret = read(eventType, &outStream);
+  if (ret != 1 || eventType > REPLAY) {
+    return false;
+  }
+  this->_eventType = (ProvenanceEventRecord::ProvenanceEventType) eventType;
+
+  ret = readUTF(this->uuidStr_, &outStream);
+  if (ret <= 0) {
+    return false;
+  }
+
+  ret = read(this->_entryDate, &outStream);
+  if (ret != 8) {
+    return false;
+  }
+
+  ret = read(this->_eventDuration, &outStream);
+  if (ret != 8) {
+    return false;
+  }
+
+  ret = read(this->_lineageStartDate, &outStream);
+  if (ret != 8) {
+    return false;
+  }
+
+  ret = readUTF(this->_componentId, &outStream);
+  if (ret <= 0) {
+    return false;
+  }
+
+  uint8_t sameComponentType;
+  ret = read(sameComponentType, &outStream);
+  if (ret != 1) {
+    return false;
+  }
+  if (sameComponentType) {
+    this->_componentType = this->_componentId;
+  } else {
+    ret = readUTF(this->_componentType, &outStream);
+    if (ret <= 0) {
+      return false;
+    }
+  }
+
+  ret = readUTF(this->flow_uuid_, &outStream);
+  if (ret <= 0) {
+    return false;
+  }
+
+  uint8_t detailFormat;
+  ret = read(detailFormat, &outStream);
+  if (ret != 1 || detailFormat > EXPIRE_DETAILS) {
+    return false;
+  }
+  this->_detailFormat = (ProvenanceEventRecord::DetailFormat) detailFormat;
+
+  if (this->_detailFormat == TEXT_DETAILS) {
+    ret = readUTF(this->_details, &outStream);
+    if (ret <= 0) {
+      return false;
+    }
+  } else if (this->_detailFormat == MODIFY_ATTRIBUTE_DETAILS || this->_detailFormat == REMOVE_ATTRIBUTE_DETAILS) {
+    ret = readUTF(this->_detailKey, &outStream, true);
+    if (ret <= 0) {
+      return false;
+    }
+    if (this->_detailFormat == MODIFY_ATTRIBUTE_DETAILS) {
+      ret = readUTF(this->_detailValue, &outStream, true);
+      if (ret <= 0) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool ProvenanceEventRecord::DeSerialize(const uint8_t *buffer, const size_t bufferSize) {
+  int ret;
+
+  org::apache::nifi::minifi::io::DataStream outStream(buffer, bufferSize);
+
+  if (bufferSize > 0 && buffer[0] == PROVENANCE_EVENT_RECORD_COMPACT_VERSION) {
+    if (!DeSerializeCompactHeader(outStream)) {
+      return false;
+    }
+  } else if (!DeSerializeLegacyHeader(outStream)) {
+    return false;
+  }
+
   // read flow attributes
   uint32_t numAttributes = 0;
   ret = read(numAttributes, &outStream);
@@ -372,13 +540,70 @@ bool ProvenanceEventRecord::DeSerialize(const uint8_t *buffer, const size_t buff
   return true;
 }
 
+ProvenanceReporter::ProvenanceReporter(std::shared_ptr<core::Repository> repo, std::string componentId, std::string componentType)
+    : logger_(logging::LoggerFactory<ProvenanceReporter>::getLogger()) {
+  _componentId = componentId;
+  _componentType = componentType;
+  repo_ = repo;
+  if (repo_) {
+    policy_ = repo_->getProvenancePolicy();
+  }
+  if (policy_) {
+    component_state_ = policy_->getComponent(_componentId);
+  }
+}
+
+std::shared_ptr<ProvenanceEventRecord> ProvenanceReporter::allocate(ProvenanceEventRecord::ProvenanceEventType eventType, std::shared_ptr<core::FlowFile> flow) {
+  if (component_state_ && !policy_->accept(*component_state_, eventType, flow->getSize())) {
+    return nullptr;
+  }
+  auto event = std::make_shared<ProvenanceEventRecord>(eventType, _componentId, _componentType);
+  if (event)
+    event->fromFlowFile(flow);
+
+  return event;
+}
+
 void ProvenanceReporter::commit() {
-  for (auto event : _events) {
-    if (!repo_->isFull()) {
-      event->Serialize(repo_);
-    } else {
-      logger_->log_debug("Provenance Repository is full");
+  std::vector<std::shared_ptr<ProvenanceEventRecord>> events(_events.begin(), _events.end());
+  // aggregates whose window closed are stored along with the events of the session
+  if (policy_) {
+    policy_->flushAggregates(getTimeMillis(), events);
+  }
+  if (events.empty()) {
+    return;
+  }
+  if (repo_->isFull()) {
+    logger_->log_debug("Provenance Repository is full");
+    return;
+  }
+  // serialize the events of the session into one buffer and persist them with a single MultiPut
+  org::apache::nifi::minifi::io::DataStream outStream;
+  std::vector<std::string> keys;
+  std::vector<std::pair<size_t, size_t>> ranges;
+  keys.reserve(events.size());
+  ranges.reserve(events.size());
+  for (auto event : events) {
+    size_t offset = outStream.getSize();
+    if (!event->Serialize(outStream)) {
+      logger_->log_error("NiFi Provenance Store event %s serialization fail", event->getEventId());
+      continue;
     }
+    keys.push_back(event->getEventId());
+    ranges.push_back(std::make_pair(offset, outStream.getSize() - offset));
+  }
+
+  std::vector<core::Repository::PutEntry> entries;
+  entries.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    core::Repository::PutEntry entry;
+    entry.key = keys[i];
+    entry.buf = outStream.getBuffer() + ranges[i].first;
+    entry.bufLen = ranges[i].second;
+    entries.push_back(std::move(entry));
+  }
+  if (!repo_->MultiPut(entries)) {
+    logger_->log_error("NiFi Provenance Store of %llu events size %llu fail", entries.size(), outStream.getSize());
   }
 }
 
@@ -391,6 +616,15 @@ void ProvenanceReporter::create(std::shared_ptr<core::FlowFile> flow, std::strin
   }
 }
 
+void ProvenanceReporter::create(std::shared_ptr<core::FlowFile> flow) {
+  auto event = allocate(ProvenanceEventRecord::CREATE, flow);
+
+  if (event) {
+    event->setDetails(ProvenanceEventRecord::CREATE_DETAILS);
+    add(event);
+  }
+}
+
 void ProvenanceReporter::route(std::shared_ptr<core::FlowFile> flow, core::Relationship relation, std::string detail, uint64_t processingDuration) {
   auto event = allocate(ProvenanceEventRecord::ROUTE, flow);
 
@@ -411,6 +645,24 @@ void ProvenanceReporter::modifyAttributes(std::shared_ptr<core::FlowFile> flow,
   }
 }
 
+void ProvenanceReporter::modifyAttributes(std::shared_ptr<core::FlowFile> flow, const std::string &key, const std::string &value) {
+  auto event = allocate(ProvenanceEventRecord::ATTRIBUTES_MODIFIED, flow);
+
+  if (event) {
+    event->setDetails(ProvenanceEventRecord::MODIFY_ATTRIBUTE_DETAILS, key, value);
+    add(event);
+  }
+}
+
+void ProvenanceReporter::removeAttribute(std::shared_ptr<core::FlowFile> flow, const std::string &key) {
+  auto event = allocate(ProvenanceEventRecord::ATTRIBUTES_MODIFIED, flow);
+
+  if (event) {
+    event->setDetails(ProvenanceEventRecord::REMOVE_ATTRIBUTE_DETAILS, key);
+    add(event);
+  }
+}
+
 void ProvenanceReporter::modifyContent(std::shared_ptr<core::FlowFile> flow, std::string detail, uint64_t processingDuration) {
   auto event = allocate(ProvenanceEventRecord::CONTENT_MODIFIED, flow);
 
@@ -421,6 +673,16 @@ void ProvenanceReporter::modifyContent(std::shared_ptr<core::FlowFile> flow, std
   }
 }
 
+void ProvenanceReporter::modifyContent(std::shared_ptr<core::FlowFile> flow, uint64_t processingDuration) {
+  auto event = allocate(ProvenanceEventRecord::CONTENT_MODIFIED, flow);
+
+  if (event) {
+    event->setDetails(ProvenanceEventRecord::MODIFY_CONTENT_DETAILS);
+    event->setEventDuration(processingDuration);
+    add(event);
+  }
+}
+
 void ProvenanceReporter::clone(std::shared_ptr<core::FlowFile> parent, std::shared_ptr<core::FlowFile> child) {
   auto event = allocate(ProvenanceEventRecord::CLONE, parent);
 
@@ -472,6 +734,15 @@ void ProvenanceReporter::expire(std::shared_ptr<core::FlowFile> flow, std::strin
   }
 }
 
+void ProvenanceReporter::expire(std::shared_ptr<core::FlowFile> flow) {
+  auto event = allocate(ProvenanceEventRecord::EXPIRE, flow);
+
+  if (event) {
+    event->setDetails(ProvenanceEventRecord::EXPIRE_DETAILS);
+    add(event);
+  }
+}
+
 void ProvenanceReporter::drop(std::shared_ptr<core::FlowFile> flow, std::string reason) {
   auto event = allocate(ProvenanceEventRecord::DROP, flow);
 
@@ -0,0 +1,280 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "provenance/ProvenancePolicy.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/Property.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtil.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace provenance {
+
+ProvenancePolicy::ProvenancePolicy()
+    : default_mode_(PROVENANCE_FULL),
+      sample_interval_(DEFAULT_PROVENANCE_SAMPLE_INTERVAL),
+      aggregation_window_(DEFAULT_PROVENANCE_AGGREGATION_WINDOW),
+      next_flush_(0),
+      logger_(logging::LoggerFactory<ProvenancePolicy>::getLogger()) {
+}
+
+ProvenancePolicy::ProvenancePolicy(const std::shared_ptr<Configure> &configuration)
+    : ProvenancePolicy() {
+  std::string value;
+  ProvenanceMode mode;
+  if (configuration->get(Configure::nifi_provenance_policy, value)) {
+    if (parseMode(value, mode)) {
+      default_mode_ = mode;
+    } else {
+      logger_->log_error("Invalid provenance policy %s, storing every event", value);
+    }
+  }
+  if (configuration->get(Configure::nifi_provenance_policy_sample_interval, value)) {
+    uint64_t interval;
+    if (core::Property::StringToInt(value, interval)) {
+      setSampleInterval(interval);
+    }
+  }
+  if (configuration->get(Configure::nifi_provenance_policy_aggregation_window, value)) {
+    int64_t window;
+    core::TimeUnit unit;
+    if (core::Property::StringToTime(value, window, unit) && core::Property::ConvertTimeUnitToMS(window, unit, window) && window > 0) {
+      setAggregationWindow(window);
+    }
+  }
+
+  const std::string component_prefix = Configure::nifi_provenance_policy_component;
+  const std::string event_prefix = Configure::nifi_provenance_policy_event;
+  for (const auto &key : configuration->getConfiguredKeys()) {
+    bool is_component = key.compare(0, component_prefix.length(), component_prefix) == 0;
+    bool is_event = key.compare(0, event_prefix.length(), event_prefix) == 0;
+    if (!is_component && !is_event) {
+      continue;
+    }
+    if (!configuration->get(key, value) || !parseMode(value, mode)) {
+      logger_->log_error("Invalid provenance policy %s for %s", value, key);
+      continue;
+    }
+    if (is_component) {
+      setComponentMode(key.substr(component_prefix.length()), mode);
+      continue;
+    }
+    std::string type = key.substr(event_prefix.length());
+    bool found = false;
+    for (int i = 0; i <= ProvenanceEventRecord::REPLAY; i++) {
+      if (utils::StringUtils::equalsIgnoreCase(type, ProvenanceEventRecord::ProvenanceEventTypeStr[i])) {
+        setEventTypeMode(static_cast<ProvenanceEventRecord::ProvenanceEventType>(i), mode);
+        found = true;
+      }
+    }
+    if (!found) {
+      logger_->log_error("Unknown provenance event type %s", type);
+    }
+  }
+  logger_->log_debug("Provenance policy %s, sampling one in %llu events, aggregating over %llu ms", getModeName(default_mode_), sample_interval_, aggregation_window_);
+}
+
+bool ProvenancePolicy::parseMode(const std::string &value, ProvenanceMode &mode) {
+  std::string name = utils::StringUtils::trim(value);
+  std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+  if (name == "off") {
+    mode = PROVENANCE_OFF;
+  } else if (name == "full") {
+    mode = PROVENANCE_FULL;
+  } else if (name == "sample") {
+    mode = PROVENANCE_SAMPLE;
+  } else if (name == "aggregate") {
+    mode = PROVENANCE_AGGREGATE;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::string ProvenancePolicy::getModeName(ProvenanceMode mode) {
+  switch (mode) {
+    case PROVENANCE_OFF:
+      return "off";
+    case PROVENANCE_SAMPLE:
+      return "sample";
+    case PROVENANCE_AGGREGATE:
+      return "aggregate";
+    default:
+      return "full";
+  }
+}
+
+bool ProvenancePolicy::isSelective() const {
+  if (default_mode_ != PROVENANCE_FULL) {
+    return true;
+  }
+  for (const auto &mode : component_modes_) {
+    if (mode.second != PROVENANCE_FULL) {
+      return true;
+    }
+  }
+  for (const auto &mode : event_type_modes_) {
+    if (mode.second != PROVENANCE_FULL) {
+      return true;
+    }
+  }
+  return false;
+}
+
+ProvenanceMode ProvenancePolicy::getMode(const std::string &component_id, ProvenanceEventRecord::ProvenanceEventType type) const {
+  auto component = component_modes_.find(component_id);
+  if (component != component_modes_.end()) {
+    return component->second;
+  }
+  auto event_type = event_type_modes_.find(type);
+  if (event_type != event_type_modes_.end()) {
+    return event_type->second;
+  }
+  return default_mode_;
+}
+
+std::shared_ptr<ProvenanceComponentState> ProvenancePolicy::getComponent(const std::string &component_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = components_.find(component_id);
+  if (it != components_.end()) {
+    return it->second;
+  }
+  std::shared_ptr<ProvenanceComponentState> component = std::make_shared<ProvenanceComponentState>();
+  component->component_id = component_id;
+  for (int i = 0; i <= ProvenanceEventRecord::REPLAY; i++) {
+    ProvenanceEventTypeState &state = component->types[i];
+    state.mode = getMode(component_id, static_cast<ProvenanceEventRecord::ProvenanceEventType>(i));
+    state.events = 0;
+    state.stored = 0;
+    state.aggregated = 0;
+    state.window_start = 0;
+    state.window_count = 0;
+    state.window_bytes = 0;
+  }
+  components_[component_id] = component;
+  return component;
+}
+
+bool ProvenancePolicy::accept(ProvenanceComponentState &component, ProvenanceEventRecord::ProvenanceEventType type, uint64_t size) {
+  ProvenanceEventTypeState &state = component.types[type];
+  uint64_t event = state.events++;
+  switch (state.mode) {
+    case PROVENANCE_OFF:
+      return false;
+    case PROVENANCE_SAMPLE:
+      if (event % sample_interval_ != 0) {
+        return false;
+      }
+      state.stored++;
+      return true;
+    case PROVENANCE_AGGREGATE: {
+      uint64_t now = getTimeMillis();
+      uint64_t window_start = now - now % aggregation_window_;
+      std::shared_ptr<ProvenanceEventRecord> closed;
+      {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.window_count > 0 && state.window_start != window_start) {
+          closed = closeWindow(component.component_id, type, state);
+        }
+        state.window_start = window_start;
+        state.window_count++;
+        state.window_bytes += size;
+      }
+      state.aggregated++;
+      if (closed) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_aggregates_.push_back(closed);
+      }
+      return false;
+    }
+    default:
+      state.stored++;
+      return true;
+  }
+}
+
+std::shared_ptr<ProvenanceEventRecord> ProvenancePolicy::closeWindow(const std::string &component_id, ProvenanceEventRecord::ProvenanceEventType type, ProvenanceEventTypeState &state) {
+  std::shared_ptr<ProvenanceEventRecord> event = std::make_shared<ProvenanceEventRecord>(type, component_id, component_id);
+  std::string count = std::to_string(state.window_count);
+  std::string bytes = std::to_string(state.window_bytes);
+  std::string start = std::to_string(state.window_start);
+  std::string end = std::to_string(state.window_start + aggregation_window_);
+  event->setDetails("Aggregated " + count + " " + ProvenanceEventRecord::ProvenanceEventTypeStr[type] + " events of " + bytes + " bytes from " + start + " to " + end);
+  event->setAttribute("provenance.aggregate.count", count);
+  event->setAttribute("provenance.aggregate.bytes", bytes);
+  event->setAttribute("provenance.aggregate.window.start", start);
+  event->setAttribute("provenance.aggregate.window.end", end);
+  state.window_count = 0;
+  state.window_bytes = 0;
+  return event;
+}
+
+void ProvenancePolicy::flushAggregates(uint64_t now, std::vector<std::shared_ptr<ProvenanceEventRecord>> &events, bool force) {
+  if (!force && now < next_flush_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &event : closed_aggregates_) {
+    events.push_back(event);
+  }
+  closed_aggregates_.clear();
+  for (const auto &component : components_) {
+    for (int i = 0; i <= ProvenanceEventRecord::REPLAY; i++) {
+      ProvenanceEventTypeState &state = component.second->types[i];
+      if (state.mode != PROVENANCE_AGGREGATE) {
+        continue;
+      }
+      std::lock_guard<std::mutex> state_lock(state.mutex);
+      if (state.window_count > 0 && (force || state.window_start + aggregation_window_ <= now)) {
+        events.push_back(closeWindow(component.first, static_cast<ProvenanceEventRecord::ProvenanceEventType>(i), state));
+      }
+    }
+  }
+  next_flush_ = now - now % aggregation_window_ + aggregation_window_;
+}
+
+std::map<std::string, std::map<ProvenanceEventRecord::ProvenanceEventType, ProvenanceCounters>> ProvenancePolicy::getCounters() {
+  std::map<std::string, std::map<ProvenanceEventRecord::ProvenanceEventType, ProvenanceCounters>> counters;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto &component : components_) {
+    for (int i = 0; i <= ProvenanceEventRecord::REPLAY; i++) {
+      ProvenanceEventTypeState &state = component.second->types[i];
+      if (state.events == 0) {
+        continue;
+      }
+      ProvenanceCounters &counter = counters[component.first][static_cast<ProvenanceEventRecord::ProvenanceEventType>(i)];
+      counter.events = state.events;
+      counter.stored = state.stored;
+      counter.aggregated = state.aggregated;
+    }
+  }
+  return counters;
+}
+
+} /* namespace provenance */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
@@ -0,0 +1,162 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sitetosite/PeerSelector.h"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "utils/TimeUtil.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace sitetosite {
+
+namespace {
+
+// no peer takes more than this share of the flow files into account, so that busy peers are not starved
+const double MAX_FLOW_FILE_SHARE = 0.8;
+
+// peers always keep a small chance of being selected
+const double MIN_WEIGHT = 0.05;
+
+}  // namespace
+
+constexpr uint64_t PeerSelector::DEFAULT_PENALTY_MILLIS;
+
+PeerSelector::PeerSelector(uint64_t penalty_millis)
+    : penalty_millis_(penalty_millis),
+      random_(std::random_device()()) {
+}
+
+void PeerSelector::setPeers(const std::vector<PeerStatus> &peers) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<PeerEntry> entries;
+  entries.reserve(peers.size());
+  for (const auto &status : peers) {
+    PeerEntry entry;
+    entry.peer = status.getPeer();
+    entry.flow_file_count = status.getFlowFileCount();
+    entry.penalized_until = 0;
+    PeerEntry *existing = find(*entry.peer);
+    if (existing != nullptr) {
+      entry.penalized_until = existing->penalized_until;
+    }
+    entries.push_back(entry);
+  }
+  peers_ = std::move(entries);
+}
+
+std::vector<std::shared_ptr<Peer>> PeerSelector::getPeers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::shared_ptr<Peer>> peers;
+  for (const auto &entry : peers_) {
+    peers.push_back(entry.peer);
+  }
+  return peers;
+}
+
+std::shared_ptr<Peer> PeerSelector::select(TransferDirection direction) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (peers_.empty()) {
+    return nullptr;
+  }
+  uint64_t now = getTimeMillis();
+  uint64_t total_flow_file_count = 0;
+  for (const auto &entry : peers_) {
+    total_flow_file_count += entry.flow_file_count;
+  }
+
+  std::vector<const PeerEntry*> candidates;
+  std::vector<double> weights;
+  double total_weight = 0;
+  for (const auto &entry : peers_) {
+    if (entry.penalized_until <= now) {
+      candidates.push_back(&entry);
+      weights.push_back(getWeight(entry.flow_file_count, total_flow_file_count, direction));
+      total_weight += weights.back();
+    }
+  }
+
+  if (candidates.empty()) {
+    // every peer is penalized, so use the one whose penalty ends first
+    auto first = std::min_element(peers_.begin(), peers_.end(), [](const PeerEntry &a, const PeerEntry &b) {
+      return a.penalized_until < b.penalized_until;
+    });
+    return first->peer;
+  }
+
+  double choice = std::uniform_real_distribution<double>(0, total_weight)(random_);
+  for (size_t i = 0; i < candidates.size(); i++) {
+    if (choice < weights[i]) {
+      return candidates[i]->peer;
+    }
+    choice -= weights[i];
+  }
+  return candidates.back()->peer;
+}
+
+void PeerSelector::penalize(const Peer &peer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  PeerEntry *entry = find(peer);
+  if (entry != nullptr) {
+    entry->penalized_until = getTimeMillis() + penalty_millis_;
+  }
+}
+
+bool PeerSelector::isPenalized(const Peer &peer) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string key = peer.toString();
+  for (const auto &entry : peers_) {
+    if (entry.peer->toString() == key) {
+      return entry.penalized_until > getTimeMillis();
+    }
+  }
+  return false;
+}
+
+size_t PeerSelector::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return peers_.size();
+}
+
+double PeerSelector::getWeight(uint32_t flow_file_count, uint64_t total_flow_file_count, TransferDirection direction) {
+  if (total_flow_file_count == 0) {
+    return 1.0;
+  }
+  double share = std::min(MAX_FLOW_FILE_SHARE, static_cast<double>(flow_file_count) / total_flow_file_count);
+  double weight = direction == SEND ? 1.0 - share : share;
+  return std::max(MIN_WEIGHT, weight);
+}
+
+PeerSelector::PeerEntry *PeerSelector::find(const Peer &peer) {
+  std::string key = peer.toString();
+  for (auto &entry : peers_) {
+    if (entry.peer->toString() == key) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+} /* namespace sitetosite */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
@@ -50,6 +50,37 @@ RespondCodeContext SiteToSiteRequest::respondCodeContext[21] = { //NOLINT
     { UNRECOGNIZED_RESPONSE_CODE, "Unrecognized Response Code", false },  //NOLINT
     { END_OF_STREAM, "End of Stream", false } };
 
+io::BaseStream &Transaction::getPacketStream() {
+  if (!compress_) {
+    return crcStream;
+  }
+  if (!packet_stream_) {
+    io::BaseStream *compression_stream;
+    if (_direction == SEND) {
+      compression_output_ = std::unique_ptr<io::CompressionOutputStream>(new io::CompressionOutputStream(crcStream.getstream(), compression_level_));
+      compression_stream = compression_output_.get();
+    } else {
+      compression_input_ = std::unique_ptr<io::CompressionInputStream>(new io::CompressionInputStream(crcStream.getstream()));
+      compression_stream = compression_input_.get();
+    }
+    packet_stream_ = std::unique_ptr<io::CRCStream<io::BaseStream>>(new io::CRCStream<io::BaseStream>(compression_stream));
+    packet_stream_->setCRC(crcStream.getCRC());
+  }
+  return *packet_stream_;
+}
+
+bool Transaction::closePacket() {
+  if (!packet_stream_) {
+    return true;
+  }
+  crcStream.setCRC(packet_stream_->getCRC());
+  bool closed = compression_output_ == nullptr || compression_output_->close() == 0;
+  packet_stream_ = nullptr;
+  compression_output_ = nullptr;
+  compression_input_ = nullptr;
+  return closed;
+}
+
 } /* namespace sitetosite */
 } /* namespace minifi */
 } /* namespace nifi */
@@ -109,11 +109,11 @@ int SiteToSiteClient::writeResponse(const std::shared_ptr<Transaction> &transact
 }
 
 bool SiteToSiteClient::transferFlowFiles(const std::shared_ptr<core::ProcessContext> &context, const std::shared_ptr<core::ProcessSession> &session) {
-  std::shared_ptr<FlowFileRecord> flow = std::static_pointer_cast<FlowFileRecord>(session->get());
+  std::vector<std::shared_ptr<core::FlowFile>> flows = session->get(_batchGetCount);
 
   std::shared_ptr<Transaction> transaction = NULL;
 
-  if (!flow) {
+  if (flows.empty()) {
     return false;
   }
 
@@ -137,39 +137,45 @@ bool SiteToSiteClient::transferFlowFiles(const std::shared_ptr<core::ProcessCont
     throw Exception(SITE2SITE_EXCEPTION, "Can not create transaction");
   }
 
-  bool continueTransaction = true;
   uint64_t startSendingNanos = getTimeNano();
 
   try {
-    while (continueTransaction) {
-      uint64_t startTime = getTimeMillis();
-      std::string payload;
-      DataPacket packet(getLogger(), transaction, flow->getAttributes(), payload);
-
-      int16_t resp = send(transactionID, &packet, flow, session);
-      if (resp == -1) {
-        throw Exception(SITE2SITE_EXCEPTION, "Send Failed");
+    while (!flows.empty()) {
+      if (transaction->isCompressed()) {
+        uint64_t batch_bytes = 0;
+        for (const auto &flowFile : flows) {
+          batch_bytes += flowFile->getSize();
+        }
+        transaction->setCompressionLevel(batch_bytes >= compression_threshold_ ? compression_level_ : 0);
       }
+      // every flow file taken from the session is sent, the time budget is only checked between batches
+      for (const auto &flowFile : flows) {
+        std::shared_ptr<FlowFileRecord> flow = std::static_pointer_cast<FlowFileRecord>(flowFile);
+        uint64_t startTime = getTimeMillis();
+        std::string payload;
+        DataPacket packet(getLogger(), transaction, flow->getAttributes(), payload);
+
+        int16_t resp = send(transactionID, &packet, flow, session);
+        if (resp == -1) {
+          throw Exception(SITE2SITE_EXCEPTION, "Send Failed");
+        }
 
-      logger_->log_debug("Site2Site transaction %s send flow record %s", transactionID, flow->getUUIDStr());
-      if (resp == 0) {
-        uint64_t endTime = getTimeMillis();
-        std::string transitUri = peer_->getURL() + "/" + flow->getUUIDStr();
-        std::string details = "urn:nifi:" + flow->getUUIDStr() + "Remote Host=" + peer_->getHostName();
-        session->getProvenanceReporter()->send(flow, transitUri, details, endTime - startTime, false);
+        logger_->log_debug("Site2Site transaction %s send flow record %s", transactionID, flow->getUUIDStr());
+        if (resp == 0) {
+          uint64_t endTime = getTimeMillis();
+          std::string transitUri = peer_->getURL() + "/" + flow->getUUIDStr();
+          std::string details = "urn:nifi:" + flow->getUUIDStr() + "Remote Host=" + peer_->getHostName();
+          session->getProvenanceReporter()->send(flow, transitUri, details, endTime - startTime, false);
+        }
+        session->remove(flow);
       }
-      session->remove(flow);
 
       uint64_t transferNanos = getTimeNano() - startSendingNanos;
       if (transferNanos > _batchSendNanos)
         break;
 
-      flow = std::static_pointer_cast<FlowFileRecord>(session->get());
-
-      if (!flow) {
-        continueTransaction = false;
-      }
-    }  // while true
+      flows = session->get(_batchGetCount);
+    }  // while flows
 
     if (!confirm(transactionID)) {
       throw Exception(SITE2SITE_EXCEPTION, "Confirm Failed for " + transactionID);
@@ -444,19 +450,19 @@ int16_t SiteToSiteClient::send(std::string transactionID, DataPacket *packet, co
   }
   // start to read the packet
   uint32_t numAttributes = packet->_attributes.size();
-  ret = transaction->getStream().write(numAttributes);
+  ret = transaction->getPacketStream().write(numAttributes);
   if (ret != 4) {
     return -1;
   }
 
   std::map<std::string, std::string>::iterator itAttribute;
   for (itAttribute = packet->_attributes.begin(); itAttribute != packet->_attributes.end(); itAttribute++) {
-    ret = transaction->getStream().writeUTF(itAttribute->first, true);
+    ret = transaction->getPacketStream().writeUTF(itAttribute->first, true);
 
     if (ret <= 0) {
       return -1;
     }
-    ret = transaction->getStream().writeUTF(itAttribute->second, true);
+    ret = transaction->getPacketStream().writeUTF(itAttribute->second, true);
     if (ret <= 0) {
       return -1;
     }
@@ -466,7 +472,7 @@ int16_t SiteToSiteClient::send(std::string transactionID, DataPacket *packet, co
   uint64_t len = 0;
   if (flowFile) {
     len = flowFile->getSize();
-    ret = transaction->getStream().write(len);
+    ret = transaction->getPacketStream().write(len);
     if (ret != 8) {
       logger_->log_debug("ret != 8");
       return -1;
@@ -488,12 +494,12 @@ int16_t SiteToSiteClient::send(std::string transactionID, DataPacket *packet, co
   } else if (packet->payload_.length() > 0) {
     len = packet->payload_.length();
 
-    ret = transaction->getStream().write(len);
+    ret = transaction->getPacketStream().write(len);
     if (ret != 8) {
       return -1;
     }
 
-    ret = transaction->getStream().writeData(reinterpret_cast<uint8_t *>(const_cast<char*>(packet->payload_.c_str())), len);
+    ret = transaction->getPacketStream().writeData(reinterpret_cast<uint8_t *>(const_cast<char*>(packet->payload_.c_str())), len);
     if (ret != (int64_t)len) {
       logger_->log_debug("ret != len");
       return -1;
@@ -501,6 +507,10 @@ int16_t SiteToSiteClient::send(std::string transactionID, DataPacket *packet, co
     packet->_size += len;
   }
 
+  if (!transaction->closePacket()) {
+    return -1;
+  }
+
   transaction->current_transfers_++;
   transaction->total_transfers_++;
   transaction->_state = DATA_EXCHANGED;
@@ -547,6 +557,9 @@ bool SiteToSiteClient::receive(std::string transactionID, DataPacket *packet, bo
     return true;
   }
 
+  // the content of the previous packet was read through its stream
+  transaction->closePacket();
+
   if (transaction->current_transfers_ > 0) {
     // if we already has transfer before, check to see whether another one is available
     RespondCode code;
@@ -579,7 +592,7 @@ bool SiteToSiteClient::receive(std::string transactionID, DataPacket *packet, bo
 
   // start to read the packet
   uint32_t numAttributes;
-  ret = transaction->getStream().read(numAttributes);
+  ret = transaction->getPacketStream().read(numAttributes);
   if (ret <= 0 || numAttributes > MAX_NUM_ATTRIBUTES) {
     return false;
   }
@@ -589,11 +602,11 @@ bool SiteToSiteClient::receive(std::string transactionID, DataPacket *packet, bo
   for (unsigned int i = 0; i < numAttributes; i++) {
     std::string key;
     std::string value;
-    ret = transaction->getStream().readUTF(key, true);
+    ret = transaction->getPacketStream().readUTF(key, true);
     if (ret <= 0) {
       return false;
     }
-    ret = transaction->getStream().readUTF(value, true);
+    ret = transaction->getPacketStream().readUTF(value, true);
     if (ret <= 0) {
       return false;
     }
@@ -602,7 +615,7 @@ bool SiteToSiteClient::receive(std::string transactionID, DataPacket *packet, bo
   }
 
   uint64_t len;
-  ret = transaction->getStream().read(len);
+  ret = transaction->getPacketStream().read(len);
   if (ret <= 0) {
     return false;
   }
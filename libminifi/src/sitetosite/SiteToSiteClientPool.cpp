@@ -0,0 +1,122 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sitetosite/SiteToSiteClientPool.h"
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "utils/TimeUtil.h"
+
+namespace org {
+namespace apache {
+namespace nifi {
+namespace minifi {
+namespace sitetosite {
+
+constexpr uint64_t SiteToSiteClientPool::DEFAULT_IDLE_EXPIRATION_MILLIS;
+
+SiteToSiteClientPool::SiteToSiteClientPool(size_t max_idle_per_peer, uint64_t idle_expiration_millis)
+    : max_idle_per_peer_(max_idle_per_peer),
+      idle_expiration_millis_(idle_expiration_millis) {
+}
+
+std::unique_ptr<SiteToSiteClient> SiteToSiteClientPool::take(const Peer &peer) {
+  std::vector<std::unique_ptr<SiteToSiteClient>> expired;
+  std::unique_ptr<SiteToSiteClient> client;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = idle_clients_.find(peer.toString());
+    if (it == idle_clients_.end()) {
+      return nullptr;
+    }
+    uint64_t now = getTimeMillis();
+    while (!it->second.empty() && !client) {
+      IdleClient idle = std::move(it->second.back());
+      it->second.pop_back();
+      if (now - idle.idle_since > idle_expiration_millis_) {
+        expired.push_back(std::move(idle.client));
+      } else {
+        client = std::move(idle.client);
+      }
+    }
+  }
+  return client;
+}
+
+bool SiteToSiteClientPool::put(const Peer &peer, std::unique_ptr<SiteToSiteClient> client) {
+  if (!client) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &clients = idle_clients_[peer.toString()];
+  if (clients.size() >= max_idle_per_peer_) {
+    return false;
+  }
+  IdleClient idle;
+  idle.client = std::move(client);
+  idle.idle_since = getTimeMillis();
+  clients.push_back(std::move(idle));
+  return true;
+}
+
+size_t SiteToSiteClientPool::size(const Peer &peer) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = idle_clients_.find(peer.toString());
+  return it != idle_clients_.end() ? it->second.size() : 0;
+}
+
+void SiteToSiteClientPool::evict(const std::vector<std::shared_ptr<Peer>> &peers) {
+  std::set<std::string> known;
+  for (const auto &peer : peers) {
+    known.insert(peer->toString());
+  }
+  std::vector<std::unique_ptr<SiteToSiteClient>> evicted;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t now = getTimeMillis();
+    for (auto it = idle_clients_.begin(); it != idle_clients_.end();) {
+      auto &clients = it->second;
+      bool is_known = known.find(it->first) != known.end();
+      // the oldest clients are at the front
+      while (!clients.empty() && (!is_known || now - clients.front().idle_since > idle_expiration_millis_)) {
+        evicted.push_back(std::move(clients.front().client));
+        clients.pop_front();
+      }
+      if (clients.empty()) {
+        it = idle_clients_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+void SiteToSiteClientPool::clear() {
+  std::map<std::string, std::deque<IdleClient>> cleared;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cleared.swap(idle_clients_);
+  }
+}
+
+} /* namespace sitetosite */
+} /* namespace minifi */
+} /* namespace nifi */
+} /* namespace apache */
+} /* namespace org */
@@ -60,6 +60,10 @@ const std::vector<char> ByteOutputCallback::to_string() {
 
 void ByteOutputCallback::close() {
   is_alive_ = false;
+  {
+    // a reader that just found nothing to read must be waiting before it is notified
+    std::lock_guard<std::recursive_mutex> lock(vector_lock_);
+  }
   spinner_.notify_all();
 }
 
@@ -75,6 +79,13 @@ bool ByteOutputCallback::waitingOps() {
   return true;
 }
 
+bool ByteOutputCallback::waitForData() {
+  std::unique_lock<std::recursive_mutex> lock(vector_lock_);
+  spinner_.wait(lock, [&] {
+    return size_ > 0 || current_str_pos < current_str.length() || !is_alive_;});
+  return size_ > 0 || current_str_pos < current_str.length();
+}
+
 void ByteOutputCallback::write(char *data, size_t size) {
   if (!read_started_) {
     std::unique_lock<std::recursive_mutex> lock(vector_lock_);
@@ -93,6 +104,9 @@ void ByteOutputCallback::write_and_notify(char *data, size_t size) {
   if (size_ > max_size_) {
     logger_->log_trace("Size exceeds desired limits, please adjust write tempo");
   }
+  {
+    std::lock_guard<std::recursive_mutex> lock(vector_lock_);
+  }
   spinner_.notify_all();
 }
 
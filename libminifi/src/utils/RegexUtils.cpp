@@ -18,7 +18,15 @@
 
 #include "utils/RegexUtils.h"
 #include "Exception.h"
-#include <iostream>
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <regex>
+#include <utility>
 #include <vector>
 
 namespace org {
@@ -27,6 +35,936 @@ namespace nifi {
 namespace minifi {
 namespace utils {
 
+namespace {
+
+// patterns whose program would exceed this many instructions are rejected
+const size_t MAX_PROGRAM_SIZE = 100000;
+
+// compiled programs kept for reuse
+const size_t MAX_CACHED_PROGRAMS = 512;
+
+typedef std::bitset<256> CharSet;
+
+enum class Op : uint8_t {
+  CHAR,
+  CLASS,
+  MATCH,
+  JMP,
+  SPLIT,
+  SAVE,
+  BEGIN_LINE,
+  END_LINE,
+  WORD_BOUNDARY,
+  NOT_WORD_BOUNDARY
+};
+
+struct Inst {
+  Op op;
+  uint8_t c;
+  // jump target, class index or save slot
+  uint32_t x;
+  // second, less preferred, target of SPLIT
+  uint32_t y;
+};
+
+/**
+ * Thrown while parsing patterns which the Pike VM cannot match.
+ */
+struct UnsupportedPattern {
+};
+
+struct Node {
+  enum Type {
+    CHARS,
+    CONCAT,
+    ALTERNATE,
+    REPEAT,
+    GROUP,
+    ASSERT
+  };
+
+  explicit Node(Type type)
+      : type(type),
+        min(0),
+        max(0),
+        greedy(true),
+        group(0),
+        assertion(Op::BEGIN_LINE) {
+  }
+
+  Type type;
+  CharSet chars;
+  std::vector<std::unique_ptr<Node>> children;
+  // repetition bounds, max is -1 when unbounded
+  int min;
+  int max;
+  bool greedy;
+  size_t group;
+  Op assertion;
+};
+
+bool isWordChar(unsigned char c) {
+  return std::isalnum(c) || c == '_';
+}
+
+CharSet charRange(int first, int last) {
+  CharSet set;
+  for (int c = first; c <= last; c++) {
+    set.set(c);
+  }
+  return set;
+}
+
+CharSet digitChars() {
+  return charRange('0', '9');
+}
+
+CharSet wordChars() {
+  return charRange('0', '9') | charRange('a', 'z') | charRange('A', 'Z') | charRange('_', '_');
+}
+
+CharSet spaceChars() {
+  CharSet set;
+  for (char c : { ' ', '\t', '\n', '\r', '\f', '\v' }) {
+    set.set(static_cast<unsigned char>(c));
+  }
+  return set;
+}
+
+/**
+ * Parses an ECMAScript pattern into a syntax tree.
+ */
+class Parser {
+ public:
+  Parser(const std::string &pattern, bool icase)
+      : pattern_(pattern),
+        pos_(0),
+        icase_(icase),
+        groups_(1) {
+  }
+
+  std::unique_ptr<Node> parse() {
+    auto node = parseAlternation();
+    if (pos_ < pattern_.size()) {
+      error("unmatched )");
+    }
+    return node;
+  }
+
+  size_t getGroupCount() const {
+    return groups_;
+  }
+
+ private:
+  void error(const std::string &message) const {
+    throw Exception(REGEX_EXCEPTION, message + " at offset " + std::to_string(pos_) + " in " + pattern_);
+  }
+
+  bool atEnd() const {
+    return pos_ >= pattern_.size();
+  }
+
+  char peek() const {
+    return pattern_[pos_];
+  }
+
+  std::unique_ptr<Node> makeChars(CharSet chars) const {
+    std::unique_ptr<Node> node(new Node(Node::CHARS));
+    node->chars = fold(chars);
+    return node;
+  }
+
+  CharSet fold(CharSet chars) const {
+    if (icase_) {
+      for (int c = 'a'; c <= 'z'; c++) {
+        if (chars.test(c) || chars.test(std::toupper(c))) {
+          chars.set(c);
+          chars.set(std::toupper(c));
+        }
+      }
+    }
+    return chars;
+  }
+
+  std::unique_ptr<Node> parseAlternation() {
+    auto first = parseConcat();
+    if (atEnd() || peek() != '|') {
+      return first;
+    }
+    std::unique_ptr<Node> node(new Node(Node::ALTERNATE));
+    node->children.push_back(std::move(first));
+    while (!atEnd() && peek() == '|') {
+      pos_++;
+      node->children.push_back(parseConcat());
+    }
+    return node;
+  }
+
+  std::unique_ptr<Node> parseConcat() {
+    std::unique_ptr<Node> node(new Node(Node::CONCAT));
+    while (!atEnd() && peek() != '|' && peek() != ')') {
+      node->children.push_back(parseRepeat());
+    }
+    return node;
+  }
+
+  bool parseBounds(int &min, int &max) {
+    size_t end = pattern_.find('}', pos_);
+    if (end == std::string::npos) {
+      return false;
+    }
+    std::string bounds = pattern_.substr(pos_ + 1, end - pos_ - 1);
+    size_t comma = bounds.find(',');
+    std::string low = bounds.substr(0, comma);
+    std::string high = comma == std::string::npos ? low : bounds.substr(comma + 1);
+    auto is_number = [](const std::string &str) {
+      return !str.empty() && str.size() < 6 && std::all_of(str.begin(), str.end(), [](char c) {return std::isdigit(static_cast<unsigned char>(c));});
+    };
+    if (!is_number(low) || (!high.empty() && !is_number(high))) {
+      return false;
+    }
+    min = std::stoi(low);
+    max = high.empty() ? -1 : std::stoi(high);
+    if (max != -1 && max < min) {
+      error("invalid repetition bounds");
+    }
+    pos_ = end + 1;
+    return true;
+  }
+
+  std::unique_ptr<Node> parseRepeat() {
+    auto atom = parseAtom();
+    while (!atEnd()) {
+      int min, max;
+      char c = peek();
+      if (c == '*') {
+        min = 0;
+        max = -1;
+        pos_++;
+      } else if (c == '+') {
+        min = 1;
+        max = -1;
+        pos_++;
+      } else if (c == '?') {
+        min = 0;
+        max = 1;
+        pos_++;
+      } else if (c == '{' && parseBounds(min, max)) {
+      } else {
+        break;
+      }
+      if (atom->type == Node::ASSERT) {
+        error("nothing to repeat");
+      }
+      std::unique_ptr<Node> node(new Node(Node::REPEAT));
+      node->min = min;
+      node->max = max;
+      if (!atEnd() && peek() == '?') {
+        node->greedy = false;
+        pos_++;
+      }
+      node->children.push_back(std::move(atom));
+      atom = std::move(node);
+    }
+    return atom;
+  }
+
+  std::unique_ptr<Node> parseAtom() {
+    char c = pattern_[pos_++];
+    switch (c) {
+      case '(': {
+        std::unique_ptr<Node> node;
+        if (!atEnd() && peek() == '?') {
+          if (pos_ + 1 < pattern_.size() && pattern_[pos_ + 1] == ':') {
+            pos_ += 2;
+            node = parseAlternation();
+          } else {
+            // lookaround
+            throw UnsupportedPattern();
+          }
+        } else {
+          node.reset(new Node(Node::GROUP));
+          node->group = groups_++;
+          node->children.push_back(parseAlternation());
+        }
+        if (atEnd() || peek() != ')') {
+          error("missing )");
+        }
+        pos_++;
+        return node;
+      }
+      case '[':
+        return parseClass();
+      case '.': {
+        CharSet chars;
+        chars.set();
+        chars.reset('\n');
+        chars.reset('\r');
+        return makeChars(chars);
+      }
+      case '^':
+      case '$': {
+        std::unique_ptr<Node> node(new Node(Node::ASSERT));
+        node->assertion = c == '^' ? Op::BEGIN_LINE : Op::END_LINE;
+        return node;
+      }
+      case '*':
+      case '+':
+      case '?':
+        pos_--;
+        error("nothing to repeat");
+        break;
+      case '\\': {
+        if (atEnd()) {
+          error("trailing \\");
+        }
+        char escape = peek();
+        if (escape == 'b' || escape == 'B') {
+          pos_++;
+          std::unique_ptr<Node> node(new Node(Node::ASSERT));
+          node->assertion = escape == 'b' ? Op::WORD_BOUNDARY : Op::NOT_WORD_BOUNDARY;
+          return node;
+        }
+        if (escape >= '1' && escape <= '9') {
+          // backreference
+          throw UnsupportedPattern();
+        }
+        return makeChars(parseEscape());
+      }
+      default:
+        break;
+    }
+    CharSet chars;
+    chars.set(static_cast<unsigned char>(c));
+    return makeChars(chars);
+  }
+
+  int parseHex(size_t digits) {
+    if (pos_ + digits > pattern_.size()) {
+      error("invalid escape");
+    }
+    int value = 0;
+    for (size_t i = 0; i < digits; i++) {
+      char c = pattern_[pos_++];
+      if (!std::isxdigit(static_cast<unsigned char>(c))) {
+        error("invalid escape");
+      }
+      value = value * 16 + (std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : std::tolower(c) - 'a' + 10);
+    }
+    return value;
+  }
+
+  /**
+   * Parses the escape following a backslash into the characters it matches.
+   */
+  CharSet parseEscape() {
+    char c = pattern_[pos_++];
+    CharSet chars;
+    switch (c) {
+      case 'd':
+        return digitChars();
+      case 'D':
+        return ~digitChars();
+      case 'w':
+        return wordChars();
+      case 'W':
+        return ~wordChars();
+      case 's':
+        return spaceChars();
+      case 'S':
+        return ~spaceChars();
+      case 't':
+        chars.set('\t');
+        break;
+      case 'n':
+        chars.set('\n');
+        break;
+      case 'r':
+        chars.set('\r');
+        break;
+      case 'f':
+        chars.set('\f');
+        break;
+      case 'v':
+        chars.set('\v');
+        break;
+      case '0':
+        chars.set(0);
+        break;
+      case 'x':
+        chars.set(parseHex(2));
+        break;
+      case 'u': {
+        int value = parseHex(4);
+        if (value > 0xff) {
+          throw UnsupportedPattern();
+        }
+        chars.set(value);
+        break;
+      }
+      default:
+        chars.set(static_cast<unsigned char>(c));
+        break;
+    }
+    return chars;
+  }
+
+  CharSet parsePosixClass() {
+    size_t end = pattern_.find(":]", pos_);
+    if (end == std::string::npos) {
+      error("unterminated character class");
+    }
+    std::string name = pattern_.substr(pos_, end - pos_);
+    pos_ = end + 2;
+    CharSet chars;
+    for (int c = 0; c < 256; c++) {
+      bool member = false;
+      if (name == "alpha") {
+        member = std::isalpha(c);
+      } else if (name == "digit") {
+        member = std::isdigit(c);
+      } else if (name == "alnum") {
+        member = std::isalnum(c);
+      } else if (name == "upper") {
+        member = std::isupper(c);
+      } else if (name == "lower") {
+        member = std::islower(c);
+      } else if (name == "space") {
+        member = std::isspace(c);
+      } else if (name == "blank") {
+        member = c == ' ' || c == '\t';
+      } else if (name == "punct") {
+        member = std::ispunct(c);
+      } else if (name == "print") {
+        member = std::isprint(c);
+      } else if (name == "graph") {
+        member = std::isgraph(c);
+      } else if (name == "cntrl") {
+        member = std::iscntrl(c);
+      } else if (name == "xdigit") {
+        member = std::isxdigit(c);
+      } else if (name == "w") {
+        member = isWordChar(c);
+      } else {
+        error("unknown character class " + name);
+      }
+      if (member && c < 128) {
+        chars.set(c);
+      }
+    }
+    return chars;
+  }
+
+  /**
+   * Parses a single member of a bracket expression, returning the character for
+   * members which can start a range and -1 for classes.
+   */
+  int parseClassMember(CharSet &chars) {
+    char c = pattern_[pos_++];
+    if (c == '[' && !atEnd() && peek() == ':') {
+      pos_++;
+      chars |= parsePosixClass();
+      return -1;
+    }
+    if (c == '\\') {
+      if (atEnd()) {
+        error("unterminated character class");
+      }
+      if (peek() == 'b') {
+        pos_++;
+        chars.set('\b');
+        return '\b';
+      }
+      CharSet escaped = parseEscape();
+      chars |= escaped;
+      if (escaped.count() != 1) {
+        return -1;
+      }
+      for (int i = 0; i < 256; i++) {
+        if (escaped.test(i)) {
+          return i;
+        }
+      }
+    }
+    chars.set(static_cast<unsigned char>(c));
+    return static_cast<unsigned char>(c);
+  }
+
+  std::unique_ptr<Node> parseClass() {
+    bool negated = false;
+    if (!atEnd() && peek() == '^') {
+      negated = true;
+      pos_++;
+    }
+    CharSet chars;
+    bool first = true;
+    while (true) {
+      if (atEnd()) {
+        error("unterminated character class");
+      }
+      if (peek() == ']' && !first) {
+        pos_++;
+        break;
+      }
+      first = false;
+      int low = parseClassMember(chars);
+      if (low >= 0 && pos_ + 1 < pattern_.size() && peek() == '-' && pattern_[pos_ + 1] != ']') {
+        pos_++;
+        int high = parseClassMember(chars);
+        if (high < 0 || high < low) {
+          error("invalid range in character class");
+        }
+        chars |= charRange(low, high);
+      }
+    }
+    chars = fold(chars);
+    if (negated) {
+      chars = ~chars;
+    }
+    std::unique_ptr<Node> node(new Node(Node::CHARS));
+    node->chars = chars;
+    return node;
+  }
+
+  const std::string &pattern_;
+  size_t pos_;
+  bool icase_;
+  size_t groups_;
+};
+
+}  // namespace
+
+/**
+ * Program for the Pike VM, or the std::regex for patterns it cannot run.
+ */
+class RegexProgram {
+ public:
+  RegexProgram(const std::string &pattern, bool icase)
+      : groups_(1),
+        can_skip_(false) {
+    try {
+      Parser parser(pattern, icase);
+      auto tree = parser.parse();
+      groups_ = parser.getGroupCount();
+      emit(Op::SAVE, 0);
+      compile(*tree);
+      emit(Op::SAVE, 1);
+      emit(Op::MATCH);
+      computeFirstChars();
+    } catch (const UnsupportedPattern &) {
+      auto flags = std::regex_constants::ECMAScript;
+      if (icase) {
+        flags |= std::regex_constants::icase;
+      }
+      try {
+        fallback_.reset(new std::regex(pattern, flags));
+      } catch (const std::regex_error &e) {
+        throw Exception(REGEX_EXCEPTION, e.what());
+      }
+      groups_ = fallback_->mark_count() + 1;
+    }
+  }
+
+  size_t getGroupCount() const {
+    return groups_;
+  }
+
+  /**
+   * Runs the program on data from start.
+   * @param anchored whether the match has to begin at start
+   * @param full whether the match has to span from start to the end of data
+   * @param not_empty whether empty matches are rejected
+   * @param slots receives the offsets of the first slots.size() / 2 groups
+   */
+  bool run(const char *data, size_t length, size_t start, bool anchored, bool full, bool not_empty, std::vector<size_t> &slots) const;
+
+ private:
+  struct ThreadList {
+    ThreadList()
+        : size(0) {
+    }
+    void reset(size_t program_size, size_t slots) {
+      if (sparse.size() < program_size) {
+        sparse.resize(program_size);
+        dense.resize(program_size);
+      }
+      if (caps.size() < program_size * slots) {
+        caps.resize(program_size * slots);
+      }
+      size = 0;
+    }
+    bool contains(uint32_t pc) const {
+      return sparse[pc] < size && dense[sparse[pc]] == pc;
+    }
+    void insert(uint32_t pc) {
+      sparse[pc] = size;
+      dense[size++] = pc;
+    }
+    std::vector<uint32_t> sparse;
+    std::vector<uint32_t> dense;
+    uint32_t size;
+    // capture slots of the threads, indexed by program counter
+    std::vector<size_t> caps;
+  };
+
+  struct Job {
+    uint32_t pc;
+    // slot to restore to value, when pc is UINT32_MAX
+    uint32_t slot;
+    size_t value;
+  };
+
+  // working memory of run(), kept per thread to avoid allocating on every search
+  struct Scratch {
+    ThreadList lists[2];
+    std::vector<size_t> caps;
+    std::vector<Job> stack;
+  };
+
+  uint32_t emit(Op op, uint32_t x = 0, uint32_t y = 0, uint8_t c = 0) {
+    if (insts_.size() >= MAX_PROGRAM_SIZE) {
+      throw Exception(REGEX_EXCEPTION, "regular expression is too large");
+    }
+    insts_.push_back(Inst { op, c, x, y });
+    return static_cast<uint32_t>(insts_.size() - 1);
+  }
+
+  uint32_t next() const {
+    return static_cast<uint32_t>(insts_.size());
+  }
+
+  void compile(const Node &node) {
+    switch (node.type) {
+      case Node::CHARS:
+        if (node.chars.count() == 1) {
+          for (int c = 0; c < 256; c++) {
+            if (node.chars.test(c)) {
+              emit(Op::CHAR, 0, 0, static_cast<uint8_t>(c));
+            }
+          }
+        } else {
+          classes_.push_back(node.chars);
+          emit(Op::CLASS, static_cast<uint32_t>(classes_.size() - 1));
+        }
+        break;
+      case Node::CONCAT:
+        for (const auto &child : node.children) {
+          compile(*child);
+        }
+        break;
+      case Node::ALTERNATE: {
+        std::vector<uint32_t> jumps;
+        for (size_t i = 0; i < node.children.size(); i++) {
+          if (i + 1 < node.children.size()) {
+            uint32_t split = emit(Op::SPLIT);
+            insts_[split].x = next();
+            compile(*node.children[i]);
+            jumps.push_back(emit(Op::JMP));
+            insts_[split].y = next();
+          } else {
+            compile(*node.children[i]);
+          }
+        }
+        for (auto jump : jumps) {
+          insts_[jump].x = next();
+        }
+        break;
+      }
+      case Node::GROUP:
+        emit(Op::SAVE, static_cast<uint32_t>(2 * node.group));
+        compile(*node.children[0]);
+        emit(Op::SAVE, static_cast<uint32_t>(2 * node.group + 1));
+        break;
+      case Node::REPEAT:
+        compileRepeat(node);
+        break;
+      case Node::ASSERT:
+        emit(node.assertion);
+        break;
+    }
+  }
+
+  void setSplit(uint32_t split, uint32_t body, uint32_t out, bool greedy) {
+    insts_[split].x = greedy ? body : out;
+    insts_[split].y = greedy ? out : body;
+  }
+
+  void compileRepeat(const Node &node) {
+    const Node &child = *node.children[0];
+    for (int i = 0; i < node.min; i++) {
+      compile(child);
+    }
+    if (node.max == -1) {
+      uint32_t split = emit(Op::SPLIT);
+      compile(child);
+      emit(Op::JMP, split);
+      setSplit(split, split + 1, next(), node.greedy);
+      return;
+    }
+    // each optional copy skips all the remaining ones
+    std::vector<uint32_t> splits;
+    for (int i = node.min; i < node.max; i++) {
+      splits.push_back(emit(Op::SPLIT));
+      compile(child);
+    }
+    for (auto split : splits) {
+      setSplit(split, split + 1, next(), node.greedy);
+    }
+  }
+
+  /**
+   * Collects the literal prefix or the characters any match has to start with,
+   * letting searches skip ahead to the next place a match can begin.
+   */
+  void computeFirstChars() {
+    for (uint32_t pc = 0; pc < insts_.size(); pc++) {
+      if (insts_[pc].op == Op::CHAR) {
+        prefix_.push_back(static_cast<char>(insts_[pc].c));
+      } else if (insts_[pc].op != Op::SAVE) {
+        break;
+      }
+    }
+    std::vector<bool> visited(insts_.size());
+    std::vector<uint32_t> stack { 0 };
+    while (!stack.empty()) {
+      uint32_t pc = stack.back();
+      stack.pop_back();
+      if (visited[pc]) {
+        continue;
+      }
+      visited[pc] = true;
+      const Inst &inst = insts_[pc];
+      switch (inst.op) {
+        case Op::CHAR:
+          first_chars_.set(inst.c);
+          break;
+        case Op::CLASS:
+          first_chars_ |= classes_[inst.x];
+          break;
+        case Op::MATCH:
+          // matches the empty string
+          return;
+        case Op::JMP:
+          stack.push_back(inst.x);
+          break;
+        case Op::SPLIT:
+          stack.push_back(inst.x);
+          stack.push_back(inst.y);
+          break;
+        default:
+          stack.push_back(pc + 1);
+          break;
+      }
+    }
+    can_skip_ = !first_chars_.all();
+  }
+
+  /**
+   * @return offset of the next occurrence of the literal prefix from pos, or length
+   */
+  size_t findPrefix(const char *data, size_t length, size_t pos) const {
+    while (pos + prefix_.size() <= length) {
+      const void *first = std::memchr(data + pos, prefix_[0], length - pos - prefix_.size() + 1);
+      if (first == nullptr) {
+        break;
+      }
+      pos = static_cast<const char*>(first) - data;
+      if (std::memcmp(data + pos, prefix_.data(), prefix_.size()) == 0) {
+        return pos;
+      }
+      pos++;
+    }
+    return length;
+  }
+
+  bool assertionHolds(Op op, const char *data, size_t length, size_t pos) const {
+    switch (op) {
+      case Op::BEGIN_LINE:
+        return pos == 0;
+      case Op::END_LINE:
+        return pos == length;
+      default: {
+        bool before = pos > 0 && isWordChar(data[pos - 1]);
+        bool after = pos < length && isWordChar(data[pos]);
+        return (before != after) == (op == Op::WORD_BOUNDARY);
+      }
+    }
+  }
+
+  /**
+   * Adds the thread at pc and every thread reachable from it without consuming
+   * input, in priority order.
+   * @param thread_caps capture slots of the thread
+   * @param caps working copy of the capture slots
+   */
+  void addThread(ThreadList &list, uint32_t pc, const char *data, size_t length, size_t pos, const size_t *thread_caps, std::vector<size_t> &caps,
+                 std::vector<Job> &stack) const {
+    const size_t slots = caps.size();
+    if (list.contains(pc)) {
+      return;
+    }
+    Op op = insts_[pc].op;
+    if (op == Op::CHAR || op == Op::CLASS || op == Op::MATCH) {
+      list.insert(pc);
+      std::copy(thread_caps, thread_caps + slots, list.caps.begin() + pc * slots);
+      return;
+    }
+    std::copy(thread_caps, thread_caps + slots, caps.begin());
+    stack.push_back(Job { pc, 0, 0 });
+    while (!stack.empty()) {
+      Job job = stack.back();
+      stack.pop_back();
+      if (job.pc == UINT32_MAX) {
+        caps[job.slot] = job.value;
+        continue;
+      }
+      pc = job.pc;
+      while (!list.contains(pc)) {
+        list.insert(pc);
+        const Inst &inst = insts_[pc];
+        if (inst.op == Op::JMP) {
+          pc = inst.x;
+        } else if (inst.op == Op::SPLIT) {
+          stack.push_back(Job { inst.y, 0, 0 });
+          pc = inst.x;
+        } else if (inst.op == Op::SAVE) {
+          if (inst.x < slots) {
+            stack.push_back(Job { UINT32_MAX, inst.x, caps[inst.x] });
+            caps[inst.x] = pos;
+          }
+          pc++;
+        } else if (inst.op == Op::CHAR || inst.op == Op::CLASS || inst.op == Op::MATCH) {
+          std::copy(caps.begin(), caps.end(), list.caps.begin() + pc * slots);
+          break;
+        } else if (assertionHolds(inst.op, data, length, pos)) {
+          pc++;
+        } else {
+          break;
+        }
+      }
+    }
+  }
+
+  std::vector<Inst> insts_;
+  std::vector<CharSet> classes_;
+  size_t groups_;
+  std::string prefix_;
+  CharSet first_chars_;
+  bool can_skip_;
+  std::unique_ptr<std::regex> fallback_;
+};
+
+bool RegexProgram::run(const char *data, size_t length, size_t start, bool anchored, bool full, bool not_empty, std::vector<size_t> &slots) const {
+  std::fill(slots.begin(), slots.end(), std::string::npos);
+  anchored = anchored || full;
+  if (fallback_) {
+    std::cmatch matches;
+    auto flags = start > 0 ? std::regex_constants::match_prev_avail : std::regex_constants::match_default;
+    if (anchored) {
+      flags |= std::regex_constants::match_continuous;
+    }
+    if (not_empty) {
+      flags |= std::regex_constants::match_not_null;
+    }
+    bool matched = full ? std::regex_match(data + start, data + length, matches, *fallback_, flags) : std::regex_search(data + start, data + length, matches, *fallback_, flags);
+    if (!matched) {
+      return false;
+    }
+    for (size_t i = 0; i < slots.size() / 2 && i < matches.size(); i++) {
+      if (matches[i].matched) {
+        slots[2 * i] = matches[i].first - data;
+        slots[2 * i + 1] = matches[i].second - data;
+      }
+    }
+    return true;
+  }
+
+  static thread_local Scratch scratch;
+  const size_t slot_count = slots.size();
+  ThreadList *clist = &scratch.lists[0];
+  ThreadList *nlist = &scratch.lists[1];
+  clist->reset(insts_.size(), slot_count);
+  nlist->reset(insts_.size(), slot_count);
+  std::vector<size_t> &caps = scratch.caps;
+  caps.resize(slot_count);
+  std::vector<Job> &stack = scratch.stack;
+  bool matched = false;
+
+  for (size_t pos = start; pos <= length; pos++) {
+    if (!matched && (!anchored || pos == start)) {
+      if (clist->size == 0 && !anchored && !prefix_.empty()) {
+        pos = findPrefix(data, length, pos);
+        if (pos == length) {
+          break;
+        }
+      } else if (clist->size == 0 && !anchored && can_skip_) {
+        while (pos < length && !first_chars_.test(static_cast<unsigned char>(data[pos]))) {
+          pos++;
+        }
+        if (pos == length) {
+          break;
+        }
+      }
+      // no match can begin at a character outside of the first characters
+      if (!can_skip_ || (pos < length && first_chars_.test(static_cast<unsigned char>(data[pos])))) {
+        std::fill(caps.begin(), caps.end(), std::string::npos);
+        addThread(*clist, 0, data, length, pos, caps.data(), caps, stack);
+      }
+    }
+    if (clist->size == 0) {
+      break;
+    }
+    nlist->size = 0;
+    for (uint32_t i = 0; i < clist->size; i++) {
+      uint32_t pc = clist->dense[i];
+      const Inst &inst = insts_[pc];
+      bool consumes = false;
+      if (inst.op == Op::CHAR) {
+        consumes = pos < length && static_cast<unsigned char>(data[pos]) == inst.c;
+      } else if (inst.op == Op::CLASS) {
+        consumes = pos < length && classes_[inst.x].test(static_cast<unsigned char>(data[pos]));
+      } else if (inst.op == Op::MATCH) {
+        if ((full && pos != length) || (not_empty && pos == start)) {
+          continue;
+        }
+        std::copy(clist->caps.begin() + pc * slot_count, clist->caps.begin() + (pc + 1) * slot_count, slots.begin());
+        matched = true;
+        // lower priority threads can only find less preferred matches
+        break;
+      }
+      if (consumes) {
+        addThread(*nlist, pc + 1, data, length, pos + 1, clist->caps.data() + pc * slot_count, caps, stack);
+      }
+    }
+    std::swap(clist, nlist);
+  }
+  return matched;
+}
+
+namespace {
+
+std::shared_ptr<const RegexProgram> compileProgram(const std::string &pattern, bool icase) {
+  static std::mutex mutex;
+  static std::map<std::pair<std::string, bool>, std::shared_ptr<const RegexProgram>> programs;
+  auto key = std::make_pair(pattern, icase);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = programs.find(key);
+    if (it != programs.end()) {
+      return it->second;
+    }
+  }
+  auto program = std::make_shared<const RegexProgram>(pattern, icase);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (programs.size() >= MAX_CACHED_PROGRAMS) {
+    programs.clear();
+  }
+  programs[key] = program;
+  return program;
+}
+
+}  // namespace
+
 Regex::Regex() : Regex::Regex("") {}
 
 Regex::Regex(const std::string &value) : Regex::Regex(value, {}) {}
@@ -35,54 +973,20 @@ Regex::Regex(const std::string &value,
                            const std::vector<Regex::Mode> &mode)
     : regexStr_(value),
       valid_(false) {
-  if (regexStr_.empty())
-    return;
-
-  // Create regex mode
-#ifdef NO_MORE_REGFREEE
-  regex_mode_ = std::regex_constants::ECMAScript;
-#else
-  regex_mode_ = REG_EXTENDED;
-#endif
+  bool icase = false;
   for (const auto m : mode) {
     switch (m) {
       case Mode::ICASE:
-#ifdef NO_MORE_REGFREEE
-        regex_mode_ |= std::regex_constants::icase;
-#else
-        regex_mode_ |= REG_ICASE;
-#endif
+        icase = true;
         break;
     }
   }
-  // Compile
-#ifdef NO_MORE_REGFREEE
-  try {
-    compiledRegex_ = std::regex(regexStr_, regex_mode_);
-    valid_ = true;
-  } catch (const std::regex_error &e) {
-    throw Exception(REGEX_EXCEPTION, e.what());
-  }
-#else
-  int err_code = regcomp(&compiledRegex_, regexStr_.c_str(), regex_mode_);
-  if (err_code) {
-    const size_t sz = regerror(err_code, &compiledRegex_, nullptr, 0);
-    std::vector<char> msg(sz);
-    regerror(err_code, &compiledRegex_, msg.data(), msg.size());
-    throw Exception(REGEX_EXCEPTION, std::string(msg.begin(), msg.end()));
-  }
-  valid_ = true;
-  int maxGroups = std::count(regexStr_.begin(), regexStr_.end(), '(') + 1;
-  matches_.resize(maxGroups);
-#endif
+  program_ = compileProgram(regexStr_, icase);
+  valid_ = !regexStr_.empty();
 }
 
 Regex::Regex(Regex&& other)
-#ifndef NO_MORE_REGFREEE
-  : valid_(false),
-    regex_mode_(REG_EXTENDED)
-#endif
-{
+    : valid_(false) {
   *this = std::move(other);
 }
 
@@ -95,27 +999,13 @@ Regex& Regex::operator=(Regex&& other) {
   suffix_ = std::move(other.suffix_);
   regexStr_ = std::move(other.regexStr_);
   results_ = std::move(other.results_);
-#ifdef NO_MORE_REGFREEE
-  compiledRegex_ = std::move(other.compiledRegex_);
-  regex_mode_ = other.regex_mode_;
-  matches_ = std::move(other.matches_);
-#else
-  if (valid_)
-    regfree(&compiledRegex_);
-  compiledRegex_ = other.compiledRegex_;
-  regex_mode_ = other.regex_mode_;
-  matches_ = std::move(other.matches_);
-#endif
+  program_ = std::move(other.program_);
   valid_ = other.valid_;
   other.valid_ = false;
   return *this;
 }
 
 Regex::~Regex() {
-#ifndef NO_MORE_REGFREEE
-  if (valid_)
-    regfree(&compiledRegex_);
-#endif
 }
 
 bool Regex::match(const std::string &pattern) {
@@ -124,40 +1014,121 @@ bool Regex::match(const std::string &pattern) {
   }
   results_.clear();
   pat_ = pattern;
-#ifdef NO_MORE_REGFREEE
-  if (std::regex_search(pattern, matches_, compiledRegex_)) {
-    for (const auto &m : matches_) {
-      results_.push_back(m.str());
-    }
-    suffix_ = matches_.suffix();
-    return true;
+  std::vector<size_t> groups;
+  if (!search(pattern.data(), pattern.size(), 0, groups)) {
+    return false;
   }
-  return false;
-#else
-  if (regexec(&compiledRegex_, pattern.c_str(), matches_.size(),
-              matches_.data(), 0) == 0) {
-    for (const auto &m : matches_) {
-      if (m.rm_so == -1) {
-        break;
-      }
-      std::string s(pattern.begin() + m.rm_so, pattern.begin() + m.rm_eo);
-      results_.push_back(s);
-    }
-    if ((size_t) matches_[0].rm_eo >= pattern.size()) {
-      suffix_ = "";
+  for (size_t i = 0; i < groups.size(); i += 2) {
+    if (groups[i] == std::string::npos) {
+      results_.push_back("");
     } else {
-      suffix_ = pattern.substr(matches_[0].rm_eo + 1);
+      results_.push_back(pattern.substr(groups[i], groups[i + 1] - groups[i]));
     }
-    return true;
   }
-  return false;
-#endif
+  if (groups[1] >= pattern.size()) {
+    suffix_ = "";
+  } else {
+    suffix_ = pattern.substr(groups[1] + 1);
+  }
+  return true;
 }
 
 const std::vector<std::string>& Regex::getResult() const { return results_; }
 
 const std::string& Regex::getSuffix() const { return suffix_; }
 
+bool Regex::matchesFully(const std::string &subject) const {
+  std::vector<size_t> slots;
+  return program_ && program_->run(subject.data(), subject.size(), 0, true, true, false, slots);
+}
+
+bool Regex::find(const std::string &subject) const {
+  std::vector<size_t> slots;
+  return program_ && program_->run(subject.data(), subject.size(), 0, false, false, false, slots);
+}
+
+bool Regex::search(const char *data, size_t length, size_t start, std::vector<size_t> &groups) const {
+  if (!program_ || start > length) {
+    return false;
+  }
+  groups.resize(2 * program_->getGroupCount());
+  return program_->run(data, length, start, false, false, false, groups);
+}
+
+std::string Regex::replace(const std::string &subject, const std::string &format, bool first_only) const {
+  std::string result;
+  std::vector<size_t> groups;
+  // end of the previous match, which $` starts from
+  size_t copied = 0;
+  size_t pos = 0;
+  bool after_empty = false;
+  while (program_) {
+    bool found = false;
+    if (after_empty) {
+      // as std::regex_replace does, a non-empty match at the position of an empty one takes precedence
+      groups.resize(2 * getGroupCount());
+      found = program_->run(subject.data(), subject.size(), pos, true, false, true, groups);
+      if (!found && pos < subject.size()) {
+        found = search(subject.data(), subject.size(), ++pos, groups);
+      }
+    } else {
+      found = search(subject.data(), subject.size(), pos, groups);
+    }
+    if (!found) {
+      break;
+    }
+    result.append(subject, copied, groups[0] - copied);
+    for (size_t i = 0; i < format.size(); i++) {
+      char c = format[i];
+      if (c != '$' || i + 1 == format.size()) {
+        result.push_back(c);
+        continue;
+      }
+      char ref = format[i + 1];
+      if (ref == '$') {
+        result.push_back('$');
+        i++;
+      } else if (ref == '&') {
+        result.append(subject, groups[0], groups[1] - groups[0]);
+        i++;
+      } else if (ref == '`') {
+        result.append(subject, copied, groups[0] - copied);
+        i++;
+      } else if (ref == '\'') {
+        result.append(subject, groups[1], std::string::npos);
+        i++;
+      } else if (std::isdigit(static_cast<unsigned char>(ref))) {
+        // as std::regex_replace does, up to two digits are read and missing groups are empty
+        size_t group = ref - '0';
+        i++;
+        if (i + 1 < format.size() && std::isdigit(static_cast<unsigned char>(format[i + 1]))) {
+          group = group * 10 + (format[i + 1] - '0');
+          i++;
+        }
+        if (group < getGroupCount() && groups[2 * group] != std::string::npos) {
+          result.append(subject, groups[2 * group], groups[2 * group + 1] - groups[2 * group]);
+        }
+      } else {
+        result.push_back(c);
+      }
+    }
+    copied = groups[1];
+    if (first_only) {
+      break;
+    }
+    after_empty = groups[0] == groups[1];
+    pos = groups[1];
+  }
+  if (copied < subject.size()) {
+    result.append(subject, copied, std::string::npos);
+  }
+  return result;
+}
+
+size_t Regex::getGroupCount() const {
+  return program_ ? program_->getGroupCount() : 0;
+}
+
 } /* namespace utils */
 } /* namespace minifi */
 } /* namespace nifi */
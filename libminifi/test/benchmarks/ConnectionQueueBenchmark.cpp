@@ -0,0 +1,101 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Measures Connection put/poll throughput for each queue type with 1 to 32
+ * producer and consumer threads.
+ *
+ * usage: ConnectionQueueBenchmark [flow files per producer]
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../unit/ProvenanceTestHelper.h"
+#include "Connection.h"
+#include "FlowFileRecord.h"
+#include "core/repository/VolatileContentRepository.h"
+
+namespace minifi = org::apache::nifi::minifi;
+namespace core = minifi::core;
+
+double run(const std::shared_ptr<core::Repository> &repo, const std::shared_ptr<core::ContentRepository> &content_repo, const std::string &queue_type, int threads, int per_thread) {
+  std::shared_ptr<minifi::Connection> connection = std::make_shared<minifi::Connection>(repo, content_repo, "benchmark");
+  connection->setQueueType(queue_type);
+
+  std::vector<std::vector<std::shared_ptr<core::FlowFile>>> flows(threads);
+  for (auto &thread_flows : flows) {
+    for (int i = 0; i < per_thread; i++) {
+      std::map<std::string, std::string> attributes;
+      std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(repo, content_repo, attributes);
+      flow->setSize(1024);
+      flow->setStoredToRepository(true);
+      thread_flows.push_back(flow);
+    }
+  }
+
+  const int total = threads * per_thread;
+  std::atomic<int> polled(0);
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < threads; i++) {
+    std::vector<std::shared_ptr<core::FlowFile>> &thread_flows = flows[i];
+    workers.emplace_back([&connection, &thread_flows]() {
+      for (const auto &flow : thread_flows) {
+        connection->put(flow);
+      }
+    });
+    workers.emplace_back([&connection, &polled, total]() {
+      std::set<std::shared_ptr<core::FlowFile>> expired;
+      while (polled < total) {
+        if (nullptr != connection->poll(expired)) {
+          polled++;
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  return elapsed > 0 ? (total * 1000000.0) / elapsed : 0;
+}
+
+int main(int argc, char **argv) {
+  int per_thread = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+
+  std::cout << "queue type, producer threads, consumer threads, flow files/sec" << std::endl;
+  for (const std::string queue_type : { "locking", "concurrent" }) {
+    for (int threads = 1; threads <= 32; threads *= 2) {
+      double rate = run(repo, content_repo, queue_type, threads, per_thread);
+      std::cout << queue_type << ", " << threads << ", " << threads << ", " << static_cast<uint64_t>(rate) << std::endl;
+    }
+  }
+  return 0;
+}
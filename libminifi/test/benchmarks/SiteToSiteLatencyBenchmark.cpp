@@ -0,0 +1,103 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Measures the throughput of a remote port sending flow files over a link with the given round
+ * trip time, for several values of its Max In-Flight Transactions.
+ *
+ * The port is triggered until its queue is drained. Its clients talk to in-process responders,
+ * which hold back each response for a round trip after the client last wrote to them.
+ *
+ * usage: SiteToSiteLatencyBenchmark [round trip ms] [transactions per run]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "../unit/ProvenanceTestHelper.h"
+#include "../unit/RemotePortHelper.h"
+#include "Connection.h"
+#include "RemoteProcessorGroupPort.h"
+#include "core/ProcessContext.h"
+#include "core/ProcessSessionFactory.h"
+#include "core/ProcessorNode.h"
+#include "core/repository/VolatileContentRepository.h"
+
+namespace minifi = org::apache::nifi::minifi;
+namespace core = minifi::core;
+
+void run(std::chrono::milliseconds round_trip, int in_flight, int transactions, int packets, const std::string &payload) {
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+
+  // each transaction sends as many flow files as it had packets
+  auto script = std::make_shared<RemotePortScript>(round_trip, packets);
+  auto port = std::make_shared<ScriptedRemotePort>("benchmark", configuration, script);
+  port->initialize();
+  port->setProperty(minifi::RemoteProcessorGroupPort::hostName, "fake_host");
+  port->setProperty(minifi::RemoteProcessorGroupPort::port, "65433");
+  port->setProperty(minifi::RemoteProcessorGroupPort::portUUID, "c56a4180-65aa-42ec-a945-5fd21dec0538");
+  port->setProperty(minifi::RemoteProcessorGroupPort::maxInFlightTransactions, std::to_string(in_flight));
+  port->setTransmitting(true);
+
+  auto connection = std::make_shared<minifi::Connection>(repo, content_repo, "benchmark");
+  connection->setDestination(port);
+  minifi::utils::Identifier port_uuid;
+  port->getUUID(port_uuid);
+  connection->setDestinationUUID(port_uuid);
+  port->addConnection(connection);
+  for (int i = 0; i < transactions * packets; i++) {
+    connection->put(createFlowFile(repo, content_repo, payload));
+  }
+
+  std::shared_ptr<core::ProcessorNode> node = std::make_shared<core::ProcessorNode>(port);
+  std::shared_ptr<core::controller::ControllerServiceProvider> controller_services_provider = nullptr;
+  auto context = std::make_shared<core::ProcessContext>(node, controller_services_provider, repo, repo, configuration, content_repo);
+  auto factory = std::make_shared<core::ProcessSessionFactory>(context);
+  port->onSchedule(context, factory);
+
+  auto start = std::chrono::steady_clock::now();
+  // a failed transaction puts its flow files back, so the triggers are bounded rather than run until the queue is empty
+  for (int i = 0; i < transactions && !connection->isEmpty(); i++) {
+    port->onTrigger(context, factory);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  port->notifyStop();
+
+  bool ok = script->confirmed == transactions;
+  double seconds = std::max<int64_t>(elapsed, 1) / 1000.0;
+  std::cout << round_trip.count() << ", " << in_flight << ", " << transactions << ", " << elapsed << ", " << static_cast<uint64_t>(transactions / seconds) << ", "
+            << static_cast<uint64_t>(transactions * packets * payload.size() / seconds / 1024) << (ok ? "" : ", failed") << std::endl;
+}
+
+int main(int argc, char **argv) {
+  int round_trip = argc > 1 ? std::atoi(argv[1]) : 50;
+  int transactions = argc > 2 ? std::atoi(argv[2]) : 32;
+  const int packets = 16;
+  const std::string payload(4096, 'x');
+
+  std::cout << "round trip ms, in-flight transactions, transactions, elapsed ms, transactions/s, KB/s" << std::endl;
+  for (int in_flight : { 1, 2, 4, 8 }) {
+    run(std::chrono::milliseconds(round_trip), in_flight, transactions, packets, payload);
+  }
+  return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Measures how late periodic tasks run on the polling and the work stealing
+ * thread pools, and the CPU time each pool uses while its tasks are mostly idle.
+ *
+ * usage: ThreadPoolLatencyBenchmark [seconds per run]
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utils/ThreadPool.h"
+
+namespace minifi = org::apache::nifi::minifi;
+namespace utils = minifi::utils;
+
+/**
+ * Runs a task every period until the benchmark stops it.
+ */
+class PeriodicTask : public utils::AfterExecute<uint64_t> {
+ public:
+  PeriodicTask(std::atomic<bool> *running, uint64_t period)
+      : running_(running),
+        period_(period) {
+  }
+  virtual bool isFinished(const uint64_t &result) {
+    return !*running_;
+  }
+  virtual bool isCancelled(const uint64_t &result) {
+    return false;
+  }
+  virtual int64_t wait_time() {
+    return period_;
+  }
+
+ private:
+  std::atomic<bool> *running_;
+  uint64_t period_;
+};
+
+// Lateness of every run in microseconds
+struct Latencies {
+  std::mutex mutex;
+  std::vector<int64_t> samples;
+};
+
+void run(bool work_stealing, int tasks, uint64_t period, int seconds) {
+  utils::ThreadPool<uint64_t> pool(2, false, nullptr, "BenchmarkPool", work_stealing);
+  std::atomic<bool> running(true);
+  Latencies latencies;
+  std::vector<std::future<uint64_t>> futures;
+  for (int i = 0; i < tasks; i++) {
+    auto due = std::make_shared<std::chrono::steady_clock::time_point>(std::chrono::steady_clock::now());
+    std::function<uint64_t()> f_ex = [&latencies, due, period]() {
+      auto now = std::chrono::steady_clock::now();
+      {
+        std::lock_guard<std::mutex> lock(latencies.mutex);
+        latencies.samples.push_back(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(now - *due).count()));
+      }
+      *due = now + std::chrono::milliseconds(period);
+      return period;
+    };
+    std::unique_ptr<utils::AfterExecute<uint64_t>> monitor = std::unique_ptr<utils::AfterExecute<uint64_t>>(new PeriodicTask(&running, period));
+    utils::Worker<uint64_t> worker(f_ex, "task" + std::to_string(i), std::move(monitor));
+    std::future<uint64_t> future;
+    pool.execute(std::move(worker), future);
+    futures.push_back(std::move(future));
+  }
+
+  std::clock_t cpu_start = std::clock();
+  pool.start();
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  running = false;
+  for (auto &future : futures) {
+    future.wait();
+  }
+  double cpu_ms = (std::clock() - cpu_start) * 1000.0 / CLOCKS_PER_SEC;
+  pool.shutdown();
+
+  std::vector<int64_t> &samples = latencies.samples;
+  std::sort(samples.begin(), samples.end());
+  if (samples.empty()) {
+    return;
+  }
+  auto percentile = [&samples](double p) {
+    return samples[std::min(samples.size() - 1, static_cast<size_t>(samples.size() * p))];
+  };
+  std::cout << (work_stealing ? "work stealing" : "polling") << ", " << tasks << ", " << period << ", " << samples.size() << ", " << percentile(0.5) << ", " << percentile(0.99) << ", "
+            << samples.back() << ", " << static_cast<uint64_t>(cpu_ms) << std::endl;
+}
+
+int main(int argc, char **argv) {
+  int seconds = argc > 1 ? std::atoi(argv[1]) : 5;
+
+  std::cout << "pool, tasks, period ms, runs, p50 lateness us, p99 lateness us, max lateness us, cpu ms" << std::endl;
+  for (bool work_stealing : { false, true }) {
+    for (uint64_t period : { 1, 5, 100 }) {
+      for (int tasks : { 1, 16 }) {
+        run(work_stealing, tasks, period, seconds);
+      }
+    }
+  }
+  return 0;
+}
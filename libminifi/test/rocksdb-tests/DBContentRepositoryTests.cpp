@@ -292,3 +292,54 @@ auto dir = testController.createTempDirectory(format);
 
   REQUIRE(readstr == "well hello there");
 }
+
+TEST_CASE("Chunked Claim", "[TestDBCR7]") {
+  TestController testController;
+  char format[] = "/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  auto content_repo = std::make_shared<core::repository::DatabaseContentRepository>();
+
+  auto configuration = std::make_shared<org::apache::nifi::minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, dir);
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_chunk_size, "4");
+  REQUIRE(true == content_repo->initialize(configuration));
+
+  auto claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+  std::string content = "0123456789";
+  auto stream = content_repo->write(claim);
+  REQUIRE(10 == stream->writeData(reinterpret_cast<uint8_t*>(&content[0]), content.size()));
+  stream->closeStream();
+
+  // appending continues the partial last chunk
+  std::string appended = "abcdef";
+  stream = content_repo->write(claim, true);
+  REQUIRE(10 == stream->getSize());
+  REQUIRE(6 == stream->writeData(reinterpret_cast<uint8_t*>(&appended[0]), appended.size()));
+  stream->closeStream();
+
+  auto read_stream = content_repo->read(claim);
+  REQUIRE(16 == read_stream->getSize());
+  std::vector<uint8_t> buffer(32);
+  REQUIRE(16 == read_stream->readData(buffer.data(), 32));
+  REQUIRE("0123456789abcdef" == std::string(reinterpret_cast<char*>(buffer.data()), 16));
+
+  read_stream->seek(7);
+  REQUIRE(5 == read_stream->readData(buffer.data(), 5));
+  REQUIRE("789ab" == std::string(reinterpret_cast<char*>(buffer.data()), 5));
+
+  // replacing the content removes chunks past its end
+  std::string replaced = "xyz";
+  stream = content_repo->write(claim);
+  REQUIRE(3 == stream->writeData(reinterpret_cast<uint8_t*>(&replaced[0]), replaced.size()));
+  stream->closeStream();
+  read_stream = content_repo->read(claim);
+  REQUIRE(3 == read_stream->getSize());
+  REQUIRE(3 == read_stream->readData(buffer.data(), 32));
+  REQUIRE("xyz" == std::string(reinterpret_cast<char*>(buffer.data()), 3));
+
+  REQUIRE(true == content_repo->exists(claim));
+  REQUIRE(true == content_repo->remove(claim));
+  REQUIRE(false == content_repo->exists(claim));
+  read_stream = content_repo->read(claim);
+  REQUIRE(-1 == read_stream->readData(buffer.data(), 32));
+}
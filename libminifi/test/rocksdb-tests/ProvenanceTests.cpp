@@ -27,6 +27,7 @@
 #include "core/Core.h"
 #include "core/repository/AtomicRepoEntries.h"
 #include "FlowFileRepository.h"
+#include "ProvenanceRepository.h"
 #include "core/repository/VolatileProvenanceRepository.h"
 
 TEST_CASE("Test Provenance record create", "[Testprovenance::ProvenanceEventRecord]") {
@@ -162,3 +163,104 @@ TEST_CASE("Test Provenance record serialization NoOp", "[Testprovenance::Provena
   record2.setEventId(eventId);
   REQUIRE(record2.DeSerialize(testRepository) == false);
 }
+
+TEST_CASE("Test Provenance details formatted when read", "[Testprovenance::ProvenanceDetails]") {
+  std::shared_ptr<core::Repository> testRepository = std::make_shared<TestRepository>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  std::map<std::string, std::string> attributes;
+  std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(testRepository, content_repo, attributes);
+
+  provenance::ProvenanceReporter reporter(testRepository, "componentid", "componentid");
+  reporter.create(flow);
+  reporter.modifyAttributes(flow, "key", "value");
+  reporter.removeAttribute(flow, "key");
+  reporter.modifyContent(flow, 5);
+  reporter.expire(flow);
+  reporter.drop(flow, "done");
+  // all events of the session are stored with a single MultiPut
+  reporter.commit();
+
+  std::set<std::string> details;
+  for (const auto &event : reporter.getEvents()) {
+    provenance::ProvenanceEventRecord stored;
+    stored.setEventId(event->getEventId());
+    REQUIRE(stored.DeSerialize(testRepository));
+    REQUIRE(stored.getDetailFormat() == event->getDetailFormat());
+    REQUIRE(stored.getComponentType() == "componentid");
+    REQUIRE(stored.getDetails() == event->getDetails());
+    details.insert(stored.getDetails());
+  }
+  std::string uuid = flow->getUUIDStr();
+  REQUIRE(details.size() == 6);
+  REQUIRE(details.count("componentid creates flow record " + uuid) == 1);
+  REQUIRE(details.count("componentid modify flow record " + uuid + " attribute key:value") == 1);
+  REQUIRE(details.count("componentid remove flow record " + uuid + " attribute key") == 1);
+  REQUIRE(details.count("componentid modify flow record content " + uuid) == 1);
+  REQUIRE(details.count("componentid expire flow record " + uuid) == 1);
+  REQUIRE(details.count("Discard reason: done") == 1);
+}
+
+TEST_CASE("Test Provenance repository time partitions", "[Testprovenance::ProvenancePartitions]") {
+  TestController testController;
+  char format[] = "/tmp/provenance.XXXXXX";
+  std::string directory = testController.createTempDirectory(format);
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_provenance_repository_directory_default, directory);
+  configuration->set(minifi::Configure::nifi_provenance_repository_max_storage_time, "1 sec");
+
+  std::shared_ptr<provenance::ProvenanceRepository> repository = std::make_shared<provenance::ProvenanceRepository>("provenance", directory, 1000, 10 * 1024 * 1024, 0);
+  REQUIRE(repository->initialize(configuration));
+
+  std::vector<std::string> eventIds;
+  {
+    provenance::ProvenanceReporter reporter(repository, "componentid", "componenttype");
+    std::shared_ptr<core::Repository> flow_repo = std::make_shared<TestRepository>();
+    std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+    std::map<std::string, std::string> attributes;
+    for (int i = 0; i < 10; i++) {
+      std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(flow_repo, content_repo, attributes);
+      reporter.create(flow);
+    }
+    reporter.commit();
+    for (const auto &event : reporter.getEvents()) {
+      eventIds.push_back(event->getEventId());
+    }
+  }
+  REQUIRE(repository->getPartitionCount() == 1);
+  REQUIRE(repository->getRepoSize() > 0);
+
+  std::vector<std::shared_ptr<provenance::ProvenanceEventRecord>> records;
+  repository->getProvenanceRecord(records, 100);
+  REQUIRE(records.size() == 10);
+  REQUIRE(records.at(0)->getComponentType() == "componenttype");
+
+  // partitions are reopened with the database
+  repository->destroy();
+  {
+    // a restarted repository counts the events it still holds
+    std::shared_ptr<provenance::ProvenanceRepository> restarted = std::make_shared<provenance::ProvenanceRepository>("provenance", directory, 1000, 10 * 1024 * 1024, 0);
+    REQUIRE(restarted->initialize(configuration));
+    REQUIRE(restarted->getRepoSize() > 0);
+    restarted->destroy();
+  }
+  REQUIRE(repository->initialize(configuration));
+  REQUIRE(repository->getPartitionCount() == 1);
+  REQUIRE(repository->getRepoSize() > 0);
+  std::string value;
+  REQUIRE(repository->Get(eventIds.at(0), value));
+
+  // a partition is dropped once all of its events are older than the max storage time
+  REQUIRE(repository->purgeExpiredPartitions(getTimeMillis()) == 0);
+  REQUIRE(repository->purgeExpiredPartitions(getTimeMillis() + 2000) == 1);
+  REQUIRE(repository->getPartitionCount() == 0);
+  REQUIRE(repository->getRepoSize() == 0);
+  REQUIRE_FALSE(repository->Get(eventIds.at(0), value));
+  records.clear();
+  repository->getProvenanceRecord(records, 100);
+  REQUIRE(records.empty());
+
+  repository->destroy();
+  REQUIRE(repository->initialize(configuration));
+  REQUIRE(repository->getPartitionCount() == 0);
+  repository->destroy();
+}
@@ -250,3 +250,194 @@ TEST_CASE("Test Validate Checkpoint ", "[TestFFR5]") {
   LogTestController::getInstance().reset();
 }
 
+
+TEST_CASE("Test Repo Batched Serialize", "[TestFFR6]") {
+  TestController testController;
+  char format[] = "/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  std::shared_ptr<core::repository::FlowFileRepository> repository = std::make_shared<core::repository::FlowFileRepository>("ff", dir, 0, 0, 1);
+
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_flowfile_repository_sync_policy, "always");
+  repository->initialize(configuration);
+
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  std::vector<std::pair<std::shared_ptr<core::FlowFile>, std::string>> flows;
+  for (int i = 0; i < 10; i++) {
+    std::map<std::string, std::string> attributes;
+    attributes["index"] = std::to_string(i);
+    std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(repository, content_repo, attributes);
+    flows.push_back(std::make_pair(flow, "connection" + std::to_string(i % 2)));
+  }
+
+  REQUIRE(true == minifi::FlowFileRecord::Serialize(repository, content_repo, flows));
+
+  for (int i = 0; i < 10; i++) {
+    REQUIRE(true == flows[i].first->isStored());
+    minifi::FlowFileRecord record(repository, content_repo);
+    REQUIRE(true == record.DeSerialize(flows[i].first->getUUIDStr()));
+    std::string value;
+    REQUIRE(true == record.getAttribute("index", value));
+    REQUIRE(std::to_string(i) == value);
+    REQUIRE(flows[i].second == record.getConnectionUuid());
+  }
+
+  repository->stop();
+
+  utils::file::FileUtils::delete_dir(FLOWFILE_CHECKPOINT_DIRECTORY, true);
+}
+
+TEST_CASE("Test Delete Content With Known Claim", "[TestFFR7]") {
+  TestController testController;
+  char format[] = "/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  std::shared_ptr<core::repository::FlowFileRepository> repository = std::make_shared<core::repository::FlowFileRepository>("ff", dir, 0, 0, 1);
+
+  std::stringstream ss;
+  ss << dir << utils::file::FileUtils::get_separator() << "tstFile.ext";
+  std::fstream file;
+  file.open(ss.str(), std::ios::out);
+  file << "tempFile";
+  file.close();
+
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::FileSystemRepository>();
+  repository->initialize(std::make_shared<minifi::Configure>());
+  repository->loadComponent(content_repo);
+
+  std::shared_ptr<minifi::ResourceClaim> claim = std::make_shared<minifi::ResourceClaim>(ss.str(), content_repo);
+  std::map<std::string, std::string> attributes;
+  minifi::FlowFileRecord record(repository, content_repo, attributes, claim);
+  REQUIRE(true == record.Serialize());
+
+  claim->decreaseFlowFileRecordOwnedCount();
+  claim->decreaseFlowFileRecordOwnedCount();
+
+  repository->Delete(record.getUUIDStr(), claim);
+  repository->flush();
+
+  std::string value;
+  REQUIRE(false == repository->Get(record.getUUIDStr(), value));
+  std::ifstream fileopen(ss.str(), std::ios::in);
+  REQUIRE(false == fileopen.good());
+
+  repository->stop();
+  utils::file::FileUtils::delete_dir(FLOWFILE_CHECKPOINT_DIRECTORY, true);
+}
+
+TEST_CASE("Test Delete High Water Mark Wakes Purge", "[TestFFR8]") {
+  TestController testController;
+  char format[] = "/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  // a purge period long enough that only the high water mark can trigger the flush
+  std::shared_ptr<core::repository::FlowFileRepository> repository = std::make_shared<core::repository::FlowFileRepository>("ff", dir, 0, 0, 3600000);
+  repository->initialize(std::make_shared<minifi::Configure>());
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  repository->loadComponent(content_repo);
+
+  std::vector<std::pair<std::shared_ptr<core::FlowFile>, std::string>> flows;
+  for (int i = 0; i < FLOWFILE_REPOSITORY_DELETE_HIGH_WATER_MARK; i++) {
+    std::map<std::string, std::string> attributes;
+    flows.push_back(std::make_pair(std::make_shared<minifi::FlowFileRecord>(repository, content_repo, attributes), "connection"));
+  }
+  REQUIRE(true == minifi::FlowFileRecord::Serialize(repository, content_repo, flows));
+  uint64_t stored_size = repository->getRepoSize();
+  REQUIRE(0 < stored_size);
+
+  repository->start();
+  for (const auto &flow : flows) {
+    repository->Delete(flow.first->getUUIDStr(), nullptr);
+  }
+
+  std::string value;
+  for (int i = 0; i < 100 && repository->Get(flows.back().first->getUUIDStr(), value); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  REQUIRE(false == repository->Get(flows.front().first->getUUIDStr(), value));
+  REQUIRE(false == repository->Get(flows.back().first->getUUIDStr(), value));
+  REQUIRE(stored_size > repository->getRepoSize());
+
+  repository->stop();
+  utils::file::FileUtils::delete_dir(FLOWFILE_CHECKPOINT_DIRECTORY, true);
+}
+
+TEST_CASE("Test Restored Container Is Removed Once Drained", "[TestFFR9]") {
+  TestController testController;
+  utils::file::FileUtils::delete_dir(FLOWFILE_CHECKPOINT_DIRECTORY, true);
+  char format[] = "/tmp/testRepo.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+  char content_format[] = "/tmp/content.XXXXXX";
+  auto content_dir = testController.createTempDirectory(content_format);
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, content_dir);
+  configuration->set(minifi::Configure::nifi_content_claim_max_appendable_size, "1 MB");
+  configuration->set(minifi::Configure::nifi_content_claim_max_flow_files, "4");
+
+  // the first two flow files are queued in a connection, the third in a connection that no longer exists
+  std::string container;
+  std::vector<std::string> uuids;
+  {
+    std::shared_ptr<core::repository::FlowFileRepository> repository = std::make_shared<core::repository::FlowFileRepository>("ff", dir, 0, 0, 1);
+    repository->initialize(configuration);
+    std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::FileSystemRepository>();
+    content_repo->initialize(configuration);
+    repository->loadComponent(content_repo);
+    for (int i = 0; i < 3; i++) {
+      std::shared_ptr<minifi::ResourceClaim> claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+      std::string content = "content" + std::to_string(i);
+      auto stream = content_repo->write(claim);
+      REQUIRE(static_cast<int>(content.size()) == stream->writeData(reinterpret_cast<uint8_t*>(&content[0]), content.size()));
+      stream->closeStream();
+      std::map<std::string, std::string> attributes;
+      minifi::FlowFileRecord record(repository, content_repo, attributes, claim);
+      record.setOffset(claim->getOffset());
+      record.setSize(content.size());
+      record.setUuidConnection(i < 2 ? "connection" : "removed connection");
+      REQUIRE(true == record.Serialize());
+      uuids.push_back(record.getUUIDStr());
+      if (container.empty()) {
+        container = claim->getContentFullPath();
+      }
+      REQUIRE(container == claim->getContentFullPath());
+    }
+    repository->stop();
+  }
+
+  // restart with a new content repository, which only learns the claim counts from the restored flow files
+  std::shared_ptr<core::repository::FlowFileRepository> repository = std::make_shared<core::repository::FlowFileRepository>("ff", dir, 0, 0, 1);
+  repository->initialize(configuration);
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::FileSystemRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<minifi::Connection> connection = std::make_shared<minifi::Connection>(repository, content_repo, "connection");
+  std::map<std::string, std::shared_ptr<core::Connectable>> connectionMap;
+  connectionMap["connection"] = connection;
+  repository->setConnectionMap(connectionMap);
+  repository->loadComponent(content_repo);
+  repository->start();
+
+  std::string value;
+  for (int i = 0; i < 100 && (connection->getQueueSize() < 2 || repository->Get(uuids[2], value)); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  repository->stop();
+  REQUIRE(2 == connection->getQueueSize());
+  REQUIRE(false == repository->Get(uuids[2], value));
+  REQUIRE(std::ifstream(container).good());
+
+  // drains the queue the way a session drops its flow files
+  for (int i = 0; i < 2; i++) {
+    std::set<std::shared_ptr<core::FlowFile>> expired;
+    std::shared_ptr<core::FlowFile> flow = connection->poll(expired);
+    REQUIRE(nullptr != flow);
+    std::shared_ptr<minifi::ResourceClaim> claim = flow->getResourceClaim();
+    REQUIRE(container == claim->getContentFullPath());
+    flow->setDeleted(true);
+    claim->decreaseFlowFileRecordOwnedCount();
+    repository->Delete(flow->getUUIDStr(), claim);
+    flow = nullptr;
+    repository->flush();
+    // the container is only removed with the last flow file that has content in it
+    REQUIRE((i == 0) == std::ifstream(container).good());
+  }
+
+  utils::file::FileUtils::delete_dir(FLOWFILE_CHECKPOINT_DIRECTORY, true);
+}
@@ -0,0 +1,119 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <vector>
+#include "../TestBase.h"
+#include "io/BaseStream.h"
+#include "io/CompressionStream.h"
+
+TEST_CASE("CompressionStreamRoundTrip", "[compressionstream1]") {
+  std::string data;
+  for (int i = 0; i < 1000; i++) {
+    data += "compressed site to site data " + std::to_string(i) + "\n";
+  }
+
+  minifi::io::BaseStream wire;
+  {
+    // a small buffer splits the data into several chunks
+    minifi::io::CompressionOutputStream stream(&wire, 6, 4096);
+    REQUIRE(stream.write(static_cast<uint32_t>(data.size())) == 4);
+    REQUIRE(stream.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(data.data())), data.size()) == static_cast<int>(data.size()));
+    REQUIRE(stream.close() == 0);
+    REQUIRE(stream.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(data.data())), 1) == -1);
+  }
+  REQUIRE(wire.getSize() < data.size() / 4);
+  // another stream may follow on the same wire
+  uint8_t trailer = 42;
+  wire.write(&trailer, 1);
+
+  minifi::io::CompressionInputStream stream(&wire);
+  uint32_t size;
+  REQUIRE(stream.read(size) == 4);
+  REQUIRE(size == data.size());
+  std::vector<uint8_t> buffer(size + 10);
+  REQUIRE(stream.readData(buffer.data(), size + 10) == static_cast<int>(size));
+  REQUIRE(data == std::string(buffer.begin(), buffer.begin() + size));
+  REQUIRE(stream.isFinished());
+
+  uint8_t next = 0;
+  REQUIRE(wire.read(&next, 1) == 1);
+  REQUIRE(42 == next);
+}
+
+TEST_CASE("CompressionStreamFormat", "[compressionstream2]") {
+  minifi::io::BaseStream wire;
+  minifi::io::CompressionOutputStream stream(&wire, 0, 8);
+  std::string data = "0123456789";
+  stream.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(data.data())), data.size());
+  REQUIRE(stream.close() == 0);
+
+  // two chunks of SYNC, the lengths and stored zlib data, separated by a 1 and ended by a 0
+  std::string bytes(reinterpret_cast<const char*>(wire.getBuffer()), wire.getSize());
+  REQUIRE("SYNC" == bytes.substr(0, 4));
+  REQUIRE(std::string("\0\0\0\x08", 4) == bytes.substr(4, 4));
+  uint32_t first = (static_cast<uint8_t>(bytes[10]) << 8) | static_cast<uint8_t>(bytes[11]);
+  size_t second = 12 + first;
+  REQUIRE(1 == bytes[second]);
+  REQUIRE("SYNC" == bytes.substr(second + 1, 4));
+  REQUIRE(std::string("\0\0\0\x02", 4) == bytes.substr(second + 5, 4));
+  REQUIRE(0 == bytes[bytes.size() - 1]);
+}
+
+TEST_CASE("CompressionStreamRejectsInvalidData", "[compressionstream3]") {
+  minifi::io::BaseStream empty_wire;
+  {
+    minifi::io::CompressionOutputStream stream(&empty_wire);
+    REQUIRE(stream.close() == 0);
+  }
+  minifi::io::CompressionInputStream empty(&empty_wire);
+  uint8_t byte;
+  REQUIRE(empty.readData(&byte, 1) == 0);
+  REQUIRE(empty.isFinished());
+
+  minifi::io::BaseStream wire;
+  std::string garbage = "SINK and some more bytes";
+  wire.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(garbage.data())), garbage.size());
+  minifi::io::CompressionInputStream stream(&wire);
+  REQUIRE(stream.readData(&byte, 1) == -1);
+}
+
+TEST_CASE("CompressionStreamRejectsTruncatedData", "[compressionstream4]") {
+  minifi::io::BaseStream wire;
+  {
+    minifi::io::CompressionOutputStream stream(&wire, 0, 8);
+    std::string data = "0123456789";
+    stream.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(data.data())), data.size());
+    REQUIRE(stream.close() == 0);
+  }
+  std::string bytes(reinterpret_cast<const char*>(wire.getBuffer()), wire.getSize());
+  uint8_t buffer[10];
+
+  // the byte ending the stream is missing
+  minifi::io::BaseStream truncated_wire;
+  truncated_wire.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(bytes.data())), bytes.size() - 1);
+  minifi::io::CompressionInputStream truncated(&truncated_wire);
+  REQUIRE(truncated.readData(buffer, sizeof(buffer)) == -1);
+
+  // the byte ending the stream is neither 0 nor 1
+  bytes[bytes.size() - 1] = 2;
+  minifi::io::BaseStream invalid_wire;
+  invalid_wire.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(bytes.data())), bytes.size());
+  minifi::io::CompressionInputStream invalid(&invalid_wire);
+  REQUIRE(invalid.readData(buffer, sizeof(buffer)) == -1);
+}
@@ -0,0 +1,311 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../TestBase.h"
+#include "Connection.h"
+#include "FlowFileRecord.h"
+#include "core/Processor.h"
+#include "core/repository/VolatileContentRepository.h"
+
+namespace {
+
+std::shared_ptr<minifi::Connection> createConnection(const std::shared_ptr<core::Repository> &repo, const std::string &queue_type) {
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<minifi::Connection> connection = std::make_shared<minifi::Connection>(repo, content_repo, "testconnection");
+  REQUIRE(connection->setQueueType(queue_type));
+  return connection;
+}
+
+std::shared_ptr<core::FlowFile> createFlowFile(const std::shared_ptr<core::Repository> &repo, uint64_t size) {
+  std::map<std::string, std::string> attributes;
+  std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(repo, nullptr, attributes);
+  flow->setSize(size);
+  // keeps the test repository, which is not thread safe, out of the picture
+  flow->setStoredToRepository(true);
+  return flow;
+}
+
+}  // namespace
+
+TEST_CASE("ConnectionQueueTypes", "[connection1]") {
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  auto connection = createConnection(repo, "locking");
+  REQUIRE("locking" == connection->getQueueType());
+  REQUIRE(connection->setQueueType("Concurrent"));
+  REQUIRE("concurrent" == connection->getQueueType());
+  REQUIRE_FALSE(connection->setQueueType("unknown"));
+  REQUIRE("concurrent" == connection->getQueueType());
+}
+
+TEST_CASE("ConnectionBackPressure", "[connection2]") {
+  for (const std::string queue_type : { "locking", "concurrent" }) {
+    std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+    auto connection = createConnection(repo, queue_type);
+    connection->setMaxQueueSize(3);
+    connection->setMaxQueueDataSize(100);
+
+    REQUIRE(connection->isEmpty());
+    connection->put(createFlowFile(repo, 10));
+    connection->put(createFlowFile(repo, 10));
+    REQUIRE(2 == connection->getQueueSize());
+    REQUIRE(20 == connection->getQueueDataSize());
+    REQUIRE_FALSE(connection->isFull());
+    connection->put(createFlowFile(repo, 10));
+    REQUIRE(connection->isFull());
+
+    std::set<std::shared_ptr<core::FlowFile>> expired;
+    REQUIRE(nullptr != connection->poll(expired));
+    REQUIRE_FALSE(connection->isFull());
+    connection->put(createFlowFile(repo, 90));
+    REQUIRE(connection->isFull());
+
+    connection->drain();
+    REQUIRE(connection->isEmpty());
+    REQUIRE(0 == connection->getQueueDataSize());
+  }
+}
+
+TEST_CASE("ConnectionPenalizedHead", "[connection3]") {
+  for (const std::string queue_type : { "locking", "concurrent" }) {
+    std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+    auto connection = createConnection(repo, queue_type);
+
+    auto flow = createFlowFile(repo, 10);
+    flow->setPenaltyExpiration(getTimeMillis() + 60000);
+    connection->put(flow);
+
+    std::set<std::shared_ptr<core::FlowFile>> expired;
+    REQUIRE(nullptr == connection->poll(expired));
+    REQUIRE(1 == connection->getQueueSize());
+    REQUIRE(10 == connection->getQueueDataSize());
+    REQUIRE(1 == connection->getPenalizedCount());
+    REQUIRE_FALSE(connection->isWorkAvailable());
+
+    // flow files queued behind a penalized flow file are not held up by it
+    auto ready = createFlowFile(repo, 20);
+    connection->put(ready);
+    REQUIRE(connection->isWorkAvailable());
+    REQUIRE(ready == connection->poll(expired));
+    REQUIRE(nullptr == connection->poll(expired));
+    REQUIRE(1 == connection->getQueueSize());
+  }
+}
+
+TEST_CASE("ConnectionPenaltyExpires", "[connection6]") {
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  auto connection = createConnection(repo, "locking");
+
+  auto flow = createFlowFile(repo, 10);
+  flow->setPenaltyExpiration(getTimeMillis() + 50);
+  connection->put(flow);
+
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  REQUIRE(nullptr == connection->poll(expired));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  REQUIRE(connection->isWorkAvailable());
+  REQUIRE(flow == connection->poll(expired));
+  REQUIRE(0 == connection->getPenalizedCount());
+  REQUIRE(connection->isEmpty());
+}
+
+TEST_CASE("ConnectionConcurrentPutPoll", "[connection4]") {
+  for (const std::string queue_type : { "locking", "concurrent" }) {
+    std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+    auto connection = createConnection(repo, queue_type);
+    const int threads = 4;
+    const int per_thread = 1000;
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < threads; i++) {
+      producers.emplace_back([&]() {
+        for (int j = 0; j < per_thread; j++) {
+          connection->put(createFlowFile(repo, 1));
+        }
+      });
+    }
+    for (auto &producer : producers) {
+      producer.join();
+    }
+    REQUIRE(threads * per_thread == connection->getQueueSize());
+    REQUIRE(threads * per_thread == connection->getQueueDataSize());
+
+    std::atomic<int> polled(0);
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < threads; i++) {
+      consumers.emplace_back([&]() {
+        std::set<std::shared_ptr<core::FlowFile>> expired;
+        while (nullptr != connection->poll(expired)) {
+          polled++;
+        }
+      });
+    }
+    for (auto &consumer : consumers) {
+      consumer.join();
+    }
+    REQUIRE(threads * per_thread == polled);
+    REQUIRE(connection->isEmpty());
+    REQUIRE(0 == connection->getQueueDataSize());
+  }
+}
+
+TEST_CASE("ConnectionBatchPoll", "[connection5]") {
+  for (const std::string queue_type : { "locking", "concurrent" }) {
+    std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+    auto connection = createConnection(repo, queue_type);
+    for (int i = 0; i < 10; i++) {
+      connection->put(createFlowFile(repo, 10));
+    }
+    auto penalized = createFlowFile(repo, 10);
+    penalized->setPenaltyExpiration(getTimeMillis() + 60000);
+    connection->put(penalized);
+
+    std::set<std::shared_ptr<core::FlowFile>> expired;
+    std::vector<std::shared_ptr<core::FlowFile>> flows;
+    REQUIRE(4 == connection->poll(flows, 4, 0, expired));
+    REQUIRE(4 == flows.size());
+    REQUIRE(7 == connection->getQueueSize());
+
+    flows.clear();
+    REQUIRE(3 == connection->poll(flows, 100, 25, expired));
+    REQUIRE(4 == connection->getQueueSize());
+    REQUIRE(40 == connection->getQueueDataSize());
+
+    // the penalized flow file is re-queued rather than returned
+    flows.clear();
+    REQUIRE(3 == connection->poll(flows, 100, 0, expired));
+    REQUIRE(1 == connection->getQueueSize());
+    REQUIRE(10 == connection->getQueueDataSize());
+    REQUIRE(expired.empty());
+  }
+}
+
+TEST_CASE("ConnectionPrioritizers", "[connection7]") {
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  auto connection = createConnection(repo, "locking");
+  std::vector<std::shared_ptr<core::FlowFilePrioritizer>> prioritizers;
+  prioritizers.push_back(core::FlowFilePrioritizer::create("PriorityAttributePrioritizer"));
+  prioritizers.push_back(core::FlowFilePrioritizer::create("org.apache.nifi.prioritizer.FirstInFirstOutPrioritizer"));
+  REQUIRE(nullptr == core::FlowFilePrioritizer::create("unknown"));
+  connection->setPrioritizers(prioritizers);
+  REQUIRE("prioritized" == connection->getQueueType());
+
+  std::vector<std::shared_ptr<core::FlowFile>> flows;
+  for (const std::string priority : { "", "10", "2", "b", "", "2", "a" }) {
+    auto flow = createFlowFile(repo, 1);
+    if (!priority.empty()) {
+      flow->setAttribute("priority", priority);
+    }
+    flows.push_back(flow);
+    connection->put(flow);
+  }
+
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  for (const size_t index : { 2, 5, 1, 6, 3, 0, 4 }) {
+    REQUIRE(flows[index] == connection->poll(expired));
+  }
+  REQUIRE(connection->isEmpty());
+}
+
+TEST_CASE("ConnectionPrioritizersMixNumericAndText", "[connection10]") {
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  auto prioritizer = core::FlowFilePrioritizer::create("PriorityAttributePrioritizer");
+  std::vector<std::shared_ptr<core::FlowFile>> flows;
+  for (const std::string priority : { "1a", "9", "10", "-3", "b" }) {
+    auto flow = createFlowFile(repo, 1);
+    flow->setAttribute("priority", priority);
+    flows.push_back(flow);
+  }
+
+  // numeric priorities come before the others, so the order is the same whichever flow files are compared
+  const std::vector<size_t> expected = { 3, 1, 2, 0, 4 };
+  for (size_t i = 0; i < expected.size(); i++) {
+    for (size_t j = 0; j < expected.size(); j++) {
+      int order = prioritizer->compare(flows[expected[i]], flows[expected[j]]);
+      REQUIRE((i < j ? order < 0 : (i > j ? order > 0 : order == 0)));
+    }
+  }
+
+  auto connection = createConnection(repo, "locking");
+  connection->setPrioritizers({ prioritizer });
+  for (const auto &flow : flows) {
+    connection->put(flow);
+  }
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  for (const size_t index : expected) {
+    REQUIRE(flows[index] == connection->poll(expired));
+  }
+  REQUIRE(connection->isEmpty());
+}
+
+TEST_CASE("ConnectionNewestFirst", "[connection8]") {
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  auto connection = createConnection(repo, "concurrent");
+
+  auto older = createFlowFile(repo, 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  auto newer = createFlowFile(repo, 1);
+  connection->put(older);
+  connection->put(newer);
+
+  std::vector<std::shared_ptr<core::FlowFilePrioritizer>> prioritizers;
+  prioritizers.push_back(core::FlowFilePrioritizer::create("NewestFlowFileFirstPrioritizer"));
+  connection->setPrioritizers(prioritizers);
+  REQUIRE(2 == connection->getQueueSize());
+
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  std::vector<std::shared_ptr<core::FlowFile>> polled;
+  REQUIRE(2 == connection->poll(polled, 10, 0, expired));
+  REQUIRE(newer == polled[0]);
+  REQUIRE(older == polled[1]);
+}
+
+TEST_CASE("ConnectionNotifiesEventDrivenDestination", "[connection9]") {
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  auto connection = createConnection(repo, "locking");
+  std::shared_ptr<core::Processor> processor = std::make_shared<core::Processor>("destination");
+  connection->setDestination(processor);
+  std::atomic<int> notifications(0);
+  processor->setWorkNotifier([&notifications]() {
+    notifications++;
+  });
+
+  // only event driven processors are notified
+  connection->put(createFlowFile(repo, 1));
+  REQUIRE(0 == notifications);
+  processor->setSchedulingStrategy(core::EVENT_DRIVEN);
+  connection->put(createFlowFile(repo, 1));
+  std::vector<std::shared_ptr<core::FlowFile>> flows;
+  flows.push_back(createFlowFile(repo, 1));
+  flows.push_back(createFlowFile(repo, 1));
+  connection->multiPut(flows);
+  REQUIRE(2 == notifications);
+
+  processor->setWorkNotifier(nullptr);
+  connection->put(createFlowFile(repo, 1));
+  REQUIRE(2 == notifications);
+}
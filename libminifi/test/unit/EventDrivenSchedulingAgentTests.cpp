@@ -0,0 +1,124 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include "../TestBase.h"
+#include "ProvenanceTestHelper.h"
+#include "Connection.h"
+#include "EventDrivenSchedulingAgent.h"
+#include "FlowFileRecord.h"
+#include "core/Processor.h"
+#include "core/repository/VolatileContentRepository.h"
+
+namespace {
+
+class CountingProcessor : public core::Processor {
+ public:
+  explicit CountingProcessor(const std::string &name)
+      : Processor(name),
+        triggers_(0) {
+  }
+
+  virtual void onTrigger(core::ProcessContext *context, core::ProcessSession *session) {
+    triggers_++;
+    std::shared_ptr<core::FlowFile> flow = session->get();
+    if (flow != nullptr) {
+      session->remove(flow);
+    }
+  }
+
+  // Returns the notifier as a connection notifying this processor sees it
+  std::shared_ptr<std::function<void()>> getWorkNotifier() {
+    std::lock_guard<std::mutex> lock(work_available_mutex_);
+    return work_notifier_;
+  }
+
+  int getTriggers() const {
+    return triggers_;
+  }
+
+ private:
+  std::atomic<int> triggers_;
+};
+
+std::shared_ptr<core::FlowFile> createFlowFile(const std::shared_ptr<core::Repository> &repo, const std::shared_ptr<core::ContentRepository> &content_repo) {
+  std::map<std::string, std::string> attributes;
+  std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(repo, content_repo, attributes);
+  flow->setStoredToRepository(true);
+  return flow;
+}
+
+bool waitForQueueSize(const std::shared_ptr<minifi::Connection> &connection, uint64_t size) {
+  for (int i = 0; i < 100 && connection->getQueueSize() != size; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  return connection->getQueueSize() == size;
+}
+
+}  // namespace
+
+TEST_CASE("EventDrivenAgentIgnoresNotificationsAfterUnschedule", "[eventdriven1]") {
+  TestController testController;
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+
+  auto processor = std::make_shared<CountingProcessor>("counting");
+  processor->setSchedulingStrategy(core::EVENT_DRIVEN);
+  processor->setAutoTerminatedRelationships({ core::Relationship("success", "") });
+  auto connection = std::make_shared<minifi::Connection>(repo, content_repo, "connection");
+  connection->setDestination(processor);
+  utils::Identifier processor_uuid;
+  processor->getUUID(processor_uuid);
+  connection->setDestinationUUID(processor_uuid);
+  processor->addConnection(connection);
+
+  auto agent = std::make_shared<minifi::EventDrivenSchedulingAgent>(nullptr, repo, repo, content_repo, configuration);
+  agent->start();
+  processor->setScheduledState(core::RUNNING);
+  agent->schedule(processor);
+
+  connection->put(createFlowFile(repo, content_repo));
+  REQUIRE(waitForQueueSize(connection, 0));
+
+  // a put that copied the notifier before the processor was unscheduled calls it afterwards
+  auto notifier = processor->getWorkNotifier();
+  REQUIRE(nullptr != notifier);
+  agent->unschedule(processor);
+  REQUIRE(core::STOPPED == processor->getScheduledState());
+  int triggers = processor->getTriggers();
+  connection->put(createFlowFile(repo, content_repo));
+  (*notifier)();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  REQUIRE(triggers == processor->getTriggers());
+  REQUIRE(1 == connection->getQueueSize());
+
+  // the late notification left no tasks behind that keep the processor from being scheduled again
+  processor->setScheduledState(core::RUNNING);
+  agent->schedule(processor);
+  REQUIRE(waitForQueueSize(connection, 0));
+  agent->unschedule(processor);
+  agent->stop();
+}
@@ -242,3 +242,57 @@ TEST_CASE("TestFileExceedSize", "[TestLoader]") {
 
   unlink(ss.str().c_str());
 }
+
+TEST_CASE("TestFileBufferedWrites", "[TestFiles]") {
+  TestController testController;
+  char format[] = "/tmp/gt.XXXXXX";
+  auto dir = testController.createTempDirectory(format);
+
+  std::stringstream ss;
+  ss << dir << "/" << "tstFile.ext";
+  std::string path = ss.str();
+
+  std::string content(minifi::io::FileStream::WriteBufferSize + 100, 'a');
+  {
+    minifi::io::FileStream stream(path);
+    REQUIRE(stream.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>("small")), 5) == 5);
+    REQUIRE(stream.writeBytes(reinterpret_cast<const uint8_t*>(content.data()), content.size()) == content.size());
+    REQUIRE(stream.getSize() == content.size() + 5);
+    REQUIRE(stream.sync());
+  }
+  {
+    // appends go to the end of the file regardless of the position
+    minifi::io::FileStream stream(path, true);
+    stream.seek(0);
+    REQUIRE(stream.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>("end")), 3) == 3);
+  }
+
+  minifi::io::FileStream stream(path, 0, false);
+  REQUIRE(stream.getSize() == content.size() + 8);
+  std::vector<uint8_t> buffer(stream.getSize() + 10);
+  REQUIRE(stream.readBytes(buffer.data(), buffer.size()) == stream.getSize());
+  REQUIRE(std::string(reinterpret_cast<char*>(buffer.data()), 5) == "small");
+  REQUIRE(std::string(reinterpret_cast<char*>(buffer.data()) + 5, content.size()) == content);
+  REQUIRE(std::string(reinterpret_cast<char*>(buffer.data()) + 5 + content.size(), 3) == "end");
+
+  stream.seek(2);
+  REQUIRE(stream.readData(buffer.data(), 3) == 3);
+  REQUIRE(std::string(reinterpret_cast<char*>(buffer.data()), 3) == "all");
+  REQUIRE(stream.writeData(buffer.data(), 3) == -1);
+}
+
+#ifndef WIN32
+TEST_CASE("TestFileFailedFlushIsReported", "[TestFiles]") {
+  // every write to /dev/full fails for lack of space, but small writes only reach it once they are flushed
+  std::ifstream full("/dev/full");
+  if (!full.good()) {
+    return;
+  }
+  minifi::io::FileStream stream("/dev/full");
+  REQUIRE(stream.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>("small")), 5) == 5);
+  REQUIRE_FALSE(stream.flush());
+  // the failure sticks, so closing the stream reports it as well
+  REQUIRE_FALSE(stream.close());
+  REQUIRE_FALSE(stream.flush());
+}
+#endif
@@ -0,0 +1,244 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../TestBase.h"
+#include "ProvenanceTestHelper.h"
+#include "FlowFileRecord.h"
+#include "ResourceClaim.h"
+#include "core/repository/FileSystemRepository.h"
+
+namespace {
+
+std::shared_ptr<core::repository::FileSystemRepository> createRepository(const std::string &directory, const std::string &max_appendable_size) {
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, directory);
+  configuration->set(minifi::Configure::nifi_content_claim_max_appendable_size, max_appendable_size);
+  configuration->set(minifi::Configure::nifi_content_claim_max_flow_files, "3");
+  std::shared_ptr<core::repository::FileSystemRepository> content_repo = std::make_shared<core::repository::FileSystemRepository>();
+  content_repo->initialize(configuration);
+  return content_repo;
+}
+
+std::shared_ptr<minifi::ResourceClaim> writeClaim(const std::shared_ptr<core::ContentRepository> &content_repo, std::string content) {
+  std::shared_ptr<minifi::ResourceClaim> claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+  auto stream = content_repo->write(claim);
+  claim->increaseFlowFileRecordOwnedCount();
+  REQUIRE(static_cast<int>(content.size()) == stream->writeData(reinterpret_cast<uint8_t*>(&content[0]), content.size()));
+  REQUIRE(content.size() == stream->getSize());
+  stream->closeStream();
+  return claim;
+}
+
+std::string readClaim(const std::shared_ptr<core::ContentRepository> &content_repo, const std::shared_ptr<minifi::ResourceClaim> &claim, uint64_t length) {
+  auto stream = content_repo->read(claim, claim->getOffset(), length);
+  REQUIRE(length == stream->getSize());
+  std::vector<uint8_t> buffer(length + 16);
+  int read = stream->readData(buffer.data(), buffer.size());
+  return std::string(reinterpret_cast<char*>(buffer.data()), read > 0 ? read : 0);
+}
+
+bool fileExists(const std::string &path) {
+  std::ifstream file(path);
+  return file.good();
+}
+
+}  // namespace
+
+TEST_CASE("FileSystemRepositoryAppendsClaimsToContainers", "[container1]") {
+  TestController testController;
+  char format[] = "/tmp/content.XXXXXX";
+  std::string directory = testController.createTempDirectory(format);
+  auto content_repo = createRepository(directory, "1 MB");
+  REQUIRE(content_repo->isUsingContainers());
+
+  auto first = writeClaim(content_repo, "first");
+  auto second = writeClaim(content_repo, "second");
+  auto third = writeClaim(content_repo, "third");
+  auto fourth = writeClaim(content_repo, "fourth");
+
+  // the container is full after max flow files claims
+  REQUIRE(first->getContentFullPath() == second->getContentFullPath());
+  REQUIRE(first->getContentFullPath() == third->getContentFullPath());
+  REQUIRE(first->getContentFullPath() != fourth->getContentFullPath());
+  REQUIRE(0 == first->getOffset());
+  REQUIRE(5 == second->getOffset());
+  REQUIRE(11 == third->getOffset());
+  REQUIRE(0 == fourth->getOffset());
+  REQUIRE_FALSE(content_repo->isAppendable(first));
+
+  // reads are bounded to the claimed content
+  REQUIRE("first" == readClaim(content_repo, first, 5));
+  REQUIRE("second" == readClaim(content_repo, second, 6));
+  REQUIRE("third" == readClaim(content_repo, third, 5));
+  REQUIRE("fourth" == readClaim(content_repo, fourth, 6));
+
+  std::string container = first->getContentFullPath();
+  first->decreaseFlowFileRecordOwnedCount();
+  second->decreaseFlowFileRecordOwnedCount();
+  // claim counts are kept per container
+  REQUIRE(1 == third->getFlowFileRecordOwnedCount());
+  REQUIRE_FALSE(content_repo->removeIfOrphaned(third));
+  REQUIRE(fileExists(container));
+  third->decreaseFlowFileRecordOwnedCount();
+  REQUIRE(content_repo->removeIfOrphaned(third));
+  REQUIRE_FALSE(fileExists(container));
+
+  // the container still accepting claims outlives its last claim
+  fourth->decreaseFlowFileRecordOwnedCount();
+  content_repo->removeIfOrphaned(fourth);
+  REQUIRE(fileExists(fourth->getContentFullPath()));
+  content_repo->stop();
+  REQUIRE_FALSE(fileExists(fourth->getContentFullPath()));
+}
+
+TEST_CASE("FileSystemRepositoryRollsLargeContainers", "[container2]") {
+  TestController testController;
+  char format[] = "/tmp/content.XXXXXX";
+  std::string directory = testController.createTempDirectory(format);
+  auto content_repo = createRepository(directory, "8 B");
+
+  auto first = writeClaim(content_repo, "0123456789");
+  auto second = writeClaim(content_repo, "small");
+  REQUIRE(first->getContentFullPath() != second->getContentFullPath());
+  REQUIRE(0 == second->getOffset());
+  REQUIRE("0123456789" == readClaim(content_repo, first, 10));
+}
+
+TEST_CASE("FileSystemRepositoryRestoresContainerClaimCounts", "[container5]") {
+  TestController testController;
+  char format[] = "/tmp/content.XXXXXX";
+  std::string directory = testController.createTempDirectory(format);
+  std::shared_ptr<core::Repository> flow_repo = std::make_shared<TestRepository>();
+
+  std::string container;
+  std::string first_uuid;
+  std::string second_uuid;
+  {
+    auto content_repo = createRepository(directory, "1 MB");
+    auto first = writeClaim(content_repo, "first");
+    auto second = writeClaim(content_repo, "second");
+    // the third claim fills the container, so it no longer accepts claims
+    writeClaim(content_repo, "third");
+    container = first->getContentFullPath();
+    REQUIRE(container == second->getContentFullPath());
+
+    auto first_record = std::make_shared<minifi::FlowFileRecord>(flow_repo, content_repo, std::map<std::string, std::string>(), first);
+    first_record->setOffset(first->getOffset());
+    first_record->setSize(5);
+    REQUIRE(first_record->Serialize());
+    first_uuid = first_record->getUUIDStr();
+    auto second_record = std::make_shared<minifi::FlowFileRecord>(flow_repo, content_repo, std::map<std::string, std::string>(), second);
+    second_record->setOffset(second->getOffset());
+    second_record->setSize(6);
+    REQUIRE(second_record->Serialize());
+    second_uuid = second_record->getUUIDStr();
+  }
+
+  // restart with a new repository, which only learns the claim counts from the restored flow files
+  auto content_repo = createRepository(directory, "1 MB");
+  auto first_restored = std::make_shared<minifi::FlowFileRecord>(flow_repo, content_repo);
+  REQUIRE(first_restored->DeSerialize(first_uuid));
+  auto second_restored = std::make_shared<minifi::FlowFileRecord>(flow_repo, content_repo);
+  REQUIRE(second_restored->DeSerialize(second_uuid));
+  REQUIRE(container == first_restored->getContentFullPath());
+  REQUIRE(2 == second_restored->getResourceClaim()->getFlowFileRecordOwnedCount());
+
+  // releasing the first flow file leaves the content of the second in place
+  flow_repo->Delete(first_uuid);
+  first_restored = nullptr;
+  REQUIRE(fileExists(container));
+  REQUIRE_FALSE(content_repo->remove(second_restored->getResourceClaim()));
+  REQUIRE(fileExists(container));
+  auto stream = content_repo->read(second_restored->getResourceClaim(), second_restored->getOffset(), second_restored->getSize());
+  std::vector<uint8_t> buffer(6);
+  REQUIRE(6 == stream->readData(buffer.data(), buffer.size()));
+  REQUIRE("second" == std::string(reinterpret_cast<char*>(buffer.data()), buffer.size()));
+  stream->closeStream();
+
+  flow_repo->Delete(second_uuid);
+  second_restored = nullptr;
+  REQUIRE_FALSE(fileExists(container));
+}
+
+TEST_CASE("FileSystemRepositoryWithoutContainers", "[container3]") {
+  TestController testController;
+  char format[] = "/tmp/content.XXXXXX";
+  std::string directory = testController.createTempDirectory(format);
+  auto content_repo = createRepository(directory, "0");
+  REQUIRE_FALSE(content_repo->isUsingContainers());
+
+  auto first = writeClaim(content_repo, "first");
+  auto second = writeClaim(content_repo, "second");
+  REQUIRE(first->getContentFullPath() != second->getContentFullPath());
+  REQUIRE(content_repo->isAppendable(first));
+  REQUIRE("second" == readClaim(content_repo, second, 6));
+}
+
+TEST_CASE("FileSystemRepositoryImportsAndExportsFiles", "[container4]") {
+  TestController testController;
+  char format[] = "/tmp/content.XXXXXX";
+  std::string directory = testController.createTempDirectory(format);
+  auto content_repo = createRepository(directory, "0");
+
+  std::string source = directory + "/source";
+  {
+    std::ofstream out(source, std::ios::binary);
+    out << "0123456789";
+  }
+  std::shared_ptr<minifi::ResourceClaim> copied = std::make_shared<minifi::ResourceClaim>(content_repo);
+  uint64_t size = 0;
+  REQUIRE(content_repo->importFile(source, 4, false, copied, size));
+  REQUIRE(6 == size);
+  REQUIRE(fileExists(source));
+  REQUIRE("456789" == readClaim(content_repo, copied, 6));
+
+  std::shared_ptr<minifi::ResourceClaim> moved = std::make_shared<minifi::ResourceClaim>(content_repo);
+  REQUIRE(content_repo->importFile(source, 0, true, moved, size));
+  REQUIRE(10 == size);
+  REQUIRE_FALSE(fileExists(source));
+
+  std::string destination = directory + "/destination";
+  REQUIRE(content_repo->exportFile(moved, 2, 5, destination));
+  std::ifstream in(destination, std::ios::binary);
+  std::string exported((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  REQUIRE("23456" == exported);
+
+  std::string whole = directory + "/whole";
+  REQUIRE(content_repo->exportFile(moved, 0, 10, whole));
+  std::ifstream whole_in(whole, std::ios::binary);
+  REQUIRE("0123456789" == std::string((std::istreambuf_iterator<char>(whole_in)), std::istreambuf_iterator<char>()));
+
+  // content in containers is always streamed in
+  auto container_repo = createRepository(directory, "1 MB");
+  std::shared_ptr<minifi::ResourceClaim> claim = std::make_shared<minifi::ResourceClaim>(container_repo);
+  REQUIRE_FALSE(container_repo->importFile(destination, 0, false, claim, size));
+
+  // a claim at the start of a container exports only its own content
+  auto first = writeClaim(container_repo, "first");
+  auto second = writeClaim(container_repo, "second");
+  REQUIRE(first->getContentFullPath() == second->getContentFullPath());
+  std::string first_destination = directory + "/first";
+  REQUIRE(container_repo->exportFile(first, first->getOffset(), 5, first_destination));
+  std::ifstream first_in(first_destination, std::ios::binary);
+  REQUIRE("first" == std::string((std::istreambuf_iterator<char>(first_in)), std::istreambuf_iterator<char>()));
+}
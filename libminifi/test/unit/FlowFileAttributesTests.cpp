@@ -0,0 +1,163 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../TestBase.h"
+#include "FlowFileRecord.h"
+#include "core/FlowFileAttributes.h"
+#include "io/DataStream.h"
+#include "io/Serializable.h"
+#include "core/repository/VolatileContentRepository.h"
+
+namespace {
+
+/**
+ * Writes flow file records in the format used before the attribute dictionary.
+ */
+class LegacyRecordWriter : public minifi::io::Serializable {
+ public:
+  void write(const std::string &uuid, const std::map<std::string, std::string> &attributes, minifi::io::DataStream &stream) {
+    uint64_t time = 1;
+    Serializable::write(time, &stream);
+    Serializable::write(time, &stream);
+    Serializable::write(time, &stream);
+    writeUTF(uuid, &stream);
+    writeUTF("connection", &stream);
+    uint32_t size = attributes.size();
+    Serializable::write(size, &stream);
+    for (const auto &attribute : attributes) {
+      writeUTF(attribute.first, &stream, true);
+      writeUTF(attribute.second, &stream, true);
+    }
+    writeUTF("content", &stream);
+    uint64_t zero = 0;
+    Serializable::write(zero, &stream);
+    Serializable::write(zero, &stream);
+  }
+};
+
+}  // namespace
+
+TEST_CASE("AttributeKeysAreInterned", "[flowfileattributes1]") {
+  auto &registry = core::AttributeKeyRegistry::getInstance();
+  const core::AttributeKey *key = registry.intern("interned.key");
+  REQUIRE(key == registry.intern("interned.key"));
+  REQUIRE(key == registry.find("interned.key"));
+  REQUIRE(key == registry.get(key->id));
+  REQUIRE(nullptr == registry.find("never.interned.key"));
+  REQUIRE(key != registry.intern("other.interned.key"));
+}
+
+TEST_CASE("AttributeKeyRegistryIsBounded", "[flowfileattributes5]") {
+  core::AttributeKeyRegistry registry(2);
+  const core::AttributeKey *first = registry.intern("first.key");
+  const core::AttributeKey *second = registry.intern("second.key");
+  REQUIRE(nullptr != first);
+  REQUIRE(nullptr != second);
+  // keys past the capacity are not interned, while interned keys are still found
+  REQUIRE(nullptr == registry.intern("third.key"));
+  REQUIRE(nullptr == registry.find("third.key"));
+  REQUIRE(first == registry.intern("first.key"));
+  REQUIRE(2 == registry.size());
+}
+
+TEST_CASE("FlowFileAttributesAreCopiedOnWrite", "[flowfileattributes2]") {
+  core::FlowFileAttributes attributes;
+  REQUIRE(attributes.empty());
+  REQUIRE(attributes.add("a", "1"));
+  REQUIRE_FALSE(attributes.add("a", "2"));
+  REQUIRE(attributes.update("a", "3"));
+  REQUIRE_FALSE(attributes.update("b", "3"));
+  attributes.set("b", "a value longer than the small string buffer");
+  REQUIRE(2 == attributes.size());
+
+  core::FlowFileAttributes copy(attributes);
+  REQUIRE(attributes.isShared());
+  REQUIRE(attributes.find("a") == copy.find("a"));
+
+  copy.set("a", "4");
+  REQUIRE_FALSE(attributes.isShared());
+  REQUIRE("3" == *attributes.find("a"));
+  REQUIRE("4" == *copy.find("a"));
+
+  REQUIRE(copy.remove("b"));
+  REQUIRE_FALSE(copy.remove("b"));
+  REQUIRE(1 == copy.size());
+  REQUIRE(2 == attributes.size());
+
+  std::map<std::string, std::string> expected = { { "a", "3" }, { "b", "a value longer than the small string buffer" } };
+  REQUIRE(expected == attributes.toMap());
+  REQUIRE(expected == core::FlowFileAttributes(expected).toMap());
+}
+
+TEST_CASE("FlowFilesInheritParentAttributes", "[flowfileattributes3]") {
+  std::shared_ptr<TestRepository> repo = std::make_shared<TestRepository>();
+  std::map<std::string, std::string> attributes = { { "shared", "value" }, { "discard.reason", "none" } };
+  std::shared_ptr<core::FlowFile> parent = std::make_shared<minifi::FlowFileRecord>(repo, nullptr, attributes);
+  std::shared_ptr<core::FlowFile> child = std::make_shared<minifi::FlowFileRecord>(repo, nullptr, std::map<std::string, std::string>());
+  child->setAttribute("child", "value");
+
+  child->inheritAttributes(*parent, { "uuid", "discard.reason" });
+  std::string value;
+  REQUIRE(child->getAttribute("shared", value));
+  REQUIRE("value" == value);
+  REQUIRE(child->getAttribute("child", value));
+  REQUIRE(child->getAttribute("uuid", value));
+  REQUIRE(child->getUUIDStr() == value);
+  REQUIRE_FALSE(child->getAttribute("discard.reason", value));
+  REQUIRE(parent->getAttribute("filename", value));
+  std::string child_filename;
+  REQUIRE(child->getAttribute("filename", child_filename));
+  REQUIRE(value == child_filename);
+
+  // a record persisting a flow file shares its attributes
+  std::shared_ptr<core::FlowFile> persisted = std::make_shared<minifi::FlowFileRecord>(repo, nullptr, parent, "connection");
+  REQUIRE(parent->getAttributeStore().isShared());
+  REQUIRE(parent->getAttributes() == persisted->getAttributes());
+}
+
+TEST_CASE("FlowFileRecordSerializesAttributeDictionary", "[flowfileattributes4]") {
+  std::shared_ptr<TestRepository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(std::make_shared<minifi::Configure>());
+  std::map<std::string, std::string> attributes = { { "mime.type", "text/plain" }, { "custom", "value" } };
+  std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(repo, content_repo, attributes);
+  minifi::FlowFileRecord record(repo, content_repo, flow, "connection");
+
+  minifi::io::DataStream stream;
+  REQUIRE(record.Serialize(stream));
+  // dictionary keys are written as a single byte rather than their name
+  std::string serialized(reinterpret_cast<const char*>(stream.getBuffer()), stream.getSize());
+  REQUIRE(std::string::npos == serialized.find("mime.type"));
+  REQUIRE(std::string::npos != serialized.find("custom"));
+
+  minifi::FlowFileRecord deserialized(repo, content_repo);
+  REQUIRE(deserialized.DeSerialize(stream));
+  REQUIRE(flow->getAttributes() == deserialized.getAttributes());
+
+  // records written before the dictionary remain readable
+  minifi::io::DataStream legacy;
+  LegacyRecordWriter().write("legacy", attributes, legacy);
+  minifi::FlowFileRecord legacy_record(repo, content_repo);
+  REQUIRE(legacy_record.DeSerialize(legacy));
+  REQUIRE(attributes == legacy_record.getAttributes());
+  REQUIRE("legacy" == legacy_record.getUUIDStr());
+}
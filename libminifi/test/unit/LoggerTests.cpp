@@ -19,8 +19,38 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <chrono>
 #include <ctime>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include "../TestBase.h"
+#include "core/logging/AsyncLogQueue.h"
+#include "spdlog/sinks/ostream_sink.h"
+
+namespace {
+
+/**
+ * Writes messages to a stream while the test does not hold its mutex.
+ */
+class GatedSink : public spdlog::sinks::sink {
+ public:
+  explicit GatedSink(std::ostream &stream)
+      : stream_(stream) {
+  }
+  void log(const spdlog::details::log_msg &msg) override {
+    std::lock_guard<std::mutex> lock(gate);
+    stream_.write(msg.formatted.data(), msg.formatted.size());
+  }
+  void flush() override {
+  }
+  std::mutex gate;
+
+ private:
+  std::ostream &stream_;
+};
+
+}  // namespace
 
 
 TEST_CASE("Test log Levels", "[ttl1]") {
@@ -75,3 +105,89 @@ TEST_CASE("Test log Levels change", "[ttl5]") {
 
 TEST_CASE("Test Demangle template", "[ttl6]") {
 }
+
+TEST_CASE("Test log builder skips disabled levels", "[ttl7]") {
+  LogTestController::getInstance().setInfo<logging::Logger>();
+  std::shared_ptr<logging::Logger> logger = logging::LoggerFactory<logging::Logger>::getLogger();
+  REQUIRE_FALSE(logger->should_log(logging::LOG_LEVEL::debug));
+  {
+    logging::LogBuilder builder(logger.get(), logging::LOG_LEVEL::debug);
+    REQUIRE(builder.ignore);
+    REQUIRE(nullptr == builder.str);
+    builder << "hello " << "world";
+  }
+  logging::LOG_INFO(logger) << "hello " << "builder";
+  REQUIRE(true == LogTestController::getInstance().contains("[org::apache::nifi::minifi::core::logging::Logger] [info] hello builder"));
+  LogTestController::getInstance().reset();
+}
+
+TEST_CASE("Test async log queue writes messages in order", "[ttl8]") {
+  std::ostringstream stream;
+  auto logger = std::make_shared<spdlog::logger>("AsyncLogQueueTest", std::make_shared<spdlog::sinks::ostream_sink_mt>(stream));
+  logger->set_pattern("%v");
+  logging::AsyncLogQueue queue(4, logging::AsyncLogQueue::OverflowPolicy::BLOCK);
+  std::string expected;
+  for (int i = 0; i < 1000; i++) {
+    std::string message = "message " + std::to_string(i);
+    expected += message + "\n";
+    REQUIRE(queue.push(logger.get(), spdlog::level::info, message));
+  }
+  queue.stop();
+  REQUIRE(expected == stream.str());
+  REQUIRE(0 == queue.getDroppedCount());
+
+  // a stopped queue leaves the message to the caller
+  std::string message = "late";
+  REQUIRE_FALSE(queue.push(logger.get(), spdlog::level::info, message));
+  REQUIRE("late" == message);
+}
+
+TEST_CASE("Test async log queue drops messages when full", "[ttl9]") {
+  std::ostringstream stream;
+  auto sink = std::make_shared<GatedSink>(stream);
+  auto logger = std::make_shared<spdlog::logger>("AsyncLogQueueDropTest", sink);
+  logger->set_pattern("%v");
+  logging::AsyncLogQueue queue(4, logging::AsyncLogQueue::OverflowPolicy::DROP);
+  {
+    // the sink holds up the background thread, so the ring buffer fills up
+    std::lock_guard<std::mutex> lock(sink->gate);
+    for (int i = 0; i < 100; i++) {
+      std::string message = "message " + std::to_string(i);
+      REQUIRE(queue.push(logger.get(), spdlog::level::info, message));
+    }
+    REQUIRE(queue.getDroppedCount() > 0);
+  }
+  queue.stop();
+  REQUIRE(stream.str().find("message 0\n") != std::string::npos);
+  REQUIRE(stream.str().find("log messages as the log queue was full") != std::string::npos);
+}
+
+TEST_CASE("Test async log queue wakes up for messages after idling", "[ttl10]") {
+  std::ostringstream stream;
+  auto sink = std::make_shared<GatedSink>(stream);
+  auto logger = std::make_shared<spdlog::logger>("AsyncLogQueueIdleTest", sink);
+  logger->set_pattern("%v");
+  logging::AsyncLogQueue queue(4, logging::AsyncLogQueue::OverflowPolicy::BLOCK);
+  auto written = [&sink, &stream](const std::string &expected) {
+    for (int i = 0; i < 500; i++) {
+      {
+        std::lock_guard<std::mutex> lock(sink->gate);
+        if (stream.str() == expected) {
+          return true;
+        }
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  };
+  std::string expected;
+  for (int i = 0; i < 20; i++) {
+    // the background thread has nothing left to write and sleeps until the next message
+    std::string message = "message " + std::to_string(i);
+    expected += message + "\n";
+    REQUIRE(queue.push(logger.get(), spdlog::level::info, message));
+    REQUIRE(written(expected));
+  }
+  queue.stop();
+  REQUIRE(expected == stream.str());
+}
@@ -0,0 +1,126 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../TestBase.h"
+#include "io/DataStream.h"
+#include "sitetosite/PeerSelector.h"
+#include "sitetosite/RawSocketProtocol.h"
+#include "sitetosite/SiteToSiteClientPool.h"
+
+namespace {
+
+std::vector<minifi::sitetosite::PeerStatus> createPeers(uint32_t busy_count, uint32_t idle_count) {
+  std::vector<minifi::sitetosite::PeerStatus> peers;
+  peers.push_back(minifi::sitetosite::PeerStatus(std::make_shared<minifi::sitetosite::Peer>("busy", 8081), busy_count, true));
+  peers.push_back(minifi::sitetosite::PeerStatus(std::make_shared<minifi::sitetosite::Peer>("idle", 8081), idle_count, true));
+  return peers;
+}
+
+std::map<std::string, int> countSelections(minifi::sitetosite::PeerSelector &selector, minifi::sitetosite::TransferDirection direction) {
+  std::map<std::string, int> selections;
+  for (int i = 0; i < 1000; i++) {
+    selections[selector.select(direction)->getHost()]++;
+  }
+  return selections;
+}
+
+std::unique_ptr<minifi::sitetosite::SiteToSiteClient> createClient() {
+  std::unique_ptr<minifi::sitetosite::SiteToSitePeer> peer(
+      new minifi::sitetosite::SiteToSitePeer(std::unique_ptr<minifi::io::DataStream>(new minifi::io::DataStream()), "fake_host", 65433, ""));
+  return std::unique_ptr<minifi::sitetosite::SiteToSiteClient>(new minifi::sitetosite::RawSiteToSiteClient(std::move(peer)));
+}
+
+}  // namespace
+
+TEST_CASE("PeerSelectorWeighsByFlowFileCount", "[peerselector1]") {
+  minifi::sitetosite::PeerSelector selector;
+  REQUIRE(nullptr == selector.select(minifi::sitetosite::SEND));
+
+  selector.setPeers(createPeers(900, 100));
+  REQUIRE(2 == selector.size());
+  auto sent = countSelections(selector, minifi::sitetosite::SEND);
+  auto received = countSelections(selector, minifi::sitetosite::RECEIVE);
+  // the weights are 0.2 and 0.9 when sending, and the reverse when receiving
+  REQUIRE(sent["idle"] > 2 * sent["busy"]);
+  REQUIRE(sent["busy"] > 0);
+  REQUIRE(received["busy"] > 2 * received["idle"]);
+
+  REQUIRE(1.0 == minifi::sitetosite::PeerSelector::getWeight(0, 0, minifi::sitetosite::SEND));
+  REQUIRE(0.05 == minifi::sitetosite::PeerSelector::getWeight(0, 100, minifi::sitetosite::RECEIVE));
+}
+
+TEST_CASE("PeerSelectorAvoidsPenalizedPeers", "[peerselector2]") {
+  minifi::sitetosite::PeerSelector selector(60000);
+  selector.setPeers(createPeers(900, 100));
+  minifi::sitetosite::Peer idle("idle", 8081);
+  selector.penalize(idle);
+  REQUIRE(selector.isPenalized(idle));
+  REQUIRE(1000 == countSelections(selector, minifi::sitetosite::SEND)["busy"]);
+
+  // penalties survive refreshes of the peer list
+  selector.setPeers(createPeers(900, 100));
+  REQUIRE(selector.isPenalized(idle));
+
+  // when every peer is penalized, the peer whose penalty ends first is used
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  selector.penalize(minifi::sitetosite::Peer("busy", 8081));
+  REQUIRE("idle" == selector.select(minifi::sitetosite::SEND)->getHost());
+
+  minifi::sitetosite::PeerSelector expiring(0);
+  expiring.setPeers(createPeers(900, 100));
+  expiring.penalize(idle);
+  REQUIRE_FALSE(expiring.isPenalized(idle));
+}
+
+TEST_CASE("SiteToSiteClientPoolIsBoundedPerPeer", "[peerselector3]") {
+  minifi::sitetosite::SiteToSiteClientPool pool(2);
+  minifi::sitetosite::Peer first("first", 8081);
+  auto second = std::make_shared<minifi::sitetosite::Peer>("second", 8081);
+  REQUIRE(nullptr == pool.take(first));
+
+  auto client = createClient();
+  auto client_address = client.get();
+  REQUIRE(pool.put(first, std::move(client)));
+  REQUIRE(pool.put(first, createClient()));
+  REQUIRE_FALSE(pool.put(first, createClient()));
+  REQUIRE(pool.put(*second, createClient()));
+  REQUIRE(2 == pool.size(first));
+
+  // the most recently returned client is reused first
+  auto taken = pool.take(first);
+  REQUIRE(taken != nullptr);
+  REQUIRE(taken.get() != client_address);
+  REQUIRE(1 == pool.size(first));
+
+  // clients of peers that are no longer known are dropped
+  pool.evict({ second });
+  REQUIRE(0 == pool.size(first));
+  REQUIRE(1 == pool.size(*second));
+
+  minifi::sitetosite::SiteToSiteClientPool expiring(1, 0);
+  REQUIRE(expiring.put(first, createClient()));
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  REQUIRE(nullptr == expiring.take(first));
+}
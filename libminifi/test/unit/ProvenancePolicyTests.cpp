@@ -0,0 +1,147 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../TestBase.h"
+#include "ProvenanceTestHelper.h"
+#include "FlowFileRecord.h"
+#include "core/state/nodes/RepositoryMetrics.h"
+#include "provenance/Provenance.h"
+#include "provenance/ProvenancePolicy.h"
+#include "core/repository/VolatileContentRepository.h"
+
+namespace {
+
+std::shared_ptr<core::FlowFile> createFlowFile(const std::shared_ptr<core::Repository> &repo, uint64_t size) {
+  std::map<std::string, std::string> attributes;
+  std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(repo, nullptr, attributes);
+  flow->setSize(size);
+  return flow;
+}
+
+}  // namespace
+
+TEST_CASE("ProvenancePolicyResolvesModes", "[provenancepolicy1]") {
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  provenance::ProvenancePolicy full(configuration);
+  REQUIRE_FALSE(full.isSelective());
+
+  configuration->set(minifi::Configure::nifi_provenance_policy, "sample");
+  configuration->set(minifi::Configure::nifi_provenance_policy_sample_interval, "4");
+  configuration->set("nifi.provenance.policy.event.ATTRIBUTES_MODIFIED", "off");
+  configuration->set("nifi.provenance.policy.event.route", "aggregate");
+  configuration->set("nifi.provenance.policy.component.PutFile", "Full");
+  provenance::ProvenancePolicy policy(configuration);
+  REQUIRE(policy.isSelective());
+  REQUIRE(provenance::PROVENANCE_SAMPLE == policy.getMode("GetFile", provenance::ProvenanceEventRecord::CREATE));
+  REQUIRE(provenance::PROVENANCE_OFF == policy.getMode("GetFile", provenance::ProvenanceEventRecord::ATTRIBUTES_MODIFIED));
+  REQUIRE(provenance::PROVENANCE_AGGREGATE == policy.getMode("GetFile", provenance::ProvenanceEventRecord::ROUTE));
+  // component modes take precedence over event type modes
+  REQUIRE(provenance::PROVENANCE_FULL == policy.getMode("PutFile", provenance::ProvenanceEventRecord::ATTRIBUTES_MODIFIED));
+
+  auto component = policy.getComponent("GetFile");
+  int stored = 0;
+  for (int i = 0; i < 10; i++) {
+    if (policy.accept(*component, provenance::ProvenanceEventRecord::CREATE, 1)) {
+      stored++;
+    }
+    REQUIRE_FALSE(policy.accept(*component, provenance::ProvenanceEventRecord::ATTRIBUTES_MODIFIED, 1));
+  }
+  // one in four events, starting with the first
+  REQUIRE(3 == stored);
+
+  auto counters = policy.getCounters();
+  REQUIRE(10 == counters["GetFile"][provenance::ProvenanceEventRecord::CREATE].events);
+  REQUIRE(3 == counters["GetFile"][provenance::ProvenanceEventRecord::CREATE].stored);
+  REQUIRE(10 == counters["GetFile"][provenance::ProvenanceEventRecord::ATTRIBUTES_MODIFIED].events);
+  REQUIRE(0 == counters["GetFile"][provenance::ProvenanceEventRecord::ATTRIBUTES_MODIFIED].stored);
+}
+
+TEST_CASE("ProvenancePolicyFiltersReportedEvents", "[provenancepolicy2]") {
+  std::shared_ptr<TestRepository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<provenance::ProvenancePolicy> policy = std::make_shared<provenance::ProvenancePolicy>();
+  policy->setDefaultMode(provenance::PROVENANCE_OFF);
+  policy->setEventTypeMode(provenance::ProvenanceEventRecord::CREATE, provenance::PROVENANCE_FULL);
+  repo->setProvenancePolicy(policy);
+
+  provenance::ProvenanceReporter reporter(repo, "processor", "processor");
+  auto flow = createFlowFile(repo, 10);
+  reporter.create(flow);
+  reporter.modifyAttributes(flow, "key", "value");
+  reporter.modifyContent(flow, 1);
+  reporter.drop(flow, "done");
+  REQUIRE(1 == reporter.getEvents().size());
+  REQUIRE(provenance::ProvenanceEventRecord::CREATE == (*reporter.getEvents().begin())->getEventType());
+  reporter.commit();
+  REQUIRE(1 == repo->getRepoMap().size());
+}
+
+TEST_CASE("ProvenancePolicyAggregatesEvents", "[provenancepolicy3]") {
+  std::shared_ptr<TestRepository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<provenance::ProvenancePolicy> policy = std::make_shared<provenance::ProvenancePolicy>();
+  policy->setDefaultMode(provenance::PROVENANCE_AGGREGATE);
+  policy->setAggregationWindow(3600000);
+  repo->setProvenancePolicy(policy);
+
+  {
+    provenance::ProvenanceReporter reporter(repo, "processor", "processor");
+    for (int i = 0; i < 5; i++) {
+      reporter.create(createFlowFile(repo, 100));
+    }
+    reporter.drop(createFlowFile(repo, 7), "done");
+    REQUIRE(reporter.getEvents().empty());
+    reporter.commit();
+  }
+
+  // windows that are still open are only stored when forced
+  std::vector<std::shared_ptr<provenance::ProvenanceEventRecord>> events;
+  policy->flushAggregates(getTimeMillis(), events);
+  REQUIRE(events.empty());
+  policy->flushAggregates(getTimeMillis(), events, true);
+  REQUIRE(2 == events.size());
+  for (const auto &event : events) {
+    REQUIRE("processor" == event->getComponentId());
+    auto attributes = event->getAttributes();
+    if (event->getEventType() == provenance::ProvenanceEventRecord::CREATE) {
+      REQUIRE("5" == attributes["provenance.aggregate.count"]);
+      REQUIRE("500" == attributes["provenance.aggregate.bytes"]);
+    } else {
+      REQUIRE(provenance::ProvenanceEventRecord::DROP == event->getEventType());
+      REQUIRE("1" == attributes["provenance.aggregate.count"]);
+      REQUIRE("7" == attributes["provenance.aggregate.bytes"]);
+    }
+  }
+  events.clear();
+  policy->flushAggregates(getTimeMillis(), events, true);
+  REQUIRE(events.empty());
+
+  // the counters are reported with the repository metrics
+  minifi::state::response::RepositoryMetrics metrics;
+  metrics.addRepository(repo);
+  auto serialized = metrics.serialize();
+  REQUIRE(1 == serialized.size());
+  REQUIRE(4 == serialized.at(0).children.size());
+  auto provenance = serialized.at(0).children.at(3);
+  REQUIRE("provenance" == provenance.name);
+  REQUIRE(1 == provenance.children.size());
+  REQUIRE("processor" == provenance.children.at(0).name);
+  REQUIRE(2 == provenance.children.at(0).children.size());
+}
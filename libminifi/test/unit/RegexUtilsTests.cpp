@@ -70,3 +70,57 @@ TEST_CASE("TestRegexUtils::check_mode", "[regex4]") {
   Regex r2(rgx1, mode);
   REQUIRE(r2.match(pat));
 }
+
+TEST_CASE("TestRegexUtils::full_match", "[regex5]") {
+  Regex r1("(Ct|Bt|At):.*t");
+  REQUIRE(r1.matchesFully("At:est"));
+  REQUIRE(!r1.matchesFully(" At:est"));
+  REQUIRE(r1.find(" At:est"));
+  REQUIRE(!r1.find("At:es"));
+  REQUIRE(Regex("[[:alpha:]]+\\d{2,3}").matchesFully("abc123"));
+  REQUIRE(!Regex("[[:alpha:]]+\\d{2,3}").matchesFully("abc1234"));
+}
+
+TEST_CASE("TestRegexUtils::groups", "[regex6]") {
+  std::string subject = "key=value; other=";
+  Regex r1("(\\w+)=(\\w+)?");
+  REQUIRE(3 == r1.getGroupCount());
+  std::vector<size_t> groups;
+  REQUIRE(r1.search(subject.data(), subject.size(), 0, groups));
+  std::vector<size_t> first = {0, 9, 0, 3, 4, 9};
+  REQUIRE(first == groups);
+  REQUIRE(r1.search(subject.data(), subject.size(), groups[1], groups));
+  std::vector<size_t> second = {11, 17, 11, 16, std::string::npos, std::string::npos};
+  REQUIRE(second == groups);
+  REQUIRE(!r1.search(subject.data(), subject.size(), groups[1], groups));
+  // alternatives and quantifiers prefer the leftmost, greedy match as std::regex does
+  REQUIRE(r1.match("a=b"));
+  REQUIRE("<a>b" == Regex("a|ab").replace("ab", "<$&>"));
+  REQUIRE("<ab>" == Regex("ab|a").replace("ab", "<$&>"));
+  REQUIRE("<a>b" == Regex("a+?").replace("ab", "<$&>"));
+}
+
+TEST_CASE("TestRegexUtils::replace", "[regex7]") {
+  REQUIRE("new filename.txt" == Regex("a brand (new)").replace("a brand new filename.txt", "$1"));
+  REQUIRE("a brand new filename" == Regex("\\..*").replace("a brand new filename.txt", ""));
+  REQUIRE("X b c" == Regex("\\w").replace("a b c", "X", true));
+  REQUIRE("-a-b-" == Regex("x*").replace("ab", "-$&"));
+  REQUIRE("$[b]" == Regex("(a)(b)").replace("ab", "$$[$2]"));
+}
+
+TEST_CASE("TestRegexUtils::linear_time", "[regex8]") {
+  // backtracking engines take exponential time or overflow the stack on these
+  std::string subject(100000, 'a');
+  REQUIRE(!Regex("(a*)*b").find(subject));
+  REQUIRE(!Regex("(a|aa)+$").find(subject + "!"));
+  REQUIRE(Regex("(a|b)*").matchesFully(subject));
+}
+
+TEST_CASE("TestRegexUtils::fallback", "[regex9]") {
+  Regex backreference("(\\w)\\1");
+  REQUIRE(backreference.find("abba"));
+  REQUIRE(!backreference.find("abab"));
+  Regex lookahead("a(?=b)");
+  REQUIRE(lookahead.find("ab"));
+  REQUIRE(!lookahead.find("ac"));
+}
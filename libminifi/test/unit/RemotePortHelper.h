@@ -0,0 +1,248 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef LIBMINIFI_TEST_UNIT_REMOTEPORTHELPER_H_
+#define LIBMINIFI_TEST_UNIT_REMOTEPORTHELPER_H_
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include "SiteToSiteHelper.h"
+#include "FlowFileRecord.h"
+#include "ResourceClaim.h"
+#include "core/ContentRepository.h"
+#include "core/Repository.h"
+#include "io/BaseStream.h"
+#include "sitetosite/Peer.h"
+#include "sitetosite/RawSocketProtocol.h"
+#include "RemoteProcessorGroupPort.h"
+
+/**
+ * Answers the reads of a client a round trip after the client wrote its request.
+ */
+class DelayedResponder : public SiteToSiteResponder {
+ public:
+  explicit DelayedResponder(std::chrono::milliseconds round_trip)
+      : round_trip_(round_trip),
+        pending_(false) {
+  }
+
+  int writeData(uint8_t *value, int size) {
+    if (!pending_) {
+      request_time_ = std::chrono::steady_clock::now();
+      pending_ = true;
+    }
+    return size;
+  }
+
+  virtual int read(uint8_t &value) {
+    wait();
+    return SiteToSiteResponder::read(value);
+  }
+
+  virtual int read(uint16_t &base_value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
+    wait();
+    return SiteToSiteResponder::read(base_value, is_little_endian);
+  }
+
+  virtual int read(char &value) {
+    wait();
+    return SiteToSiteResponder::read(value);
+  }
+
+  virtual int read(uint8_t *value, int len) {
+    wait();
+    return SiteToSiteResponder::read(value, len);
+  }
+
+  virtual int readData(uint8_t *buf, int buflen) {
+    wait();
+    return SiteToSiteResponder::readData(buf, buflen);
+  }
+
+  virtual int read(uint32_t &value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
+    wait();
+    return SiteToSiteResponder::read(value, is_little_endian);
+  }
+
+  virtual int read(uint64_t &value, bool is_little_endian = minifi::io::EndiannessCheck::IS_LITTLE) {
+    wait();
+    return SiteToSiteResponder::read(value, is_little_endian);
+  }
+
+  virtual int readUTF(std::string &str, bool widen = false) {
+    wait();
+    return SiteToSiteResponder::readUTF(str, widen);
+  }
+
+ private:
+  // the first read after a request waits for the response to arrive, later reads take the rest of it
+  void wait() {
+    if (pending_) {
+      std::this_thread::sleep_until(request_time_ + round_trip_);
+      pending_ = false;
+    }
+  }
+
+  std::chrono::milliseconds round_trip_;
+  bool pending_;
+  std::chrono::steady_clock::time_point request_time_;
+};
+
+inline void pushCode(SiteToSiteResponder *responder, minifi::sitetosite::RespondCode code) {
+  responder->push_response("R");
+  responder->push_response("C");
+  responder->push_response(std::string(1, static_cast<char>(code)));
+}
+
+inline void pushBootstrap(SiteToSiteResponder *responder) {
+  std::string resource_ok(1, static_cast<char>(0x14));
+  responder->push_response(resource_ok);
+  pushCode(responder, minifi::sitetosite::PROPERTIES_OK);
+  responder->push_response(resource_ok);
+}
+
+// Creates a flow file with the given content, which the remote port can send
+inline std::shared_ptr<core::FlowFile> createFlowFile(const std::shared_ptr<core::Repository> &repo, const std::shared_ptr<core::ContentRepository> &content_repo,
+                                                      const std::string &content) {
+  std::shared_ptr<minifi::ResourceClaim> claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+  content_repo->write(claim)->writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(content.data())), content.size());
+  std::map<std::string, std::string> attributes = { { "filename", "payload.txt" } };
+  std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(repo, content_repo, attributes, claim);
+  flow->setSize(content.size());
+  flow->setStoredToRepository(true);
+  return flow;
+}
+
+/**
+ * How the remote instance behind a ScriptedRemotePort answers, and what it saw.
+ */
+struct RemotePortScript {
+  explicit RemotePortScript(std::chrono::milliseconds round_trip, uint64_t batch_count = 1, int failing_transaction = -1)
+      : round_trip(round_trip),
+        batch_count(batch_count),
+        failing_transaction(failing_transaction),
+        transactions(0),
+        confirmed(0),
+        in_flight(0),
+        max_in_flight(0) {
+  }
+
+  std::chrono::milliseconds round_trip;
+  // flow files each transaction sends
+  uint64_t batch_count;
+  // number of the transaction, counted from 0 in the order they are confirmed, whose checksum the remote instance rejects
+  int failing_transaction;
+
+  std::atomic<int> transactions;
+  std::atomic<int> confirmed;
+  std::atomic<int> in_flight;
+  // most transactions that waited for their confirmation at the same time
+  std::atomic<int> max_in_flight;
+};
+
+// Holds the responder of a client. As a base class of the client it is destroyed after the client, which still writes to it when it is torn down
+class ResponderHolder {
+ protected:
+  explicit ResponderHolder(std::chrono::milliseconds round_trip)
+      : responder_(new DelayedResponder(round_trip)) {
+  }
+
+  std::unique_ptr<DelayedResponder> responder_;
+};
+
+/**
+ * Raw client whose remote instance is a DelayedResponder, which is given the responses of each
+ * transaction as the transaction needs them.
+ */
+class ScriptedSiteToSiteClient : private ResponderHolder, public minifi::sitetosite::RawSiteToSiteClient {
+ public:
+  ScriptedSiteToSiteClient(const std::shared_ptr<RemotePortScript> &script, const std::string &host, uint16_t port)
+      : ResponderHolder(script->round_trip),
+        minifi::sitetosite::RawSiteToSiteClient(
+            std::unique_ptr<minifi::sitetosite::SiteToSitePeer>(
+                new minifi::sitetosite::SiteToSitePeer(std::unique_ptr<minifi::io::DataStream>(new minifi::io::BaseStream(responder_.get())), host, port, ""))),
+        script_(script) {
+    _batchGetCount = script->batch_count;
+    // a transaction sends a single batch
+    _batchSendNanos = 0;
+  }
+
+  virtual bool bootstrap() {
+    if (peer_state_ != minifi::sitetosite::READY) {
+      pushBootstrap(responder_.get());
+    }
+    return minifi::sitetosite::RawSiteToSiteClient::bootstrap();
+  }
+
+  virtual bool confirm(std::string transactionID) {
+    auto it = known_transactions_.find(transactionID);
+    if (it == known_transactions_.end()) {
+      return false;
+    }
+    // the remote instance confirms the checksum of the packets it received, then finishes once the client confirms too
+    if (script_->transactions++ == script_->failing_transaction) {
+      pushCode(responder_.get(), minifi::sitetosite::BAD_CHECKSUM);
+    } else {
+      std::string crc = std::to_string(it->second->getCRC());
+      pushCode(responder_.get(), minifi::sitetosite::CONFIRM_TRANSACTION);
+      responder_->push_response(std::to_string(crc.size()));
+      responder_->push_response(crc);
+      pushCode(responder_.get(), minifi::sitetosite::TRANSACTION_FINISHED);
+    }
+    int in_flight = ++script_->in_flight;
+    int max_in_flight = script_->max_in_flight;
+    while (in_flight > max_in_flight && !script_->max_in_flight.compare_exchange_weak(max_in_flight, in_flight)) {
+    }
+    bool confirmed = minifi::sitetosite::RawSiteToSiteClient::confirm(transactionID);
+    script_->in_flight--;
+    if (confirmed) {
+      script_->confirmed++;
+    }
+    return confirmed;
+  }
+
+ private:
+  std::shared_ptr<RemotePortScript> script_;
+};
+
+/**
+ * Remote port whose clients talk to scripted remote instances rather than over sockets.
+ */
+class ScriptedRemotePort : public minifi::RemoteProcessorGroupPort {
+ public:
+  ScriptedRemotePort(const std::string &name, const std::shared_ptr<minifi::Configure> &configure, const std::shared_ptr<RemotePortScript> &script)
+      : minifi::RemoteProcessorGroupPort(nullptr, name, "", configure),
+        script_(script) {
+  }
+
+ protected:
+  virtual std::unique_ptr<minifi::sitetosite::SiteToSiteClient> createProtocol(const std::shared_ptr<minifi::sitetosite::Peer> &peer) {
+    std::unique_ptr<minifi::sitetosite::SiteToSiteClient> client(new ScriptedSiteToSiteClient(script_, peer->getHost(), peer->getPort()));
+    client->setPortId(protocol_uuid_);
+    return client;
+  }
+
+ private:
+  std::shared_ptr<RemotePortScript> script_;
+};
+
+#endif /* LIBMINIFI_TEST_UNIT_REMOTEPORTHELPER_H_ */
@@ -0,0 +1,77 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include "../TestBase.h"
+#include "ProvenanceTestHelper.h"
+#include "RemotePortHelper.h"
+#include "Connection.h"
+#include "RemoteProcessorGroupPort.h"
+#include "core/ProcessContext.h"
+#include "core/ProcessSessionFactory.h"
+#include "core/ProcessorNode.h"
+#include "core/repository/VolatileContentRepository.h"
+
+TEST_CASE("RemotePortRollsBackOnlyTheFailedTransaction", "[rpg1]") {
+  TestController testController;
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+
+  // the second transaction to be confirmed has its checksum rejected
+  auto script = std::make_shared<RemotePortScript>(std::chrono::milliseconds(100), 1, 1);
+  auto port = std::make_shared<ScriptedRemotePort>("port", configuration, script);
+  port->initialize();
+  port->setProperty(minifi::RemoteProcessorGroupPort::hostName, "fake_host");
+  port->setProperty(minifi::RemoteProcessorGroupPort::port, "65433");
+  port->setProperty(minifi::RemoteProcessorGroupPort::portUUID, "c56a4180-65aa-42ec-a945-5fd21dec0538");
+  port->setProperty(minifi::RemoteProcessorGroupPort::maxInFlightTransactions, "4");
+  port->setTransmitting(true);
+
+  auto connection = std::make_shared<minifi::Connection>(repo, content_repo, "connection");
+  connection->setDestination(port);
+  utils::Identifier port_uuid;
+  port->getUUID(port_uuid);
+  connection->setDestinationUUID(port_uuid);
+  port->addConnection(connection);
+  for (int i = 0; i < 4; i++) {
+    connection->put(createFlowFile(repo, content_repo, "Test MiNiFi payload"));
+  }
+
+  std::shared_ptr<core::ProcessorNode> node = std::make_shared<core::ProcessorNode>(port);
+  std::shared_ptr<core::controller::ControllerServiceProvider> controller_services_provider = nullptr;
+  auto context = std::make_shared<core::ProcessContext>(node, controller_services_provider, repo, repo, configuration, content_repo);
+  auto factory = std::make_shared<core::ProcessSessionFactory>(context);
+  port->onSchedule(context, factory);
+
+  // each transaction takes one flow file over a client of its own, and only the rejected one is put back
+  port->onTrigger(context, factory);
+  REQUIRE(4 == script->transactions);
+  REQUIRE(3 == script->confirmed);
+  REQUIRE(1 == connection->getQueueSize());
+  REQUIRE(1 < script->max_in_flight);
+
+  port->onTrigger(context, factory);
+  REQUIRE(4 == script->confirmed);
+  REQUIRE(0 == connection->getQueueSize());
+
+  port->notifyStop();
+}
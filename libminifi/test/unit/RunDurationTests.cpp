@@ -0,0 +1,132 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include "../TestBase.h"
+#include "Connection.h"
+#include "FlowFileRecord.h"
+#include "core/Processor.h"
+#include "core/ProcessContext.h"
+#include "core/ProcessSession.h"
+#include "core/ProcessSessionFactory.h"
+#include "core/ProcessorNode.h"
+#include "core/repository/VolatileContentRepository.h"
+
+namespace {
+
+/**
+ * Removes one flow file per trigger, counting triggers and sessions.
+ */
+class RemovingProcessor : public core::Processor {
+ public:
+  explicit RemovingProcessor(const std::string &name)
+      : Processor(name),
+        triggers_(0),
+        sessions_(0),
+        last_session_(nullptr) {
+  }
+
+  using core::Processor::onTrigger;
+
+  virtual void onTrigger(core::ProcessContext *context, core::ProcessSession *session) {
+    triggers_++;
+    if (session != last_session_) {
+      sessions_++;
+      last_session_ = session;
+    }
+    auto flow = session->get();
+    if (flow) {
+      session->remove(flow);
+    }
+  }
+
+  int triggers_;
+  int sessions_;
+  core::ProcessSession *last_session_;
+};
+
+struct RunDurationFixture {
+  RunDurationFixture()
+      : repo(std::make_shared<TestRepository>()),
+        content_repo(std::make_shared<core::repository::VolatileContentRepository>()),
+        processor(std::make_shared<RemovingProcessor>("remove")),
+        connection(std::make_shared<minifi::Connection>(repo, content_repo, "incoming")) {
+    content_repo->initialize(std::make_shared<minifi::Configure>());
+    utils::Identifier uuid;
+    processor->getUUID(uuid);
+    connection->setDestination(processor);
+    connection->setDestinationUUID(uuid);
+    processor->addConnection(connection);
+    processor->incrementActiveTasks();
+    processor->setScheduledState(core::ScheduledState::RUNNING);
+
+    std::shared_ptr<core::ProcessorNode> node = std::make_shared<core::ProcessorNode>(processor);
+    std::shared_ptr<core::controller::ControllerServiceProvider> controller_services_provider = nullptr;
+    context = std::make_shared<core::ProcessContext>(node, controller_services_provider, repo, repo, content_repo);
+    factory = std::make_shared<core::ProcessSessionFactory>(context);
+  }
+
+  void queue(int count) {
+    for (int i = 0; i < count; i++) {
+      std::map<std::string, std::string> attributes;
+      std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(repo, content_repo, attributes);
+      flow->setStoredToRepository(true);
+      connection->put(flow);
+    }
+  }
+
+  std::shared_ptr<core::Repository> repo;
+  std::shared_ptr<core::ContentRepository> content_repo;
+  std::shared_ptr<RemovingProcessor> processor;
+  std::shared_ptr<minifi::Connection> connection;
+  std::shared_ptr<core::ProcessContext> context;
+  std::shared_ptr<core::ProcessSessionFactory> factory;
+};
+
+}  // namespace
+
+TEST_CASE("ProcessorTriggersOnceWithoutRunDuration", "[runduration1]") {
+  RunDurationFixture fixture;
+  fixture.queue(10);
+  fixture.processor->onTrigger(fixture.context, fixture.factory);
+  REQUIRE(1 == fixture.processor->triggers_);
+  REQUIRE(9 == fixture.connection->getQueueSize());
+}
+
+TEST_CASE("ProcessorRunsUntilInputIsEmpty", "[runduration2]") {
+  RunDurationFixture fixture;
+  // one minute is never reached, the trigger ends once the connection is empty
+  fixture.processor->setRunDurationNano(60000000000ULL);
+  fixture.queue(10);
+  fixture.processor->onTrigger(fixture.context, fixture.factory);
+  REQUIRE(10 == fixture.processor->triggers_);
+  REQUIRE(1 == fixture.processor->sessions_);
+  REQUIRE(fixture.connection->isEmpty());
+}
+
+TEST_CASE("ProcessorStopsWhenYielding", "[runduration3]") {
+  RunDurationFixture fixture;
+  fixture.processor->setRunDurationNano(60000000000ULL);
+  fixture.processor->yield(60000);
+  fixture.queue(10);
+  fixture.processor->onTrigger(fixture.context, fixture.factory);
+  REQUIRE(1 == fixture.processor->triggers_);
+}
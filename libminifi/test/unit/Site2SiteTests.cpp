@@ -22,6 +22,7 @@
 #include <utility>
 #include <map>
 #include "io/BaseStream.h"
+#include "io/CompressionStream.h"
 #include "sitetosite/Peer.h"
 #include "sitetosite/RawSocketProtocol.h"
 #include <algorithm>
@@ -153,6 +154,85 @@ TEST_CASE("TestSiteToSiteVerifySend", "[S2S3]") {
   REQUIRE(payload == rx_payload);
 }
 
+TEST_CASE("TestSiteToSiteVerifyCompressedSend", "[S2S5]") {
+  SiteToSiteResponder *collector = new SiteToSiteResponder();
+
+  sunny_path_bootstrap(collector);
+
+  std::unique_ptr<minifi::sitetosite::SiteToSitePeer> peer = std::unique_ptr<minifi::sitetosite::SiteToSitePeer>(
+      new minifi::sitetosite::SiteToSitePeer(std::unique_ptr<minifi::io::DataStream>(new org::apache::nifi::minifi::io::BaseStream(collector)), "fake_host", 65433, ""));
+
+  minifi::sitetosite::RawSiteToSiteClient protocol(std::move(peer));
+
+  utils::Identifier fakeUUID;
+  fakeUUID = "c56a4180-65aa-42ec-a945-5fd21dec0538";
+  protocol.setPortId(fakeUUID);
+  protocol.setCompression(true, 6, 0);
+
+  REQUIRE(true == protocol.bootstrap());
+
+  bool gzip_requested = false;
+  while (collector->has_next_client_response()) {
+    if (collector->get_next_client_response() == "GZIP") {
+      collector->get_next_client_response();
+      gzip_requested = collector->get_next_client_response() == "true";
+      break;
+    }
+  }
+  REQUIRE(gzip_requested);
+  while (collector->has_next_client_response() && collector->get_next_client_response() != "SEND_FLOWFILES") {
+  }
+
+  std::string transactionID;
+  std::string payload;
+  for (int i = 0; i < 20; i++) {
+    payload += "Test MiNiFi payload ";
+  }
+  std::shared_ptr<minifi::sitetosite::Transaction> transaction = protocol.createTransaction(transactionID, minifi::sitetosite::SEND);
+  REQUIRE(transaction->isCompressed());
+  while (collector->has_next_client_response()) {
+    collector->get_next_client_response();
+  }
+  std::map<std::string, std::string> attributes = { { "filename", "payload.txt" } };
+  std::shared_ptr<logging::Logger> logger = nullptr;
+  minifi::sitetosite::DataPacket packet(logger, transaction, attributes, payload);
+  REQUIRE(protocol.send(transactionID, &packet, nullptr, nullptr) == 0);
+
+  // the packet arrives as a single compressed stream, which ends with the packet
+  minifi::io::BaseStream sent;
+  while (collector->has_next_client_response()) {
+    std::string response = collector->get_next_client_response();
+    sent.writeData(reinterpret_cast<uint8_t*>(const_cast<char*>(response.data())), response.size());
+  }
+  REQUIRE(sent.getSize() < payload.size());
+  minifi::io::CompressionInputStream packet_stream(&sent);
+  uint32_t num_attributes;
+  REQUIRE(4 == packet_stream.read(num_attributes));
+  REQUIRE(1 == num_attributes);
+  std::string key, value;
+  packet_stream.readUTF(key, true);
+  packet_stream.readUTF(value, true);
+  REQUIRE("filename" == key);
+  REQUIRE("payload.txt" == value);
+  uint64_t length;
+  REQUIRE(8 == packet_stream.read(length));
+  REQUIRE(payload.size() == length);
+  std::vector<uint8_t> content(length);
+  REQUIRE(static_cast<int>(length) == packet_stream.readData(content.data(), length));
+  REQUIRE(payload == std::string(content.begin(), content.end()));
+  REQUIRE(packet_stream.isFinished());
+
+  // the transaction checksum covers the uncompressed packet
+  minifi::io::BaseStream uncompressed;
+  minifi::io::CRCStream<minifi::io::BaseStream> crc(&uncompressed);
+  crc.write(num_attributes);
+  crc.writeUTF(key, true);
+  crc.writeUTF(value, true);
+  crc.write(length);
+  crc.writeData(content.data(), length);
+  REQUIRE(crc.getCRC() == transaction->getCRC());
+}
+
 TEST_CASE("TestSiteToSiteVerifyNegotiationFail", "[S2S4]") {
   SiteToSiteResponder *collector = new SiteToSiteResponder();
 
@@ -0,0 +1,199 @@
+/**
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "../TestBase.h"
+#include "Connection.h"
+#include "FlowFileRecord.h"
+#include "core/SwappingFlowFileQueue.h"
+#include "core/repository/VolatileContentRepository.h"
+#include "utils/file/FileUtils.h"
+
+namespace {
+
+std::shared_ptr<core::FlowFile> createFlowFile(const std::shared_ptr<core::Repository> &repo, int index) {
+  std::map<std::string, std::string> attributes;
+  attributes["index"] = std::to_string(index);
+  std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(repo, nullptr, attributes);
+  flow->setSize(1);
+  flow->setStoredToRepository(true);
+  return flow;
+}
+
+std::string getIndex(const std::shared_ptr<core::FlowFile> &flow) {
+  std::string index;
+  flow->getAttribute("index", index);
+  return index;
+}
+
+size_t countSwapFiles(const std::string &directory) {
+  size_t count = 0;
+  auto logger = logging::LoggerFactory<core::SwappingFlowFileQueue>::getLogger();
+  utils::file::FileUtils::list_dir(directory, [&](const std::string&, const std::string &filename) {
+    if (filename.find(core::SwappingFlowFileQueue::SwapFileExtension) != std::string::npos) {
+      count++;
+    }
+    return true;
+  }, logger, false);
+  return count;
+}
+
+}  // namespace
+
+TEST_CASE("SwappingQueueSwapsOutAndIn", "[swap1]") {
+  TestController testController;
+  char format[] = "/tmp/swap.XXXXXX";
+  std::string directory = testController.createTempDirectory(format);
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+
+  core::SwappingFlowFileQueue queue(core::FlowFileQueue::create("locking"), 10, directory, "connection", repo, nullptr);
+  REQUIRE("locking" == queue.getName());
+  for (int i = 0; i < 100; i++) {
+    queue.push(createFlowFile(repo, i));
+  }
+  // 10 flow files in the head and 90 in swap files of 5
+  REQUIRE(90 == queue.getSwappedCount());
+  REQUIRE(18 == queue.getSwapFileCount());
+
+  std::shared_ptr<core::FlowFile> flow;
+  for (int i = 0; i < 50; i++) {
+    REQUIRE(queue.tryPop(flow));
+    REQUIRE(std::to_string(i) == getIndex(flow));
+  }
+  std::vector<std::shared_ptr<core::FlowFile>> flows;
+  // each bulk pop drains the head and swaps in at most one swap file
+  while (queue.tryPopBulk(flows, 100, 0) > 0) {
+  }
+  REQUIRE(50 == flows.size());
+  for (int i = 0; i < 50; i++) {
+    REQUIRE(std::to_string(i + 50) == getIndex(flows[i]));
+  }
+  REQUIRE_FALSE(queue.tryPop(flow));
+  REQUIRE(0 == queue.getSwappedCount());
+  REQUIRE(0 == queue.getSwapFileCount());
+}
+
+TEST_CASE("SwappingQueueKeepsUnstoredFlowFiles", "[swap2]") {
+  TestController testController;
+  char format[] = "/tmp/swap.XXXXXX";
+  std::string directory = testController.createTempDirectory(format);
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+
+  core::SwappingFlowFileQueue queue(core::FlowFileQueue::create("locking"), 2, directory, "connection", repo, nullptr);
+  for (int i = 0; i < 6; i++) {
+    auto flow = createFlowFile(repo, i);
+    // flow files missing from the flow file repository cannot be swapped
+    flow->setStoredToRepository(i % 2 == 0);
+    queue.push(flow);
+  }
+  REQUIRE(2 == queue.getSwappedCount());
+
+  std::shared_ptr<core::FlowFile> flow;
+  std::set<std::string> indices;
+  while (queue.tryPop(flow)) {
+    indices.insert(getIndex(flow));
+  }
+  REQUIRE(6 == indices.size());
+}
+
+TEST_CASE("ConnectionSwapThreshold", "[swap3]") {
+  TestController testController;
+  char format[] = "/tmp/swap.XXXXXX";
+  std::string directory = testController.createTempDirectory(format);
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<minifi::Connection> connection = std::make_shared<minifi::Connection>(repo, content_repo, "testconnection");
+  connection->setSwapThreshold(4, directory);
+  REQUIRE(connection->setQueueType("concurrent"));
+  REQUIRE("concurrent" == connection->getQueueType());
+  REQUIRE(4 == connection->getSwapThreshold());
+
+  for (int i = 0; i < 20; i++) {
+    connection->put(createFlowFile(repo, i));
+  }
+  REQUIRE(20 == connection->getQueueSize());
+
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  for (int i = 0; i < 20; i++) {
+    auto flow = connection->poll(expired);
+    REQUIRE(nullptr != flow);
+    REQUIRE(std::to_string(i) == getIndex(flow));
+  }
+  REQUIRE(connection->isEmpty());
+}
+
+TEST_CASE("ConnectionStoresFlowFilesBeforeSwapping", "[swap4]") {
+  TestController testController;
+  char format[] = "/tmp/swap.XXXXXX";
+  std::string directory = testController.createTempDirectory(format);
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::VolatileContentRepository>();
+  content_repo->initialize(configuration);
+  std::shared_ptr<minifi::Connection> connection = std::make_shared<minifi::Connection>(repo, content_repo, "testconnection");
+  connection->setSwapThreshold(2, directory);
+
+  for (int i = 0; i < 6; i++) {
+    auto flow = createFlowFile(repo, i);
+    flow->setStoredToRepository(false);
+    connection->put(flow);
+    REQUIRE(flow->isStored());
+  }
+  // the flow files past the threshold were stored when they reached the queue, so each was swapped out
+  REQUIRE(4 == countSwapFiles(directory));
+
+  std::set<std::shared_ptr<core::FlowFile>> expired;
+  for (int i = 0; i < 6; i++) {
+    auto flow = connection->poll(expired);
+    REQUIRE(nullptr != flow);
+    REQUIRE(std::to_string(i) == getIndex(flow));
+  }
+}
+
+TEST_CASE("SwappingQueueRemovesStaleSwapFiles", "[swap5]") {
+  TestController testController;
+  char format[] = "/tmp/swap.XXXXXX";
+  std::string directory = testController.createTempDirectory(format);
+  std::shared_ptr<core::Repository> repo = std::make_shared<TestRepository>();
+  for (const auto &name : { "connection-0.swap", "removed-connection-3.swap" }) {
+    std::ofstream stale(utils::file::FileUtils::concat_path(directory, name));
+    stale << "stale";
+  }
+  std::ofstream(utils::file::FileUtils::concat_path(directory, "other.txt")) << "kept";
+  REQUIRE(2 == countSwapFiles(directory));
+
+  core::SwappingFlowFileQueue queue(core::FlowFileQueue::create("locking"), 2, directory, "connection", repo, nullptr);
+  REQUIRE(0 == countSwapFiles(directory));
+  std::ifstream kept(utils::file::FileUtils::concat_path(directory, "other.txt"));
+  REQUIRE(kept.good());
+
+  // swap files of the current run are left to their queues
+  for (int i = 0; i < 4; i++) {
+    queue.push(createFlowFile(repo, i));
+  }
+  REQUIRE(2 == countSwapFiles(directory));
+  core::SwappingFlowFileQueue other(core::FlowFileQueue::create("locking"), 2, directory, "other", repo, nullptr);
+  REQUIRE(2 == countSwapFiles(directory));
+}
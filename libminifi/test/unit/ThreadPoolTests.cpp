@@ -16,9 +16,13 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <chrono>
 #include <utility>
 #include <future>
 #include <memory>
+#include <string>
+#include <vector>
 #include "../TestBase.h"
 #include "utils/ThreadPool.h"
 
@@ -95,3 +99,64 @@ TEST_CASE("ThreadPoolTest2", "[TPT2]") {
   fut.wait();
   REQUIRE(20 == fut.get());
 }
+
+class ImmediateExecutions : public WorkerNumberExecutions {
+ public:
+  explicit ImmediateExecutions(int tasks)
+      : WorkerNumberExecutions(tasks) {
+  }
+
+  virtual int64_t wait_time() {
+    return 0;
+  }
+};
+
+TEST_CASE("WorkStealingThreadPoolTest1", "[TPT3]") {
+  utils::ThreadPool<bool> pool(5, false, nullptr, "WorkStealingPool", true);
+  REQUIRE(pool.isWorkStealing());
+  std::function<bool()> f_ex = function;
+  utils::Worker<bool> functor(f_ex, "id");
+  pool.start();
+  std::future<bool> fut;
+  REQUIRE(true == pool.execute(std::move(functor), fut));
+  fut.wait();
+  REQUIRE(true == fut.get());
+}
+
+TEST_CASE("WorkStealingThreadPoolTest2", "[TPT4]") {
+  counter = 0;
+  utils::ThreadPool<int> pool(5, false, nullptr, "WorkStealingPool", true);
+  std::function<int()> f_ex = counterFunction;
+  std::unique_ptr<utils::AfterExecute<int>> after_execute = std::unique_ptr<utils::AfterExecute<int>>(new WorkerNumberExecutions(20));
+  utils::Worker<int> functor(f_ex, "id", std::move(after_execute));
+  auto start = std::chrono::steady_clock::now();
+  pool.start();
+  std::future<int> fut;
+  REQUIRE(true == pool.execute(std::move(functor), fut));
+  fut.wait();
+  REQUIRE(20 == fut.get());
+  // the task waits 50ms between each of its runs
+  REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(19 * 50));
+}
+
+TEST_CASE("WorkStealingThreadPoolTest3", "[TPT5]") {
+  std::atomic<int> executions(0);
+  utils::ThreadPool<int> pool(4, false, nullptr, "WorkStealingPool", true);
+  // tasks queued before the pool starts are run once it does
+  std::vector<std::future<int>> futures;
+  for (int i = 0; i < 50; i++) {
+    std::function<int()> f_ex = [&executions]() {
+      return ++executions;
+    };
+    std::unique_ptr<utils::AfterExecute<int>> after_execute = std::unique_ptr<utils::AfterExecute<int>>(new ImmediateExecutions(10));
+    utils::Worker<int> functor(f_ex, "id" + std::to_string(i), std::move(after_execute));
+    std::future<int> fut;
+    REQUIRE(true == pool.execute(std::move(functor), fut));
+    futures.push_back(std::move(fut));
+  }
+  pool.start();
+  for (auto &fut : futures) {
+    fut.wait();
+  }
+  REQUIRE(500 == executions);
+}
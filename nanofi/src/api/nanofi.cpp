@@ -68,6 +68,30 @@ file_buffer file_to_buffer(const char *path) {
   return fb;
 }
 
+//Just an internal utility func., not to be published via API!
+//Content repositories may store the content of several flow files in one file, so the content of a record
+//created from a flow file is the range that flow file occupies in its claim
+void get_content_range(const flow_file_record *ff, uint64_t &offset, uint64_t &size) {
+  offset = 0;
+  size = ff->size;
+  if (ff->ffp) {
+    auto flow = *static_cast<std::shared_ptr<core::FlowFile>*>(ff->ffp);
+    auto claim = flow ? flow->getResourceClaim() : nullptr;
+    if (claim && ff->contentLocation && claim->getContentFullPath() == ff->contentLocation) {
+      offset = flow->getOffset();
+      size = flow->getSize();
+    }
+  }
+}
+
+//Just an internal utility func., not to be published via API!
+std::shared_ptr<minifi::io::BaseStream> read_content(const flow_file_record *ff, const std::shared_ptr<minifi::core::ContentRepository> &content_repo) {
+  uint64_t offset, size;
+  get_content_range(ff, offset, size);
+  std::shared_ptr<minifi::ResourceClaim> claim = std::make_shared<minifi::ResourceClaim>(ff->contentLocation, content_repo);
+  return content_repo->read(claim, offset, size);
+}
+
 int API_INITIALIZER::initialized = initialize_api();
 
 static nifi_instance* standalone_instance = nullptr;
@@ -284,10 +308,9 @@ void free_flowfile(flow_file_record *ff) {
     }
     delete content_repo_ptr;
   }
-  if (ff->ffp == nullptr) {
-    auto map = static_cast<string_map*>(ff->attributes);
-    delete map;
-  } else {
+  auto map = static_cast<string_map*>(ff->attributes);
+  delete map;
+  if (ff->ffp != nullptr) {
     auto ff_sptr = reinterpret_cast<std::shared_ptr<core::FlowFile>*>(ff->ffp);
     delete ff_sptr;
   }
@@ -386,9 +409,7 @@ int get_content(const flow_file_record* ff, uint8_t* target, int size) {
   NULL_CHECK(0, ff, target);
   auto content_repo = static_cast<std::shared_ptr<minifi::core::ContentRepository>*>(ff->crp);
   if(ff->crp && (*content_repo)) {
-    std::shared_ptr<minifi::ResourceClaim> claim = std::make_shared<minifi::ResourceClaim>(ff->contentLocation,
-                                                                                           *content_repo);
-    auto stream = (*content_repo)->read(claim);
+    auto stream = read_content(ff, *content_repo);
     return stream->read(target, size);
   } else {
     file_buffer fb = file_to_buffer(ff->contentLocation);
@@ -446,7 +467,14 @@ int transmit_flowfile(flow_file_record *ff, nifi_instance *instance) {
 
   auto ffr = std::make_shared<minifi::FlowFileRecord>(no_op, content_repo, attribute_map, claim);
   ffr->addAttribute("nanofi.version", API_VERSION);
-  ffr->setSize(ff->size);
+  if (claim) {
+    uint64_t offset, size;
+    get_content_range(ff, offset, size);
+    ffr->setOffset(offset);
+    ffr->setSize(size);
+  } else {
+    ffr->setSize(ff->size);
+  }
 
   std::string port_uuid = instance->port.port_id;
 
@@ -562,7 +590,7 @@ flow_file_record* flowfile_to_record(std::shared_ptr<core::FlowFile> ff, const s
   auto path = claim->getContentFullPath();
   auto ffr = create_ff_object_na(path.c_str(), path.length(), ff->getSize());
   ffr->ffp = static_cast<void*>(new std::shared_ptr<core::FlowFile>(ff));
-  ffr->attributes = ff->getAttributesPtr();
+  ffr->attributes = new string_map(ff->getAttributes());
   auto content_repo_ptr = static_cast<std::shared_ptr<minifi::core::ContentRepository>*>(ffr->crp);
   *content_repo_ptr = crp;
   return ffr;
@@ -634,9 +662,7 @@ flow_file_record *invoke_ff(standalone_processor* proc, const flow_file_record *
     auto ff_data = std::make_shared<flowfile_input_params>();
 
     if(input_ff->crp && (*content_repo)) {
-      std::shared_ptr<minifi::ResourceClaim> claim = std::make_shared<minifi::ResourceClaim>(input_ff->contentLocation,
-                                                                                             *content_repo);
-      ff_data->content_stream = (*content_repo)->read(claim);
+      ff_data->content_stream = read_content(input_ff, *content_repo);
     } else {
       ff_data->content_stream = std::make_shared<minifi::io::DataStream>();
       file_buffer fb = file_to_buffer(input_ff->contentLocation);
@@ -713,6 +739,10 @@ int transfer_to_relationship(flow_file_record * ffr, processor_session * ps, con
     return -1;
   }
   auto ff_sptr = reinterpret_cast<std::shared_ptr<core::FlowFile>*>(ffr->ffp);
+  // the record holds a copy of the attributes, which may have been modified
+  if (ffr->attributes) {
+    (*ff_sptr)->setAttributes(*static_cast<string_map*>(ffr->attributes));
+  }
   ps->transfer(*ff_sptr, core::Relationship(relationship, "desc"));
   return 0;
 }
@@ -30,6 +30,7 @@
 #include <chrono>
 #include <thread>
 #include "api/nanofi.h"
+#include "core/repository/FileSystemRepository.h"
 
 std::string test_file_content = "C API raNdOMcaSe test d4t4 th1s is!";
 std::string test_file_name = "tstFile.ext";
@@ -428,6 +429,65 @@ TEST_CASE("Test standalone processors with file input", "[testStandaloneWithFile
   free_standalone_processor(extract_test);
 }
 
+TEST_CASE("Test flow files sharing a content container", "[testSharedContainer]") {
+  TestController testController;
+
+  char format[] = "/tmp/content.XXXXXX";
+  auto content_dir = testController.createTempDirectory(format);
+  std::shared_ptr<minifi::Configure> configuration = std::make_shared<minifi::Configure>();
+  configuration->set(minifi::Configure::nifi_dbcontent_repository_directory_default, content_dir);
+  configuration->set(minifi::Configure::nifi_content_claim_max_appendable_size, "1 MB");
+  std::shared_ptr<core::ContentRepository> content_repo = std::make_shared<core::repository::FileSystemRepository>();
+  REQUIRE(content_repo->initialize(configuration));
+  std::shared_ptr<core::Repository> flow_repo = std::make_shared<TestRepository>();
+
+  // both flow files append their content to the same container
+  std::vector<std::string> contents = { "first content", "the second content" };
+  std::vector<flow_file_record*> records;
+  for (auto &content : contents) {
+    std::shared_ptr<minifi::ResourceClaim> claim = std::make_shared<minifi::ResourceClaim>(content_repo);
+    auto stream = content_repo->write(claim);
+    REQUIRE(static_cast<int>(content.size()) == stream->writeData(reinterpret_cast<uint8_t*>(&content[0]), content.size()));
+    stream->closeStream();
+    std::shared_ptr<core::FlowFile> flow = std::make_shared<minifi::FlowFileRecord>(flow_repo, content_repo, std::map<std::string, std::string>(), claim);
+    flow->setOffset(claim->getOffset());
+    flow->setSize(content.size());
+
+    std::string location = claim->getContentFullPath();
+    flow_file_record *ffr = create_ff_object(location.c_str(), location.length(), content.size());
+    *static_cast<std::shared_ptr<core::ContentRepository>*>(ffr->crp) = content_repo;
+    ffr->ffp = static_cast<void*>(new std::shared_ptr<core::FlowFile>(flow));
+    ffr->keepContent = 1;
+    records.push_back(ffr);
+  }
+  REQUIRE(std::string(records[0]->contentLocation) == records[1]->contentLocation);
+
+  for (size_t i = 0; i < records.size(); i++) {
+    // a buffer larger than the content must only receive the content of this flow file
+    std::vector<uint8_t> buffer(64);
+    int read = get_content(records[i], buffer.data(), buffer.size());
+    REQUIRE(contents[i] == std::string(reinterpret_cast<char*>(buffer.data()), read > 0 ? read : 0));
+
+    standalone_processor* extract_test = create_processor("ExtractText");
+    REQUIRE(extract_test != nullptr);
+    REQUIRE(set_standalone_property(extract_test, "Attribute", "TestAttr") == 0);
+    flow_file_record* ffr = invoke_ff(extract_test, records[i]);
+    REQUIRE(ffr != nullptr);
+    attribute attr;
+    char test_attr[] = "TestAttr";
+    attr.key = test_attr;
+    attr.value_size = 0;
+    REQUIRE(get_attribute(ffr, &attr) == 0);
+    REQUIRE(std::string(static_cast<char*>(attr.value), attr.value_size) == contents[i]);
+    free_flowfile(ffr);
+    free_standalone_processor(extract_test);
+  }
+
+  for (auto ffr : records) {
+    free_flowfile(ffr);
+  }
+}
+
 TEST_CASE("Test custom processor", "[TestCutomProcessor]") {
   TestController testController;
 